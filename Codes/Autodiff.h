@@ -0,0 +1,212 @@
+#ifndef __AUTODIFF__H
+#define __AUTODIFF__H
+
+#include <vector>
+#include <cmath>
+#include <math.h>
+// ------------------------------------------ Reverse mode automatic differentiation ------------------------------------------------
+// A Var is a number that records on a tape how it was computed. After the evaluation the tape is run backwards once,
+// which gives the derivatives of the result with respect to all the independent variables, whatever their number.
+// Operations involving only constants (Vars not on the tape) are not recorded. Every thread records on its own tape.
+// A node may have any number of parents, so that the kernels differentiated by hand (Kernels.h) record a single node per
+// result, with one edge to each of their inputs.
+
+using namespace std;
+
+struct TapeNode {
+  int a, b; // parents on the tape, -1 if none; a = -2 - n for a node with n > 2 parents, whose edges start at edges[b]
+  double da, db; // derivatives with respect to them
+};
+
+struct TapeEdge {
+  int parent; // position of the parent on the tape
+  double d; // derivative of the node with respect to it
+};
+
+class Tape {
+public:
+
+  Tape() : nedges(0) {}
+
+  void clear()
+  {
+    nodes.clear();
+    nedges = 0;
+  }
+
+  int push(int a, double da, int b, double db)
+  {
+    TapeNode n = {a, b, da, db};
+    nodes.push_back(n);
+    return nodes.size() - 1;
+  }
+
+  // Node with any number of parents: Edge adds one to those of the next PushEdges, which returns the position of the node
+  void Edge(int parent, double d)
+  {
+    TapeEdge* e = AddEdges(1);
+    e->parent = parent;
+    e->d = d;
+  }
+  unsigned NEdges() const { return nedges; }
+  TapeEdge* AddEdges(unsigned n) // n more edges, to be filled
+  {
+    if (nedges + n > edges.size())
+      edges.resize(2 * (nedges + n));
+    nedges += n;
+    return &edges[nedges - n];
+  }
+  void RemoveEdges(unsigned n) { nedges -= n; } // the last n
+  int PushEdges(unsigned first) // the parents are given by the edges from position first on
+  {
+    int n = nedges - first;
+    if (n <= 2) // short enough for a plain node
+    {
+      TapeEdge e[2] = {{-1, 0.}, {-1, 0.}};
+      for (int k = 0; k < n; k++)
+        e[k] = edges[first + k];
+      nedges = first;
+      return n == 0 ? -1 : push(e[0].parent, e[0].d, e[1].parent, e[1].d);
+    }
+    return push(-2 - n, 0., first, 0.);
+  }
+
+  // grad[i] = d out / d (node i), for the first grad.size() nodes, which are the independent variables
+  void gradient(int out, vector<double>& grad)
+  {
+    adj.assign(nodes.size(), 0.);
+    if (out >= 0)
+      adj[out] = 1.;
+    for (int k = out; k >= 0; k--)
+    {
+      double w = adj[k];
+      if (w == 0.)
+        continue;
+      const TapeNode& n = nodes[k];
+      if (n.a < -1)
+      {
+        for (int e = n.b; e < n.b - 2 - n.a; e++)
+          adj[edges[e].parent] += edges[e].d * w;
+        continue;
+      }
+      if (n.a >= 0)
+        adj[n.a] += n.da * w;
+      if (n.b >= 0)
+        adj[n.b] += n.db * w;
+    }
+    for (unsigned i = 0; i < grad.size(); i++)
+      grad[i] = i < adj.size() ? adj[i] : 0.;
+  }
+
+  unsigned size() const { return nodes.size(); }
+
+  // Tape on which the calling thread records, set with Use before the evaluation
+  static Tape& Current() { return *CurrentPointer(); }
+  void Use() { CurrentPointer() = this; }
+
+private:
+  static Tape*& CurrentPointer()
+  {
+    static thread_local Tape* current = 0; // plain pointer, so that reading it needs no initialization check
+    return current;
+  }
+
+  // clear keeps the memory, so that a tape recording the same function at every call stops allocating after the first one
+  vector<TapeNode> nodes;
+  vector<TapeEdge> edges; // parents of the nodes with more than two, the first nedges in use
+  unsigned nedges;
+  vector<double> adj;
+};
+
+class Var {
+public:
+  double v; // value
+  int i; // position on the tape, -1 for a constant
+
+  Var() : v(0.), i(-1) {}
+  Var(double x) : v(x), i(-1) {}
+  Var(double x, int index) : v(x), i(index) {}
+
+  static Var Independent(double x) { return Var(x, Tape::Current().push(-1, 0., -1, 0.)); }
+
+  // result of a function of one or two Vars, f with derivatives da and db
+  static Var Unary(double f, const Var& a, double da)
+  {
+    if (a.i < 0)
+      return Var(f);
+    return Var(f, Tape::Current().push(a.i, da, -1, 0.));
+  }
+  static Var Binary(double f, const Var& a, double da, const Var& b, double db)
+  {
+    if (a.i < 0)
+      return Unary(f, b, db);
+    if (b.i < 0)
+      return Unary(f, a, da);
+    return Var(f, Tape::Current().push(a.i, da, b.i, db));
+  }
+
+  // result of a function of the n Vars *x[k], f with derivatives d[k]: a single node, whatever n
+  static Var Nary(double f, const Var* const* x, const double* d, unsigned n)
+  {
+    Tape& tape = Tape::Current();
+    unsigned first = tape.NEdges();
+    TapeEdge* e = tape.AddEdges(n);
+    unsigned m = 0;
+    for (unsigned k = 0; k < n; k++)
+      if (x[k]->i >= 0)
+      {
+        e[m].parent = x[k]->i;
+        e[m++].d = d[k];
+      }
+    tape.RemoveEdges(n - m);
+    return Var(f, tape.PushEdges(first));
+  }
+
+  Var& operator+=(const Var& b) { return *this = Binary(v + b.v, *this, 1., b, 1.); }
+  Var& operator-=(const Var& b) { return *this = Binary(v - b.v, *this, 1., b, -1.); }
+  Var& operator*=(const Var& b) { return *this = Binary(v * b.v, *this, b.v, b, v); }
+  Var& operator/=(const Var& b) { return *this = Binary(v / b.v, *this, 1. / b.v, b, -v / (b.v * b.v)); }
+};
+
+inline double Value(double x) { return x; }
+inline double Value(const Var& x) { return x.v; }
+
+inline Var operator+(const Var& a, const Var& b) { return Var::Binary(a.v + b.v, a, 1., b, 1.); }
+inline Var operator-(const Var& a, const Var& b) { return Var::Binary(a.v - b.v, a, 1., b, -1.); }
+inline Var operator*(const Var& a, const Var& b) { return Var::Binary(a.v * b.v, a, b.v, b, a.v); }
+inline Var operator/(const Var& a, const Var& b) { return Var::Binary(a.v / b.v, a, 1. / b.v, b, -a.v / (b.v * b.v)); }
+inline Var operator+(double a, const Var& b) { return Var::Unary(a + b.v, b, 1.); }
+inline Var operator-(double a, const Var& b) { return Var::Unary(a - b.v, b, -1.); }
+inline Var operator*(double a, const Var& b) { return Var::Unary(a * b.v, b, a); }
+inline Var operator/(double a, const Var& b) { return Var::Unary(a / b.v, b, -a / (b.v * b.v)); }
+inline Var operator+(const Var& a, double b) { return Var::Unary(a.v + b, a, 1.); }
+inline Var operator-(const Var& a, double b) { return Var::Unary(a.v - b, a, 1.); }
+inline Var operator*(const Var& a, double b) { return Var::Unary(a.v * b, a, b); }
+inline Var operator/(const Var& a, double b) { return Var::Unary(a.v / b, a, 1. / b); }
+inline Var operator-(const Var& a) { return Var::Unary(-a.v, a, -1.); }
+inline Var operator+(const Var& a) { return a; }
+
+inline bool operator==(const Var& a, const Var& b) { return a.v == b.v; }
+inline bool operator!=(const Var& a, const Var& b) { return a.v != b.v; }
+inline bool operator<(const Var& a, const Var& b) { return a.v < b.v; }
+inline bool operator>(const Var& a, const Var& b) { return a.v > b.v; }
+inline bool operator<=(const Var& a, const Var& b) { return a.v <= b.v; }
+inline bool operator>=(const Var& a, const Var& b) { return a.v >= b.v; }
+
+inline Var sin(const Var& a) { return Var::Unary(std::sin(a.v), a, std::cos(a.v)); }
+inline Var cos(const Var& a) { return Var::Unary(std::cos(a.v), a, -std::sin(a.v)); }
+inline Var tan(const Var& a) { double t = std::tan(a.v); return Var::Unary(t, a, 1. + t * t); }
+inline Var atan(const Var& a) { return Var::Unary(std::atan(a.v), a, 1. / (1. + a.v * a.v)); }
+inline Var atan2(const Var& y, const Var& x)
+{
+  double r2 = x.v * x.v + y.v * y.v;
+  return Var::Binary(std::atan2(y.v, x.v), y, x.v / r2, x, -y.v / r2);
+}
+inline Var sqrt(const Var& a) { double s = std::sqrt(a.v); return Var::Unary(s, a, 0.5 / s); }
+inline Var exp(const Var& a) { double e = std::exp(a.v); return Var::Unary(e, a, e); }
+inline Var log(const Var& a) { return Var::Unary(std::log(a.v), a, 1. / a.v); }
+inline Var fabs(const Var& a) { return Var::Unary(std::fabs(a.v), a, a.v < 0. ? -1. : 1.); }
+inline Var remainder(const Var& a, double b) { return Var::Unary(std::remainder(a.v, b), a, 1.); }
+inline Var pow(const Var& a, double p) { double f = std::pow(a.v, p); return Var::Unary(f, a, p * std::pow(a.v, p - 1.)); }
+
+#endif
@@ -0,0 +1,175 @@
+#include "BlockDiagonalGaussian.h"
+
+BlockDiagonalGaussian::BlockDiagonalGaussian(const MeasurementRegistry<dato>& meas,
+                                             const MeasurementRegistry<CorrelatedGaussianObservables>& corrmeas,
+                                             const vector<unsigned>& predoffset_i)
+{
+  mean.assign(Meas::N, 0.);
+  invsigma2.assign(Meas::N, 0.);
+  for (unsigned i = 0; i < Meas::N; i++)
+    if (meas.Has(i))
+    {
+      mean[i] = meas[i].getMean();
+      invsigma2[i] = meas[i].getInvSigma2();
+    }
+
+  firstblock.assign(CorrMeas::N + 1, 0);
+  for (unsigned id = 0; id < CorrMeas::N; id++)
+  {
+    firstblock[id] = dim.size();
+    if (!corrmeas.Has(id))
+      continue;
+    const CorrelatedGaussianObservables& c = corrmeas[id];
+    dim.push_back(c.size());
+    predoffset.push_back(predoffset_i[id]);
+    woffset.push_back(W.size());
+    obsoffset.push_back(WObs.size());
+    W.insert(W.end(), c.getW().begin(), c.getW().end());
+    WObs.insert(WObs.end(), c.getWObs().begin(), c.getWObs().end());
+    sign.insert(sign.end(), c.getSign().begin(), c.getSign().end());
+  }
+  firstblock[CorrMeas::N] = dim.size();
+}
+
+double BlockDiagonalGaussian::logweight(const double* spred, const double* pred, unsigned mfirst, unsigned mlast,
+                                       unsigned cfirst, unsigned clast) const
+{
+  double chisq = 0.;
+
+  // 1x1 blocks
+  const double* m = mean.data();
+  const double* w = invsigma2.data();
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : chisq)
+#endif
+  for (unsigned i = mfirst; i < mlast; i++)
+  {
+    double d = spred[i] - m[i];
+    chisq += d * d * w[i];
+  }
+
+  // correlated blocks, stored one after the other so that Wi and WObsi just run through W and WObs
+  unsigned kfirst = firstblock[cfirst], klast = firstblock[clast];
+  if (kfirst == klast)
+    return -0.5 * chisq;
+  const double* Wi = &W[woffset[kfirst]];
+  const double* WObsi = &WObs[obsoffset[kfirst]];
+  const double* si = &sign[obsoffset[kfirst]];
+  for (unsigned k = kfirst; k < klast; k++)
+  {
+    const double* v = pred + predoffset[k];
+    int n = dim[k];
+    for (int i = 0; i < n; i++)
+    {
+      double z = -WObsi[i]; // i-th component of the whitened residual
+      for (int j = 0; j <= i; j++)
+        z += Wi[j] * v[j];
+      chisq += si[i] * z * z;
+      Wi += i + 1;
+    }
+    WObsi += n;
+    si += n;
+  }
+
+  return -0.5 * chisq;
+}
+
+Var BlockDiagonalGaussian::logweight(const Var* spred, const Var* pred, unsigned mfirst, unsigned mlast,
+                                    unsigned cfirst, unsigned clast) const
+{
+  // the value is accumulated in chisq; the result is one node of the tape, with an edge to each prediction on it
+  double chisq = 0.;
+  Tape& tape = Tape::Current();
+  unsigned first = tape.NEdges();
+
+  for (unsigned i = mfirst; i < mlast; i++)
+  {
+    double d = spred[i].v - mean[i];
+    chisq += d * d * invsigma2[i];
+    if (spred[i].i >= 0)
+      tape.Edge(spred[i].i, -d * invsigma2[i]);
+  }
+
+  unsigned kfirst = firstblock[cfirst], klast = firstblock[clast];
+  if (kfirst < klast)
+  {
+    const double* Wblock = &W[woffset[kfirst]];
+    const double* WObsi = &WObs[obsoffset[kfirst]];
+    const double* si = &sign[obsoffset[kfirst]];
+    vector<double>& z = work; // whitened residual of the block
+    for (unsigned k = kfirst; k < klast; k++)
+    {
+      const Var* v = pred + predoffset[k];
+      int n = dim[k];
+      z.assign(n, 0.);
+      const double* Wi = Wblock;
+      for (int i = 0; i < n; i++)
+      {
+        z[i] = -WObsi[i];
+        for (int j = 0; j <= i; j++)
+          z[i] += Wi[j] * v[j].v;
+        chisq += si[i] * z[i] * z[i];
+        Wi += i + 1;
+      }
+      // d(-chi2/2)/dv_j = -sum_i W_ij sign_i z_i
+      for (int j = 0; j < n; j++)
+      {
+        if (v[j].i < 0)
+          continue; // constant prediction
+        double g = 0.;
+        for (int i = j; i < n; i++)
+          g -= Wblock[i * (i + 1) / 2 + j] * si[i] * z[i];
+        tape.Edge(v[j].i, g);
+      }
+      Wblock = Wi;
+      WObsi += n;
+      si += n;
+    }
+  }
+
+  return Var(-0.5 * chisq, tape.PushEdges(first));
+}
+
+#ifdef LANES
+Lanes BlockDiagonalGaussian::logweight(const Lanes* spred, const Lanes* pred, unsigned mfirst, unsigned mlast,
+                                      unsigned cfirst, unsigned clast) const
+{
+  Lanes chisq = 0.;
+
+  for (unsigned i = mfirst; i < mlast; i++)
+  {
+    Lanes d = spred[i] - mean[i];
+    chisq += d * d * invsigma2[i];
+  }
+
+  unsigned kfirst = firstblock[cfirst], klast = firstblock[clast];
+  if (kfirst == klast)
+    return -0.5 * chisq;
+  const double* Wi = &W[woffset[kfirst]];
+  const double* WObsi = &WObs[obsoffset[kfirst]];
+  const double* si = &sign[obsoffset[kfirst]];
+  for (unsigned k = kfirst; k < klast; k++)
+  {
+    const Lanes* v = pred + predoffset[k];
+    int n = dim[k];
+    for (int i = 0; i < n; i++)
+    {
+      Lanes z = -WObsi[i];
+      for (int j = 0; j <= i; j++)
+        z += Wi[j] * v[j];
+      chisq += si[i] * z * z;
+      Wi += i + 1;
+    }
+    WObsi += n;
+    si += n;
+  }
+
+  return -0.5 * chisq;
+}
+#endif
+
+unsigned BlockDiagonalGaussian::memory() const
+{
+  return (mean.size() + invsigma2.size() + W.size() + WObs.size() + sign.size()) * sizeof(double)
+    + (dim.size() + predoffset.size() + woffset.size() + obsoffset.size() + firstblock.size()) * sizeof(unsigned);
+}
@@ -0,0 +1,49 @@
+#ifndef __BLOCKDIAGONALGAUSSIAN__H
+#define __BLOCKDIAGONALGAUSSIAN__H
+
+#include <vector>
+#include "dato.h"
+#include "CorrelatedGaussianObservables.h"
+#include "MeasurementRegistry.h"
+#include "Autodiff.h"
+#include "Lanes.h"
+// ------------------------------------------ All the Gaussian measurements of a combination in one structure ------------------------------------------------
+// The measurements form a single Gaussian with block-diagonal covariance: a 1x1 block for each dato and one block for each
+// CorrelatedGaussianObservables. The inverse variances and the whitening factors are copied here, in order of handle, into
+// a few contiguous arrays, so that the chi2 of a range of handles is one pass over contiguous memory.
+
+using namespace std;
+
+class BlockDiagonalGaussian {
+public:
+
+  BlockDiagonalGaussian() {};
+  // predoffset[id] is the position of the predictions of the correlated measurement id in the prediction buffer
+  BlockDiagonalGaussian(const MeasurementRegistry<dato>& meas, const MeasurementRegistry<CorrelatedGaussianObservables>& corrmeas,
+                        const vector<unsigned>& predoffset);
+
+  // -chi2/2 of the uncorrelated measurements with handles in [mfirst, mlast) and of the correlated ones with handles in
+  // [cfirst, clast). spred holds the uncorrelated predictions indexed by Meas::Id, pred the buffer of the correlated ones.
+  double logweight(const double* spred, const double* pred, unsigned mfirst, unsigned mlast, unsigned cfirst, unsigned clast) const;
+  // Same to differentiate the likelihood: the derivatives with respect to the predictions, -(W^T W)(v - Obs), are put on
+  // the tape directly, as the edges of a single node
+  Var logweight(const Var* spred, const Var* pred, unsigned mfirst, unsigned mlast, unsigned cfirst, unsigned clast) const;
+#ifdef LANES
+  // Same for the points in the lanes of a pack, the operations of the double version being done on all the lanes at once
+  Lanes logweight(const Lanes* spred, const Lanes* pred, unsigned mfirst, unsigned mlast, unsigned cfirst, unsigned clast) const;
+#endif
+
+  unsigned memory() const; // bytes taken by the packed arrays
+
+private:
+  vector<double> mean, invsigma2; // uncorrelated measurements, indexed by Meas::Id; zero weight for the handles not used
+  // Correlated measurements, one block after the other: W = L^-1 packed by rows as in CorrelatedGaussianObservables, W Obs
+  // and the sign of each row in the chi2
+  vector<double> W, WObs, sign;
+  vector<unsigned> dim, predoffset; // size and position in the prediction buffer of each block
+  vector<unsigned> woffset, obsoffset; // start of each block in W and in WObs and sign
+  vector<unsigned> firstblock; // firstblock[id] is the first block with handle >= id, firstblock[CorrMeas::N] the number of blocks
+  mutable vector<double> work; // whitened residual of a block, for the Var logweight
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef __CHECKPOINT__H
+#define __CHECKPOINT__H
+
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+#include <TDirectory.h>
+#include <TRandom3.h>
+// ------------------------------------------ State of a run in a checkpoint ------------------------------------------------
+// The state of the samplers, of the convergence monitor and of BAT's statistics is packed into flat vectors of doubles,
+// which keep the positions bit for bit and the counters exactly up to 2^53; the generators are written as ROOT objects,
+// the only access to their state.
+
+using namespace std;
+
+class StateWriter {
+public:
+  void Add(double v) { state.push_back(v); }
+  void Add(const vector<double>& v)
+  {
+    state.push_back(v.size());
+    state.insert(state.end(), v.begin(), v.end());
+  }
+  void Write(TDirectory& dir, const char* name) const { dir.WriteObject(&state, name); }
+
+private:
+  vector<double> state;
+};
+
+class StateReader {
+public:
+  StateReader(TDirectory& dir, const char* name) : pos(0)
+  {
+    vector<double>* s = 0;
+    dir.GetObject(name, s);
+    if (!s)
+    {
+      cout << "The checkpoint has no " << name << endl;
+      exit(EXIT_FAILURE);
+    }
+    state.swap(*s);
+    delete s;
+  }
+  double Next()
+  {
+    if (pos >= state.size())
+    {
+      cout << "The checkpoint is truncated" << endl;
+      exit(EXIT_FAILURE);
+    }
+    return state[pos++];
+  }
+  void Next(vector<double>& v)
+  {
+    v.resize((size_t)Next());
+    for (size_t i = 0; i < v.size(); i++)
+      v[i] = Next();
+  }
+
+private:
+  vector<double> state;
+  size_t pos;
+};
+
+inline void WriteRandom(TDirectory& dir, const char* name, const TRandom3& rnd)
+{
+  dir.WriteTObject(&rnd, name);
+}
+
+inline void ReadRandom(TDirectory& dir, const char* name, TRandom3& rnd)
+{
+  TRandom3* r = 0;
+  dir.GetObject(name, r);
+  if (!r)
+  {
+    cout << "The checkpoint has no generator " << name << endl;
+    exit(EXIT_FAILURE);
+  }
+  rnd = *r;
+  delete r;
+}
+
+#endif
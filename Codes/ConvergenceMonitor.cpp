@@ -0,0 +1,304 @@
+#include "ConvergenceMonitor.h"
+#include "Checkpoint.h"
+
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <TMath.h>
+
+// in-place radix-2 FFT, a.size() a power of 2
+static void FFT(vector<complex<double> >& a, bool inverse)
+{
+  unsigned n = a.size();
+  for (unsigned i = 1, j = 0; i < n; i++)
+  {
+    unsigned bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      swap(a[i], a[j]);
+  }
+  for (unsigned len = 2; len <= n; len <<= 1)
+  {
+    double angle = (inverse ? -2. : 2.) * M_PI / len;
+    complex<double> wlen(cos(angle), sin(angle));
+    for (unsigned i = 0; i < n; i += len)
+    {
+      complex<double> w(1.);
+      for (unsigned j = 0; j < len / 2; j++)
+      {
+        complex<double> u = a[i + j], v = a[i + j + len / 2] * w;
+        a[i + j] = u + v;
+        a[i + j + len / 2] = u - v;
+        w *= wlen;
+      }
+    }
+  }
+  if (inverse)
+    for (unsigned i = 0; i < n; i++)
+      a[i] /= n;
+}
+
+// autocovariance of x at lags 0 ... n-1, biased estimate
+static void Autocovariance(const vector<double>& x, vector<double>& acov)
+{
+  unsigned n = x.size(), m = 1;
+  while (m < 2 * n)
+    m <<= 1;
+  double mean = 0.;
+  for (unsigned i = 0; i < n; i++)
+    mean += x[i];
+  mean /= n;
+  vector<complex<double> > a(m, 0.);
+  for (unsigned i = 0; i < n; i++)
+    a[i] = x[i] - mean;
+  FFT(a, false);
+  for (unsigned i = 0; i < m; i++)
+    a[i] = norm(a[i]);
+  FFT(a, true);
+  acov.resize(n);
+  for (unsigned i = 0; i < n; i++)
+    acov[i] = a[i].real() / n;
+}
+
+// normal scores of the ranks of all the draws, the ties getting their average rank
+static void RankNormalize(vector<vector<double> >& chains)
+{
+  vector<pair<double, pair<unsigned, unsigned> > > all;
+  for (unsigned c = 0; c < chains.size(); c++)
+    for (unsigned k = 0; k < chains[c].size(); k++)
+      all.push_back(make_pair(chains[c][k], make_pair(c, k)));
+  sort(all.begin(), all.end());
+  double S = all.size();
+  for (unsigned i = 0; i < all.size();)
+  {
+    unsigned j = i;
+    while (j < all.size() && all[j].first == all[i].first)
+      j++;
+    double r = 0.5 * (i + j - 1) + 1.; // average rank, from 1
+    double z = TMath::NormQuantile((r - 0.375) / (S + 0.25));
+    for (unsigned k = i; k < j; k++)
+      chains[all[k].second.first][all[k].second.second] = z;
+    i = j;
+  }
+}
+
+ConvergenceMonitor::ConvergenceMonitor(unsigned nch, const vector<string>& n, unsigned maxd)
+  : names(n), nchains(nch), maxdraws(maxd & ~1u), stride(1)
+{
+  count.assign(nchains, 0);
+  draws.assign(nchains, vector<vector<double> >(names.size()));
+  rhat.assign(names.size(), 0.);
+  bulkess.assign(names.size(), 0.);
+  tailess.assign(names.size(), 0.);
+}
+
+void ConvergenceMonitor::Add(unsigned ichain, const vector<double>& values)
+{
+  if (count[ichain]++ % stride != 0)
+    return;
+  for (unsigned i = 0; i < names.size(); i++)
+    draws[ichain][i].push_back(values[i]);
+
+  if (ichain == nchains - 1 && draws[ichain][0].size() == maxdraws)
+  { // full: keep one draw in two, and store one in 2 stride from now on
+    for (unsigned c = 0; c < nchains; c++)
+      for (unsigned i = 0; i < names.size(); i++)
+      {
+        vector<double>& d = draws[c][i];
+        for (unsigned k = 0; k < maxdraws / 2; k++)
+          d[k] = d[2 * k];
+        d.resize(maxdraws / 2);
+      }
+    stride *= 2;
+  }
+}
+
+void ConvergenceMonitor::Split(unsigned i, vector<vector<double> >& chains) const
+{
+  chains.clear();
+  for (unsigned c = 0; c < nchains; c++)
+  {
+    const vector<double>& d = draws[c][i];
+    unsigned half = d.size() / 2;
+    chains.push_back(vector<double>(d.begin(), d.begin() + half));
+    chains.push_back(vector<double>(d.end() - half, d.end())); // the middle draw is dropped if the number is odd
+  }
+}
+
+double ConvergenceMonitor::SplitRhat(const vector<vector<double> >& chains) const
+{
+  unsigned m = chains.size(), n = chains[0].size();
+  double W = 0., meanall = 0.;
+  vector<double> mean(m, 0.);
+  for (unsigned c = 0; c < m; c++)
+  {
+    for (unsigned k = 0; k < n; k++)
+      mean[c] += chains[c][k];
+    mean[c] /= n;
+    meanall += mean[c] / m;
+    double s = 0.;
+    for (unsigned k = 0; k < n; k++)
+      s += (chains[c][k] - mean[c]) * (chains[c][k] - mean[c]);
+    W += s / (n - 1.) / m;
+  }
+  double B = 0.;
+  for (unsigned c = 0; c < m; c++)
+    B += (mean[c] - meanall) * (mean[c] - meanall) * n / (m - 1.);
+  if (!(W > 0.))
+    return B > 0. ? HUGE_VAL : 1.;
+  return sqrt(((n - 1.) / n * W + B / n) / W);
+}
+
+double ConvergenceMonitor::ESS(const vector<vector<double> >& chains) const
+{
+  // Geyer's initial monotone sequence on the autocorrelation of all the chains together (Stan's estimator)
+  unsigned m = chains.size(), n = chains[0].size();
+  vector<vector<double> > acov(m);
+  vector<double> mean(m, 0.);
+  double W = 0., meanall = 0.;
+  for (unsigned c = 0; c < m; c++)
+  {
+    Autocovariance(chains[c], acov[c]);
+    for (unsigned k = 0; k < n; k++)
+      mean[c] += chains[c][k];
+    mean[c] /= n;
+    meanall += mean[c] / m;
+    W += acov[c][0] * n / (n - 1.) / m;
+  }
+  double B = 0.;
+  for (unsigned c = 0; c < m; c++)
+    B += (mean[c] - meanall) * (mean[c] - meanall) * n / (m - 1.);
+  double varplus = (n - 1.) / n * W + B / n;
+  if (!(varplus > 0.))
+    return m * n; // constant
+
+  vector<double> rho(n);
+  for (unsigned t = 0; t < n; t++)
+  {
+    double s = 0.;
+    for (unsigned c = 0; c < m; c++)
+      s += acov[c][t];
+    rho[t] = 1. - (W - s / m) / varplus;
+  }
+  double tau = -1., previous = HUGE_VAL;
+  for (unsigned t = 0; t + 1 < n; t += 2)
+  {
+    double P = rho[t] + rho[t + 1];
+    if (P < 0.)
+      break;
+    if (P > previous)
+      P = previous;
+    previous = P;
+    tau += 2. * P;
+  }
+  tau = max(tau, 1. / log10((double)m * n));
+  return m * n / tau;
+}
+
+void ConvergenceMonitor::Compute()
+{
+  vector<vector<double> > chains, work;
+  for (unsigned i = 0; i < names.size(); i++)
+  {
+    if (draws[0][i].size() < 4)
+    {
+      rhat[i] = HUGE_VAL;
+      bulkess[i] = tailess[i] = 0.;
+      continue;
+    }
+    Split(i, chains);
+
+    // bulk: rank-normalized draws; tail: rank-normalized distance from the median
+    work = chains;
+    RankNormalize(work);
+    double rbulk = SplitRhat(work);
+    bulkess[i] = ESS(work);
+
+    vector<double> all;
+    for (unsigned c = 0; c < chains.size(); c++)
+      all.insert(all.end(), chains[c].begin(), chains[c].end());
+    sort(all.begin(), all.end());
+    unsigned S = all.size();
+    double median = 0.5 * (all[(S - 1) / 2] + all[S / 2]);
+    double q05 = all[(unsigned)(0.05 * (S - 1))], q95 = all[(unsigned)(0.95 * (S - 1))];
+
+    work = chains;
+    for (unsigned c = 0; c < work.size(); c++)
+      for (unsigned k = 0; k < work[c].size(); k++)
+        work[c][k] = fabs(work[c][k] - median);
+    RankNormalize(work);
+    rhat[i] = max(rbulk, SplitRhat(work));
+
+    // tail ESS: the worse of the ESS of the indicators of the 5% and 95% quantiles
+    double tail = HUGE_VAL;
+    for (int side = 0; side < 2; side++)
+    {
+      double q = side ? q95 : q05;
+      work = chains;
+      for (unsigned c = 0; c < work.size(); c++)
+        for (unsigned k = 0; k < work[c].size(); k++)
+          work[c][k] = chains[c][k] <= q ? 1. : 0.;
+      tail = min(tail, ESS(work));
+    }
+    tailess[i] = tail;
+  }
+}
+
+double ConvergenceMonitor::MaxRhat(unsigned* index) const
+{
+  unsigned k = max_element(rhat.begin(), rhat.end()) - rhat.begin();
+  if (index)
+    *index = k;
+  return rhat.empty() ? 0. : rhat[k];
+}
+
+double ConvergenceMonitor::MinBulkESS(unsigned* index) const
+{
+  unsigned k = min_element(bulkess.begin(), bulkess.end()) - bulkess.begin();
+  if (index)
+    *index = k;
+  return bulkess.empty() ? 0. : bulkess[k];
+}
+
+double ConvergenceMonitor::MinTailESS(unsigned* index) const
+{
+  unsigned k = min_element(tailess.begin(), tailess.end()) - tailess.begin();
+  if (index)
+    *index = k;
+  return tailess.empty() ? 0. : tailess[k];
+}
+
+void ConvergenceMonitor::SaveState(TDirectory& dir) const
+{
+  StateWriter w;
+  w.Add(nchains);
+  w.Add(names.size());
+  w.Add(stride);
+  for (unsigned c = 0; c < nchains; c++)
+  {
+    w.Add(count[c]);
+    for (unsigned i = 0; i < names.size(); i++)
+      w.Add(draws[c][i]);
+  }
+  w.Write(dir, "monitor");
+}
+
+void ConvergenceMonitor::LoadState(TDirectory& dir)
+{
+  StateReader r(dir, "monitor");
+  unsigned nch = r.Next(), nq = r.Next();
+  if (nch != nchains || nq != names.size())
+  {
+    cout << "The checkpoint was written by a run monitoring other chains or quantities" << endl;
+    exit(EXIT_FAILURE);
+  }
+  stride = r.Next();
+  for (unsigned c = 0; c < nchains; c++)
+  {
+    count[c] = r.Next();
+    for (unsigned i = 0; i < names.size(); i++)
+      r.Next(draws[c][i]);
+  }
+}
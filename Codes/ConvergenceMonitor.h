@@ -0,0 +1,53 @@
+#ifndef __CONVERGENCEMONITOR__H
+#define __CONVERGENCEMONITOR__H
+
+#include <vector>
+#include <string>
+#include <TDirectory.h>
+// ------------------------------------------ Convergence diagnostics of a run ------------------------------------------------
+// Stores the draws of a set of quantities for every chain and computes, for each of them, the rank-normalized split R-hat
+// and the bulk and tail effective sample sizes of Vehtari et al., arXiv:1903.08008.
+// Memory is bounded: at most maxdraws draws per chain are kept; when they are all used, every other one is dropped and
+// only one draw in twice as many is stored from then on. The ESS are those of the stored draws, i.e. lower bounds of
+// those of the whole run.
+
+using namespace std;
+
+class ConvergenceMonitor {
+public:
+
+  ConvergenceMonitor(unsigned nchains, const vector<string>& names, unsigned maxdraws = 4096);
+
+  // next draw of a chain, values in the order of names; every iteration adds one draw to each chain, in order of chain
+  void Add(unsigned ichain, const vector<double>& values);
+  void Compute(); // diagnostics of the draws stored so far, at least 4 per chain are needed
+
+  double GetRhat(unsigned i) const { return rhat[i]; }
+  double GetBulkESS(unsigned i) const { return bulkess[i]; }
+  double GetTailESS(unsigned i) const { return tailess[i]; }
+  // worst values over the quantities, with the index of the quantity
+  double MaxRhat(unsigned* i = 0) const;
+  double MinBulkESS(unsigned* i = 0) const;
+  double MinTailESS(unsigned* i = 0) const;
+  const string& GetName(unsigned i) const { return names[i]; }
+  unsigned GetNQuantities() const { return names.size(); }
+  unsigned long GetNDraws() const { return count[0]; } // draws added per chain
+  unsigned GetStride() const { return stride; } // one draw in stride is stored
+
+  // stored draws, for the checkpoints of long runs
+  void SaveState(TDirectory& dir) const;
+  void LoadState(TDirectory& dir);
+
+private:
+  double SplitRhat(const vector<vector<double> >& chains) const;
+  double ESS(const vector<vector<double> >& chains) const;
+  void Split(unsigned i, vector<vector<double> >& chains) const; // the two halves of the stored draws of every chain
+
+  vector<string> names;
+  unsigned nchains, maxdraws, stride;
+  vector<unsigned long> count; // draws added to each chain
+  vector<vector<vector<double> > > draws; // draws[ichain][i] are the stored draws of quantity i
+  vector<double> rhat, bulkess, tailess;
+};
+
+#endif
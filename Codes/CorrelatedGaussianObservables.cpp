@@ -1,4 +1,6 @@
 #include "CorrelatedGaussianObservables.h"
+#include <iostream>
+#include <cmath>
 
 CorrelatedGaussianObservables::CorrelatedGaussianObservables(vector<dato> v_i,
         const TMatrixDSym& corr_i)
@@ -13,14 +15,14 @@ CorrelatedGaussianObservables::CorrelatedGaussianObservables(vector<dato> v_i,
       Obs(i++) = it->getMean(); //equivalente a Obs(i) = it -> GetMean(); i++;
     }
 
-    Cov.ResizeTo(n, n);
+    TMatrixDSym Cov(n);
     for(int i = 0; i < n; i++)
       for(int j = 0; j < n; j++)
 	      Cov(i,j) = Sig(i)*corr_i(i,j)*Sig(j);
 
     //norm = 1./sqrt(pow(2.*M_PI,n)*Cov.Determinant()); //Fattore di Normalizzazione inutile per il fattore di Bayes
 
-    Cov.InvertFast();
+    SetCovariance(Cov);
 
   }
 
@@ -37,14 +39,14 @@ CorrelatedGaussianObservables::CorrelatedGaussianObservables(vector<dato> v_i,
       Obs(i++) = it->getMean();
     }
 
-    Cov.ResizeTo(n, n);
+    TMatrixDSym Cov(n);
     for(int i = 0; i < n; i++)
       for(int j = 0; j < n; j++)
 	      Cov(i,j) = Sig1(i)*corr_1(i,j)*Sig1(j) + Sig2(i)*corr_2(i,j)*Sig2(j);
 
     //    norm = 1./sqrt(pow(2.*M_PI,n)*Cov.Determinant());
 
-    Cov.InvertFast(); //Calcola l'inversa
+    SetCovariance(Cov);
 
   }
 
@@ -62,29 +64,118 @@ CorrelatedGaussianObservables::CorrelatedGaussianObservables(vector<dato> v_i,
       Obs(i++) = it->getMean();
     }
 
-    Cov.ResizeTo(n, n);
+    TMatrixDSym Cov(n);
     for(int i = 0; i < n; i++)
       for(int j = 0; j < n; j++)
 	      Cov(i,j) = Sig1(i)*corr_1(i,j)*Sig1(j) + Sig2(i)*corr_2(i,j)*Sig2(j) + Sig3(i)*corr_3(i,j)*Sig3(j);
 
     //    norm = 1./sqrt(pow(2.*M_PI,n)*Cov.Determinant());
 
-    Cov.InvertFast(); //Calcola l'inversa
+    SetCovariance(Cov);
 
   }
 
 
-double CorrelatedGaussianObservables::logweight(const TVectorD& v) {
+void CorrelatedGaussianObservables::SetCovariance(const TMatrixDSym& Cov) {
     int n = Obs.GetNrows();
-    double chisq = 0.;
+    positive = true;
+    singular = false;
+    sign.assign(n, 1.);
+
+    // Cholesky decomposition Cov = L L^T, L stored packed like W
+    vector<double> L(n * (n + 1) / 2);
+    for(int i = 0; i < n && positive; i++) {
+      double* Li = &L[i * (i + 1) / 2];
+      for(int j = 0; j <= i; j++) {
+        const double* Lj = &L[j * (j + 1) / 2];
+        double sum = Cov(i,j);
+        for(int k = 0; k < j; k++)
+          sum -= Li[k] * Lj[k];
+        if (i == j) {
+          if (sum <= 0.) {
+            positive = false; // e.g. fully correlated uncertainties after rounding
+            break;
+          }
+          Li[i] = sqrt(sum);
+        }
+        else
+          Li[j] = sum / Lj[j];
+      }
+    }
 
-    if (n != v.GetNrows()) {
-      cout << "Errore in getWeight()" << endl;
-      exit(EXIT_FAILURE);
+    if (!positive) {
+      // Cov = L D L^T with L unit lower triangular, stored packed with its diagonal set to sqrt|D|, so that the
+      // substitution below gives |D|^-1/2 L^-1 and sign the sign of D
+      vector<double> D(n);
+      for(int i = 0; i < n; i++) {
+        double* Li = &L[i * (i + 1) / 2];
+        for(int j = 0; j <= i; j++) {
+          const double* Lj = &L[j * (j + 1) / 2];
+          double sum = Cov(i,j);
+          for(int k = 0; k < j; k++)
+            sum -= Li[k] * Lj[k] * D[k];
+          if (i == j)
+            D[i] = sum;
+          else
+            Li[j] = sum / D[j];
+        }
+        if (fabs(D[i]) <= 1e-14 * fabs(Cov(i,i))) {
+          singular = true; // no inverse either: the measurement cannot be used
+          return;
+        }
+        if (D[i] < 0.)
+          sign[i] = -1.;
+        Li[i] = 1.; // unit diagonal for the next rows
+      }
+      // W = |D|^-1/2 L^-1: forward substitution with the unit diagonal, then the rows scaled
+      W.assign(n * (n + 1) / 2, 0.);
+      for(int j = 0; j < n; j++) {
+        W[j * (j + 1) / 2 + j] = 1.;
+        for(int i = j + 1; i < n; i++) {
+          const double* Li = &L[i * (i + 1) / 2];
+          double sum = 0.;
+          for(int k = j; k < i; k++)
+            sum -= Li[k] * W[k * (k + 1) / 2 + j];
+          W[i * (i + 1) / 2 + j] = sum;
+        }
+      }
+      for(int i = 0; i < n; i++)
+        for(int j = 0; j <= i; j++)
+          W[i * (i + 1) / 2 + j] /= sqrt(fabs(D[i]));
+    }
+    else {
+      // W = L^-1, column by column with forward substitution
+      W.assign(n * (n + 1) / 2, 0.);
+      for(int j = 0; j < n; j++) {
+        W[j * (j + 1) / 2 + j] = 1. / L[j * (j + 1) / 2 + j];
+        for(int i = j + 1; i < n; i++) {
+          const double* Li = &L[i * (i + 1) / 2];
+          double sum = 0.;
+          for(int k = j; k < i; k++)
+            sum -= Li[k] * W[k * (k + 1) / 2 + j];
+          W[i * (i + 1) / 2 + j] = sum / Li[i];
+        }
+      }
     }
+
+    WObs.assign(n, 0.);
     for(int i = 0; i < n; i++)
-      for(int j = 0; j < n; j++)
-	chisq += (v(i)-Obs(i))*Cov(i,j)*(v(j)-Obs(j));
+      for(int j = 0; j <= i; j++)
+        WObs[i] += W[i * (i + 1) / 2 + j] * Obs(j);
+  }
+
+double CorrelatedGaussianObservables::logweight(const double* v) const {
+    int n = WObs.size();
+    const double* Wi = W.data();
+    double chisq = 0.;
+
+    for(int i = 0; i < n; i++) {
+      double z = -WObs[i]; // i-th component of the whitened residual
+      for(int j = 0; j <= i; j++)
+        z += Wi[j] * v[j];
+      chisq += sign[i] * z * z; // sign[i] = 1 unless Cov is not positive definite
+      Wi += i + 1;
+    }
 
     return(-0.5*chisq);
   }
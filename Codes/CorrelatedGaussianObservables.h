@@ -22,18 +22,32 @@ public:
   CorrelatedGaussianObservables(vector<dato> v_i, const TMatrixDSym& corr_1, const TMatrixDSym& corr_2, const TMatrixDSym& corr_3) ;
   CorrelatedGaussianObservables(vector<dato> v_i, const TMatrixDSym& corr_1, const TMatrixDSym& corr_2) ;
   CorrelatedGaussianObservables(vector<dato> v_i, const TMatrixDSym& corr_i) ;
-  CorrelatedGaussianObservables(const CorrelatedGaussianObservables& orig)
-  :Obs(orig.getObs()),Cov(orig.getCov()) {};
 
   const TVectorD& getObs() const { return Obs; }
 
-  const TMatrixDSym& getCov() const { return Cov; }
+  int size() const { return Obs.GetNrows(); }
+  const vector<double>& getW() const { return W; }
+  const vector<double>& getWObs() const { return WObs; }
+  const vector<double>& getSign() const { return sign; }
+  bool IsPositiveDefinite() const { return positive; }
+  bool IsSingular() const { return singular; } // then the chi2 is not defined, see SetCovariance
 
-  double logweight(const TVectorD& v) ;
+  // -chi2/2 of the predictions v, which must have size() elements (not checked)
+  double logweight(const TVectorD& v) const { return logweight(v.GetMatrixArray()); }
+  double logweight(const double* v) const;
 
 private:
+  void SetCovariance(const TMatrixDSym& Cov); // Compute the whitening factor W and WObs
+
   TVectorD Obs;
-  TMatrixDSym Cov;
+  // W = L^-1, with Cov = L L^T the Cholesky decomposition, so that chi2 = |W v - W Obs|^2.
+  // W is lower triangular and stored packed by rows: row i starts at i*(i+1)/2 and has i+1 elements.
+  // If Cov is not positive definite, W = |D|^-1/2 L^-1 with Cov = L D L^T, L unit lower triangular, and the rows with
+  // D < 0 count negatively: chi2 = sum_i sign[i] (W v - W Obs)_i^2, which is (v - Obs)^T Cov^-1 (v - Obs) as before.
+  vector<double> W;
+  vector<double> WObs;
+  vector<double> sign; // +1 or -1 for each row of W
+  bool positive, singular;
 };
 
 #endif	/* CORRELATEDGAUSSIANOBSERVABLES_H */
@@ -0,0 +1,279 @@
+#ifndef __KERNELS__H
+#define __KERNELS__H
+
+#include "Phase.h"
+#include "Autodiff.h"
+// ------------------------------------------ Formulas of the fit as templates over the numeric type ------------------------------------------------
+// Every input, including gamma and the D mixing parameters, is an argument, so that the same code can be instantiated
+// for double (the fit), float, SIMD packs or dual numbers for automatic differentiation. T must be constructible from a
+// double and provide the arithmetic operators; the phases carry the numeric type, the other arguments are converted to it.
+
+// The scalar arguments do not take part in the deduction of T, which comes from the phases: double literals can be passed
+// whatever T is.
+template <class T>
+struct KernelArg {
+  typedef T type;
+};
+
+// B+ and B- decay rates of a (B mode, D mode) pair, up to a common normalization. The favoured rates are those of
+// B- -> D0 h-, D0 -> f (and charge conjugate), the suppressed ones those of B- -> D0bar h-, D0bar -> f.
+// All the ADS/GLW observables of the pair follow from these four numbers.
+template <class T>
+struct BDRatesT {
+  T fp, fm; // favoured, B+ and B-
+  T sp, sm; // suppressed, B+ and B-
+
+  T Sfav() const { return fp + fm; }
+  T Ssup() const { return sp + sm; }
+  T Afav() const { return (fm - fp) / (fm + fp); }
+  T Asup() const { return (sm - sp) / (sm + sp); }
+  T Acp() const { return Afav(); } // for CP eigenstates the favoured and suppressed rates coincide
+  T Rp() const { return sp / fp; }
+  T Rm() const { return sm / fm; }
+  T Rads() const { return (sp + sm) / (fp + fm); }
+};
+
+// The ratios differentiated by hand, one node each
+template <>
+inline Var BDRatesT<Var>::Afav() const
+{
+  double S = fm.v + fp.v;
+  const Var* u[] = {&fm, &fp};
+  double d[] = {2 * fp.v / (S * S), -2 * fm.v / (S * S)};
+  return Var::Nary((fm.v - fp.v) / S, u, d, 2);
+}
+template <>
+inline Var BDRatesT<Var>::Asup() const
+{
+  double S = sm.v + sp.v;
+  const Var* u[] = {&sm, &sp};
+  double d[] = {2 * sp.v / (S * S), -2 * sm.v / (S * S)};
+  return Var::Nary((sm.v - sp.v) / S, u, d, 2);
+}
+template <>
+inline Var BDRatesT<Var>::Rads() const
+{
+  double N = sp.v + sm.v, D = fp.v + fm.v;
+  const Var* u[] = {&sp, &sm, &fp, &fm};
+  double d[] = {1. / D, 1. / D, -N / (D * D), -N / (D * D)};
+  return Var::Nary(N / D, u, d, 4);
+}
+
+typedef BDRatesT<double> BDRates;
+
+// Observables of a pair as free functions, for the code written as Acp(R) rather than R.Acp()
+template <class T> inline T Sfav(const BDRatesT<T>& R) { return R.Sfav(); }
+template <class T> inline T Ssup(const BDRatesT<T>& R) { return R.Ssup(); }
+template <class T> inline T Afav(const BDRatesT<T>& R) { return R.Afav(); }
+template <class T> inline T Asup(const BDRatesT<T>& R) { return R.Asup(); }
+template <class T> inline T Acp(const BDRatesT<T>& R) { return R.Acp(); }
+template <class T> inline T Rp(const BDRatesT<T>& R) { return R.Rp(); }
+template <class T> inline T Rm(const BDRatesT<T>& R) { return R.Rm(); }
+template <class T> inline T Rads(const BDRatesT<T>& R) { return R.Rads(); }
+
+// Rates of B -> D h, D -> f including D mixing at first order: rB, delta_B, kB of the B decay, rD, delta_D, kD of the D
+// decay, alpha the dilution of the mixing terms, g = gamma, x12 and y12 the mixing parameters.
+template <class T>
+inline BDRatesT<T> Rates(typename KernelArg<T>::type rB, const PhaseT<T>& delta_B, typename KernelArg<T>::type kB,
+                         typename KernelArg<T>::type rD, const PhaseT<T>& delta_D, typename KernelArg<T>::type kD,
+                         typename KernelArg<T>::type alpha, const PhaseT<T>& g, typename KernelArg<T>::type x12,
+                         typename KernelArg<T>::type y12)
+{
+  // strong phase plus or minus the weak phase for B+ and B-
+  PhaseT<T> tp = delta_B + g, tm = delta_B - g;
+
+  // pieces that do not depend on the charge of the B
+  T f0 = 1 + rD * rD * rB * rB, s0 = rD * rD + rB * rB;
+  T interf = 2 * rB * rD * kB * kD;
+  T yD = alpha * y12 * rD * kD * (1 + rB * rB) * delta_D.c, xD = alpha * x12 * rD * kD * (1 - rB * rB) * delta_D.s;
+  T yB = alpha * y12 * rB * kB * (1 + rD * rD), xB = alpha * x12 * rB * kB * (1 - rD * rD);
+
+  BDRatesT<T> R;
+  R.fp = f0 + interf * (tp - delta_D).c - yD - yB * tp.c + xB * tp.s - xD;
+  R.fm = f0 + interf * (tm - delta_D).c - yD - yB * tm.c + xB * tm.s - xD;
+  R.sp = s0 + interf * (tp + delta_D).c - yD - yB * tp.c - xB * tp.s + xD;
+  R.sm = s0 + interf * (tm + delta_D).c - yD - yB * tm.c - xB * tm.s + xD;
+  return R;
+}
+
+// Rates differentiated by hand: the four rates are computed in double together with their derivatives with respect to
+// every input, and each rate is one node of the tape with an edge to each input on it.
+template <>
+inline BDRatesT<Var> Rates<Var>(Var rB, const PhaseT<Var>& delta_B, Var kB, Var rD, const PhaseT<Var>& delta_D, Var kD, Var alpha,
+                                const PhaseT<Var>& g, Var x12, Var y12)
+{
+  double rb = rB.v, kb = kB.v, rd = rD.v, kd = kD.v, al = alpha.v, x = x12.v, y = y12.v;
+  double Bs = delta_B.s.v, Bc = delta_B.c.v, Ds = delta_D.s.v, Dc = delta_D.c.v, Gs = g.s.v, Gc = g.c.v;
+
+  // values, as in the generic version
+  double ps = Bs * Gc + Bc * Gs, pc = Bc * Gc - Bs * Gs; // delta_B + gamma
+  double ms = Bs * Gc - Bc * Gs, mc = Bc * Gc + Bs * Gs; // delta_B - gamma
+  double f0 = 1 + rd * rd * rb * rb, s0 = rd * rd + rb * rb;
+  double I = 2 * rb * rd * kb * kd;
+  double cy = al * y * rd * kd * (1 + rb * rb), cx = al * x * rd * kd * (1 - rb * rb); // yD / Dc, xD / Ds
+  double yD = cy * Dc, xD = cx * Ds;
+  double yB = al * y * rb * kb * (1 + rd * rd), xB = al * x * rb * kb * (1 - rd * rd);
+  double Afp = pc * Dc + ps * Ds, Afm = mc * Dc + ms * Ds; // cos(delta_B +- gamma - delta_D)
+  double Asp = pc * Dc - ps * Ds, Asm = mc * Dc - ms * Ds; // cos(delta_B +- gamma + delta_D)
+
+  // d[r][k]: derivative of the rate r (fp, fm, sp, sm) with respect to the input u[k], computed only if u[k] is on the tape
+  const Var* u[] = {&rB, &rD, &kB, &kD, &alpha, &x12, &y12, &delta_D.s, &delta_D.c, &delta_B.s, &delta_B.c, &g.s, &g.c};
+  const unsigned n = sizeof(u) / sizeof(u[0]);
+  double d[4][n];
+
+  // inputs entering through f0, s0, I, yD, xD, yB, xB: their derivatives with respect to u[k] are passed
+  auto set = [&](unsigned k, double df0, double ds0, double dI, double dyD, double dxD, double dyB, double dxB) {
+    d[0][k] = df0 + dI * Afp - dyD - dyB * pc + dxB * ps - dxD;
+    d[1][k] = df0 + dI * Afm - dyD - dyB * mc + dxB * ms - dxD;
+    d[2][k] = ds0 + dI * Asp - dyD - dyB * pc - dxB * ps + dxD;
+    d[3][k] = ds0 + dI * Asm - dyD - dyB * mc - dxB * ms + dxD;
+  };
+  if (rB.i >= 0)
+    set(0, 2 * rd * rd * rb, 2 * rb, 2 * rd * kb * kd, al * y * rd * kd * 2 * rb * Dc, -al * x * rd * kd * 2 * rb * Ds,
+        al * y * kb * (1 + rd * rd), al * x * kb * (1 - rd * rd));
+  if (rD.i >= 0)
+    set(1, 2 * rd * rb * rb, 2 * rd, 2 * rb * kb * kd, al * y * kd * (1 + rb * rb) * Dc, al * x * kd * (1 - rb * rb) * Ds,
+        al * y * rb * kb * 2 * rd, -al * x * rb * kb * 2 * rd);
+  if (kB.i >= 0)
+    set(2, 0., 0., 2 * rb * rd * kd, 0., 0., al * y * rb * (1 + rd * rd), al * x * rb * (1 - rd * rd));
+  if (kD.i >= 0)
+    set(3, 0., 0., 2 * rb * rd * kb, al * y * rd * (1 + rb * rb) * Dc, al * x * rd * (1 - rb * rb) * Ds, 0., 0.);
+  if (alpha.i >= 0)
+    set(4, 0., 0., 0., y * rd * kd * (1 + rb * rb) * Dc, x * rd * kd * (1 - rb * rb) * Ds, y * rb * kb * (1 + rd * rd),
+        x * rb * kb * (1 - rd * rd));
+  if (x12.i >= 0)
+    set(5, 0., 0., 0., 0., al * rd * kd * (1 - rb * rb) * Ds, 0., al * rb * kb * (1 - rd * rd));
+  if (y12.i >= 0)
+    set(6, 0., 0., 0., al * rd * kd * (1 + rb * rb) * Dc, 0., al * rb * kb * (1 + rd * rd), 0.);
+
+  // sine and cosine of delta_D
+  d[0][7] = I * ps - cx;
+  d[1][7] = I * ms - cx;
+  d[2][7] = -I * ps + cx;
+  d[3][7] = -I * ms + cx;
+  d[0][8] = I * pc - cy;
+  d[1][8] = I * mc - cy;
+  d[2][8] = I * pc - cy;
+  d[3][8] = I * mc - cy;
+
+  // sine and cosine of delta_B and gamma, through those of delta_B +- gamma
+  double fpc = I * Dc - yB, fps = I * Ds + xB, spc = I * Dc - yB, sps = -I * Ds - xB;
+  double dpc[] = {-Gs, Gc, -Bs, Bc}, dps[] = {Gc, Gs, Bc, Bs}, dmc[] = {Gs, Gc, Bs, Bc}, dms[] = {Gc, -Gs, -Bc, Bs};
+  for (unsigned k = 0; k < 4; k++)
+  {
+    if (u[9 + k]->i < 0)
+      continue;
+    d[0][9 + k] = fpc * dpc[k] + fps * dps[k];
+    d[1][9 + k] = fpc * dmc[k] + fps * dms[k];
+    d[2][9 + k] = spc * dpc[k] + sps * dps[k];
+    d[3][9 + k] = spc * dmc[k] + sps * dms[k];
+  }
+
+  BDRatesT<Var> R;
+  R.fp = Var::Nary(f0 + I * Afp - yD - yB * pc + xB * ps - xD, u, d[0], n);
+  R.fm = Var::Nary(f0 + I * Afm - yD - yB * mc + xB * ms - xD, u, d[1], n);
+  R.sp = Var::Nary(s0 + I * Asp - yD - yB * pc - xB * ps + xD, u, d[2], n);
+  R.sm = Var::Nary(s0 + I * Asm - yD - yB * mc - xB * ms + xD, u, d[3], n);
+  return R;
+}
+
+// Same for a D decay to a state of CP-even fraction F_D, which behaves as rD = 1, delta_D = 0, kD = 2 F_D - 1
+template <class T>
+inline BDRatesT<T> CPRates(typename KernelArg<T>::type rB, const PhaseT<T>& delta_B, typename KernelArg<T>::type kB,
+                           typename KernelArg<T>::type F_D, typename KernelArg<T>::type alpha, const PhaseT<T>& g,
+                           typename KernelArg<T>::type x12, typename KernelArg<T>::type y12)
+{
+  return Rates<T>(rB, delta_B, kB, 1., PhaseT<T>(), 2 * F_D - 1, alpha, g, x12, y12);
+}
+
+// Mixing parameters of the D0 -> f decays rotated by the strong phase delta_D, for D0 (plus) and D0bar (minus);
+// qop = |q/p| and phi the weak phase of the mixing
+template <class T>
+inline T y_plus(typename KernelArg<T>::type x, typename KernelArg<T>::type y, typename KernelArg<T>::type qop,
+                const PhaseT<T>& phi, const PhaseT<T>& delta_D)
+{
+  return qop * (phi.s * (x * delta_D.c + y * delta_D.s) - phi.c * (-x * delta_D.s + y * delta_D.c));
+}
+
+template <class T>
+inline T y_minus(typename KernelArg<T>::type x, typename KernelArg<T>::type y, typename KernelArg<T>::type qop,
+                 const PhaseT<T>& phi, const PhaseT<T>& delta_D)
+{
+  return (1. / qop) * (-phi.s * (x * delta_D.c + y * delta_D.s) - phi.c * (-x * delta_D.s + y * delta_D.c));
+}
+
+template <class T>
+inline T x_plus(typename KernelArg<T>::type x, typename KernelArg<T>::type y, typename KernelArg<T>::type qop,
+                const PhaseT<T>& phi, const PhaseT<T>& delta_D)
+{
+  return (qop) * (-phi.c * (x * delta_D.c + y * delta_D.s) - phi.s * (-x * delta_D.s + y * delta_D.c));
+}
+
+template <class T>
+inline T x_minus(typename KernelArg<T>::type x, typename KernelArg<T>::type y, typename KernelArg<T>::type qop,
+                 const PhaseT<T>& phi, const PhaseT<T>& delta_D)
+{
+  return (-1. / qop) * (phi.c * (x * delta_D.c + y * delta_D.s) - phi.s * (-x * delta_D.s + y * delta_D.c));
+}
+
+// The same differentiated by hand, k (a1 A + a2 B) with A = x cos(delta_D) + y sin(delta_D), B = y cos(delta_D) - x sin(delta_D),
+// k = qop or +-1/qop (dk its derivative) and a1 = s1 u1, a2 = s2 u2 the sine and cosine of phi with their signs
+inline Var RotatedMixing(const Var& x, const Var& y, const Var& qop, double k, double dk, const Var& u1, double s1, const Var& u2,
+                         double s2, const PhaseT<Var>& delta_D)
+{
+  double Ds = delta_D.s.v, Dc = delta_D.c.v, a1 = s1 * u1.v, a2 = s2 * u2.v;
+  double A = x.v * Dc + y.v * Ds, B = -x.v * Ds + y.v * Dc;
+  const Var* u[] = {&x, &y, &qop, &u1, &u2, &delta_D.s, &delta_D.c};
+  double d[] = {k * (a1 * Dc - a2 * Ds), k * (a1 * Ds + a2 * Dc), dk * (a1 * A + a2 * B), k * A * s1, k * B * s2,
+                k * (a1 * y.v - a2 * x.v), k * (a1 * x.v + a2 * y.v)};
+  return Var::Nary(k * (a1 * A + a2 * B), u, d, 7);
+}
+
+template <>
+inline Var y_plus<Var>(Var x, Var y, Var qop, const PhaseT<Var>& phi, const PhaseT<Var>& delta_D)
+{
+  return RotatedMixing(x, y, qop, qop.v, 1., phi.s, 1., phi.c, -1., delta_D);
+}
+
+template <>
+inline Var y_minus<Var>(Var x, Var y, Var qop, const PhaseT<Var>& phi, const PhaseT<Var>& delta_D)
+{
+  return RotatedMixing(x, y, qop, 1. / qop.v, -1. / (qop.v * qop.v), phi.s, -1., phi.c, -1., delta_D);
+}
+
+template <>
+inline Var x_plus<Var>(Var x, Var y, Var qop, const PhaseT<Var>& phi, const PhaseT<Var>& delta_D)
+{
+  return RotatedMixing(x, y, qop, qop.v, 1., phi.c, -1., phi.s, -1., delta_D);
+}
+
+template <>
+inline Var x_minus<Var>(Var x, Var y, Var qop, const PhaseT<Var>& phi, const PhaseT<Var>& delta_D)
+{
+  return RotatedMixing(x, y, qop, -1. / qop.v, 1. / (qop.v * qop.v), phi.c, 1., phi.s, -1., delta_D);
+}
+
+// Sine and cosine of a Var with one call to the math library, for the phases built from the parameters
+inline void SinCos(const Var& angle, Var* s, Var* c)
+{
+  double sn, cs;
+  SinCos(angle.v, &sn, &cs);
+  *s = Var::Unary(sn, angle, cs);
+  *c = Var::Unary(cs, angle, -sn);
+}
+
+// Sum and difference of phases differentiated by hand: one node for the sine and one for the cosine
+inline PhaseT<Var> operator+(const PhaseT<Var>& a, const PhaseT<Var>& b)
+{
+  const Var* u[] = {&a.s, &a.c, &b.s, &b.c};
+  double ds[] = {b.c.v, b.s.v, a.c.v, a.s.v}, dc[] = {-b.s.v, b.c.v, -a.s.v, a.c.v};
+  return PhaseT<Var>(Var::Nary(a.s.v * b.c.v + a.c.v * b.s.v, u, ds, 4), Var::Nary(a.c.v * b.c.v - a.s.v * b.s.v, u, dc, 4));
+}
+inline PhaseT<Var> operator-(const PhaseT<Var>& a, const PhaseT<Var>& b)
+{
+  const Var* u[] = {&a.s, &a.c, &b.s, &b.c};
+  double ds[] = {b.c.v, -b.s.v, -a.c.v, a.s.v}, dc[] = {b.s.v, b.c.v, a.s.v, a.c.v};
+  return PhaseT<Var>(Var::Nary(a.s.v * b.c.v - a.c.v * b.s.v, u, ds, 4), Var::Nary(a.c.v * b.c.v + a.s.v * b.s.v, u, dc, 4));
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef __LANES__H
+#define __LANES__H
+
+#include <cmath>
+#include <math.h>
+
+// ------------------------------------------ SIMD packs for the batch likelihood ------------------------------------------------
+// A Lanes holds one double per point, so that MixingContextT<Lanes> evaluates the likelihood at as many points at once:
+// 2 with SSE2, 4 with AVX2 and 8 with AVX-512, following the instruction set the code is compiled for (NATIVE_ARCH in
+// CMakeLists.txt). The pack is std::experimental::native_simd, whose arithmetic and mathematical functions work lane by
+// lane; without it (a compiler before C++17 or without the Parallelism TS) LANES is not defined and the batch is scalar.
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<experimental/simd>)
+// GCC 12 warns about the undefined vectors its AVX-512 intrinsics start from, in the sin and cos of the packs
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <experimental/simd>
+#pragma GCC diagnostic pop
+#define LANES
+typedef std::experimental::native_simd<double> Lanes;
+#endif
+#endif
+
+// Whether a parameter changed since the previous point (MixingContextT::SetParameters), in any lane for a pack
+template <class T>
+inline bool Differs(const T& a, const T& b) { return a != b; }
+#ifdef LANES
+inline bool Differs(const Lanes& a, const Lanes& b) { return any_of(a != b); }
+#endif
+
+// Angle in [-pi, pi] brought to [0, 2 pi], lane by lane for a pack
+template <class T>
+inline T PositiveAngle(const T& a) { return a < 0 ? a + 2 * M_PI : a; }
+#ifdef LANES
+inline Lanes PositiveAngle(const Lanes& a)
+{
+  Lanes r = a;
+  where(a < 0., r) += 2 * M_PI;
+  return r;
+}
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef __MEASUREMENTREGISTRY__H
+#define __MEASUREMENTREGISTRY__H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+// ------------------------------------------ Registry of the measurements ------------------------------------------------
+// Every input has a fixed handle. The Add_*_meas functions store it in a contiguous table under its handle, and the
+// Calculate_* functions read it back through the same handle, so no lookup by name is done while evaluating the likelihood.
+
+using namespace std;
+
+// Handles of the uncorrelated measurements (dato)
+namespace Meas {
+  enum Id {
+    // Add_ChargedB_meas
+    Babar_0807_2408_ACPp,
+    Babar_0807_2408_ACPm,
+    Babar_0807_2408_RCPp,
+    Babar_0807_2408_RCPm,
+    Babar_PRD80_092001_ACPp,
+    Babar_PRD80_092001_ACPm,
+    Babar_PRD80_092001_RCPp,
+    Babar_PRD80_092001_RCPm,
+    Babar_0703037,
+    Babar_1006_4241_RDK,
+    Babar_1006_4241_ADK,
+    Babar_1006_4241_RDstarKpi0,
+    Babar_1006_4241_ADstarKpi0,
+    Babar_1006_4241_RDstarKg,
+    Babar_1006_4241_ADstarKg,
+    Babar_1006_4241_RDpi,
+    Babar_1006_4241_ADpi,
+    Babar_1006_4241_RDstarpipi0,
+    Babar_1006_4241_ADstarpipi0,
+    Babar_1006_4241_RDstarpig,
+    Babar_1006_4241_ADstarpig,
+    Babar_1104_4472_Rp_DK_Kpipi0,
+    Babar_1104_4472_Rm_DK_Kpipi0,
+    Babar_0909_3981_RADS,
+    Babar_0909_3981_Asup,
+    CDF_PRD81_031105_ACPp,
+    CDF_PRD81_031105_RCPp,
+    CDF_1108_5765_RDK,
+    CDF_1108_5765_ADK,
+    CDF_1108_5765_RDpi,
+    CDF_1108_5765_ADpi,
+    UID24,
+
+    // Add_NeutralBd_meas
+    arXiv_0602049_aDpi,
+    arXiv_0602049_cDpi,
+    arXiv_0602049_aDstarpi,
+    arXiv_0602049_cDstarpi,
+    arXiv_0602049_aDrho,
+    arXiv_0602049_cDrho,
+    arXiv_0504035_aDstarpi,
+    arXiv_0504035_cDstarpi,
+    arXiv_0604013_aDpi,
+    arXiv_0604013_cDpi,
+    arXiv_0604013_aDstarpi,
+    arXiv_0604013_cDstarpi,
+    arXiv_11020888_aDstarpi,
+    arXiv_11020888_cDstarpi,
+    UID25,
+    UID27,
+
+    // Add_NeutralBs_meas
+    UID26,
+
+    // Add_time_dependent_Dmeas
+    arXiv_1405_2797_tKKOverTauD_DAcp,
+    arXiv_1405_2797_tpipiOverTauD_DAcp,
+    arXiv_1405_2797_tKKOverTauD_Acp,
+    arXiv_1610_09476_tKKOverTauD,
+    arXiv_1602_03160_DeltaACPpitagged,
+    arXiv_1602_03160_tKKOverTauD,
+    arXiv_1602_03160_tpipiOverTauD,
+    DeltaACPpitagged,
+    DeltaACPmutagged,
+    tavepitaggedOverTauD,
+    tavemutaggedOverTauD,
+    DeltatmutaggedOverTauD,
+    UID28,
+    UID29,
+    DYKKmDYpipi,
+    arXiv_1410_5435_AGammaKK,
+    arXiv_1410_5435_AGammapipi,
+    arXiv_1111_5023_tKKOverTauD_CDF,
+    arXiv_1111_5023_tpipiOverTauD_CDF,
+    arXiv_1208_2517_AcpKK_CDF,
+    arXiv_1208_2517_Acppipi_CDF,
+    arXiv_0709_2715_AcpKK_Babar,
+    arXiv_0709_2715_Acppipi_Babar,
+    arXiv_0807_0148_AcpKK_Belle,
+    arXiv_0807_0148_Acppipi_Belle,
+
+    // Add_other_meas
+    BESIII_2503_19542_BrDKpi,
+    BESIII_2503_19542_BrDK3pi,
+    BESIII_2503_19542_BrDKpipi0,
+    UID20,
+    Fpipipipi_BESIII,
+    FKKpipi_BESIII,
+    UID22,
+
+    // Add_old_meas
+    UID18,
+    RM,
+
+    N // number of handles
+  };
+}
+
+// Handles of the correlated measurements (CorrelatedGaussianObservables)
+namespace CorrMeas {
+  enum Id {
+    // Add_ChargedB_meas
+    Babar_PRD82_072004,
+    Babar_0703037_rhotheta,
+    Babar_PRL105_121801,
+    UID0,
+    GLW_2301_10328,
+    arXiv_2112_10617,
+    UID4,
+    arXiv_2308_05048,
+    Belle_PRD88_2013,
+    Belle_PRL106_2011,
+    arXiv_2306_02940,
+    arXiv_2209_03692,
+    arXiv_1908_09499,
+    arXiv_2110_12125,
+    GGSZ_2301_10328,
+    GGSZ_LHCb_Cb,
+    UID5,
+    Belle_PRD73_2006,
+    Belle_PRD81_2010,
+    LHCB_PAPER_2024_023_GLWADS,
+    arXiv_0604054,
+    UID9,
+
+    // Add_NeutralBd_meas
+    arXiv_2401_17934Bd,
+    arXiv_2309_05514,
+    DKst0Pcomb,
+    arXiv_1509_01098,
+    UID12,
+
+    // Add_NeutralBs_meas
+    arXiv_2401_17934Bs,
+    arXiv_2401_17934,
+    BSDSKRun1,
+    BSDSKRun2,
+    UID11,
+
+    // Add_time_dependent_Dmeas
+    arXiv_1405_2797_1610_09476_Acp,
+    tausforDACP,
+    ACPKK,
+    UID30,
+    arXiv_2407_18001,
+    BESIII_Adk,
+    BESIII_rDkpi_polar,
+    UID14,
+    LHCb_kspp_Au2022,
+
+    // Add_other_meas
+    UID21,
+    arXiv_2409_07197_F_BESIII,
+    UID19,
+    UID23,
+
+    // Add_old_meas
+    kpi_babar_plus,
+    kpi_babar_minus,
+    kpi_belle_plus,
+    kpi_belle_minus,
+    cleoc,
+    kpp_belle,
+    UID13,
+    kppkk,
+    kppp0_Babar,
+    kpp_babar_plus,
+    kpp_babar_minus,
+
+    N // number of handles
+  };
+}
+
+template <class T>
+class MeasurementRegistry {
+public:
+
+  MeasurementRegistry(unsigned nhandles) : slot(nhandles, -1), first(0), last(nhandles) {};
+
+  // Handles allowed from now on, [first_i, last_i): each block of the likelihood registers its measurements in its own
+  // range of handles, see MeasBegin and CorrMeasBegin in MixingContext.h
+  void SetRange(unsigned first_i, unsigned last_i, const string& block)
+  {
+    first = first_i;
+    last = last_i;
+    rangeblock = block;
+  }
+
+  // Store a measurement under its handle and return its position in the table
+  unsigned Add(unsigned id, const string& name, const T& m)
+  {
+    if (slot.at(id) >= 0) {
+      cout << "Measurement " << name << " added twice" << endl;
+      exit(EXIT_FAILURE);
+    }
+    if (id < first || id >= last) {
+      cout << "Measurement " << name << " is added by the block " << rangeblock << " but its handle is not in the range of the block" << endl;
+      exit(EXIT_FAILURE);
+    }
+    slot[id] = table.size();
+    table.push_back(m);
+    names.push_back(name);
+    return slot[id];
+  }
+
+  bool Has(unsigned id) const { return slot.at(id) >= 0; }
+
+  const T& operator[](unsigned id) const { return table[slot[id]]; }
+
+  unsigned size() const { return table.size(); }
+  const string& GetName(unsigned i) const { return names[i]; } // i = position in the table
+  const string& Name(unsigned id) const { return names[slot.at(id)]; } // id = handle
+
+private:
+  vector<int> slot; // position in the table of each handle, -1 if not used by this combination
+  unsigned first, last; // range of the handles allowed, set by SetRange
+  string rangeblock;
+  vector<T> table;
+  vector<string> names;
+};
+
+#endif
@@ -0,0 +1,2353 @@
+#include "MixingContext.h"
+
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+// ---------------------------------------------------------
+
+template <class T>
+MixingContextT<T>::MixingContextT(int combination, const MeasurementRegistry<dato>& m, const MeasurementRegistry<CorrelatedGaussianObservables>& cm) : meas(m), corrmeas(cm)
+{
+  comb = combination; // set the combination type
+  r2d = 180. / M_PI;  // to go form radiants to degrees
+  d2r = M_PI / 180.;  // degrees to radiants
+  tau = 4.1e-1;       // ps D lifetime
+
+  // angles that are not parameters of every combination, so that SetPhases never reads them uninitialized
+  g = phis = phi_d = 0.;
+  d_dk = d_dpi = d_dstk = d_dstpi = d_dkst = d_dkstz = d_dkstzs = d_dkpipi = d_dpipipi = 0.;
+  d_dsk = d_dskpipi = d_dmpi = d_dstarmpi = d_dmrho = 0.;
+
+  // measurements fitted to the same predictions share their buffer: {measurement, measurement whose buffer it uses}
+  const unsigned shared[][2] = {{CorrMeas::BSDSKRun2, CorrMeas::BSDSKRun1},
+                                {CorrMeas::kpi_belle_plus, CorrMeas::kpi_babar_plus},
+                                {CorrMeas::kpi_belle_minus, CorrMeas::kpi_babar_minus},
+                                {CorrMeas::kppp0_Babar, CorrMeas::kppkk},
+                                {CorrMeas::UID13, CorrMeas::kppkk}};
+  const unsigned nshared = sizeof(shared) / sizeof(shared[0]);
+  vector<int> owner(CorrMeas::N, -1);
+  for (unsigned k = 0; k < nshared; k++)
+    if (corrmeas.Has(shared[k][0]) && corrmeas.Has(shared[k][1]))
+      owner[shared[k][0]] = shared[k][1];
+
+  predoffset.assign(CorrMeas::N, 0);
+  unsigned n = 0;
+  for (unsigned i = 0; i < CorrMeas::N; i++)
+    if (corrmeas.Has(i) && owner[i] < 0)
+    {
+      predoffset[i] = n;
+      n += corrmeas[i].size();
+    }
+  for (unsigned i = 0; i < CorrMeas::N; i++)
+    if (owner[i] >= 0)
+      predoffset[i] = predoffset[owner[i]];
+  pred.assign(n, 0.);
+  spred.assign(Meas::N, 0.);
+
+  gauss = BlockDiagonalGaussian(meas, corrmeas, predoffset);
+
+  // blocks of the likelihood of each combination, in order of evaluation
+  if (comb == 0)
+  {
+    blocks.push_back(ChargedB);
+  }
+  else if (comb == 1)
+  {
+    blocks.push_back(NeutralBd);
+  }
+  else if (comb == 2)
+  {
+    blocks.push_back(NeutralBs);
+  }
+  else if (comb == 3)
+  {
+    blocks.push_back(ChargedB);
+    blocks.push_back(NeutralBd);
+    blocks.push_back(NeutralBs);
+  }
+  blocks.push_back(TimeDependentD);
+  blocks.push_back(Other);
+  blocks.push_back(Old);
+  for (int b = 0; b < NBlocks; b++)
+  {
+    reads[b] = 0;
+    if (find(blocks.begin(), blocks.end(), b) != blocks.end())
+      continue;
+    // the chi2 runs over the handles from the first block of the combination to its last one, so the blocks in between
+    // that are not evaluated must have no measurement
+    for (unsigned i = MeasBegin[b]; i < MeasBegin[b + 1]; i++)
+      if (meas.Has(i))
+      {
+        cout << "The block " << BlockName[b] << " has measurements in the combination " << comb << ", which does not evaluate it" << endl;
+        exit(EXIT_FAILURE);
+      }
+    for (unsigned i = CorrMeasBegin[b]; i < CorrMeasBegin[b + 1]; i++)
+      if (corrmeas.Has(i))
+      {
+        cout << "The block " << BlockName[b] << " has measurements in the combination " << comb << ", which does not evaluate it" << endl;
+        exit(EXIT_FAILURE);
+      }
+  }
+  dirty = ~0u;
+  validate = false;
+};
+
+// ---------------------------------------------------------
+
+template <class T>
+void MixingContextT<T>::SetParameters(const std::vector<T> &parameters)
+{
+  // blocks to recompute at the next LogLikelihood call: the flags add up until then, so that calls made only for the
+  // observables (MixingModel::MCMCCurrentPointInterface) are also accounted for
+  if (lastpars.size() != parameters.size())
+  {
+    lastpars = parameters;
+    dirty = ~0u;
+  }
+  else
+    for (unsigned i = 0; i < parameters.size(); i++)
+      if (Differs(parameters[i], lastpars[i]))
+      {
+        dirty |= (pardeps.empty() ? ~0u : pardeps[i]);
+        lastpars[i] = parameters[i];
+      }
+
+  if (comb == 0)
+  {
+
+    // Variabili globali
+    g = parameters[0];
+    x12 = parameters[1];
+    y12 = parameters[2];
+
+    // 1. PDF: glwads-dh-hh-dmix (UID0)
+    r_dk = parameters[3];
+    r_dpi = parameters[4];
+    rD_kpi = parameters[5];
+    d_dk = parameters[6];
+    d_dpi = parameters[7];
+    dD_kpi = parameters[8];
+
+    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
+    rD_k3pi = parameters[9];
+    dD_k3pi = parameters[10];
+    kD_k3pi = parameters[11];
+    F_pipipipi = parameters[12];
+
+    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
+    rD_kpipi0 = parameters[13];
+    dD_kpipi0 = parameters[14];
+    kD_kpipi0 = parameters[15];
+    F_pipipi0 = parameters[16];
+    F_kkpi0 = parameters[17];
+
+    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
+    rD_kskpi = parameters[18];
+    dD_kskpi = parameters[19];
+    kD_kskpi = parameters[20];
+    RBRdkdpi = parameters[21];
+
+    // 6. PDF: glwads-dsth-hh-dmix (UID5)
+    r_dstk = parameters[22];
+    d_dstk = parameters[23];
+    r_dstpi = parameters[24];
+    d_dstpi = parameters[25];
+
+    // 7. PDF: glwads-dkst-hh-h3pi-dmix-newvars (UID6)
+    r_dkst = parameters[26];
+    d_dkst = parameters[27];
+    k_dkst = parameters[28];
+
+    // 10. PDF: glwads-dhpipi-hh-dmix (UID9)
+    r_dkpipi = parameters[29];
+    d_dkpipi = parameters[30];
+    k_dkpipi = parameters[31];
+    r_dpipipi = parameters[32];
+    d_dpipipi = parameters[33];
+    k_dpipipi = parameters[34];
+
+    // 15. PDF: charm-kspipi (UID14)
+    PhiM12 = parameters[35];
+    PhiG12 = parameters[36];
+
+    adKK = parameters[37];
+    adpipi = parameters[38];
+    DYKKmDYpipi = parameters[39];
+    tavepitaggedOverTauD = parameters[40];
+    tavemutaggedOverTauD = parameters[41];
+    DeltatmutaggedOverTauD = parameters[42];
+    DeltatpitaggedOverTauD = parameters[43];
+    tKKCDp = parameters[44];
+    tKKCDs = parameters[45];
+
+    F_kkpipi = parameters[46];
+
+    tauKK_DAcp_Run1_sl = parameters[47];
+    taupipi_DAcp_Run1_sl = parameters[48];
+    tauKK_Acp_Run1_sl = parameters[49];
+
+    tauKK_DAcp_Run1_pi = parameters[50];
+    taupipi_DAcp_Run1_pi = parameters[51];
+    tauKK_Acp_Run1_pi = parameters[52];
+
+    tauKK_Acp_CDF = parameters[53];
+    taupipi_Acp_CDF = parameters[54];
+
+    // General parameters
+    AD = 0.; // NO direct CPV for CF/DCS
+    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
+    x = x12;
+    y = y12;
+    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
+    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
+    sc.phi = Phase(phi);
+    d = (1. - qop * qop) / (1. + qop * qop);
+
+    xcp = 0.5 * (x * sc.phi.c * (qop + 1. / qop) + y * sc.phi.s * (qop - 1. / qop));
+    ycp = 0.5 * (y * sc.phi.c * (qop + 1. / qop) - x * sc.phi.s * (qop - 1. / qop));
+    dx = 0.5 * (x * sc.phi.c * (qop - 1. / qop) + y * sc.phi.s * (qop + 1. / qop));
+    dy = 0.5 * (y * sc.phi.c * (qop - 1. / qop) - x * sc.phi.s * (qop + 1. / qop));
+  }
+  else if (comb == 1)
+  {
+
+    // Variabili globali
+    g = parameters[0];
+    x12 = parameters[1];
+    y12 = parameters[2];
+
+    // 1. PDF: glwads-dh-hh-dmix (UID0)
+    rD_kpi = parameters[3];
+    dD_kpi = parameters[4];
+
+    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
+    rD_k3pi = parameters[5];
+    dD_k3pi = parameters[6];
+    kD_k3pi = parameters[7];
+    F_pipipipi = parameters[8];
+
+    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
+    rD_kpipi0 = parameters[9];
+    dD_kpipi0 = parameters[10];
+    kD_kpipi0 = parameters[11];
+    F_pipipi0 = parameters[12];
+    F_kkpi0 = parameters[13];
+
+    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
+    rD_kskpi = parameters[14];
+    dD_kskpi = parameters[15];
+    kD_kskpi = parameters[16];
+
+    //  8. PDF: glwads-dkstz-hh-h3pi-dmix
+    r_dkstz = parameters[17];
+    d_dkstz = parameters[18];
+    k_dkstz = parameters[19];
+
+    // 13. PDF: dmpi (UID12)
+    l_dmpi = parameters[20];
+    d_dmpi = parameters[21];
+    phi_d = parameters[22];
+
+    // 15. PDF: charm-kspipi (UID14)
+    PhiM12 = parameters[23];
+    PhiG12 = parameters[24];
+
+    adKK = parameters[25];
+    adpipi = parameters[26];
+    DYKKmDYpipi = parameters[27];
+    tavepitaggedOverTauD = parameters[28];
+    tavemutaggedOverTauD = parameters[29];
+    DeltatmutaggedOverTauD = parameters[30];
+    DeltatpitaggedOverTauD = parameters[31];
+    tKKCDp = parameters[32];
+    tKKCDs = parameters[33];
+
+    F_kkpipi = parameters[34];
+
+    tauKK_DAcp_Run1_sl = parameters[35];
+    taupipi_DAcp_Run1_sl = parameters[36];
+    tauKK_Acp_Run1_sl = parameters[37];
+
+    tauKK_DAcp_Run1_pi = parameters[38];
+    taupipi_DAcp_Run1_pi = parameters[39];
+    tauKK_Acp_Run1_pi = parameters[40];
+
+    tauKK_Acp_CDF = parameters[41];
+    taupipi_Acp_CDF = parameters[42];
+
+    l_dstarmpi = parameters[43];
+    d_dstarmpi = parameters[44];
+    l_dmrho = parameters[45];
+    d_dmrho = parameters[46];
+
+    // General parameters
+    AD = 0.; // NO direct CPV for CF/DCS
+    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
+    x = x12;
+    y = y12;
+    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
+    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
+    sc.phi = Phase(phi);
+    d = (1. - qop * qop) / (1. + qop * qop);
+
+    xcp = 0.5 * (x * sc.phi.c * (qop + 1. / qop) + y * sc.phi.s * (qop - 1. / qop));
+    ycp = 0.5 * (y * sc.phi.c * (qop + 1. / qop) - x * sc.phi.s * (qop - 1. / qop));
+    dx = 0.5 * (x * sc.phi.c * (qop - 1. / qop) + y * sc.phi.s * (qop + 1. / qop));
+    dy = 0.5 * (y * sc.phi.c * (qop - 1. / qop) - x * sc.phi.s * (qop + 1. / qop));
+  }
+  else if (comb == 2)
+  {
+
+    // Variabili globali
+    g = parameters[0];
+    x12 = parameters[1];
+    y12 = parameters[2];
+
+    // 1. PDF: glwads-dh-hh-dmix (UID0)
+    rD_kpi = parameters[3];
+    dD_kpi = parameters[4];
+
+    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
+    rD_k3pi = parameters[5];
+    dD_k3pi = parameters[6];
+    kD_k3pi = parameters[7];
+    F_pipipipi = parameters[8];
+
+    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
+    rD_kpipi0 = parameters[9];
+    dD_kpipi0 = parameters[10];
+    kD_kpipi0 = parameters[11];
+    F_pipipi0 = parameters[12];
+    F_kkpi0 = parameters[13];
+
+    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
+    rD_kskpi = parameters[14];
+    dD_kskpi = parameters[15];
+    kD_kskpi = parameters[16];
+
+    // 11. PDF: dsk (UID10)
+    l_dsk = parameters[17];
+    d_dsk = parameters[18];
+    phis = parameters[19];
+
+    // 12. PDF: dskpipi (UID11)
+    l_dskpipi = parameters[20];
+    d_dskpipi = parameters[21];
+    k_dskpipi = parameters[22];
+
+    // 15. PDF: charm-kspipi (UID14)
+    PhiM12 = parameters[23];
+    PhiG12 = parameters[24];
+
+    adKK = parameters[25];
+    adpipi = parameters[26];
+    DYKKmDYpipi = parameters[27];
+    tavepitaggedOverTauD = parameters[28];
+    tavemutaggedOverTauD = parameters[29];
+    DeltatmutaggedOverTauD = parameters[30];
+    DeltatpitaggedOverTauD = parameters[31];
+    tKKCDp = parameters[32];
+    tKKCDs = parameters[33];
+
+    F_kkpipi = parameters[34];
+
+    // 2401.17934 Bs part
+    r_dkstzs = parameters[35];
+    d_dkstzs = parameters[36];
+    k_dkstzs = parameters[37];
+
+    tauKK_DAcp_Run1_sl = parameters[38];
+    taupipi_DAcp_Run1_sl = parameters[39];
+    tauKK_Acp_Run1_sl = parameters[40];
+
+    tauKK_DAcp_Run1_pi = parameters[41];
+    taupipi_DAcp_Run1_pi = parameters[42];
+    tauKK_Acp_Run1_pi = parameters[43];
+
+    tauKK_Acp_CDF = parameters[44];
+    taupipi_Acp_CDF = parameters[45];
+
+    // General parameters
+    AD = 0.; // NO direct CPV for CF/DCS
+    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
+    x = x12;
+    y = y12;
+    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
+    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
+    sc.phi = Phase(phi);
+    d = (1. - qop * qop) / (1. + qop * qop);
+
+    xcp = 0.5 * (x * sc.phi.c * (qop + 1. / qop) + y * sc.phi.s * (qop - 1. / qop));
+    ycp = 0.5 * (y * sc.phi.c * (qop + 1. / qop) - x * sc.phi.s * (qop - 1. / qop));
+    dx = 0.5 * (x * sc.phi.c * (qop - 1. / qop) + y * sc.phi.s * (qop + 1. / qop));
+    dy = 0.5 * (y * sc.phi.c * (qop - 1. / qop) - x * sc.phi.s * (qop + 1. / qop));
+  }
+  else if (comb == 3)
+  {
+
+    // Variabili globali
+    g = parameters[0];
+    x12 = parameters[1];
+    y12 = parameters[2];
+
+    // 1. PDF: glwads-dh-hh-dmix (UID0)
+    r_dk = parameters[3];
+    r_dpi = parameters[4];
+    rD_kpi = parameters[5];
+    d_dk = parameters[6];
+    d_dpi = parameters[7];
+    dD_kpi = parameters[8];
+
+    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
+    rD_k3pi = parameters[9];
+    dD_k3pi = parameters[10];
+    kD_k3pi = parameters[11];
+    F_pipipipi = parameters[12];
+
+    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
+    rD_kpipi0 = parameters[13];
+    dD_kpipi0 = parameters[14];
+    kD_kpipi0 = parameters[15];
+    F_pipipi0 = parameters[16];
+    F_kkpi0 = parameters[17];
+
+    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
+    rD_kskpi = parameters[18];
+    dD_kskpi = parameters[19];
+    kD_kskpi = parameters[20];
+    RBRdkdpi = parameters[21];
+
+    // 6. PDF: glwads-dsth-hh-dmix (UID5)
+    r_dstk = parameters[22];
+    d_dstk = parameters[23];
+    r_dstpi = parameters[24];
+    d_dstpi = parameters[25];
+
+    // 7. PDF: glwads-dkst-hh-h3pi-dmix-newvars (UID6)
+    r_dkst = parameters[26];
+    d_dkst = parameters[27];
+    k_dkst = parameters[28];
+
+    //  8. PDF: glwads-dkstz-hh-h3pi-dmix
+    r_dkstz = parameters[29];
+    d_dkstz = parameters[30];
+    k_dkstz = parameters[31];
+
+    // 10. PDF: glwads-dhpipi-hh-dmix (UID9)
+    r_dkpipi = parameters[32];
+    d_dkpipi = parameters[33];
+    k_dkpipi = parameters[34];
+    r_dpipipi = parameters[35];
+    d_dpipipi = parameters[36];
+    k_dpipipi = parameters[37];
+
+    // 11. PDF: dsk (UID10)
+    l_dsk = parameters[38];
+    d_dsk = parameters[39];
+    phis = parameters[40];
+
+    // 12. PDF: dskpipi (UID11)
+    l_dskpipi = parameters[41];
+    d_dskpipi = parameters[42];
+    k_dskpipi = parameters[43];
+
+    // 13. PDF: dmpi (UID12)
+    l_dmpi = parameters[44];
+    d_dmpi = parameters[45];
+    phi_d = parameters[46];
+
+    // 15. PDF: charm-kspipi (UID14)
+    PhiM12 = parameters[47];
+    PhiG12 = parameters[48];
+
+    adKK = parameters[49];
+    adpipi = parameters[50];
+    DYKKmDYpipi = parameters[51];
+    tavepitaggedOverTauD = parameters[52];
+    tavemutaggedOverTauD = parameters[53];
+    DeltatmutaggedOverTauD = parameters[54];
+    DeltatpitaggedOverTauD = parameters[55];
+    tKKCDp = parameters[56];
+    tKKCDs = parameters[57];
+
+    // https://arxiv.org/abs/2301.10328
+    F_kkpipi = parameters[58];
+
+    // 2401.17934 Bs part
+    r_dkstzs = parameters[59];
+    d_dkstzs = parameters[60];
+    k_dkstzs = parameters[61];
+
+    tauKK_DAcp_Run1_sl = parameters[62];
+    taupipi_DAcp_Run1_sl = parameters[63];
+    tauKK_Acp_Run1_sl = parameters[64];
+
+    tauKK_DAcp_Run1_pi = parameters[65];
+    taupipi_DAcp_Run1_pi = parameters[66];
+    tauKK_Acp_Run1_pi = parameters[67];
+
+    tauKK_Acp_CDF = parameters[68];
+    taupipi_Acp_CDF = parameters[69];
+
+    l_dstarmpi = parameters[70];
+    d_dstarmpi = parameters[71];
+    l_dmrho = parameters[72];
+    d_dmrho = parameters[73];
+
+
+    // General parameters
+    AD = 0.; // NO direct CPV for CF/DCS
+    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
+    x = x12;
+    y = y12;
+    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
+    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
+    sc.phi = Phase(phi);
+    d = (1. - qop * qop) / (1. + qop * qop);
+
+    xcp = 0.5 * (x * sc.phi.c * (qop + 1. / qop) + y * sc.phi.s * (qop - 1. / qop));
+    ycp = 0.5 * (y * sc.phi.c * (qop + 1. / qop) - x * sc.phi.s * (qop - 1. / qop));
+    dx = 0.5 * (x * sc.phi.c * (qop - 1. / qop) + y * sc.phi.s * (qop + 1. / qop));
+    dy = 0.5 * (y * sc.phi.c * (qop - 1. / qop) - x * sc.phi.s * (qop + 1. / qop));
+  }
+  else if (comb == 4)
+  {
+
+    // Variabili globali
+    g = 0.; // gamma is not a parameter of the charm only combination
+    x12 = parameters[0];
+    y12 = parameters[1];
+
+    // 1. PDF: glwads-dh-hh-dmix (UID0)
+    rD_kpi = parameters[2];
+    dD_kpi = parameters[3];
+
+    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
+    rD_k3pi = parameters[4];
+    dD_k3pi = parameters[5];
+    kD_k3pi = parameters[6];
+    F_pipipipi = parameters[7];
+
+    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
+    rD_kpipi0 = parameters[8];
+    dD_kpipi0 = parameters[9];
+    kD_kpipi0 = parameters[10];
+    F_pipipi0 = parameters[11];
+    F_kkpi0 = parameters[12];
+
+    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
+    rD_kskpi = parameters[13];
+    dD_kskpi = parameters[14];
+    kD_kskpi = parameters[15];
+
+    // 15. PDF: charm-kspipi (UID14)
+    PhiM12 = parameters[16];
+    PhiG12 = parameters[17];
+
+    adKK = parameters[18];
+    adpipi = parameters[19];
+    DYKKmDYpipi = parameters[20];
+    tavepitaggedOverTauD = parameters[21];
+    tavemutaggedOverTauD = parameters[22];
+    DeltatmutaggedOverTauD = parameters[23];
+    DeltatpitaggedOverTauD = parameters[24];
+    tKKCDp = parameters[25];
+    tKKCDs = parameters[26];
+
+    F_kkpipi = parameters[27];
+
+    tauKK_DAcp_Run1_sl = parameters[28];
+    taupipi_DAcp_Run1_sl = parameters[29];
+    tauKK_Acp_Run1_sl = parameters[30];
+
+    tauKK_DAcp_Run1_pi = parameters[31];
+    taupipi_DAcp_Run1_pi = parameters[32];
+    tauKK_Acp_Run1_pi = parameters[33];
+
+    tauKK_Acp_CDF = parameters[34];
+    taupipi_Acp_CDF = parameters[35];
+
+
+    // General parameters
+    AD = 0.; // NO direct CPV for CF/DCS
+    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
+    x = x12;
+    y = y12;
+    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
+    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
+    sc.phi = Phase(phi);
+    d = (1. - qop * qop) / (1. + qop * qop);
+
+    xcp = 0.5 * (x * sc.phi.c * (qop + 1. / qop) + y * sc.phi.s * (qop - 1. / qop));
+    ycp = 0.5 * (y * sc.phi.c * (qop + 1. / qop) - x * sc.phi.s * (qop - 1. / qop));
+    dx = 0.5 * (x * sc.phi.c * (qop - 1. / qop) + y * sc.phi.s * (qop + 1. / qop));
+    dy = 0.5 * (y * sc.phi.c * (qop - 1. / qop) - x * sc.phi.s * (qop + 1. / qop));
+  }
+
+  SetPhases();
+}
+// ---------------------------------------------------------
+
+template <class T>
+void MixingContextT<T>::SetPhases()
+{
+  // one sincos per angle; the parameters absent from the combination are zero, see the constructor
+  sc.g = Phase(g);
+  sc.phi12 = Phase(phi12);
+  sc.phis = Phase(phis);
+  sc.phi_d = Phase(phi_d);
+  sc.PhiM12 = Phase(PhiM12);
+  sc.PhiG12 = Phase(PhiG12);
+  sc.d_dk = Phase(d_dk);
+  sc.d_dpi = Phase(d_dpi);
+  sc.dD_kpi = Phase(dD_kpi);
+  sc.dD_k3pi = Phase(dD_k3pi);
+  sc.dD_kpipi0 = Phase(dD_kpipi0);
+  sc.dD_kskpi = Phase(dD_kskpi);
+  sc.d_dstk = Phase(d_dstk);
+  sc.d_dstpi = Phase(d_dstpi);
+  sc.d_dkst = Phase(d_dkst);
+  sc.d_dkstz = Phase(d_dkstz);
+  sc.d_dkstzs = Phase(d_dkstzs);
+  sc.d_dkpipi = Phase(d_dkpipi);
+  sc.d_dpipipi = Phase(d_dpipipi);
+  sc.d_dsk = Phase(d_dsk);
+  sc.d_dskpipi = Phase(d_dskpipi);
+  sc.d_dmpi = Phase(d_dmpi);
+  sc.d_dstarmpi = Phase(d_dstarmpi);
+  sc.d_dmrho = Phase(d_dmrho);
+  sc.d_dstk_pi = Phase(-sc.d_dstk.s, -sc.d_dstk.c);
+  sc.d_dstpi_pi = Phase(-sc.d_dstpi.s, -sc.d_dstpi.c);
+}
+// ---------------------------------------------------------
+
+template <class T>
+T MixingContextT<T>::LogLikelihood()
+{
+  // only the blocks touched by the parameters changed since the last call are recomputed, the others keep their value
+  for (int i = blocks.size() - 1; i >= 0; i--)
+    if (dirty & (1u << blocks[i]))
+      dirty |= reads[blocks[i]]; // the predictions it takes from earlier blocks must be up to date
+  for (unsigned i = 0; i < blocks.size(); i++)
+    if (dirty & (1u << blocks[i]))
+      CalculatePredictions(blocks[i]);
+  dirty = 0;
+  // one pass over the measurements of all the blocks, the clean ones contributing their kept predictions
+  int first = blocks.front(), last = blocks.back() + 1;
+  T ll = gauss.logweight(spred.data(), pred.data(), MeasBegin[first], MeasBegin[last], CorrMeasBegin[first], CorrMeasBegin[last]);
+
+  if (validate)
+  { // the full recomputation must give the same result, bit for bit
+    for (unsigned i = 0; i < blocks.size(); i++)
+      CalculatePredictions(blocks[i]);
+    T tfull = gauss.logweight(spred.data(), pred.data(), MeasBegin[first], MeasBegin[last], CorrMeasBegin[first], CorrMeasBegin[last]);
+    double full = Value(tfull), inc = Value(ll);
+    if (memcmp(&full, &inc, sizeof(double)) != 0)
+    {
+      cout << "Incremental log likelihood " << inc << " differs from the full recomputation " << full << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  return ll;
+}
+// ---------------------------------------------------------
+
+template <class T>
+void MixingContextT<T>::CalculatePredictions(int b)
+{
+  // the Calculate_* functions write the predictions into spred and pred
+  switch (b)
+  {
+  case ChargedB:
+    //---------------------------------------------------- Contribution to the LogLikelihood of the charged B measurements  ----------------------------------------------------
+    Calculate_ChargedB_observables();
+    break;
+  case NeutralBd:
+    //------------------------------------------------------  Contribution to the LogLikelihood of the neutral Bd observables  ----------------------------------------------------
+    Calculate_neutralBdobservables();
+    break;
+  case NeutralBs:
+    //------------------------------------------------------  Contribution to the LogLikelihood of the neutral Bs observables  ----------------------------------------------------
+    Calculate_neutralBsobservables();
+    break;
+  case TimeDependentD:
+    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables ----------------------------------------------------
+    Calculate_time_dependent_Dobservables();
+    break;
+  case Other:
+    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
+    Calculate_other_observables();
+    break;
+  case Old:
+    //-----------------------------------------------  Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
+    Calculate_old_observables();
+    break;
+  }
+}
+// ---------------------------------------------------------
+
+template <class T>
+T MixingContextT<T>::BlockLogWeight(int b)
+{
+  return gauss.logweight(spred.data(), pred.data(), MeasBegin[b], MeasBegin[b + 1], CorrMeasBegin[b], CorrMeasBegin[b + 1]);
+}
+// ---------------------------------------------------------
+
+// Name of each observable handle and the parameter it requires ("" if it is available in every combination)
+static const struct
+{
+  const char* name;
+  const char* parameter;
+} ObservableTable[Obs::N] = {
+  {"g", "g"},
+  {"x12", "x12"},
+  {"y12", "y12"},
+  {"r_dk", "r_dk"},
+  {"r_dpi", "r_dpi"},
+  {"rD_kpi", "rD_kpi"},
+  {"d_dk", "d_dk"},
+  {"d_dpi", "d_dpi"},
+  {"dD_kpi", "dD_kpi"},
+  {"rD_k3pi", "rD_k3pi"},
+  {"dD_k3pi", "dD_k3pi"},
+  {"kD_k3pi", "kD_k3pi"},
+  {"F_pipipipi", "F_pipipipi"},
+  {"rD_kpipi0", "rD_kpipi0"},
+  {"dD_kpipi0", "dD_kpipi0"},
+  {"kD_kpipi0", "kD_kpipi0"},
+  {"F_pipipi0", "F_pipipi0"},
+  {"F_kkpi0", "F_kkpi0"},
+  {"rD_kskpi", "rD_kskpi"},
+  {"dD_kskpi", "dD_kskpi"},
+  {"kD_kskpi", "kD_kskpi"},
+  {"RBRdkdpi", "RBRdkdpi"},
+  {"r_dstk", "r_dstk"},
+  {"d_dstk", "d_dstk"},
+  {"r_dstpi", "r_dstpi"},
+  {"d_dstpi", "d_dstpi"},
+  {"r_dkst", "r_dkst"},
+  {"d_dkst", "d_dkst"},
+  {"k_dkst", "k_dkst"},
+  {"r_dkpipi", "r_dkpipi"},
+  {"d_dkpipi", "d_dkpipi"},
+  {"k_dkpipi", "k_dkpipi"},
+  {"r_dpipipi", "r_dpipipi"},
+  {"d_dpipipi", "d_dpipipi"},
+  {"k_dpipipi", "k_dpipipi"},
+  {"F_kkpipi", "F_kkpipi"},
+  {"PhiM12", "PhiM12"},
+  {"PhiG12", "PhiG12"},
+  {"phipphig12", ""},
+  {"phimphig12", ""},
+  {"AD", ""},
+  {"adKK", "adKK"},
+  {"adpipi", "adpipi"},
+  {"qopm1", ""},
+  {"qop", ""},
+  {"phi", ""},
+  {"phi12", ""},
+  {"delta", ""},
+  {"x", ""},
+  {"y", ""},
+  {"M12", ""},
+  {"G12", ""},
+  {"ImM12", ""},
+  {"r_dkstz", "r_dkstz"},
+  {"d_dkstz", "d_dkstz"},
+  {"k_dkstz", "k_dkstz"},
+  {"l_dmpi", "l_dmpi"},
+  {"d_dmpi", "d_dmpi"},
+  {"beta", "phi_d"},
+  {"phid", "phi_d"},
+  {"r_dkstzs", "r_dkstzs"},
+  {"d_dkstzs", "d_dkstzs"},
+  {"k_dkstzs", "k_dkstzs"},
+  {"l_dsk", "l_dsk"},
+  {"d_dsk", "d_dsk"},
+  {"phis", "phis"},
+  {"beta_s", "phis"},
+  {"l_dskpipi", "l_dskpipi"},
+  {"d_dskpipi", "d_dskpipi"},
+  {"k_dskpipi", "k_dskpipi"},
+  {"DYKKmDYpipi", "DYKKmDYpipi"},
+  {"tavepitaggedOverTauD", "tavepitaggedOverTauD"},
+  {"tavemutaggedOverTauD", "tavemutaggedOverTauD"},
+  {"DeltatmutaggedOverTauD", "DeltatmutaggedOverTauD"},
+  {"DeltatpitaggedOverTauD", "DeltatpitaggedOverTauD"},
+  {"tKKCDp", "tKKCDp"},
+  {"tKKCDs", "tKKCDs"},
+  {"tauKK_DAcp_Run1_sl", "tauKK_DAcp_Run1_sl"},
+  {"taupipi_DAcp_Run1_sl", "taupipi_DAcp_Run1_sl"},
+  {"tauKK_Acp_Run1_sl", "tauKK_Acp_Run1_sl"},
+  {"tauKK_DAcp_Run1_pi", "tauKK_DAcp_Run1_pi"},
+  {"taupipi_DAcp_Run1_pi", "taupipi_DAcp_Run1_pi"},
+  {"tauKK_Acp_Run1_pi", "tauKK_Acp_Run1_pi"},
+  {"tauKK_Acp_CDF", "tauKK_Acp_CDF"},
+  {"taupipi_Acp_CDF", "taupipi_Acp_CDF"},
+  {"l_dstarmpi", "l_dstarmpi"},
+  {"d_dstarmpi", "d_dstarmpi"},
+  {"l_dmrho", "l_dmrho"},
+  {"d_dmrho", "d_dmrho"}};
+
+template <class T>
+int MixingContextT<T>::FindObservable(const string& name)
+{
+  for (unsigned i = 0; i < Obs::N; i++)
+    if (name == ObservableTable[i].name)
+      return i;
+  return -1;
+}
+
+template <class T>
+const char* MixingContextT<T>::ObservableParameter(unsigned id)
+{
+  return ObservableTable[id].parameter;
+}
+
+template <class T>
+bool MixingContextT<T>::IsParameter(const string& name)
+{
+  for (unsigned i = 0; i < Obs::N; i++)
+    if (name == ObservableTable[i].parameter)
+      return true; // every parameter is also an observable
+  return false;
+}
+
+template <class T>
+double MixingContextT<T>::GetObservable(unsigned id) const
+{
+  switch (id)
+  {
+  case Obs::g:
+    return g * r2d;
+  case Obs::x12:
+    return x12 * 1000;
+  case Obs::y12:
+    return y12 * 1000;
+  case Obs::r_dk:
+    return r_dk * 100;
+  case Obs::r_dpi:
+    return r_dpi * 1000;
+  case Obs::rD_kpi:
+    return rD_kpi * 100;
+  case Obs::d_dk:
+    return d_dk * r2d;
+  case Obs::d_dpi:
+    return d_dpi * r2d;
+  case Obs::dD_kpi:
+    return dD_kpi * r2d;
+  case Obs::rD_k3pi:
+    return rD_k3pi;
+  case Obs::dD_k3pi:
+    return dD_k3pi * r2d;
+  case Obs::kD_k3pi:
+    return kD_k3pi;
+  case Obs::F_pipipipi:
+    return F_pipipipi;
+  case Obs::rD_kpipi0:
+    return rD_kpipi0;
+  case Obs::dD_kpipi0:
+    return dD_kpipi0 * r2d;
+  case Obs::kD_kpipi0:
+    return kD_kpipi0;
+  case Obs::F_pipipi0:
+    return F_pipipi0;
+  case Obs::F_kkpi0:
+    return F_kkpi0;
+  case Obs::rD_kskpi:
+    return rD_kskpi;
+  case Obs::dD_kskpi:
+    return dD_kskpi * r2d;
+  case Obs::kD_kskpi:
+    return kD_kskpi;
+  case Obs::RBRdkdpi:
+    return RBRdkdpi;
+  case Obs::r_dstk:
+    return r_dstk;
+  case Obs::d_dstk:
+    return d_dstk * r2d;
+  case Obs::r_dstpi:
+    return r_dstpi;
+  case Obs::d_dstpi:
+    return d_dstpi * r2d;
+  case Obs::r_dkst:
+    return r_dkst;
+  case Obs::d_dkst:
+    return d_dkst * r2d;
+  case Obs::k_dkst:
+    return k_dkst;
+  case Obs::r_dkpipi:
+    return r_dkpipi;
+  case Obs::d_dkpipi:
+    return d_dkpipi * r2d;
+  case Obs::k_dkpipi:
+    return k_dkpipi;
+  case Obs::r_dpipipi:
+    return r_dpipipi;
+  case Obs::d_dpipipi:
+    return d_dpipipi * r2d;
+  case Obs::k_dpipipi:
+    return k_dpipipi;
+  case Obs::F_kkpipi:
+    return F_kkpipi;
+  case Obs::PhiM12:
+    return PhiM12 * r2d;
+  case Obs::PhiG12:
+    return PhiG12 * r2d;
+  case Obs::phipphig12:
+    return remainder(PhiG12 + phi, 2. * M_PI) * r2d;
+  case Obs::phimphig12:
+    return remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
+  case Obs::AD:
+    return AD;
+  case Obs::adKK:
+    return adKK * 1000;
+  case Obs::adpipi:
+    return adpipi * 1000;
+  case Obs::qopm1:
+    return (qop - 1) * 100;
+  case Obs::qop:
+    return qop;
+  case Obs::phi:
+    return phi * r2d;
+  case Obs::phi12:
+    return phi12 * r2d;
+  case Obs::delta:
+    return d;
+  case Obs::x:
+    return x * 1000;
+  case Obs::y:
+    return y * 1000;
+  case Obs::M12:
+    return 0.5 * x12 / tau;
+  case Obs::G12:
+    return y12 / tau;
+  case Obs::ImM12:
+    return 0.5 * x12 / tau * sin(PhiM12);
+  case Obs::r_dkstz:
+    return r_dkstz;
+  case Obs::d_dkstz:
+    return d_dkstz * r2d;
+  case Obs::k_dkstz:
+    return k_dkstz;
+  case Obs::l_dmpi:
+    return l_dmpi;
+  case Obs::d_dmpi:
+    return d_dmpi * r2d;
+  case Obs::beta:
+    return phi_d*0.5 * r2d;
+  case Obs::phid:
+    return phi_d * r2d;
+  case Obs::r_dkstzs:
+    return r_dkstzs;
+  case Obs::d_dkstzs:
+    return d_dkstzs * r2d;
+  case Obs::k_dkstzs:
+    return k_dkstzs;
+  case Obs::l_dsk:
+    return l_dsk;
+  case Obs::d_dsk:
+    return d_dsk * r2d;
+  case Obs::phis:
+    return phis * r2d;
+  case Obs::beta_s:
+    return -0.5 * phis;
+  case Obs::l_dskpipi:
+    return l_dskpipi;
+  case Obs::d_dskpipi:
+    return d_dskpipi * r2d;
+  case Obs::k_dskpipi:
+    return k_dskpipi;
+  case Obs::DYKKmDYpipi:
+    return DYKKmDYpipi*1000;
+  case Obs::tavepitaggedOverTauD:
+    return tavepitaggedOverTauD;
+  case Obs::tavemutaggedOverTauD:
+    return tavemutaggedOverTauD;
+  case Obs::DeltatmutaggedOverTauD:
+    return DeltatmutaggedOverTauD;
+  case Obs::DeltatpitaggedOverTauD:
+    return DeltatpitaggedOverTauD;
+  case Obs::tKKCDp:
+    return tKKCDp*1e12;
+  case Obs::tKKCDs:
+    return tKKCDs*1e12;
+  case Obs::tauKK_DAcp_Run1_sl:
+    return tauKK_DAcp_Run1_sl;
+  case Obs::taupipi_DAcp_Run1_sl:
+    return taupipi_DAcp_Run1_sl;
+  case Obs::tauKK_Acp_Run1_sl:
+    return tauKK_Acp_Run1_sl;
+  case Obs::tauKK_DAcp_Run1_pi:
+    return tauKK_DAcp_Run1_pi;
+  case Obs::taupipi_DAcp_Run1_pi:
+    return taupipi_DAcp_Run1_pi;
+  case Obs::tauKK_Acp_Run1_pi:
+    return tauKK_Acp_Run1_pi;
+  case Obs::tauKK_Acp_CDF:
+    return tauKK_Acp_CDF;
+  case Obs::taupipi_Acp_CDF:
+    return taupipi_Acp_CDF;
+  case Obs::l_dstarmpi:
+    return l_dstarmpi;
+  case Obs::d_dstarmpi:
+    return d_dstarmpi*180./M_PI;
+  case Obs::l_dmrho:
+    return l_dmrho;
+  case Obs::d_dmrho:
+    return d_dmrho*180./M_PI;
+  }
+  return 0.;
+}
+
+template <class T>
+void MixingContextT<T>::FillObservables(const vector<unsigned>& ids, vector<double>& values) const
+{
+  for (unsigned i = 0; i < ids.size(); i++)
+    values[i] = GetObservable(ids[i]);
+}
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_ChargedB_observables()
+{
+
+  //------------------------------------------------- B+ and B- rates of the (B mode, D mode) pairs used below, each computed once -----------------
+  const BDRates R_dk_cpeven_a1046 = CPRates(r_dk, sc.d_dk, 1., 1., 2 * 0.523);
+  const BDRates R_dpi_cpeven_a1046 = CPRates(r_dpi, sc.d_dpi, 1., 1., 2 * 0.523);
+  const BDRates R_dk_kpi_a1046 = Rates(r_dk, sc.d_dk, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dpi_kpi_a1046 = Rates(r_dpi, sc.d_dpi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dk_kkpipi_a1 = CPRates(r_dk, sc.d_dk, 1., F_kkpipi, 1.);
+  const BDRates R_dpi_kkpipi_a1 = CPRates(r_dpi, sc.d_dpi, 1., F_kkpipi, 1.);
+  const BDRates R_dk_pipipipi_a1 = CPRates(r_dk, sc.d_dk, 1., F_pipipipi, 1.);
+  const BDRates R_dpi_pipipipi_a1 = CPRates(r_dpi, sc.d_dpi, 1., F_pipipipi, 1.);
+  const BDRates R_dk_k3pi_a1 = Rates(r_dk, sc.d_dk, 1., rD_k3pi, sc.dD_k3pi, kD_k3pi, 1.);
+  const BDRates R_dpi_k3pi_a1 = Rates(r_dpi, sc.d_dpi, 1., rD_k3pi, sc.dD_k3pi, kD_k3pi, 1.);
+  const BDRates R_dk_kkpi0_a10 = CPRates(r_dk, sc.d_dk, 1., F_kkpi0, 2 * 0.5);
+  const BDRates R_dk_kpipi0_a10 = Rates(r_dk, sc.d_dk, 1., rD_kpipi0, sc.dD_kpipi0, kD_kpipi0, 2 * 0.5);
+  const BDRates R_dpi_kkpi0_a10 = CPRates(r_dpi, sc.d_dpi, 1., F_kkpi0, 2 * 0.5);
+  const BDRates R_dpi_kpipi0_a10 = Rates(r_dpi, sc.d_dpi, 1., rD_kpipi0, sc.dD_kpipi0, kD_kpipi0, 2 * 0.5);
+  const BDRates R_dk_pipipi0_a10 = CPRates(r_dk, sc.d_dk, 1., F_pipipi0, 2 * 0.5);
+  const BDRates R_dpi_pipipi0_a10 = CPRates(r_dpi, sc.d_dpi, 1., F_pipipi0, 2 * 0.5);
+  const BDRates R_dpi_kskpi_a1 = Rates(r_dpi, sc.d_dpi, 1., rD_kskpi, sc.dD_kskpi, kD_kskpi, 1.);
+  const BDRates R_dk_kskpi_a1 = Rates(r_dk, sc.d_dk, 1., rD_kskpi, sc.dD_kskpi, kD_kskpi, 1.);
+  const BDRates R_dstk_shift_cpeven_a1046 = CPRates(r_dstk, sc.d_dstk_pi, 1., 1., 2 * 0.523);
+  const BDRates R_dstk_cpeven_a1046 = CPRates(r_dstk, sc.d_dstk, 1., 1., 2 * 0.523);
+  const BDRates R_dstk_shift_kpi_a1046 = Rates(r_dstk, sc.d_dstk_pi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dstk_kpi_a1046 = Rates(r_dstk, sc.d_dstk, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dstpi_shift_cpeven_a1046 = CPRates(r_dstpi, sc.d_dstpi_pi, 1., 1., 2 * 0.523);
+  const BDRates R_dstpi_shift_kpi_a1046 = Rates(r_dstpi, sc.d_dstpi_pi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dstpi_cpeven_a1046 = CPRates(r_dstpi, sc.d_dstpi, 1., 1., 2 * 0.523);
+  const BDRates R_dstpi_kpi_a1046 = Rates(r_dstpi, sc.d_dstpi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.523);
+  const BDRates R_dkst_kpi_a12 = Rates(r_dkst, sc.d_dkst, k_dkst, rD_kpi, sc.dD_kpi, 1., 2 * 0.6);
+  const BDRates R_dkst_cpeven_a12 = CPRates(r_dkst, sc.d_dkst, k_dkst, 1., 2 * 0.6);
+  const BDRates R_dkst_k3pi_a12 = Rates(r_dkst, sc.d_dkst, k_dkst, rD_k3pi, sc.dD_k3pi, kD_k3pi, 2 * 0.6);
+  const BDRates R_dkst_pipipipi_a12 = CPRates(r_dkst, sc.d_dkst, k_dkst, F_pipipipi, 2 * 0.6);
+  const BDRates R_dkpipi_cpeven_a12 = CPRates(r_dkpipi, sc.d_dkpipi, k_dkpipi, 1., 2 * 0.6);
+  const BDRates R_dkpipi_kpi_a12 = Rates(r_dkpipi, sc.d_dkpipi, k_dkpipi, rD_kpi, sc.dD_kpi, 1., 2 * 0.6);
+  const BDRates R_dpipipi_cpeven_a12 = CPRates(r_dpipipi, sc.d_dpipipi, k_dpipipi, 1., 2 * 0.6);
+  const BDRates R_dpipipi_kpi_a12 = Rates(r_dpipipi, sc.d_dpipipi, k_dpipipi, rD_kpi, sc.dD_kpi, 1., 2 * 0.6);
+  const BDRates R_dk_cpeven_a10 = CPRates(r_dk, sc.d_dk, 1., 1., 2 * 0.5);
+  const BDRates R_dk_cpodd_a10 = CPRates(r_dk, sc.d_dk, 1., 0., 2 * 0.5);
+  const BDRates R_dk_kpi_a10 = Rates(r_dk, sc.d_dk, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dpi_cpeven_a10 = CPRates(r_dpi, sc.d_dpi, 1., 1., 2 * 0.5);
+  const BDRates R_dpi_kpi_a10 = Rates(r_dpi, sc.d_dpi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dpi_cpodd_a10 = CPRates(r_dpi, sc.d_dpi, 1., 0., 2 * 0.5);
+  const BDRates R_dstk_cpeven_a10 = CPRates(r_dstk, sc.d_dstk, 1., 1., 2 * 0.5);
+  const BDRates R_dstk_cpodd_a10 = CPRates(r_dstk, sc.d_dstk, 1., 0., 2 * 0.5);
+  const BDRates R_dstk_kpi_a10 = Rates(r_dstk, sc.d_dstk, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dstpi_cpeven_a10 = CPRates(r_dstpi, sc.d_dstpi, 1., 1., 2 * 0.5);
+  const BDRates R_dstpi_kpi_a10 = Rates(r_dstpi, sc.d_dstpi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dstpi_cpodd_a10 = CPRates(r_dstpi, sc.d_dstpi, 1., 0., 2 * 0.5);
+  const BDRates R_dkst_cpeven_a10 = CPRates(r_dkst, sc.d_dkst, k_dkst, 1., 2 * 0.5);
+  const BDRates R_dkst_cpodd_a10 = CPRates(r_dkst, sc.d_dkst, k_dkst, 0., 2 * 0.5);
+  const BDRates R_dkst_kpi_a10 = Rates(r_dkst, sc.d_dkst, k_dkst, rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dstk_shift_kpi_a10 = Rates(r_dstk, sc.d_dstk_pi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dstpi_shift_kpi_a10 = Rates(r_dstpi, sc.d_dstpi_pi, 1., rD_kpi, sc.dD_kpi, 1., 2 * 0.5);
+  const BDRates R_dk_kpi_a1 = Rates(r_dk, sc.d_dk, 1., rD_kpi, sc.dD_kpi, 1., 1.);
+  const BDRates R_dpi_kpi_a1 = Rates(r_dpi, sc.d_dpi, 1., rD_kpi, sc.dD_kpi, 1., 1.);
+  const BDRates R_dk_cpodd_a1 = CPRates(r_dk, sc.d_dk, 1., 0., 1.);
+  const BDRates R_dpi_cpodd_a1 = CPRates(r_dpi, sc.d_dpi, 1., 0., 1.);
+  const BDRates R_dk_cpeven_a1 = CPRates(r_dk, sc.d_dk, 1., 1., 1.);
+  const BDRates R_dpi_cpeven_a1 = CPRates(r_dpi, sc.d_dpi, 1., 1., 1.);
+  const BDRates R_dk_kpipi0_a1 = Rates(r_dk, sc.d_dk, 1., rD_kpipi0, sc.dD_kpipi0, kD_kpipi0, 1.);
+  const BDRates R_dpi_kpipi0_a1 = Rates(r_dpi, sc.d_dpi, 1., rD_kpipi0, sc.dD_kpipi0, kD_kpipi0, 1.);
+  const BDRates R_dstk_cpodd_a1 = CPRates(r_dstk, sc.d_dstk, 1., 0., 1.);
+  const BDRates R_dstk_kpi_a1 = Rates(r_dstk, sc.d_dstk, 1., rD_kpi, sc.dD_kpi, 1., 1.);
+  const BDRates R_dstpi_cpodd_a1 = CPRates(r_dstpi, sc.d_dstpi, 1., 0., 1.);
+  const BDRates R_dstpi_kpi_a1 = Rates(r_dstpi, sc.d_dstpi, 1., rD_kpi, sc.dD_kpi, 1., 1.);
+  const BDRates R_dstk_cpeven_a1 = CPRates(r_dstk, sc.d_dstk, 1., 1., 1.);
+  const BDRates R_dstpi_cpeven_a1 = CPRates(r_dstpi, sc.d_dstpi, 1., 1., 1.);
+
+  //-------------------------------------------------  Bpm -> Dhpm  -------------------------------------------------------------------------
+
+  // GLW: D -> KK, pipi; ADS: D -> Kpi
+  // https://arxiv.org/pdf/2012.09903.pdf
+  // Observables 8:
+  acp_dk_uid0 = R_dk_cpeven_a1046.Acp();
+  acp_dpi_uid0 = R_dpi_cpeven_a1046.Acp();
+  afav_dk_uid0 = R_dk_kpi_a1046.Afav();
+  rcp_uid0 = (R_dk_cpeven_a1046.Sfav() / R_dk_kpi_a1046.Sfav()) / (R_dpi_cpeven_a1046.Sfav() / R_dpi_kpi_a1046.Sfav());
+  rm_dk_uid0 = R_dk_kpi_a1046.Rm();
+  rm_dpi_uid0 = R_dpi_kpi_a1046.Rm();
+  rp_dk_uid0 = R_dk_kpi_a1046.Rp();
+  rp_dpi_uid0 = R_dpi_kpi_a1046.Rp();
+
+
+  // GLW: D -> KKpipi, D -> 4pi
+  // https://arxiv.org/abs/2301.10328
+  // 6 Observables
+  acp_dk_kkpipi_230110328 = R_dk_kkpipi_a1.Acp();
+  acp_dpi_kkpipi_230110328 = R_dpi_kkpipi_a1.Acp();
+  acp_dk_pipipipi_230110328 = R_dk_pipipipi_a1.Acp();
+  acp_dpi_pipipipi_230110328 = R_dpi_pipipipi_a1.Acp();
+  rcp_kpi_kkpipi_230110328 = (R_dk_kkpipi_a1.Sfav() / R_dk_k3pi_a1.Sfav()) / (R_dpi_kkpipi_a1.Sfav() / R_dpi_k3pi_a1.Sfav());
+  rcp_kpi_pipipipi_230110328 = (R_dk_pipipipi_a1.Sfav() / R_dk_k3pi_a1.Sfav()) / (R_dpi_pipipipi_a1.Sfav() / R_dpi_k3pi_a1.Sfav());
+
+
+  // GLW: D -> pipipi0, KKpi0; D -> Kpipi0
+  //https://arxiv.org/pdf/2112.10617
+  // Observables 11:
+  rcp_kkpi0_211210617 = (R_dk_kkpi0_a10.Sfav() / R_dk_kpipi0_a10.Sfav()) / (R_dpi_kkpi0_a10.Sfav() / R_dpi_kpipi0_a10.Sfav());
+  rcp_pipipi0_211210617 = (R_dk_pipipi0_a10.Sfav() / R_dk_kpipi0_a10.Sfav()) / (R_dpi_pipipi0_a10.Sfav() / R_dpi_kpipi0_a10.Sfav());
+  afav_dk_kpipi0_211210617 = R_dk_kpipi0_a10.Afav();
+  acp_dk_kkpi0_211210617 = R_dk_kkpi0_a10.Acp();
+  acp_dk_pipipi0_211210617 = R_dk_pipipi0_a10.Acp();
+  acp_dpi_kkpi0_211210617 = R_dpi_kkpi0_a10.Acp();
+  acp_dpi_pipipi0_211210617 = R_dpi_pipipi0_a10.Acp();
+  rp_dk_211210617 = R_dk_kpipi0_a10.Rp();
+  rm_dk_211210617 = R_dk_kpipi0_a10.Rm();
+  rp_dpi_211210617 = R_dpi_kpipi0_a10.Rp();
+  rm_dpi_211210617 = R_dpi_kpipi0_a10.Rm();
+
+
+  // ADS: D -> K0sKpi
+  // https://arxiv.org/pdf/2002.08858
+  // Observables 7:
+  afav_dpi_kskpi_uid4 = R_dpi_kskpi_a1.Afav();
+  asup_dpi_kskpi_uid4 = R_dpi_kskpi_a1.Asup();
+  afav_dk_kskpi_uid4 = R_dk_kskpi_a1.Afav();
+  asup_dk_kskpi_uid4 = R_dk_kskpi_a1.Asup();
+  rfavsup_dpi_kskpi_uid4 = 1. / R_dpi_kskpi_a1.Rads();
+  rfav_dkdpi_kskpi_uid4 = (RBRdkdpi * R_dk_kskpi_a1.Sfav() / R_dpi_kskpi_a1.Sfav());
+  rsup_dkdpi_kskpi_uid4 = (RBRdkdpi * R_dk_kskpi_a1.Ssup() / R_dpi_kskpi_a1.Ssup());
+
+
+  xm_dk_uid3 = r_dk * (sc.d_dk - sc.g).c;
+  ym_dk_uid3 = r_dk * (sc.d_dk - sc.g).s;
+  xp_dk_uid3 = r_dk * (sc.d_dk + sc.g).c;
+  yp_dk_uid3 = r_dk * (sc.d_dk + sc.g).s;
+  xi_x_dpi_uid3 = (r_dpi / r_dk) * (sc.d_dpi - sc.d_dk).c;
+  xi_y_dpi_uid3 = (r_dpi / r_dk) * (sc.d_dpi - sc.d_dk).s;
+
+
+  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
+  // https://arxiv.org/abs/2012.09903
+  // Observables 18:
+  acp_dstk_dg_uid5 = R_dstk_shift_cpeven_a1046.Acp();
+  acp_dstk_dp_uid5 = R_dstk_cpeven_a1046.Acp();
+  afav_dstk_dg_uid5 = R_dstk_shift_kpi_a1046.Afav();
+  afav_dstk_dp_uid5 = R_dstk_kpi_a1046.Afav();
+  rcp_dg_uid5 = (R_dstk_shift_cpeven_a1046.Sfav() / R_dstk_shift_kpi_a1046.Sfav()) / (R_dstpi_shift_cpeven_a1046.Sfav() / R_dstpi_shift_kpi_a1046.Sfav());
+  rcp_dp_uid5 = (R_dstk_cpeven_a1046.Sfav() / R_dstk_kpi_a1046.Sfav()) / (R_dstpi_cpeven_a1046.Sfav() / R_dstpi_kpi_a1046.Sfav());
+  rm_dstk_dg_uid5 = R_dstk_shift_kpi_a1046.Rm();
+  rm_dstk_dp_uid5 = R_dstk_kpi_a1046.Rm();
+  rp_dstk_dg_uid5 = R_dstk_shift_kpi_a1046.Rp();
+  rp_dstk_dp_uid5 = R_dstk_kpi_a1046.Rp();
+  acp_dstpi_dg_uid5 = R_dstpi_shift_cpeven_a1046.Acp();
+  acp_dstpi_dp_uid5 = R_dstpi_cpeven_a1046.Acp();
+  rm_dstpi_dg_uid5 = R_dstpi_shift_kpi_a1046.Rm();
+  rm_dstpi_dp_uid5 = R_dstpi_kpi_a1046.Rm();
+  rp_dstpi_dg_uid5 = R_dstpi_shift_kpi_a1046.Rp();
+  rp_dstpi_dp_uid5 = R_dstpi_kpi_a1046.Rp();
+  afav_dstpi_dg_uid5 = R_dstpi_shift_kpi_a1046.Afav();
+  afav_dstpi_dp_uid5 = R_dstpi_kpi_a1046.Afav();
+
+
+  // GLW: D -> KK, D -> pipi, D -> 4pi; ADS: D -> Kpi, D -> K3pi
+  // LHCb-PAPER-2024-023
+  // Observables 12:
+  afav_dkst_kpi = R_dkst_kpi_a12.Afav();
+  acp_dkst_kk = R_dkst_cpeven_a12.Acp();
+  acp_dkst_pipi = R_dkst_cpeven_a12.Acp();
+  asup_dkst_kpi = R_dkst_kpi_a12.Asup();
+  rcp_dkst_kk = (R_dkst_cpeven_a12.Sfav() / R_dkst_kpi_a12.Sfav());
+  rcp_dkst_pipi = (R_dkst_cpeven_a12.Sfav() / R_dkst_kpi_a12.Sfav());
+  rsup_dkst_kpi = R_dkst_kpi_a12.Rads();
+  afav_dkst_k3pi = R_dkst_k3pi_a12.Afav();
+  acp_dkst_pipipipi = R_dkst_pipipipi_a12.Acp();
+  asup_dkst_k3pi = R_dkst_k3pi_a12.Asup();
+  rcp_dkst_pipipipi = (R_dkst_pipipipi_a12.Sfav() / R_dkst_k3pi_a12.Sfav());
+  rsup_dkst_k3pi = R_dkst_k3pi_a12.Rads();
+
+
+  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
+  // https://arxiv.org/pdf/1505.07044
+  // Observables 11:
+  rcp_dkpipi_uid9 = (R_dkpipi_cpeven_a12.Sfav() / R_dkpipi_kpi_a12.Sfav()) / (R_dpipipi_cpeven_a12.Sfav() / R_dpipipi_kpi_a12.Sfav());
+  afav_dkpipi_kpi_uid9 = R_dkpipi_kpi_a12.Afav();
+  afav_dpipipi_kpi_uid9 = R_dpipipi_kpi_a12.Afav();
+  acp_dkpipi_kk_uid9 = R_dkpipi_cpeven_a12.Acp();
+  acp_dkpipi_pipi_uid9 = R_dkpipi_cpeven_a12.Acp();
+  acp_dpipipi_kk_uid9 = R_dpipipi_cpeven_a12.Acp();
+  acp_dpipipi_pipi_uid9 = R_dpipipi_cpeven_a12.Acp();
+  rp_dkpipi_uid9 = R_dkpipi_kpi_a12.Rp();
+  rm_dkpipi_uid9 = R_dkpipi_kpi_a12.Rm();
+  rp_dpipipi_uid9 = R_dpipipi_kpi_a12.Rp();
+  rm_dpipipi_uid9 = R_dpipipi_kpi_a12.Rm();
+
+
+  // Coherence factor kappakstpm
+  // https://arxiv.org/pdf/1709.05855
+  k_dkst_uid24 = k_dkst;
+
+  //------------------------------------------------------ Calculating the contribution to the LogLikelihood ----------------------------------------------------
+
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+  //-------------------------------------------------  Babar measurements  -------------------------------------------------------------------------
+
+  // B -> DK, D -> KK, D -> pipi normalized to D -> Kpi
+  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.82.072004
+  // 4 Observables :
+  corr = Pred(CorrMeas::Babar_PRD82_072004);
+  corr[0] = R_dk_cpeven_a10.Acp();
+  corr[1] = R_dk_cpodd_a10.Acp();
+  corr[2] =  (R_dk_cpeven_a10.Sfav() / R_dk_kpi_a10.Sfav()) / (R_dpi_cpeven_a10.Sfav() / R_dpi_kpi_a10.Sfav());
+  corr[3] =  (R_dk_cpodd_a10.Sfav() / R_dk_kpi_a10.Sfav()) / (R_dpi_cpodd_a10.Sfav() / R_dpi_kpi_a10.Sfav());
+
+
+  //  https://arxiv.org/pdf/0807.2408
+  // B -> DstarK
+  // D -> KK, pipi + fcp-
+  // 4 Observables :
+  spred[Meas::Babar_0807_2408_ACPp] = R_dstk_cpeven_a10.Acp();
+  spred[Meas::Babar_0807_2408_ACPm] = R_dstk_cpodd_a10.Acp();
+  spred[Meas::Babar_0807_2408_RCPp] = (R_dstk_cpeven_a10.Sfav() / R_dstk_kpi_a10.Sfav()) / (R_dstpi_cpeven_a10.Sfav() / R_dstpi_kpi_a10.Sfav());
+  spred[Meas::Babar_0807_2408_RCPm] = (R_dstk_cpodd_a10.Sfav() / R_dstk_kpi_a10.Sfav()) / (R_dstpi_cpodd_a10.Sfav() / R_dstpi_kpi_a10.Sfav());
+
+
+  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.80.092001
+  // B -> DKstar
+  // D -> KK, pipi, fcp-
+  spred[Meas::Babar_PRD80_092001_ACPp] = R_dkst_cpeven_a10.Acp();
+  spred[Meas::Babar_PRD80_092001_ACPm] = R_dkst_cpodd_a10.Acp();
+  spred[Meas::Babar_PRD80_092001_RCPp] = (R_dkst_cpeven_a10.Sfav() / R_dkst_kpi_a10.Sfav())  ;
+  spred[Meas::Babar_PRD80_092001_RCPm] = (R_dkst_cpodd_a10.Sfav() / R_dkst_kpi_a10.Sfav())  ;
+  //https://arxiv.org/pdf/0909.3981
+  // B -> DK
+  // D -> Kpi
+  spred[Meas::Babar_0909_3981_RADS] = R_dkst_kpi_a10.Rads();
+  spred[Meas::Babar_0909_3981_Asup] = R_dkst_kpi_a10.Asup();
+
+
+  // https://arxiv.org/pdf/hep-ex/0703037
+  // B -> DK
+  // GLW D -> pi+pi-pi0
+  spred[Meas::Babar_0703037] = R_dk_pipipi0_a10.Acp();
+  corr = Pred(CorrMeas::Babar_0703037_rhotheta);
+  corr[0] = sqrt( ( r_dk * (sc.d_dk + sc.g).c - (2 * F_pipipi0 -1 ) ) * ( r_dk * (sc.d_dk + sc.g).c - (2 * F_pipipi0 -1 ) ) + ( r_dk * (sc.d_dk + sc.g).s )*( r_dk * (sc.d_dk + sc.g).s ) );
+  T thetap_babar = PositiveAngle(atan2( r_dk * (sc.d_dk + sc.g).s, ( r_dk * (sc.d_dk + sc.g).c  - (2*F_pipipi0 -1) )  )); // in [0, 2 pi]
+  corr[1] = thetap_babar;
+  corr[2] = sqrt( ( r_dk * (sc.d_dk - sc.g).c - (2 * F_pipipi0 -1 ) ) * ( r_dk * (sc.d_dk - sc.g).c - (2 * F_pipipi0 -1 ) ) + ( r_dk * (sc.d_dk - sc.g).s )*( r_dk * (sc.d_dk - sc.g).s ) );
+  T thetam_babar = PositiveAngle(atan2( r_dk * (sc.d_dk - sc.g).s , ( r_dk * (sc.d_dk - sc.g).c  - (2*F_pipipi0 -1)  ) )); // in [0, 2 pi]
+  corr[3] = thetam_babar;
+
+
+  // https://arxiv.org/pdf/1006.4241
+  // B -> DK
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDK] =  0.5 * ( R_dk_kpi_a10.Rp() + R_dk_kpi_a10.Rm() ) ;
+  spred[Meas::Babar_1006_4241_ADK] =  ( - R_dk_kpi_a10.Rp() + R_dk_kpi_a10.Rm() ) / ( R_dk_kpi_a10.Rp() + R_dk_kpi_a10.Rm() ) ;
+  // B -> [Dpi0]_Dstar K
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDstarKpi0] =  0.5 * (  R_dstk_kpi_a10.Rm() +  R_dstk_kpi_a10.Rp()  )  ;
+  spred[Meas::Babar_1006_4241_ADstarKpi0] =  (  R_dstk_kpi_a10.Rm() -  R_dstk_kpi_a10.Rp()  ) / (  R_dstk_kpi_a10.Rm() +  R_dstk_kpi_a10.Rp()  ) ;
+  // B -> [Dg]_Dstar K
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDstarKg] =  0.5 * ( R_dstk_shift_kpi_a10.Rm() + R_dstk_shift_kpi_a10.Rp() ) ;
+  spred[Meas::Babar_1006_4241_ADstarKg] =  ( R_dstk_shift_kpi_a10.Rm() - R_dstk_shift_kpi_a10.Rp() ) / ( R_dstk_shift_kpi_a10.Rm() + R_dstk_shift_kpi_a10.Rp() ) ;
+  // B -> Dpi
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDpi] =  0.5 * ( R_dpi_kpi_a10.Rm() +  R_dpi_kpi_a10.Rp() ) ;
+  spred[Meas::Babar_1006_4241_ADpi] =  ( R_dpi_kpi_a10.Rm() -  R_dpi_kpi_a10.Rp() ) / ( R_dpi_kpi_a10.Rm() +  R_dpi_kpi_a10.Rp() ) ;
+  // B -> [Dpi0]_Dstarpi
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDstarpipi0] =  0.5 * (  R_dstpi_kpi_a10.Rm() +  R_dstpi_kpi_a10.Rp()  )  ;
+  spred[Meas::Babar_1006_4241_ADstarpipi0] =  (  R_dstpi_kpi_a10.Rm() -  R_dstpi_kpi_a10.Rp()  ) / (  R_dstpi_kpi_a10.Rm() +  R_dstpi_kpi_a10.Rp()  ) ;
+  // B -> [Dpig]_Dstarpi
+  // D -> Kpi
+  spred[Meas::Babar_1006_4241_RDstarpig] =  0.5 * ( R_dstpi_shift_kpi_a10.Rm() + R_dstpi_shift_kpi_a10.Rp() ) ;
+  spred[Meas::Babar_1006_4241_ADstarpig] =  ( R_dstpi_shift_kpi_a10.Rm() - R_dstpi_shift_kpi_a10.Rp() ) / ( R_dstpi_shift_kpi_a10.Rm() + R_dstpi_shift_kpi_a10.Rp() ) ;
+
+
+  // https://arxiv.org/pdf/1104.4472
+  // B -> DK
+  // D -> Kpipi0
+  spred[Meas::Babar_1104_4472_Rp_DK_Kpipi0] = R_dk_kpipi0_a10.Rp();
+  spred[Meas::Babar_1104_4472_Rm_DK_Kpipi0] = R_dk_kpipi0_a10.Rm();
+
+
+  // https://journals.aps.org/prl/pdf/10.1103/PhysRevLett.105.121801
+  // B -> D(star)K(star) BPGGSZ
+  // D -> K0spipi + D -> K0sKK
+  corr = Pred(CorrMeas::Babar_PRL105_121801);
+  corr[0] = r_dk * (sc.d_dk - sc.g).c;
+  corr[1] = r_dk * (sc.d_dk - sc.g).s;
+  corr[2] = r_dk * (sc.d_dk + sc.g).c;
+  corr[3] = r_dk * (sc.d_dk + sc.g).s;
+  corr[4] = r_dstk * (sc.d_dstk - sc.g).c;
+  corr[5] = r_dstk * (sc.d_dstk - sc.g).s;
+  corr[6] = r_dstk * (sc.d_dstk + sc.g).c;
+  corr[7] = r_dstk * (sc.d_dstk + sc.g).s;
+  corr[8] = k_dkst * r_dstk * (sc.d_dkst - sc.g).c;
+  corr[9] = k_dkst * r_dkst * (sc.d_dkst - sc.g).s;
+  corr[10] = k_dkst * r_dkst * (sc.d_dkst + sc.g).c;
+  corr[11] = k_dkst * r_dkst * (sc.d_dkst + sc.g).s;
+
+
+  //-------------------------------------------------  CDF measurements  -------------------------------------------------------------------------
+
+  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.81.031105
+  // B -> DK
+  // D -> KK, D-> pipi
+  spred[Meas::CDF_PRD81_031105_ACPp] = R_dk_cpeven_a10.Acp();
+  spred[Meas::CDF_PRD81_031105_RCPp] = (R_dk_cpeven_a10.Sfav() / R_dk_kpi_a10.Sfav()) / (R_dpi_cpeven_a10.Sfav() / R_dpi_kpi_a10.Sfav());
+
+
+  // https://arxiv.org/pdf/1108.5765
+  // B -> DK
+  // D -> Kpi
+  spred[Meas::CDF_1108_5765_RDK] = R_dk_kpi_a1.Rads();
+  spred[Meas::CDF_1108_5765_ADK] = R_dk_kpi_a1.Asup();
+  // B -> Dpi
+  // D -> Kpi
+  spred[Meas::CDF_1108_5765_RDpi] = R_dpi_kpi_a1.Rads();
+  spred[Meas::CDF_1108_5765_ADpi] = R_dpi_kpi_a1.Asup();
+
+  //--------------------------------------------------------------------------------------------------------------------------
+
+  //--------------------------------------------------------------------------------------------------------------------------
+
+
+  // GLW: D -> KK, pipi; ADS: D -> Kpi
+  // https://arxiv.org/pdf/2012.09903.pdf
+  // Observables 8:
+  corr = Pred(CorrMeas::UID0);
+  corr[0] = acp_dk_uid0;
+  corr[1] = acp_dpi_uid0;
+  corr[2] = afav_dk_uid0;
+  corr[3] = rcp_uid0;
+  corr[4] = rm_dk_uid0;
+  corr[5] = rm_dpi_uid0;
+  corr[6] = rp_dk_uid0;
+  corr[7] = rp_dpi_uid0;
+
+
+  // GLW: D -> KKpipi, D -> 4pi
+  // https://arxiv.org/abs/2301.10328
+  // 6 Observables
+  corr = Pred(CorrMeas::GLW_2301_10328);
+  corr[0] = acp_dk_kkpipi_230110328;
+  corr[1] = acp_dpi_kkpipi_230110328;
+  corr[2] = acp_dk_pipipipi_230110328;
+  corr[3] = acp_dpi_pipipipi_230110328;
+  corr[4] = rcp_kpi_kkpipi_230110328;
+  corr[5] = rcp_kpi_pipipipi_230110328;
+
+
+  // GLW: D -> pipipi0, KKpi0; D -> Kpipi0
+  //https://arxiv.org/pdf/2112.10617
+  // Observables 11:
+  corr = Pred(CorrMeas::arXiv_2112_10617);
+  corr[0] = rcp_kkpi0_211210617;
+  corr[1] = rcp_pipipi0_211210617;
+  corr[2] = afav_dk_kpipi0_211210617;
+  corr[3] = acp_dk_kkpi0_211210617;
+  corr[4] = acp_dk_pipipi0_211210617;
+  corr[5] = acp_dpi_kkpi0_211210617;
+  corr[6] = acp_dpi_pipipi0_211210617;
+  corr[7] = rp_dk_211210617;
+  corr[8] = rm_dk_211210617;
+  corr[9] = rp_dpi_211210617;
+  corr[10] = rm_dpi_211210617;
+
+
+  // ADS: D -> K0sKpi
+  // https://arxiv.org/pdf/2002.08858
+  // Observables 7:
+  corr = Pred(CorrMeas::UID4);
+  corr[0] = afav_dpi_kskpi_uid4;
+  corr[1] = asup_dpi_kskpi_uid4;
+  corr[2] = afav_dk_kskpi_uid4;
+  corr[3] = asup_dk_kskpi_uid4;
+  corr[4] = rfavsup_dpi_kskpi_uid4;
+  corr[5] = rfav_dkdpi_kskpi_uid4;
+  corr[6] = rsup_dkdpi_kskpi_uid4;
+
+
+  // GLW: D -> KK, D -> K0spi0
+  // https://arxiv.org/abs/2308.05048
+  // Observables 4:
+  corr = Pred(CorrMeas::arXiv_2308_05048);
+  corr[0] = R_dk_cpodd_a1.Acp();
+  corr[1] = (R_dk_cpodd_a1.Sfav() / R_dk_kpi_a1.Sfav()) / (R_dpi_cpodd_a1.Sfav() / R_dpi_kpi_a1.Sfav());
+  corr[2] = R_dk_cpeven_a1.Acp();
+  corr[3] = (R_dk_cpeven_a1.Sfav() / R_dk_kpi_a1.Sfav()) / (R_dpi_cpeven_a1.Sfav() / R_dpi_kpi_a1.Sfav());
+
+
+  // ADS: D -> Kpipi0
+  // https://arxiv.org/pdf/1310.1741
+  // Observables 4:
+  corr = Pred(CorrMeas::Belle_PRD88_2013);
+  corr[0] = R_dk_kpipi0_a1.Rads();
+  corr[1] = R_dk_kpipi0_a1.Asup();
+  corr[2] = R_dpi_kpipi0_a1.Rads();
+  corr[3] = R_dpi_kpipi0_a1.Asup();
+
+
+  // ADS: D -> Kpi
+  // https://arxiv.org/abs/1103.5951
+  // Observables 4:
+  corr = Pred(CorrMeas::Belle_PRL106_2011);
+  corr[0] = R_dk_kpi_a1.Rads();
+  corr[1] = R_dk_kpi_a1.Asup();
+  corr[2] = R_dpi_kpi_a1.Rads();
+  corr[3] = R_dpi_kpi_a1.Asup();
+
+
+  // K^*+- region fit: ADS: D -> K0sKpi
+  // 2306.02940
+  // Observables 7:
+  corr = Pred(CorrMeas::arXiv_2306_02940);
+  corr[0] = afav_dk_kskpi_uid4;
+  corr[1] = asup_dk_kskpi_uid4;
+  corr[2] = afav_dpi_kskpi_uid4;
+  corr[3] = asup_dpi_kskpi_uid4;
+  corr[4] = rfav_dkdpi_kskpi_uid4;
+  corr[5] = rsup_dkdpi_kskpi_uid4;
+  corr[6] = rfavsup_dpi_kskpi_uid4;
+
+
+  // GGSZ: D -> K3pi
+  // https://arxiv.org/pdf/2209.03692
+  // Observables 6:
+  corr = Pred(CorrMeas::arXiv_2209_03692);
+  corr[0] = xp_dk_uid3;
+  corr[1] = xm_dk_uid3;
+  corr[2] = yp_dk_uid3;
+  corr[3] = ym_dk_uid3;
+  corr[4] = xi_x_dpi_uid3;
+  corr[5] = xi_y_dpi_uid3;
+
+
+  // GGSZ D -> K0spipipi0
+  // https://arxiv.org/pdf/1908.09499
+  // Observables 8:
+  corr = Pred(CorrMeas::arXiv_1908_09499);
+  corr[0] = xm_dk_uid3;
+  corr[1] = ym_dk_uid3;
+  corr[2] = xp_dk_uid3;
+  corr[3] = yp_dk_uid3;
+  corr[4] = r_dpi * (sc.d_dpi - sc.g).c;
+  corr[5] = r_dpi * (sc.d_dpi - sc.g).s;
+  corr[6] = r_dpi * (sc.d_dpi + sc.g).c;
+  corr[7] = r_dpi * (sc.d_dpi + sc.g).s;
+
+
+  // GGSZ: D -> K0spipi, D -> K0sKK
+  // https://arxiv.org/abs/2110.12125
+  // Observables 6:
+  corr = Pred(CorrMeas::arXiv_2110_12125);
+  corr[0] = xm_dk_uid3;
+  corr[1] = ym_dk_uid3;
+  corr[2] = xp_dk_uid3;
+  corr[3] = yp_dk_uid3;
+  corr[4] = xi_x_dpi_uid3;
+  corr[5] = xi_y_dpi_uid3;
+
+
+  // GGSZ: D -> K0sKK, D -> K0spipi
+  // https://arxiv.org/abs/2301.10328
+  // 6 Observables
+  corr = Pred(CorrMeas::GGSZ_2301_10328);
+  corr[0] = xm_dk_uid3;
+  corr[1] = ym_dk_uid3;
+  corr[2] = xp_dk_uid3;
+  corr[3] = yp_dk_uid3;
+  corr[4] = xi_x_dpi_uid3;
+  corr[5] = xi_y_dpi_uid3;
+
+
+  // If combiining chargedB modes only
+  // If combining all the modes see the neutralBd section since they are all correlated
+  // https://arxiv.org/pdf/2010.08483 + https://arxiv.org/abs/2310.04277 +  https://arxiv.org/abs/2311.10434 + LHCB-PAPER-2024-023
+  if (comb == 0)
+  {
+
+    // 4. GGSZ LHCb ChargedB
+    // Observables 22:
+    corr = Pred(CorrMeas::GGSZ_LHCb_Cb);
+
+    // D -> K0spipi, D -> K0sKK
+    // https://arxiv.org/pdf/2010.08483
+    // Observables 6:
+    corr[0] = xm_dk_uid3;
+    corr[1] = ym_dk_uid3;
+    corr[2] = xp_dk_uid3;
+    corr[3] = yp_dk_uid3;
+    corr[4] = xi_x_dpi_uid3;
+    corr[5] = xi_y_dpi_uid3;
+
+    //----------------------------------------------------------------------------------------------------------------------------------
+
+    //-------------------------------------------------  Bpm -> D*hpm -------------------------------------------------------------------------
+
+    // GGSZ: D -> K0spipi, D -> K0sKK
+    // https://arxiv.org/abs/2310.04277 LHCb
+    // Observables 6:
+    corr[6] = r_dstk * (sc.d_dstk + sc.g).c;
+    corr[7] = r_dstk * (sc.d_dstk - sc.g).c;
+    corr[8] = r_dstk * (sc.d_dstk + sc.g).s;
+    corr[9] = r_dstk * (sc.d_dstk - sc.g).s;
+    corr[10] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).c;
+    corr[11] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).s;
+
+    // GGSZ: D -> K0spipi, D -> K0sKK
+    // https://arxiv.org/abs/2311.10434 LHCb
+    // Observables 6:
+    corr[12] = r_dstk * (sc.d_dstk - sc.g).c;
+    corr[13] = r_dstk * (sc.d_dstk - sc.g).s;
+    corr[14] = r_dstk * (sc.d_dstk + sc.g).c;
+    corr[15] = r_dstk * (sc.d_dstk + sc.g).s;
+    corr[16] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).c;
+    corr[17] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).s;
+
+    //----------------------------------------------------------------------------------------------------------------------------------
+
+    //-------------------------------------------------  Bpm -> DK*pm -------------------------------------------------------------------------
+
+    // GGSZ: D -> K0spipi, D -> K0sKK
+    // LHCB-PAPER-2024-023
+    // Observables 4:
+    corr[18] = r_dkst * (sc.d_dkst - sc.g).c;
+    corr[19] = r_dkst * (sc.d_dkst - sc.g).s;
+    corr[20] = r_dkst * (sc.d_dkst + sc.g).c;
+    corr[21] = r_dkst * (sc.d_dkst + sc.g).s;
+
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------------------
+
+  //-------------------------------------------------  Bpm -> D*hpm -------------------------------------------------------------------------
+
+  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
+  // https://arxiv.org/abs/2012.09903
+  // Observables 18:
+  corr = Pred(CorrMeas::UID5);
+  corr[0] = acp_dstk_dg_uid5;
+  corr[1] = acp_dstk_dp_uid5;
+  corr[2] = afav_dstk_dg_uid5;
+  corr[3] = afav_dstk_dp_uid5;
+  corr[4] = rcp_dg_uid5;
+  corr[5] = rcp_dp_uid5;
+  corr[6] = rm_dstk_dg_uid5;
+  corr[7] = rm_dstk_dp_uid5;
+  corr[8] = rp_dstk_dg_uid5;
+  corr[9] = rp_dstk_dp_uid5;
+  corr[10] = acp_dstpi_dg_uid5;
+  corr[11] = acp_dstpi_dp_uid5;
+  corr[12] = rm_dstpi_dg_uid5;
+  corr[13] = rm_dstpi_dp_uid5;
+  corr[14] = rp_dstpi_dg_uid5;
+  corr[15] = rp_dstpi_dp_uid5;
+  corr[16] = afav_dstpi_dg_uid5;
+  corr[17] = afav_dstpi_dp_uid5;
+
+
+  // GLW: D -> KK, D -> pipi, D -> K0spi0, ....
+  // https://arxiv.org/pdf/hep-ex/0601032
+  // Observables 4:
+  corr = Pred(CorrMeas::Belle_PRD73_2006);
+  corr[0] = R_dstk_cpodd_a1.Acp();
+  corr[1] = (R_dstk_cpodd_a1.Sfav() / R_dstk_kpi_a1.Sfav()) / (R_dstpi_cpodd_a1.Sfav() / R_dstpi_kpi_a1.Sfav());
+  corr[2] = R_dstk_cpeven_a1.Acp();
+  corr[3] = (R_dstk_cpeven_a1.Sfav() / R_dstk_kpi_a1.Sfav()) / (R_dstpi_cpeven_a1.Sfav() / R_dstpi_kpi_a1.Sfav());
+
+
+  // GGSZ: D -> K0spipi
+  // https://arxiv.org/abs/1003.3360
+  // Observables 8:
+  corr = Pred(CorrMeas::Belle_PRD81_2010);
+  corr[0] = r_dstk * (sc.d_dstk - sc.g).c;
+  corr[1] = r_dstk * (sc.d_dstk - sc.g).s;
+  corr[2] = r_dstk * (sc.d_dstk + sc.g).c;
+  corr[3] = r_dstk * (sc.d_dstk + sc.g).s;
+  corr[4] = -r_dstk * (sc.d_dstk - sc.g).c;
+  corr[5] = -r_dstk * (sc.d_dstk - sc.g).s;
+  corr[6] = -r_dstk * (sc.d_dstk + sc.g).c;
+  corr[7] = -r_dstk * (sc.d_dstk + sc.g).s;
+
+
+  //----------------------------------------------------------------------------------------------------------------------------------
+
+  //-------------------------------------------------  Bpm -> DKstpm -------------------------------------------------------------------------
+
+  // Bpm -> DK^*pm
+  // https://arxiv.org/pdf/hep-ex/0604054 (Belle)
+  corr = Pred(CorrMeas::arXiv_0604054);
+  corr[0] = r_dkst * (sc.d_dkst + sc.g).c;
+  corr[1] = r_dkst * (sc.d_dkst + sc.g).s;
+  corr[2] = r_dkst * (sc.d_dkst - sc.g).c;
+  corr[3] = r_dkst * (sc.d_dkst - sc.g).s;
+
+  // GLW: D -> KK, D -> pipi, D -> 4pi; ADS: D -> Kpi, D -> K3pi
+  // LHCb-PAPER-2024-023
+  // Observables 12:
+  corr = Pred(CorrMeas::LHCB_PAPER_2024_023_GLWADS);
+  corr[0] = afav_dkst_kpi;
+  corr[1] = acp_dkst_kk;
+  corr[2] = acp_dkst_pipi;
+  corr[3] = asup_dkst_kpi;
+  corr[4] = rcp_dkst_kk;
+  corr[5] = rcp_dkst_pipi;
+  corr[6] = rsup_dkst_kpi;
+  corr[7] = afav_dkst_k3pi;
+  corr[8] = acp_dkst_pipipipi;
+  corr[9] = asup_dkst_k3pi;
+  corr[10] = rcp_dkst_pipipipi;
+  corr[11] = rsup_dkst_k3pi;
+
+
+  // Coherence factor kappakstpm
+  // https://arxiv.org/pdf/1709.05855
+  spred[Meas::UID24] = k_dkst_uid24;
+
+  //----------------------------------------------------------------------------------------------------------------------------------
+
+  //-------------------------------------------------  Bpm -> Dhpipi -------------------------------------------------------------------------
+
+  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
+  // https://arxiv.org/pdf/1505.07044
+  // Observables 11:
+  corr = Pred(CorrMeas::UID9);
+  corr[0] = rcp_dkpipi_uid9;
+  corr[1] = afav_dkpipi_kpi_uid9;
+  corr[2] = afav_dpipipi_kpi_uid9;
+  corr[3] = acp_dkpipi_kk_uid9;
+  corr[4] = acp_dkpipi_pipi_uid9;
+  corr[5] = acp_dpipipi_kk_uid9;
+  corr[6] = acp_dpipipi_pipi_uid9;
+  corr[7] = rp_dkpipi_uid9;
+  corr[8] = rm_dkpipi_uid9;
+  corr[9] = rp_dpipipi_uid9;
+  corr[10] = rm_dpipipi_uid9;
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_neutralBdobservables()
+{
+
+  //------------------------------------------------- B+ and B- rates of the (B mode, D mode) pairs used below, each computed once -----------------
+  const BDRates R_dkstz_cpeven_a134 = CPRates(r_dkstz, sc.d_dkstz, k_dkstz, 1., 1.34);
+  const BDRates R_dkstz_kpi_a134 = Rates(r_dkstz, sc.d_dkstz, k_dkstz, rD_kpi, sc.dD_kpi, 1., 1.34);
+  const BDRates R_dkstz_pipipipi_a134 = CPRates(r_dkstz, sc.d_dkstz, k_dkstz, F_pipipipi, 1.34);
+  const BDRates R_dkstz_k3pi_a134 = Rates(r_dkstz, sc.d_dkstz, k_dkstz, rD_k3pi, sc.dD_k3pi, kD_k3pi, 1.34);
+
+  // 26. PDF: dkstzcoherence (UID25)
+  //  1 Osservabile
+  k_dkstz_uid25 = k_dkstz;
+
+  //----------------------------------------------- Calculating time Integrated B0d observables -------------------------------------------------------------------------
+
+  // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
+  // Observables 12:
+  acp_dkstz_kk_240117934Bd = R_dkstz_cpeven_a134.Acp();
+  acp_dkstz_pipi_240117934Bd = R_dkstz_cpeven_a134.Acp();
+  rcp_dkstz_kk_240117934Bd = (R_dkstz_cpeven_a134.Sfav() / R_dkstz_kpi_a134.Sfav());
+  rcp_dkstz_pipi_240117934Bd = (R_dkstz_cpeven_a134.Sfav() / R_dkstz_kpi_a134.Sfav());
+  acp_dkstz_4pi_240117934Bd = R_dkstz_pipipipi_a134.Acp();
+  rcp_dkstz_4pi_240117934Bd = (R_dkstz_pipipipi_a134.Sfav() / R_dkstz_k3pi_a134.Sfav());
+  rp_dkstz_kpi_240117934Bd = R_dkstz_kpi_a134.Rp();
+  rm_dkstz_kpi_240117934Bd = R_dkstz_kpi_a134.Rm();
+  rp_dkstz_k3pi_240117934Bd = R_dkstz_k3pi_a134.Rp();
+  rm_dkstz_k3pi_240117934Bd = R_dkstz_k3pi_a134.Rm();
+  afav_dkstz_kpi_240117934Bd = R_dkstz_kpi_a134.Afav();
+  afav_dkstz_k3pi_240117934Bd = R_dkstz_k3pi_a134.Afav();
+
+
+  xm_dkstz_230905514 = r_dkstz * (sc.d_dkstz - sc.g).c;
+  ym_dkstz_230905514 = r_dkstz * (sc.d_dkstz - sc.g).s;
+  xp_dkstz_230905514 = r_dkstz * (sc.d_dkstz + sc.g).c;
+  yp_dkstz_230905514 = r_dkstz * (sc.d_dkstz + sc.g).s;
+
+  //----------------------------------------------- Calculating time dependent B0d observables -------------------------------------------------------------------------
+
+
+  s_dmpi_uid12 = -(2 * l_dmpi * (sc.d_dmpi - (sc.phi_d + sc.g)).s) / (1 + l_dmpi * l_dmpi);
+  sb_dmpi_uid12 = (2 * l_dmpi * (sc.d_dmpi + (sc.phi_d + sc.g)).s) / (1 + l_dmpi * l_dmpi);
+
+  //-------------------------------------- Babar Measurements -------------------------------------------------------------------------
+
+  // https://arxiv.org/pdf/hep-ex/0602049
+  T a_Dpi = -2 * l_dmpi / (1 + l_dmpi * l_dmpi) * (sc.phi_d + sc.g).s * sc.d_dmpi.c;
+  T c_Dpi = -2 * l_dmpi / (1 + l_dmpi * l_dmpi) * (sc.phi_d + sc.g).c * sc.d_dmpi.s;
+  T a_Dstarpi = -2 * l_dstarmpi / (1 + l_dstarmpi * l_dstarmpi) * (sc.phi_d + sc.g).s * sc.d_dstarmpi.c;
+  T c_Dstarpi = -2 * l_dstarmpi / (1 + l_dstarmpi * l_dstarmpi) * (sc.phi_d + sc.g).c * sc.d_dstarmpi.s;
+  T a_Drho = -2 * l_dmrho / (1 + l_dmrho * l_dmrho) * (sc.phi_d + sc.g).s * sc.d_dmrho.c;
+  T c_Drho = -2 * l_dmrho / (1 + l_dmrho * l_dmrho) * (sc.phi_d + sc.g).c * sc.d_dmrho.s;
+
+
+  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
+
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+  if (comb == 1)
+  { // If treating it seprately from the Bs counterpart
+
+    corr = Pred(CorrMeas::arXiv_2401_17934Bd);
+    corr[0] = afav_dkstz_kpi_240117934Bd;
+    corr[1] = rp_dkstz_kpi_240117934Bd;
+    corr[2] = rm_dkstz_kpi_240117934Bd;
+    corr[3] = afav_dkstz_k3pi_240117934Bd;
+    corr[4] = rp_dkstz_k3pi_240117934Bd;
+    corr[5] = rm_dkstz_k3pi_240117934Bd;
+    corr[6] = acp_dkstz_kk_240117934Bd;
+    corr[7] = rcp_dkstz_kk_240117934Bd;
+    corr[8] = acp_dkstz_pipi_240117934Bd;
+    corr[9] = rcp_dkstz_pipi_240117934Bd;
+    corr[10] = acp_dkstz_4pi_240117934Bd;
+    corr[11] = rcp_dkstz_4pi_240117934Bd;
+
+    corr = Pred(CorrMeas::arXiv_2309_05514);
+    corr[0] = xp_dkstz_230905514;
+    corr[1] = xm_dkstz_230905514;
+    corr[2] = yp_dkstz_230905514;
+    corr[3] = ym_dkstz_230905514;
+
+  }
+  else if (comb == 3)
+  {
+
+    corr = Pred(CorrMeas::DKst0Pcomb);
+
+    corr[0] = xm_dk_uid3;
+    corr[1] = ym_dk_uid3;
+    corr[2] = xp_dk_uid3;
+    corr[3] = yp_dk_uid3;
+    corr[4] = xi_x_dpi_uid3;
+    corr[5] = xi_y_dpi_uid3;
+
+    corr[6] = r_dstk * (sc.d_dstk + sc.g).c;
+    corr[7] = r_dstk * (sc.d_dstk - sc.g).c;
+    corr[8] = r_dstk * (sc.d_dstk + sc.g).s;
+    corr[9] = r_dstk * (sc.d_dstk - sc.g).s;
+    corr[10] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).c;
+    corr[11] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).s;
+
+    corr[12] = r_dstk * (sc.d_dstk - sc.g).c;
+    corr[13] = r_dstk * (sc.d_dstk - sc.g).s;
+    corr[14] = r_dstk * (sc.d_dstk + sc.g).c;
+    corr[15] = r_dstk * (sc.d_dstk + sc.g).s;
+    corr[16] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).c;
+    corr[17] = r_dstpi / r_dstk * (sc.d_dstpi - sc.d_dstk).s;
+
+    corr[18] = r_dkst * (sc.d_dkst - sc.g).c;
+    corr[19] = r_dkst * (sc.d_dkst - sc.g).s;
+    corr[20] = r_dkst * (sc.d_dkst + sc.g).c;
+    corr[21] = r_dkst * (sc.d_dkst + sc.g).s;
+
+    corr[22] = xp_dkstz_230905514;
+    corr[23] = xm_dkstz_230905514;
+    corr[24] = yp_dkstz_230905514;
+    corr[25] = ym_dkstz_230905514;
+
+  }
+
+
+  //  https://arxiv.org/pdf/1509.01098 (Belle)
+  corr = Pred(CorrMeas::arXiv_1509_01098);
+  corr[0] = r_dkstz * (sc.d_dkstz + sc.g).c;
+  corr[1] = r_dkstz * (sc.d_dkstz + sc.g).s;
+  corr[2] = r_dkstz * (sc.d_dkstz - sc.g).c;
+  corr[3] = r_dkstz * (sc.d_dkstz - sc.g).s;
+
+
+  corr = Pred(CorrMeas::UID12);
+  corr[0] = s_dmpi_uid12;
+  corr[1] = sb_dmpi_uid12;
+
+
+  //-------------------------------------- Babar Measurements -------------------------------------------------------------------------
+  // https://arxiv.org/pdf/hep-ex/0602049
+  spred[Meas::arXiv_0602049_aDpi] = a_Dpi;
+  spred[Meas::arXiv_0602049_cDpi] = c_Dpi;
+  spred[Meas::arXiv_0602049_aDstarpi] = a_Dstarpi;
+  spred[Meas::arXiv_0602049_cDstarpi] = c_Dstarpi;
+  spred[Meas::arXiv_0602049_aDrho] = a_Drho;
+  spred[Meas::arXiv_0602049_cDrho] = c_Drho;
+
+  // https://arxiv.org/pdf/hep-ex/0504035
+  spred[Meas::arXiv_0504035_aDstarpi] = a_Dstarpi;
+  spred[Meas::arXiv_0504035_cDstarpi] = c_Dstarpi;
+
+
+  spred[Meas::UID25] = k_dkstz_uid25;
+
+  spred[Meas::UID27] = sc.phi_d.s;
+
+
+  //-------------------------------------- Belle Measurements -------------------------------------------------------------------------
+
+  // https://arxiv.org/pdf/hep-ex/0604013 (HFLAV conversion)
+  spred[Meas::arXiv_0604013_aDpi] = a_Dpi;
+  spred[Meas::arXiv_0604013_cDpi] = c_Dpi;
+  spred[Meas::arXiv_0604013_aDstarpi] = a_Dstarpi;
+  spred[Meas::arXiv_0604013_cDstarpi] = c_Dstarpi;
+
+  // https://arxiv.org/pdf/1102.0888
+  spred[Meas::arXiv_11020888_aDstarpi] = a_Dstarpi;
+  spred[Meas::arXiv_11020888_cDstarpi] = c_Dstarpi;
+
+
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_neutralBsobservables()
+{
+
+  //------------------------------------------------- B+ and B- rates of the (B mode, D mode) pairs used below, each computed once -----------------
+  const BDRates R_dkstzs_cpeven_a134 = CPRates(r_dkstzs, sc.d_dkstzs, k_dkstzs, 1., 1.34);
+  const BDRates R_dkstzs_kpi_a134 = Rates(r_dkstzs, sc.d_dkstzs, k_dkstzs, rD_kpi, sc.dD_kpi, 1., 1.34);
+  const BDRates R_dkstzs_pipipipi_a134 = CPRates(r_dkstzs, sc.d_dkstzs, k_dkstzs, F_pipipipi, 1.34);
+  const BDRates R_dkstzs_k3pi_a134 = Rates(r_dkstzs, sc.d_dkstzs, k_dkstzs, rD_k3pi, sc.dD_k3pi, kD_k3pi, 1.34);
+
+  //----------------------------------------------- Calculating time Integrated B0d observables -------------------------------------------------------------------------
+
+  acp_dkstz_kk_240117934Bs = R_dkstzs_cpeven_a134.Acp();
+  acp_dkstz_pipi_240117934Bs = R_dkstzs_cpeven_a134.Acp();
+  rcp_dkstz_kk_240117934Bs = (R_dkstzs_cpeven_a134.Sfav() / R_dkstzs_kpi_a134.Sfav());
+  rcp_dkstz_pipi_240117934Bs = (R_dkstzs_cpeven_a134.Sfav() / R_dkstzs_kpi_a134.Sfav());
+  acp_dkstz_4pi_240117934Bs = R_dkstzs_pipipipi_a134.Acp();
+  rcp_dkstz_4pi_240117934Bs = (R_dkstzs_pipipipi_a134.Sfav() / R_dkstzs_k3pi_a134.Sfav());
+  rp_dkstz_kpi_240117934Bs = R_dkstzs_kpi_a134.Rp();
+  rm_dkstz_kpi_240117934Bs = R_dkstzs_kpi_a134.Rm();
+  rp_dkstz_k3pi_240117934Bs = R_dkstzs_k3pi_a134.Rp();
+  rm_dkstz_k3pi_240117934Bs = R_dkstzs_k3pi_a134.Rm();
+  afav_dkstz_kpi_240117934Bs = R_dkstzs_kpi_a134.Afav();
+  afav_dkstz_k3pi_240117934Bs = R_dkstzs_k3pi_a134.Afav();
+
+  //----------------------------------------------- Calculating time dependent B0s observables -------------------------------------------------------------------------
+
+  c_dsk_uid10 = (1 - l_dsk * l_dsk) / (1 + l_dsk * l_dsk);
+  d_dsk_uid10 = -(2 * l_dsk * (sc.d_dsk - (sc.g + sc.phis)).c) / (1 + l_dsk * l_dsk); // phis = - 2 beta_s
+  db_dsk_uid10 = -(2 * l_dsk * (sc.d_dsk + (sc.g + sc.phis)).c) / (1 + l_dsk * l_dsk);
+  s_dsk_uid10 = (2 * l_dsk * (sc.d_dsk - (sc.g + sc.phis)).s) / (1 + l_dsk * l_dsk);
+  sb_dsk_uid10 = -(2 * l_dsk * (sc.d_dsk + (sc.g + sc.phis)).s) / (1 + l_dsk * l_dsk);
+
+
+  c_dskpipi_uid11 = (1 - l_dskpipi * l_dskpipi) / (1 + l_dskpipi * l_dskpipi);
+  d_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * (sc.d_dskpipi - (sc.g + sc.phis)).c) / (1 + l_dskpipi * l_dskpipi);
+  db_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * (sc.d_dskpipi + (sc.g + sc.phis)).c) / (1 + l_dskpipi * l_dskpipi);
+  s_dskpipi_uid11 = (2 * k_dskpipi * l_dskpipi * (sc.d_dskpipi - (sc.g + sc.phis)).s) / (1 + l_dskpipi * l_dskpipi);
+  sb_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * (sc.d_dskpipi + (sc.g + sc.phis)).s) / (1 + l_dskpipi * l_dskpipi);
+
+  phis_uid26 = phis; // -2 betas
+
+  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
+
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+  if (comb == 2)
+  { // If treating it separately from Bd counterpart
+
+    // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
+    // Observables 12:
+    corr = Pred(CorrMeas::arXiv_2401_17934Bs);
+    corr[0] = afav_dkstz_kpi_240117934Bs;
+    corr[1] = rp_dkstz_kpi_240117934Bs;
+    corr[2] = rm_dkstz_kpi_240117934Bs;
+    corr[3] = afav_dkstz_k3pi_240117934Bs;
+    corr[4] = rp_dkstz_k3pi_240117934Bs;
+    corr[5] = rm_dkstz_k3pi_240117934Bs;
+    corr[6] = acp_dkstz_kk_240117934Bs;
+    corr[7] = rcp_dkstz_kk_240117934Bs;
+    corr[8] = acp_dkstz_pipi_240117934Bs;
+    corr[9] = rcp_dkstz_pipi_240117934Bs;
+    corr[10] = acp_dkstz_4pi_240117934Bs;
+    corr[11] = rcp_dkstz_4pi_240117934Bs;
+
+  }
+  else if (comb == 3)
+  { // When using also the Bd counterpart
+
+    // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
+    // Observables 24:
+    corr = Pred(CorrMeas::arXiv_2401_17934); // Bd  part
+    corr[0] = afav_dkstz_kpi_240117934Bd;
+    corr[1] = rp_dkstz_kpi_240117934Bd;
+    corr[2] = rm_dkstz_kpi_240117934Bd;
+    corr[3] = afav_dkstz_k3pi_240117934Bd;
+    corr[4] = rp_dkstz_k3pi_240117934Bd;
+    corr[5] = rm_dkstz_k3pi_240117934Bd;
+    corr[6] = acp_dkstz_kk_240117934Bd;
+    corr[7] = rcp_dkstz_kk_240117934Bd;
+    corr[8] = acp_dkstz_pipi_240117934Bd;
+    corr[9] = rcp_dkstz_pipi_240117934Bd;
+    corr[10] = acp_dkstz_4pi_240117934Bd;
+    corr[11] = rcp_dkstz_4pi_240117934Bd;
+
+    // Bs part
+    corr[12] = afav_dkstz_kpi_240117934Bs;
+    corr[13] = rp_dkstz_kpi_240117934Bs;
+    corr[14] = rm_dkstz_kpi_240117934Bs;
+    corr[15] = afav_dkstz_k3pi_240117934Bs;
+    corr[16] = rp_dkstz_k3pi_240117934Bs;
+    corr[17] = rm_dkstz_k3pi_240117934Bs;
+    corr[18] = acp_dkstz_kk_240117934Bs;
+    corr[19] = rcp_dkstz_kk_240117934Bs;
+    corr[20] = acp_dkstz_pipi_240117934Bs;
+    corr[21] = rcp_dkstz_pipi_240117934Bs;
+    corr[22] = acp_dkstz_4pi_240117934Bs;
+    corr[23] = rcp_dkstz_4pi_240117934Bs;
+
+
+  }
+
+
+  corr = Pred(CorrMeas::BSDSKRun1);
+  corr[0] = c_dsk_uid10;
+  corr[1] = d_dsk_uid10;
+  corr[2] = db_dsk_uid10;
+  corr[3] = s_dsk_uid10;
+  corr[4] = sb_dsk_uid10;
+
+
+  corr = Pred(CorrMeas::UID11);
+  corr[0] = c_dskpipi_uid11;
+  corr[1] = d_dskpipi_uid11;
+  corr[2] = db_dskpipi_uid11;
+  corr[3] = s_dskpipi_uid11;
+  corr[4] = sb_dskpipi_uid11;
+
+
+  spred[Meas::UID26] = phis_uid26; // -2betas
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_time_dependent_Dobservables()
+{
+
+  xcp_uid14 = xcp;
+  ycp_uid14 = ycp;
+  dx_uid14 = dx;
+  dy_uid14 = dy;
+
+  ycp_uid28 = ycp + 0.5 * rD_kpi * (sc.phi.c * (-y * sc.dD_kpi.c - x * sc.dD_kpi.s) * (qop + 1. / qop) + sc.phi.s * (-y * sc.dD_kpi.s + x * sc.dD_kpi.c) * (qop - 1. / qop));
+
+  DY_uid29 = 0.5 * (-y * sc.phi.c * (qop - 1. / qop) + x * sc.phi.s * (qop + 1. / qop));
+
+  Rdp_uid30 = rD_kpi * rD_kpi * (1 + AD);
+  yp_uid30 = y_plus(sc.dD_kpi);
+  xpsq_uid30 = x_plus(sc.dD_kpi) * x_plus(sc.dD_kpi);
+  Rdm_uid30 = rD_kpi * rD_kpi * (1 - AD);
+  ym_uid30 = y_minus(sc.dD_kpi);
+  xmsq_uid30 = x_minus(sc.dD_kpi) * x_minus(sc.dD_kpi);
+
+  Akpi_BESIII = (-2 * rD_kpi * sc.dD_kpi.c + y) / (1 + rD_kpi * rD_kpi);
+  Akpi_kpipi0_BESIII = (F_pipipi0 * (-2 * rD_kpi * sc.dD_kpi.c + y)) / (1 + rD_kpi * rD_kpi + (1 - F_pipipi0) * (2 * rD_kpi * sc.dD_kpi.c + y));
+
+  xi_x_BESIII = rD_kpi * sc.dD_kpi.c;
+  xi_y_BESIII = rD_kpi * sc.dD_kpi.s;
+
+  T tKKpitaggedOverTauD = tavepitaggedOverTauD + 0.5 * DeltatpitaggedOverTauD;
+  T tKKmutaggedOverTauD = tavemutaggedOverTauD + 0.5 * DeltatmutaggedOverTauD;
+  T tpipipitaggedOverTauD = tavepitaggedOverTauD - 0.5 * DeltatpitaggedOverTauD;
+  T tpipimutaggedOverTauD = tavemutaggedOverTauD - 0.5 * DeltatmutaggedOverTauD;
+  T DYKK = DY_uid29 + 0.5 * DYKKmDYpipi;
+  T DYpipi = DY_uid29 - 0.5 * DYKKmDYpipi;
+  T DeltaACP_pitagged = adKK - adpipi + tKKpitaggedOverTauD * DYKK - tpipipitaggedOverTauD * DYpipi;
+  T DeltaACP_mutagged = adKK - adpipi + tKKmutaggedOverTauD * DYKK - tpipimutaggedOverTauD * DYpipi;
+  T ACPKKDp = adKK + tKKCDp / tauD * DYKK;
+  T ACPKKDs = adKK + tKKCDs / tauD * DYKK;
+
+  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+  // Delta ACP; Acp(KK); Run1 semileptonic tagging
+  // https://arxiv.org/pdf/1405.2797
+  // Observables 4:
+  spred[Meas::arXiv_1405_2797_tKKOverTauD_DAcp] = tauKK_DAcp_Run1_sl;
+  spred[Meas::arXiv_1405_2797_tpipiOverTauD_DAcp] = taupipi_DAcp_Run1_sl;
+  spred[Meas::arXiv_1405_2797_tKKOverTauD_Acp] = tauKK_Acp_Run1_sl;
+  corr = Pred(CorrMeas::arXiv_1405_2797_1610_09476_Acp);
+  corr[0] = adKK - adpipi + tauKK_DAcp_Run1_sl * DYKK - taupipi_DAcp_Run1_sl * DYpipi; // DAcp Run1 sl
+  corr[1] = adKK + tauKK_Acp_Run1_sl * DYKK; // Acp(KK) sl
+  // ACP(KK); Run1 Hadronic tagging; Correlated due to the removing of the detection asymmetry
+  // https://arxiv.org/pdf/1610.09476
+  // Observables 1:
+  corr[2] = adKK + tauKK_Acp_Run1_pi * DYKK; // Acp(KK) pi-tagged
+
+
+  // tOverTauD; Run1 Hadronic tagging;
+  // https://arxiv.org/pdf/1610.09476
+  // Observables 1:
+  spred[Meas::arXiv_1610_09476_tKKOverTauD] = tauKK_Acp_Run1_pi;
+
+
+  // Delta ACP; Run1 Hadronic tagging
+  // https://arxiv.org/pdf/1602.03160
+  // Observables 3:
+  T DeltaACP_Run1_pitagged = adKK - adpipi + tauKK_DAcp_Run1_pi * DYKK - taupipi_DAcp_Run1_pi * DYpipi;
+  spred[Meas::arXiv_1602_03160_DeltaACPpitagged] = DeltaACP_Run1_pitagged;
+  spred[Meas::arXiv_1602_03160_tKKOverTauD] = tauKK_DAcp_Run1_pi;
+  spred[Meas::arXiv_1602_03160_tpipiOverTauD] = taupipi_DAcp_Run1_pi;
+
+
+  // Delta ACP; Run2 Hadronic and Semileptonic tagging
+  // https://arxiv.org/pdf/1903.08726
+  // Observables 6:
+  spred[Meas::DeltaACPpitagged] = DeltaACP_pitagged;
+  spred[Meas::DeltaACPmutagged] = DeltaACP_mutagged;
+  spred[Meas::tavepitaggedOverTauD] = tavepitaggedOverTauD;
+  spred[Meas::tavemutaggedOverTauD] = tavemutaggedOverTauD;
+  spred[Meas::DeltatmutaggedOverTauD] = DeltatmutaggedOverTauD;
+  // tOverTauD; Run 2 Acp(KK); Correlated through reconstructed mean decay times
+  // https://arxiv.org/pdf/2209.03179
+  // Observables 2:
+  corr = Pred(CorrMeas::tausforDACP);
+  corr[0] = tKKCDp;
+  corr[1] = tKKCDs;
+  corr[2] = DeltatpitaggedOverTauD;
+
+
+  // Run 2 Acp(KK)
+  // https://arxiv.org/pdf/2209.03179
+  // Observables 2:
+  corr = Pred(CorrMeas::ACPKK);
+  corr[0] = ACPKKDp;
+  corr[1] = ACPKKDs;
+
+
+  // yCP - yCP(Kpi)
+  // HFLAV combo: https://hflav-eos.web.cern.ch/hflav-eos/charm/CKM23/results_mixing.html#kkpipi including latest https://arxiv.org/abs/2202.09106
+  spred[Meas::UID28] = ycp_uid28;
+
+
+  // ( DY(KK) + DY(pipi) )/2 LHCb combo Run1 + Run2
+  // https://arxiv.org/pdf/2105.09889
+  // Observables 1:
+  spred[Meas::UID29] = DY_uid29;
+
+
+  // ( DY(KK) - DY(pipi) ) LHCb combo Run1 + Run2
+  // https://arxiv.org/pdf/2105.09889
+  // Observables 1:
+  spred[Meas::DYKKmDYpipi] = DYKKmDYpipi;
+
+
+  // Agamma(KK) and Agamma(pipi) Full CDF
+  // https://arxiv.org/pdf/1410.5435
+  // Observables 2:
+  spred[Meas::arXiv_1410_5435_AGammaKK] = -DYKK;
+  spred[Meas::arXiv_1410_5435_AGammapipi] = -DYpipi;
+
+
+  // tOverTauD CDF
+  // https://arxiv.org/pdf/1111.5023
+  // Observables 2:
+  spred[Meas::arXiv_1111_5023_tKKOverTauD_CDF] = tauKK_Acp_CDF;
+  spred[Meas::arXiv_1111_5023_tpipiOverTauD_CDF] = taupipi_Acp_CDF;
+
+
+  // Acp(KK), Acp(pipi)
+  // https://arxiv.org/pdf/1208.2517
+  // Observables 2
+  T ACPKKCDF = adKK + tauKK_Acp_CDF * DYKK;
+  T ACPpipiCDF = adpipi + taupipi_Acp_CDF * DYpipi;
+  spred[Meas::arXiv_1208_2517_AcpKK_CDF] = ACPKKCDF;
+  spred[Meas::arXiv_1208_2517_Acppipi_CDF] = ACPpipiCDF;
+
+
+  // Acp(KK), Acp(pipi) Babar
+  // https://arxiv.org/pdf/0709.2715
+  // Observables 2
+  T ACPKKBfacts = adKK + DYKK; // B factories tau = 1
+  T ACPpipiBfacts = adpipi + DYpipi;
+  spred[Meas::arXiv_0709_2715_AcpKK_Babar] = ACPKKBfacts;
+  spred[Meas::arXiv_0709_2715_Acppipi_Babar] = ACPpipiBfacts;
+
+
+  // Acp(KK), Acp(pipi) Belle
+  // https://arxiv.org/pdf/0807.0148
+  // Observables 2
+  spred[Meas::arXiv_0807_0148_AcpKK_Belle] = ACPKKBfacts;
+  spred[Meas::arXiv_0807_0148_Acppipi_Belle] = ACPpipiBfacts;
+
+
+  CKpi = -y12 * sc.PhiG12.c * sc.dD_kpi.c + x12 * sc.PhiM12.c * sc.dD_kpi.s;
+  CpKpi = 1. / 4. * (x12 * x12 + y12 * y12) + 0.25 * Rdp_uid30 * (y12 * y12 - x12 * x12);
+  DCKpi = -y12 * sc.PhiG12.s * sc.dD_kpi.s - x12 * sc.PhiM12.s * sc.dD_kpi.c;
+  DCpKpi = 0.5 * x12 * y12 * sc.phi12.s;
+  T AtildeKpi = - 2. * adKK;
+  T DCtildeKpi = DCKpi - CKpi * adKK - 2. * rD_kpi * DYKK;
+  T DCtildepKpi = DCpKpi - 2. * CpKpi * adKK - 2. * rD_kpi * CKpi * DYKK;
+
+  corr = Pred(CorrMeas::arXiv_2407_18001);
+  corr[0] = Rdp_uid30;
+  corr[1] = CKpi;
+  corr[2] = CpKpi;
+  corr[3] = AtildeKpi;
+  corr[4] = DCtildeKpi;
+  corr[5] = DCtildepKpi;
+  corr[6] = AD;
+  corr[7] = DCKpi;
+  corr[8] = DCpKpi;
+
+
+  corr = Pred(CorrMeas::UID30);
+  corr[0] = Rdp_uid30;
+  corr[1] = CKpi;
+  corr[2] = CpKpi;
+  corr[3] = AD;
+  corr[4] = DCKpi;
+  corr[5] = DCpKpi;
+
+
+  corr = Pred(CorrMeas::BESIII_Adk);
+  corr[0] = Akpi_BESIII;
+  corr[1] = Akpi_kpipi0_BESIII;
+
+
+  corr = Pred(CorrMeas::BESIII_rDkpi_polar);
+  corr[0] = xi_x_BESIII;
+  corr[1] = xi_y_BESIII;
+
+
+  corr = Pred(CorrMeas::UID14);
+  corr[0] = xcp_uid14;
+  corr[1] = ycp_uid14;
+  corr[2] = dx_uid14;
+  corr[3] = dy_uid14;
+
+
+
+  corr = Pred(CorrMeas::LHCb_kspp_Au2022);
+  corr[0] = xcp;
+  corr[1] = ycp;
+  corr[2] = dx;
+  corr[3] = dy;
+
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_other_observables()
+{
+
+  // 20. PDF: dk3pi_dkpipi0_constraints (UID19)
+  //  6 Observables
+  kD_k3pi_uid19 = kD_k3pi;
+  dD_k3pi_uid19 = dD_k3pi; // because of the phase sign convention
+  kD_kpipi0_uid19 = kD_kpipi0;
+  dD_kpipi0_uid19 = dD_kpipi0; // because of the phase sign convention
+  rD_k3pi_uid19 = rD_k3pi;
+  rD_kpipi0_uid19 = rD_kpipi0;
+
+  // 21. PDF: d4pi_dmixing_cleo (UID20)
+  //  1 Osservabile
+  F_pipipipi_uid20 = F_pipipipi;
+
+  // 22. PDF: CleoDhhpi0Dilution (UID21)
+  F_pipipi0_uid21 = F_pipipi0;
+  F_kkpi0_uid21 = F_kkpi0;
+
+  //----------------------------------------------- Other Observables-------------------------------------------------------------------------
+  // 14. PDF: charm-kspipi-nocpv (UID13)
+  // 2 Observables
+  x_uid13 = x;
+  y_uid13 = y;
+
+
+
+  // 23. PDF: dkskpiRWS (UID22)
+  //  1 Osservabile
+  RD_kskpi_uid22 = (rD_kskpi * rD_kskpi - rD_kskpi * kD_kskpi * (y * sc.dD_kskpi.c - x * sc.dD_kskpi.s)) / (1. - rD_kskpi * kD_kskpi * (y * sc.dD_kskpi.c + x * sc.dD_kskpi.s));
+  // Relative Sign Problem
+
+  // 24. PDF: dkskpi (UID23)
+  //  3 Observables
+  RD_kskpi_uid23 = (rD_kskpi * rD_kskpi - rD_kskpi * kD_kskpi * (y * sc.dD_kskpi.c - x * sc.dD_kskpi.s)) / (1. - rD_kskpi * kD_kskpi * (y * sc.dD_kskpi.c + x * sc.dD_kskpi.s));
+  dD_kskpi_uid23 = dD_kskpi;
+  kD_kskpi_uid23 = kD_kskpi;
+
+  F_pipipipi_BESIII = F_pipipipi;
+
+  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+  // https://arxiv.org/pdf/2503.19542
+  spred[Meas::BESIII_2503_19542_BrDKpi] =  rD_kpi * rD_kpi + rD_kpi * y_plus(sc.dD_kpi) + 0.5 * x_plus(sc.dD_kpi) * x_plus(sc.dD_kpi) * y_plus(sc.dD_kpi) * y_plus(sc.dD_kpi) ;
+  spred[Meas::BESIII_2503_19542_BrDK3pi] =  rD_k3pi * rD_k3pi + kD_k3pi * rD_k3pi * y_plus(sc.dD_k3pi) + 0.5 * x_plus(sc.dD_k3pi) * x_plus(sc.dD_k3pi) * y_plus(sc.dD_k3pi) * y_plus(sc.dD_k3pi) ;
+  spred[Meas::BESIII_2503_19542_BrDKpipi0] =  rD_kpipi0 * rD_kpipi0 + kD_kpipi0 * rD_kpipi0 * y_plus(sc.dD_kpipi0) + 0.5 * x_plus(sc.dD_kpipi0) * x_plus(sc.dD_kpipi0) * y_plus(sc.dD_kpipi0) * y_plus(sc.dD_kpipi0) ;
+
+
+
+  corr = Pred(CorrMeas::UID21);
+  corr[0] = F_pipipi0;
+  corr[1] = F_kkpi0;
+
+
+  corr = Pred(CorrMeas::arXiv_2409_07197_F_BESIII);
+  corr[0] = F_pipipi0;
+  corr[1] = F_kkpi0;
+
+
+  spred[Meas::UID20] = F_pipipipi_uid20;
+
+
+  spred[Meas::Fpipipipi_BESIII] = F_pipipipi_BESIII;
+
+  spred[Meas::FKKpipi_BESIII] = F_kkpipi;
+
+
+  corr = Pred(CorrMeas::UID19);
+  corr[0] = kD_k3pi_uid19;
+  corr[1] = dD_k3pi_uid19;
+  corr[2] = kD_kpipi0_uid19;
+  corr[3] = dD_kpipi0_uid19;
+  corr[4] = rD_k3pi_uid19;
+  corr[5] = rD_kpipi0_uid19;
+
+
+  spred[Meas::UID22] = RD_kskpi_uid22;
+
+
+  corr = Pred(CorrMeas::UID23);
+  corr[0] = RD_kskpi_uid23;
+  corr[1] = dD_kskpi_uid23;
+  corr[2] = kD_kskpi_uid23;
+
+
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+template <class T>
+void MixingContextT<T>::Calculate_old_observables()
+{
+
+  Rd = rD_kpi * rD_kpi;
+
+  // 6th Block
+  rm = (x * x + y * y) / 2.;
+
+  yp_kpp_plus = y_plus(sc.dD_kpipi0);
+  xp_kpp_plus = x_plus(sc.dD_kpipi0);
+
+  yp_kpp_minus = y_minus(sc.dD_kpipi0);
+  xp_kpp_minus = x_minus(sc.dD_kpipi0);
+
+  yp_plus = y_plus(sc.dD_kpi);
+  xp_plus = x_plus(sc.dD_kpi);
+  xp_plus_sq = xp_plus * xp_plus;
+
+  yp_minus = y_minus(sc.dD_kpi);
+  xp_minus = x_minus(sc.dD_kpi);
+  xp_minus_sq = xp_minus * xp_minus;
+
+  T* corr; // predictions of a correlated measurement, written in its buffer
+
+
+  corr = Pred(CorrMeas::kpi_babar_plus);
+  corr[0] = Rd;
+  corr[1] = xp_plus_sq;
+  corr[2] = yp_plus;
+
+  corr = Pred(CorrMeas::kpi_babar_minus);
+  corr[0] = AD;
+  corr[1] = xp_minus_sq;
+  corr[2] = yp_minus;
+
+
+
+  corr = Pred(CorrMeas::cleoc);
+  corr[0] = Rd;
+  corr[1] = x * x;
+  corr[2] = y;
+  corr[3] = cos(M_PI - dD_kpi);
+  corr[4] = sin(M_PI - dD_kpi);
+
+  // 3rd Block
+  double epsI = 2.228 * sin(43.5 * M_PI / 180.) * 1.e-3; // values taken from PDG: https://pdglive.lbl.gov/ParticleGroup.action?init=0&node=MXXX020
+  T RCKM = 0.00384 * 0.04120 / 0.2251 / 0.97345 * sc.g.s; // values taken from https://indico.cern.ch/event/1291157/contributions/5903548/attachments/2900988/5087304/bona-utfit.pdf
+  corr = Pred(CorrMeas::kpp_belle);
+  corr[0] = x;
+  corr[1] = y;
+  corr[2] = qop;
+  corr[3] = phi - 2*epsI - RCKM; // Because of B-factories
+
+
+  corr = Pred(CorrMeas::kppkk);
+  corr[0] = x;
+  corr[1] = y;
+
+
+
+  corr = Pred(CorrMeas::kpp_babar_plus);
+
+  corr[0] = xp_kpp_plus;
+  corr[1] = yp_kpp_plus;
+
+  corr = Pred(CorrMeas::kpp_babar_minus);
+  corr[0] = xp_kpp_minus;
+  corr[1] = yp_kpp_minus;
+
+
+  k3pi_uid18 = 0.25 * (x * x + y * y);
+  spred[Meas::UID18] = k3pi_uid18;
+
+
+  spred[Meas::RM] = rm;
+}
+// ---------------------------------------------------------
+
+// ---------------------------------------------------------
+
+#ifdef LANES
+// The lanes hold other points at every call of MixingModel::LogLikelihoodBatch: every block is recomputed, without the
+// bookkeeping of the incremental likelihood
+template <>
+Lanes MixingContextT<Lanes>::LogLikelihood()
+{
+  for (unsigned i = 0; i < blocks.size(); i++)
+    CalculatePredictions(blocks[i]);
+  int first = blocks.front(), last = blocks.back() + 1;
+  return gauss.logweight(spred.data(), pred.data(), MeasBegin[first], MeasBegin[last], CorrMeasBegin[first], CorrMeasBegin[last]);
+}
+#endif
+// ---------------------------------------------------------
+
+template class MixingContextT<double>;
+
+// Only the likelihood is differentiated, the observables of the histograms are computed in double
+template MixingContextT<Var>::MixingContextT(int, const MeasurementRegistry<dato>&, const MeasurementRegistry<CorrelatedGaussianObservables>&);
+template void MixingContextT<Var>::SetParameters(const std::vector<Var>&);
+template Var MixingContextT<Var>::LogLikelihood();
+
+#ifdef LANES
+// Likewise the batch evaluates only the likelihood
+template MixingContextT<Lanes>::MixingContextT(int, const MeasurementRegistry<dato>&, const MeasurementRegistry<CorrelatedGaussianObservables>&);
+template void MixingContextT<Lanes>::SetParameters(const std::vector<Lanes>&);
+#endif
@@ -0,0 +1,251 @@
+#ifndef __MIXINGCONTEXT__H
+#define __MIXINGCONTEXT__H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "dato.h"
+#include "CorrelatedGaussianObservables.h"
+#include "MeasurementRegistry.h"
+#include "BlockDiagonalGaussian.h"
+#include "Phase.h"
+#include "Kernels.h"
+#include "Autodiff.h"
+#include "Lanes.h"
+#include <cmath>
+#include <math.h>
+// ------------------------------------------ Evaluation state of the MixingModel likelihood ------------------------------------------------
+// Every call to LogLikelihood writes the parameters and the intermediate observables into an instance of this class.
+// The measurements are only read, so several contexts (one per thread) can evaluate the likelihood at the same time.
+// T is the numeric type of the evaluation: double for the fit (MixingContext), Var to differentiate the likelihood, Lanes
+// to evaluate it at several points at once.
+
+using namespace std;
+
+// Handles of the observables that can be histogrammed, same names as in the variables file
+namespace Obs {
+  enum Id {
+    g, x12, y12, r_dk, r_dpi, rD_kpi, d_dk, d_dpi, dD_kpi, rD_k3pi, dD_k3pi, kD_k3pi, F_pipipipi, rD_kpipi0, dD_kpipi0,
+    kD_kpipi0, F_pipipi0, F_kkpi0, rD_kskpi, dD_kskpi, kD_kskpi, RBRdkdpi, r_dstk, d_dstk, r_dstpi, d_dstpi, r_dkst,
+    d_dkst, k_dkst, r_dkpipi, d_dkpipi, k_dkpipi, r_dpipipi, d_dpipipi, k_dpipipi, F_kkpipi, PhiM12, PhiG12,
+    phipphig12, phimphig12, AD, adKK, adpipi, qopm1, qop, phi, phi12, delta, x, y, M12, G12, ImM12, r_dkstz, d_dkstz,
+    k_dkstz, l_dmpi, d_dmpi, beta, phid, r_dkstzs, d_dkstzs, k_dkstzs, l_dsk, d_dsk, phis, beta_s, l_dskpipi,
+    d_dskpipi, k_dskpipi, DYKKmDYpipi, tavepitaggedOverTauD, tavemutaggedOverTauD, DeltatmutaggedOverTauD,
+    DeltatpitaggedOverTauD, tKKCDp, tKKCDs, tauKK_DAcp_Run1_sl, taupipi_DAcp_Run1_sl, tauKK_Acp_Run1_sl,
+    tauKK_DAcp_Run1_pi, taupipi_DAcp_Run1_pi, tauKK_Acp_Run1_pi, tauKK_Acp_CDF, taupipi_Acp_CDF, l_dstarmpi,
+    d_dstarmpi, l_dmrho, d_dmrho, N
+  };
+}
+
+template <class T>
+class MixingContextT {
+public:
+
+  typedef PhaseT<T> Phase;
+  typedef BDRatesT<T> BDRates;
+
+  // Constructor: the measurements are owned by the MixingModel
+  MixingContextT(int combination, const MeasurementRegistry<dato>& m, const MeasurementRegistry<CorrelatedGaussianObservables>& cm);
+
+  void SetParameters(const std::vector<T> &parameters); // Copy the parameters and compute the auxiliary ones
+  T LogLikelihood(); // Log likelihood at the point given to SetParameters
+  double GetObservable(unsigned id) const; // Value of the observable Obs::Id at the point given to SetParameters
+  void FillObservables(const vector<unsigned>& ids, vector<double>& values) const; // values[i] = GetObservable(ids[i])
+
+  static int FindObservable(const string& name); // Handle of the observable with this name, -1 if unknown
+  static const char* ObservableParameter(unsigned id); // Parameter needed by the observable, "" if always available
+  static bool IsParameter(const string& name); // Whether name is a parameter of some combination
+
+  int comb; // combination variable
+
+  // Blocks of the likelihood, i.e. the Calculate_* functions. The predictions of each block are kept between calls and
+  // recomputed only if one of the parameters it depends on has changed; the chi2 of all of them is then one pass.
+  enum Block { ChargedB, NeutralBd, NeutralBs, TimeDependentD, Other, Old, NBlocks };
+  vector<int> blocks; // blocks of this combination, in order of evaluation
+  // The two maps below are set by MixingModel::SetDependencies from the declarations of the blocks (MixingModel::DeclareBlock)
+  vector<unsigned> pardeps; // bit b of pardeps[i] is set if the block b depends on the parameter i; if empty every block depends on everything
+  unsigned reads[NBlocks]; // bit a of reads[b] is set if the block b uses predictions computed by the block a
+  unsigned dirty; // bit b is set if the block b must be recomputed
+  void Invalidate() { dirty = ~0u; } // recompute every block at the next call
+  bool validate; // if true every call also checks the result against a full recomputation
+  void CalculatePredictions(int b); // Compute the predictions of the block b
+  T BlockLogWeight(int b); // -chi2/2 of the measurements of the block b, at the predictions last computed
+
+  const MeasurementRegistry<dato>& meas;
+  const MeasurementRegistry<CorrelatedGaussianObservables>& corrmeas;
+
+  //PARAMETERS
+
+  //Combination parameters
+  T g, x12, y12, r_dk, r_dpi, rD_kpi, d_dk, d_dpi, dD_kpi, //9
+  rD_k3pi, dD_k3pi, kD_k3pi, F_pipipipi, //4
+  rD_kpipi0, dD_kpipi0, kD_kpipi0, F_pipipi0, F_kkpi0, //5
+  rD_kskpi, dD_kskpi, kD_kskpi, RBRdkdpi, //4
+  r_dstk, d_dstk, r_dstpi, d_dstpi, //4
+  r_dkst, d_dkst, k_dkst, //3
+  r_dkstz, d_dkstz, k_dkstz, //3
+  r_dkpipi, d_dkpipi, k_dkpipi, r_dpipipi, d_dpipipi, k_dpipipi, //6
+  l_dsk, d_dsk, phis, //3
+  l_dskpipi, d_dskpipi, k_dskpipi, //3
+  l_dmpi, d_dmpi, beta, phi_d, // 3
+  PhiM12, PhiG12, AD, adKK, adpipi, DYKKmDYpipi, tavepitaggedOverTauD, tavemutaggedOverTauD, DeltatmutaggedOverTauD, DeltatpitaggedOverTauD, tKKCDp, tKKCDs, //12
+  //59 total parameters
+  F_kkpipi, //airXiv 20301.10328
+  // 2401.17934 Bs
+  r_dkstzs, d_dkstzs, k_dkstzs, //3
+  tauKK_DAcp_Run1_sl, taupipi_DAcp_Run1_sl, tauKK_Acp_Run1_sl,
+  tauKK_DAcp_Run1_pi, taupipi_DAcp_Run1_pi, tauKK_Acp_Run1_pi,
+  tauKK_Acp_CDF, taupipi_Acp_CDF;
+
+  //old parameter
+  T Rd, Rdkp, d; // rdkpi^2
+
+  //auxiliary parameters
+  T x,y, phi12, qop, phi; // other parametrization of the mixing parameters
+
+  //OBSERVABLES
+  //Combination Observables
+  T  acp_dk_uid0, acp_dpi_uid0, afav_dk_uid0, rcp_uid0, rm_dk_uid0, rm_dpi_uid0, rp_dk_uid0, rp_dpi_uid0, //UID0
+  rp_dk_211210617, rm_dk_211210617, acp_dk_kkpi0_211210617, acp_dk_pipipi0_211210617, acp_dpi_kkpi0_211210617, acp_dpi_pipipi0_211210617, afav_dk_kpipi0_211210617, rp_dpi_211210617, rm_dpi_211210617, rcp_kkpi0_211210617, rcp_pipipi0_211210617, //2112.10617
+  xm_dk_uid3, ym_dk_uid3, xp_dk_uid3, yp_dk_uid3, xi_x_dpi_uid3, xi_y_dpi_uid3, //UID3
+  afav_dpi_kskpi_uid4, asup_dpi_kskpi_uid4, afav_dk_kskpi_uid4, asup_dk_kskpi_uid4, rfavsup_dpi_kskpi_uid4, rfav_dkdpi_kskpi_uid4, rsup_dkdpi_kskpi_uid4, //UID4
+  acp_dstk_dg_uid5, acp_dstk_dp_uid5, afav_dstk_dg_uid5, afav_dstk_dp_uid5, rcp_dg_uid5, rcp_dp_uid5, rm_dstk_dg_uid5, rm_dstk_dp_uid5,  rp_dstk_dg_uid5, rp_dstk_dp_uid5, acp_dstpi_dg_uid5, acp_dstpi_dp_uid5,
+  rm_dstpi_dg_uid5, rm_dstpi_dp_uid5, rp_dstpi_dg_uid5, rp_dstpi_dp_uid5, afav_dstpi_dg_uid5, afav_dstpi_dp_uid5, //UID5
+  afav_dkst_kpi, acp_dkst_kk, acp_dkst_pipi, rcp_dkst_kk, rcp_dkst_pipi, rp_dkst_kpi_uid6, rm_dkst_kpi_uid6, afav_dkst_k3pi,
+  acp_dkst_pipipipi, rcp_dkst_pipipipi, rp_dkst_k3pi_uid6, rm_dkst_k3pi_uid6, //UID6
+  asup_dkst_kpi, asup_dkst_k3pi, rsup_dkst_kpi, rsup_dkst_k3pi, //LHCb-PAPER-2024-023
+  acp_dkstz_kk_uid7, acp_dkstz_pipi_uid7, rcp_dkstz_kk_uid7, rcp_dkstz_pipi_uid7, acp_dkstz_4pi_uid7, rcp_dkstz_4pi_uid7, rp_dkstz_kpi_uid7,
+  rm_dkstz_kpi_uid7, rp_dkstz_k3pi_uid7, rm_dkstz_k3pi_uid7, afav_dkstz_kpi_uid7, afav_dkstz_k3pi_uid7, //UID7
+  xm_dkstz_uid8, ym_dkstz_uid8, xp_dkstz_uid8, yp_dkstz_uid8, //UID8
+  xm_dkstz_230905514, ym_dkstz_230905514, xp_dkstz_230905514, yp_dkstz_230905514, //230905514
+  rcp_dkpipi_uid9, afav_dkpipi_kpi_uid9, afav_dpipipi_kpi_uid9, acp_dkpipi_kk_uid9, acp_dkpipi_pipi_uid9, acp_dpipipi_kk_uid9,
+  acp_dpipipi_pipi_uid9, rp_dkpipi_uid9, rm_dkpipi_uid9, rp_dpipipi_uid9, rm_dpipipi_uid9, //UID9
+  c_dsk_uid10, d_dsk_uid10, db_dsk_uid10, s_dsk_uid10, sb_dsk_uid10, //UID10
+  c_dskpipi_uid11, d_dskpipi_uid11, db_dskpipi_uid11, s_dskpipi_uid11, sb_dskpipi_uid11, //UID11
+  s_dmpi_uid12, sb_dmpi_uid12, //UID12
+  x_uid13, y_uid13, //UID13
+  xcp_uid14, ycp_uid14, dx_uid14, dy_uid14, //UID14
+  xcp_uid15, ycp_uid15, dx_uid15, dy_uid15, //UID15
+  Rdp_uid16, yp_uid16, xpsq_uid16, Rdm_uid16, ym_uid16, xmsq_uid16, //UID16
+  dtotau_uid17, dacp_uid17, //UID17
+  k3pi_uid18, //UID18
+  kD_k3pi_uid19, dD_k3pi_uid19, kD_kpipi0_uid19, dD_kpipi0_uid19, rD_k3pi_uid19, rD_kpipi0_uid19, //UID19
+  F_pipipipi_uid20, //UID20
+  F_pipipi0_uid21, F_kkpi0_uid21, //UID21
+  RD_kskpi_uid22, //UID22
+  RD_kskpi_uid23, dD_kskpi_uid23, kD_kskpi_uid23, //UID23
+  k_dkst_uid24,  //UID24
+  k_dkstz_uid25, //UID25
+  phis_uid26, //UID26
+  beta_uid27, //UID27
+  ycp_uid28, //UID28
+  DY_uid29, //UID29
+  Rdp_uid30, yp_uid30, xpsq_uid30, Rdm_uid30, ym_uid30, xmsq_uid30; //UID30
+
+  T xcp, ycp, dx, dy; // D Observables CP final states
+
+  T tauD = 410.3e-15; // D mean lifetime
+
+  //old_observables
+  T rm,
+  yp_kpp_plus, xp_kpp_plus,
+  yp_kpp_minus, xp_kpp_minus,
+  xp_plus, xp_plus_sq, yp_plus,
+  xp_minus, xp_minus_sq, yp_minus;
+
+  //https://arxiv.org/abs/2208.09402 observables
+  T Akpi_BESIII, Akpi_kpipi0_BESIII,
+         xi_x_BESIII, xi_y_BESIII;
+
+  //https://arxiv.org/pdf/2208.10098.pdf
+  T F_pipipipi_BESIII;
+
+  //https://arxiv.org/abs/2301.10328
+  T acp_dk_kkpipi_230110328, acp_dpi_kkpipi_230110328, acp_dk_pipipipi_230110328, acp_dpi_pipipipi_230110328,
+         rcp_kpi_kkpipi_230110328, rcp_kpi_pipipipi_230110328;
+
+  //https://arxiv.org/pdf/2401.17934.pdf
+  //Bd observables
+  T acp_dkstz_kk_240117934Bd, acp_dkstz_pipi_240117934Bd, rcp_dkstz_kk_240117934Bd, rcp_dkstz_pipi_240117934Bd, acp_dkstz_4pi_240117934Bd, rcp_dkstz_4pi_240117934Bd, rp_dkstz_kpi_240117934Bd,
+           rm_dkstz_kpi_240117934Bd, rp_dkstz_k3pi_240117934Bd, rm_dkstz_k3pi_240117934Bd, afav_dkstz_kpi_240117934Bd, afav_dkstz_k3pi_240117934Bd;
+
+  //Bs observables
+  T acp_dkstz_kk_240117934Bs, acp_dkstz_pipi_240117934Bs, rcp_dkstz_kk_240117934Bs, rcp_dkstz_pipi_240117934Bs, acp_dkstz_4pi_240117934Bs, rcp_dkstz_4pi_240117934Bs, rp_dkstz_kpi_240117934Bs,
+            rm_dkstz_kpi_240117934Bs, rp_dkstz_k3pi_240117934Bs, rm_dkstz_k3pi_240117934Bs, afav_dkstz_kpi_240117934Bs, afav_dkstz_k3pi_240117934Bs;
+
+  // Alternative parametrization
+  T CKpi, CpKpi, DCKpi, DCpKpi;
+
+
+  // Babar beauty
+  // B0 time dependent
+  T l_dstarmpi, d_dstarmpi, l_dmrho, d_dmrho;
+
+  // Sine and cosine of the angular parameters, set by SetParameters
+  struct {
+    Phase g, phi, phi12, phis, phi_d, PhiM12, PhiG12;
+    Phase d_dk, d_dpi, dD_kpi, dD_k3pi, dD_kpipi0, dD_kskpi, d_dstk, d_dstpi, d_dkst, d_dkstz, d_dkstzs,
+    d_dkpipi, d_dpipipi, d_dsk, d_dskpipi, d_dmpi, d_dstarmpi, d_dmrho;
+    Phase d_dstk_pi, d_dstpi_pi; // d_dstk + pi, d_dstpi + pi
+  } sc;
+  void SetPhases(); // Fill sc from the current parameters
+
+  //Methods to calculate the predictions of the measurements, whose log weight is computed by gauss
+  void Calculate_ChargedB_observables();
+  void Calculate_neutralBdobservables();
+  void Calculate_neutralBsobservables();
+  void Calculate_time_dependent_Dobservables();
+  void Calculate_other_observables();
+  void Calculate_old_observables();
+
+  //General structure of the fit equations
+  // The formulas are in Kernels.h; these pass them gamma and the mixing parameters of the current point
+  BDRates Rates(const T& rB, const Phase& delta_B, const T& kB, const T& rD, const Phase& delta_D, const T& kD, const T& alpha)
+  { return ::Rates<T>(rB, delta_B, kB, rD, delta_D, kD, alpha, sc.g, x12, y12); }
+  BDRates CPRates(const T& rB, const Phase& delta_B, const T& kB, const T& F_D, const T& alpha) // D decay to a state of CP-even fraction F_D
+  { return ::CPRates<T>(rB, delta_B, kB, F_D, alpha, sc.g, x12, y12); }
+  T y_plus(const Phase& delta_D) { return ::y_plus<T>(x, y, qop, sc.phi, delta_D); }
+  T x_plus(const Phase& delta_D) { return ::x_plus<T>(x, y, qop, sc.phi, delta_D); }
+  T y_minus(const Phase& delta_D) { return ::y_minus<T>(x, y, qop, sc.phi, delta_D); }
+  T x_minus(const Phase& delta_D) { return ::x_minus<T>(x, y, qop, sc.phi, delta_D); }
+
+private:
+  vector<T> lastpars; // parameters of the last call to SetParameters
+  double d2r, r2d;
+  double tau; // Mean lifetime
+
+  // Prediction buffers of the correlated measurements, allocated once in the constructor so that
+  // evaluating the likelihood does no heap allocation. The buffer of CorrMeas::Id id starts at pred[predoffset[id]].
+  vector<T> pred;
+  vector<unsigned> predoffset;
+  T* Pred(unsigned id) { return &pred[predoffset[id]]; }
+  vector<T> spred; // predictions of the uncorrelated measurements, indexed by Meas::Id
+  BlockDiagonalGaussian gauss; // means and whitening factors of all the measurements, packed in handle order
+
+};
+// ---------------------------------------------------------
+
+typedef MixingContextT<double> MixingContext; // the context used by the fit
+typedef MixingContextT<Var> GradientContext; // the context used to differentiate the likelihood
+#ifdef LANES
+typedef MixingContextT<Lanes> BatchContext; // the context of MixingModel::LogLikelihoodBatch, one point per lane
+template <>
+Lanes MixingContextT<Lanes>::LogLikelihood(); // every block, at every call
+#endif
+
+// The measurements of each block have contiguous handles: the block b has the handles from MeasBegin[b] to
+// MeasBegin[b + 1] (not included) and likewise for CorrMeasBegin, so that its chi2 is one pass over them. The
+// Add_*_meas function of a block can only register handles in its ranges (MeasurementRegistry::SetRange).
+const char* const BlockName[MixingContext::NBlocks] = {"ChargedB", "NeutralBd", "NeutralBs", "TimeDependentD", "Other", "Old"};
+constexpr unsigned MeasBegin[MixingContext::NBlocks + 1] = {Meas::Babar_0807_2408_ACPp, Meas::arXiv_0602049_aDpi, Meas::UID26,
+                                                          Meas::arXiv_1405_2797_tKKOverTauD_DAcp, Meas::BESIII_2503_19542_BrDKpi,
+                                                          Meas::UID18, Meas::N};
+constexpr unsigned CorrMeasBegin[MixingContext::NBlocks + 1] = {CorrMeas::Babar_PRD82_072004, CorrMeas::arXiv_2401_17934Bd,
+                                                              CorrMeas::arXiv_2401_17934Bs, CorrMeas::arXiv_1405_2797_1610_09476_Acp,
+                                                              CorrMeas::UID21, CorrMeas::kpi_babar_plus, CorrMeas::N};
+// the ranges must start at the first handle, follow each other in the order of the blocks and end at the last one
+constexpr bool Contiguous(const unsigned* begin, unsigned n) { return n == 0 || (begin[0] < begin[1] && Contiguous(begin + 1, n - 1)); }
+static_assert(MeasBegin[0] == 0 && Contiguous(MeasBegin, MixingContext::NBlocks), "the Meas handles of the blocks are not contiguous");
+static_assert(CorrMeasBegin[0] == 0 && Contiguous(CorrMeasBegin, MixingContext::NBlocks), "the CorrMeas handles of the blocks are not contiguous");
+
+#endif
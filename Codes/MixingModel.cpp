@@ -1,24 +1,42 @@
 #include "MixingModel.h"
+#include "NUTSSampler.h"
+#include "TemperingSampler.h"
+#include "Checkpoint.h"
 
+#include <BAT/BCLog.h>
 #include <BAT/BCMath.h>
 #include <BAT/BCGaussianPrior.h>
 
 #include <TRandom3.h>
+#include <TFile.h>
+#include <TString.h>
+#include <algorithm>
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace std;
 
 // ---------------------------------------------------------
 
-MixingModel::MixingModel(std::vector<string> nParam, int combination) : BCModel(), histos(obs)
+MixingModel::MixingModel(std::vector<string> nParam, int combination) : BCModel(), meas(Meas::N), corrmeas(CorrMeas::N), histos(obs),
+                                                                      monitor(0), rhattarget(0.), esstarget(0.), maxtime(0.),
+                                                                      checkinterval(0), monitorvariables(false), checkpointinterval(0),
+                                                                      resume(false), store(0), storethin(0), allpairs(true),
+                                                                      histbudget(4096.), booked(false), autobins(false)
 {
 
   //------------------------------------------ Setting the auxiliary variables --------------------------------------------------------------------------
 
-  TH1::SetDefaultBufferSize(1000000);
   comb = combination; // set the combination type
-  r2d = 180. / M_PI;  // to go form radiants to degrees
   d2r = M_PI / 180.;  // degrees to radiants
-  tau = 4.1e-1;       // ps D lifetime
   nVarab = nParam;    // copy the names of the variables of interest to print the histograms
+  for (int b = 0; b < MixingContext::NBlocks; b++)
+    blockdecl[b].declared = false;
 
   //------------------------------------------ Inserting the measurements --------------------------------------------------------------------------
 
@@ -58,18 +76,54 @@ MixingModel::MixingModel(std::vector<string> nParam, int combination) : BCModel(
     Add_old_meas();             // old code measurements
   }
 
-  //------------------------------------------- Defining the Histograms --------------------------------------------------------------
-
-  DefineHistograms();
+  // a correlated measurement whose covariance is not positive definite keeps the chi2 given by its inverse
+  for (unsigned id = 0; id < CorrMeas::N; id++)
+    if (corrmeas.Has(id))
+    {
+      if (corrmeas[id].IsSingular())
+      {
+        cout << "The covariance matrix of the measurement " << corrmeas.Name(id) << " is singular" << endl;
+        exit(EXIT_FAILURE);
+      }
+      if (!corrmeas[id].IsPositiveDefinite())
+        BCLog::OutWarning(Form("The covariance matrix of the measurement %s is not positive definite: its chi2 is computed with an LDL^T decomposition",
+                               corrmeas.Name(id).c_str()));
+    }
 
   //------------------------------------------- Defining the parameters ---------------------------------------------------------------------------
 
   DefineParameters();
 
+  //------------------------------------------- Defining the Histograms --------------------------------------------------------------
+
+  DefineHistograms(); // after the parameters, which decide the observables available in this combination
+
+  //------------------------------------------- Creating one evaluation context per thread ---------------------------------------------------------------
+
+  int nthreads = 1;
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+  for (int i = 0; i < nthreads; i++)
+  {
+    contexts.push_back(MixingContext(comb, meas, corrmeas));
+    gradcontexts.push_back(GradientContext(comb, meas, corrmeas));
+  }
+  gradpoints.assign(nthreads, vector<Var>(GetNParameters()));
+  tapes.resize(nthreads);
+#ifdef LANES
+  for (int i = 0; i < nthreads; i++)
+    batchcontexts.push_back(BatchContext(comb, meas, corrmeas));
+  batchpoints.assign(nthreads, vector<Lanes>(GetNParameters()));
+#endif
+  SetDependencies(); // so that only the blocks affected by a change of the parameters are recomputed
+
 };
 
 // ---------------------------------------------------------
-MixingModel::~MixingModel() { // default destructor
+MixingModel::~MixingModel() {
+  delete monitor;
+  delete store;
 };
 // ---------------------------------------------------------
 
@@ -91,6 +145,12 @@ void MixingModel::Add_ChargedB_meas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2, Corr3;
 
+  // parameters of Calculate_ChargedB_observables; the neutral Bd block of comb 3 takes its UID3 predictions
+  DeclareBlock(MixingContext::ChargedB, "g x12 y12 r_dk r_dpi rD_kpi d_dk d_dpi dD_kpi rD_k3pi dD_k3pi kD_k3pi F_pipipipi rD_kpipi0 dD_kpipi0 kD_kpipi0 F_pipipi0 "
+               "F_kkpi0 rD_kskpi dD_kskpi kD_kskpi RBRdkdpi r_dstk d_dstk r_dstpi d_dstpi r_dkst d_dkst k_dkst r_dkpipi d_dkpipi "
+               "k_dkpipi r_dpipipi d_dpipipi k_dpipipi F_kkpipi",
+               "", "UID3");
+
   //-------------------------------------------------  Babar measurements  -------------------------------------------------------------------------
 
   // B -> DK, D -> KK, D -> pipi normalized to D -> Kpi
@@ -130,32 +190,32 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3,3)=1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Babar_PRD82_072004", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Babar_PRD82_072004, "Babar_PRD82_072004", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   //  https://arxiv.org/pdf/0807.2408
   // B -> DstarK
   // D -> KK, pipi + fcp-
   // 4 Observables :
-  meas.insert(pair<string, dato>("Babar_0807.2408_ACPp", dato(-0.11, 0.09, 0.01))); // ACP+
-  meas.insert(pair<string, dato>("Babar_0807.2408_ACPm", dato(0.06, 0.1, 0.02))); // ACP-
-  meas.insert(pair<string, dato>("Babar_0807.2408_RCPp", dato(1.31, 0.13, 0.03))); // RCP+
-  meas.insert(pair<string, dato>("Babar_0807.2408_RCPm", dato(1.10, 0.12, 0.04))); // RCP-
+  meas.Add(Meas::Babar_0807_2408_ACPp, "Babar_0807.2408_ACPp", dato(-0.11, 0.09, 0.01)); // ACP+
+  meas.Add(Meas::Babar_0807_2408_ACPm, "Babar_0807.2408_ACPm", dato(0.06, 0.1, 0.02)); // ACP-
+  meas.Add(Meas::Babar_0807_2408_RCPp, "Babar_0807.2408_RCPp", dato(1.31, 0.13, 0.03)); // RCP+
+  meas.Add(Meas::Babar_0807_2408_RCPm, "Babar_0807.2408_RCPm", dato(1.10, 0.12, 0.04)); // RCP-
 
 
   // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.80.092001
   // B -> DKstar
   // D -> KK, pipi, fcp-
-  meas.insert(pair<string, dato>("Babar_PRD80_092001_ACPp", dato(0.09, 0.13, 0.06))); // ACP+
-  meas.insert(pair<string, dato>("Babar_PRD80_092001_ACPm", dato(-0.23, 0.21, 0.07))); // ACP-
-  meas.insert(pair<string, dato>("Babar_PRD80_092001_RCPp", dato(2.17, 0.35, 0.09))); // RCP+
-  meas.insert(pair<string, dato>("Babar_PRD80_092001_RCPm", dato(1.03, 0.27, 0.13))); // RCP-
+  meas.Add(Meas::Babar_PRD80_092001_ACPp, "Babar_PRD80_092001_ACPp", dato(0.09, 0.13, 0.06)); // ACP+
+  meas.Add(Meas::Babar_PRD80_092001_ACPm, "Babar_PRD80_092001_ACPm", dato(-0.23, 0.21, 0.07)); // ACP-
+  meas.Add(Meas::Babar_PRD80_092001_RCPp, "Babar_PRD80_092001_RCPp", dato(2.17, 0.35, 0.09)); // RCP+
+  meas.Add(Meas::Babar_PRD80_092001_RCPm, "Babar_PRD80_092001_RCPm", dato(1.03, 0.27, 0.13)); // RCP-
 
 
   // https://arxiv.org/pdf/hep-ex/0703037
   // B -> DK
   // GLW D -> pi+pi-pi0
-  meas.insert(pair<string, dato>("Babar_0703037", dato(-0.02, 0.15, 0.03))); // ACP
+  meas.Add(Meas::Babar_0703037, "Babar_0703037", dato(-0.02, 0.15, 0.03)); // ACP
   CorrData.clear();
   CorrData.push_back(dato(0.75, 0.11, 0.04));   // rho+
   CorrData.push_back(dato( 147 / 180. * M_PI, 23. / 180. * M_PI, 1./180 * M_PI));   // theta+
@@ -190,48 +250,48 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3,3)=1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Babar_0703037_rhotheta", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Babar_0703037_rhotheta, "Babar_0703037_rhotheta", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // https://arxiv.org/pdf/1006.4241
   // B -> DK
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDK", dato(1.1e-2, 0.5e-2, 0.2e-2))); // R_DK_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADK", dato(-0.88, 0.47, 0.14))); // A_DK_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDK, "Babar_1006.4241_RDK", dato(1.1e-2, 0.5e-2, 0.2e-2)); // R_DK_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADK, "Babar_1006.4241_ADK", dato(-0.88, 0.47, 0.14)); // A_DK_Kpi
   // B -> [Dpi0]_Dstar K
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDstarKpi0", dato(1.8e-2, 0.9e-2, 0.4e-2))); // R_[Dpi0]_DstarK_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADstarKpi0", dato(0.77, 0.35, 0.12))); // A_[Dpi0]_DstarK_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDstarKpi0, "Babar_1006.4241_RDstarKpi0", dato(1.8e-2, 0.9e-2, 0.4e-2)); // R_[Dpi0]_DstarK_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADstarKpi0, "Babar_1006.4241_ADstarKpi0", dato(0.77, 0.35, 0.12)); // A_[Dpi0]_DstarK_Kpi
   // B -> [Dg]_Dstar K
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDstarKg", dato(1.3e-2, 1.4e-2, 0.8e-2))); // R_[Dg]_DstarK_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADstarKg", dato(0.28, 0.94, 0.33))); // A_[Dg]_DstarK_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDstarKg, "Babar_1006.4241_RDstarKg", dato(1.3e-2, 1.4e-2, 0.8e-2)); // R_[Dg]_DstarK_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADstarKg, "Babar_1006.4241_ADstarKg", dato(0.28, 0.94, 0.33)); // A_[Dg]_DstarK_Kpi
   // B -> Dpi
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDpi", dato(3.3e-3, 0.6e-3, 0.4e-3))); // R_Dpi_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADpi", dato(0.03, 0.17, 0.04))); // A_Dpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDpi, "Babar_1006.4241_RDpi", dato(3.3e-3, 0.6e-3, 0.4e-3)); // R_Dpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADpi, "Babar_1006.4241_ADpi", dato(0.03, 0.17, 0.04)); // A_Dpi_Kpi
   // B -> [Dpi0]_Dstarpi
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDstarpipi0", dato(3.2e-3, 0.9e-3, 0.8e-3))); // R_[Dpi0]_Dstarpi_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADstarpipi0", dato(-0.09, 0.27, 0.05))); // A_[Dpi0]_Dstarpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDstarpipi0, "Babar_1006.4241_RDstarpipi0", dato(3.2e-3, 0.9e-3, 0.8e-3)); // R_[Dpi0]_Dstarpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADstarpipi0, "Babar_1006.4241_ADstarpipi0", dato(-0.09, 0.27, 0.05)); // A_[Dpi0]_Dstarpi_Kpi
   // B -> [Dpig]_Dstarpi
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_RDstarpig", dato(2.7e-3, 1.4e-3, 2.2e-3))); // R_[Dg]_Dstarpi_Kpi
-  meas.insert(pair<string, dato>("Babar_1006.4241_ADstarpig", dato(-0.65, 0.55, 0.22))); // A_[Dg]_Dstarpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_RDstarpig, "Babar_1006.4241_RDstarpig", dato(2.7e-3, 1.4e-3, 2.2e-3)); // R_[Dg]_Dstarpi_Kpi
+  meas.Add(Meas::Babar_1006_4241_ADstarpig, "Babar_1006.4241_ADstarpig", dato(-0.65, 0.55, 0.22)); // A_[Dg]_Dstarpi_Kpi
 
 
   // https://arxiv.org/pdf/1104.4472
   // B -> DK
   // D -> Kpipi0
-  meas.insert(pair<string, dato>("Babar_1104.4472_Rp_DK_Kpipi0", dato(4.5e-3, 11e-3, 2.5e-3))); // Rp_DK_Kpipi0
-  meas.insert(pair<string, dato>("Babar_1104.4472_Rm_DK_Kpipi0", dato(12e-3, 11e-3, 3e-3))); // Rm_DK_Kpipi0
+  meas.Add(Meas::Babar_1104_4472_Rp_DK_Kpipi0, "Babar_1104.4472_Rp_DK_Kpipi0", dato(4.5e-3, 11e-3, 2.5e-3)); // Rp_DK_Kpipi0
+  meas.Add(Meas::Babar_1104_4472_Rm_DK_Kpipi0, "Babar_1104.4472_Rm_DK_Kpipi0", dato(12e-3, 11e-3, 3e-3)); // Rm_DK_Kpipi0
 
 
   //https://arxiv.org/pdf/0909.3981
   // B -> DK
   // D -> Kpi
-  meas.insert(pair<string, dato>("Babar_0909.3981_RADS", dato(0.066, 0.031, 0.010))); // RADS_DKstar_Kpi
-  meas.insert(pair<string, dato>("Babar_0909.3981_Asup", dato(-0.34, 0.43, 0.16))); // Asup_DKstar_Kpi
+  meas.Add(Meas::Babar_0909_3981_RADS, "Babar_0909.3981_RADS", dato(0.066, 0.031, 0.010)); // RADS_DKstar_Kpi
+  meas.Add(Meas::Babar_0909_3981_Asup, "Babar_0909.3981_Asup", dato(-0.34, 0.43, 0.16)); // Asup_DKstar_Kpi
 
 
   // https://journals.aps.org/prl/pdf/10.1103/PhysRevLett.105.121801
@@ -497,7 +557,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr3(11,11)=1.;
   SymmetrizeUpperTriangularMatrix(Corr3);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Babar_PRL105.121801", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+  corrmeas.Add(CorrMeas::Babar_PRL105_121801, "Babar_PRL105.121801", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
 
   //-------------------------------------------------------------------------------------------------------------------------
 
@@ -506,18 +566,18 @@ void MixingModel::Add_ChargedB_meas()
   // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.81.031105
   // B -> DK
   // D -> KK, D-> pipi
-  meas.insert(pair<string, dato>("CDF_PRD81_031105_ACPp", dato(0.39, 0.17, 0.04))); // Acp+
-  meas.insert(pair<string, dato>("CDF_PRD81_031105_RCPp", dato(1.30, 0.24, 0.12)));  //RCP+
+  meas.Add(Meas::CDF_PRD81_031105_ACPp, "CDF_PRD81_031105_ACPp", dato(0.39, 0.17, 0.04)); // Acp+
+  meas.Add(Meas::CDF_PRD81_031105_RCPp, "CDF_PRD81_031105_RCPp", dato(1.30, 0.24, 0.12));  //RCP+
 
   // https://arxiv.org/pdf/1108.5765
   // B -> DK
   // D -> Kpi
-  meas.insert(pair<string, dato>("CDF_1108.5765_RDK", dato(22.e-3, 8.6e-3, 2.6e-3))); // R_DK_Kpi
-  meas.insert(pair<string, dato>("CDF_1108.5765_ADK", dato(-0.82, 0.44, 0.09))); // A_DK_Kpi
+  meas.Add(Meas::CDF_1108_5765_RDK, "CDF_1108.5765_RDK", dato(22.e-3, 8.6e-3, 2.6e-3)); // R_DK_Kpi
+  meas.Add(Meas::CDF_1108_5765_ADK, "CDF_1108.5765_ADK", dato(-0.82, 0.44, 0.09)); // A_DK_Kpi
   // B -> Dpi
   // D -> Kpi
-  meas.insert(pair<string, dato>("CDF_1108.5765_RDpi", dato(2.8e-3, 0.7e-3, 0.4e-3))); // R_Dpi_Kpi
-  meas.insert(pair<string, dato>("CDF_1108.5765_ADpi", dato(0.13, 0.25, 0.02))); // A_Dpi_Kpi
+  meas.Add(Meas::CDF_1108_5765_RDpi, "CDF_1108.5765_RDpi", dato(2.8e-3, 0.7e-3, 0.4e-3)); // R_Dpi_Kpi
+  meas.Add(Meas::CDF_1108_5765_ADpi, "CDF_1108.5765_ADpi", dato(0.13, 0.25, 0.02)); // A_Dpi_Kpi
 
   //-------------------------------------------------------------------------------------------------------------------------
 
@@ -616,7 +676,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(7, 7) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID0", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID0, "UID0", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GLW: D -> KKpipi, D -> 4pi
@@ -680,7 +740,7 @@ void MixingModel::Add_ChargedB_meas()
   SymmetrizeUpperTriangularMatrix(Corr2);
 
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("GLW_2301.10328", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::GLW_2301_10328, "GLW_2301.10328", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   // GLW: D -> pipipi0, KKpi0; D -> Kpipi0
   //https://arxiv.org/pdf/2112.10617
@@ -837,7 +897,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(10, 10) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2112.10617", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2112_10617, "2112.10617", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // ADS: D -> K0sKpi
@@ -915,7 +975,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(6, 6) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID4", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID4, "UID4", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GLW: D -> KK, D -> K0spi0 (Belle)
@@ -955,7 +1015,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2308.05048", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2308_05048, "2308.05048", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // ADS: D -> Kpipi0 (Belle)
@@ -995,7 +1055,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Belle_PRD88_2013", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Belle_PRD88_2013, "Belle_PRD88_2013", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // ADS: D -> Kpi (Belle)
@@ -1035,7 +1095,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Belle_PRL106_2011", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Belle_PRL106_2011, "Belle_PRL106_2011", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // K^*+- region fit: ADS: D -> K0sKpi (Belle)
@@ -1113,7 +1173,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(6, 6) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2306.02940", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2306_02940, "2306.02940", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GGSZ: D -> K3pi
@@ -1156,7 +1216,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2.ResizeTo(6, 6);
   Corr2.UnitMatrix();
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2209.03692", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2209_03692, "2209.03692", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GGSZ D -> K0spipipi0 (Belle)
@@ -1252,7 +1312,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(7, 7) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("1908.09499", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_1908_09499, "1908.09499", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GGSZ: D -> K0spipi, D -> K0sKK (Belle)
@@ -1339,7 +1399,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr3(5, 5) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr3);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2110.12125", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+  corrmeas.Add(CorrMeas::arXiv_2110_12125, "2110.12125", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
 
 
   // GGSZ: D -> K0sKK, D -> K0spipi
@@ -1401,7 +1461,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(5, 5) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("GGSZ_2301.10328", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::GGSZ_2301_10328, "GGSZ_2301.10328", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
 
@@ -1890,7 +1950,7 @@ void MixingModel::Add_ChargedB_meas()
     SymmetrizeUpperTriangularMatrix(Corr3);
 
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("GGSZ_LHCb_Cb", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+    corrmeas.Add(CorrMeas::GGSZ_LHCb_Cb, "GGSZ_LHCb_Cb", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
   } // end of if comb == 0
 
   //----------------------------------------------------------------------------------------------------------------------------------
@@ -2271,7 +2331,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(17, 17) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID5", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID5, "UID5", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GLW: D -> KK, D -> pipi, D -> K0spi0, .... (Belle)
@@ -2311,7 +2371,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Belle_PRD73_2006", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Belle_PRD73_2006, "Belle_PRD73_2006", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // GGSZ: D -> K0spipi (Belle)
@@ -2407,7 +2467,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(7, 7) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("Belle_PRD81_2010", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::Belle_PRD81_2010, "Belle_PRD81_2010", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //----------------------------------------------------------------------------------------------------------------------------------
 
@@ -2594,11 +2654,11 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(11, 11) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("LHCB-PAPER-2024-023-GLWADS", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::LHCB_PAPER_2024_023_GLWADS, "LHCB-PAPER-2024-023-GLWADS", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   // Coherence factor
   // https://arxiv.org/pdf/1709.05855
-  meas.insert(pair<string, dato>("UID24", dato(0.95, 0.06, 0.))); // k_dkst
+  meas.Add(Meas::UID24, "UID24", dato(0.95, 0.06, 0.)); // k_dkst
 
 
   // Bpm -> DK^*pm
@@ -2652,7 +2712,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr3(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr3);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("0604054", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+  corrmeas.Add(CorrMeas::arXiv_0604054, "0604054", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
 
 
   //----------------------------------------------------------------------------------------------------------------------------------
@@ -2815,7 +2875,7 @@ void MixingModel::Add_ChargedB_meas()
   Corr2(10, 10) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID9", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID9, "UID9", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //----------------------------------------------------------------------------------------------------------------------------------
 
@@ -2829,6 +2889,11 @@ void MixingModel::Add_NeutralBd_meas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2, Corr3;
 
+  // parameters of Calculate_neutralBdobservables; in comb 3 it also fits the UID3 predictions of the charged B block
+  DeclareBlock(MixingContext::NeutralBd, "g x12 y12 rD_kpi dD_kpi rD_k3pi dD_k3pi kD_k3pi F_pipipipi r_dstk d_dstk r_dstpi d_dstpi r_dkst d_dkst r_dkstz "
+               "d_dkstz k_dkstz l_dmpi d_dmpi phi_d l_dstarmpi d_dstarmpi l_dmrho d_dmrho",
+               comb == 3 ? "UID3" : "", "2401.17934Bd");
+
   //-------------------------------------- B^0 -> DKst0 -------------------------------------------------------------------------
 
   if (comb == 1)
@@ -3016,7 +3081,7 @@ void MixingModel::Add_NeutralBd_meas()
     Corr2(11, 11) = 1.;
     SymmetrizeUpperTriangularMatrix(Corr2);
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2401.17934Bd", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+    corrmeas.Add(CorrMeas::arXiv_2401_17934Bd, "2401.17934Bd", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
   }
 
   if (comb == 1)
@@ -3073,7 +3138,7 @@ void MixingModel::Add_NeutralBd_meas()
     Corr3(3, 3) = 1.;
     SymmetrizeUpperTriangularMatrix(Corr3);
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2309.05514", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+    corrmeas.Add(CorrMeas::arXiv_2309_05514, "2309.05514", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
   }
   else if (comb == 3)
   {
@@ -3692,7 +3757,7 @@ void MixingModel::Add_NeutralBd_meas()
     Corr3(25, 25) = 1.;
     SymmetrizeUpperTriangularMatrix(Corr3);
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("DKst0Pcomb", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+    corrmeas.Add(CorrMeas::DKst0Pcomb, "DKst0Pcomb", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
   }
 
   //----------------------------------------------------------------------------------------------------------------------------------
@@ -3748,7 +3813,7 @@ void MixingModel::Add_NeutralBd_meas()
   Corr3(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr3);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("1509.01098", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3)));
+  corrmeas.Add(CorrMeas::arXiv_1509_01098, "1509.01098", CorrelatedGaussianObservables(CorrData, Corr, Corr2, Corr3));
 
 
 
@@ -3775,7 +3840,7 @@ void MixingModel::Add_NeutralBd_meas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID12", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID12, "UID12", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //----------------------------------------------------------------------------------------------------------------------------------
 
@@ -3784,17 +3849,17 @@ void MixingModel::Add_NeutralBd_meas()
 
    // https://arxiv.org/pdf/hep-ex/0602049
    // B^0 -> D-pi+, B0 -> D^*(Full rec.)pi, B0 -> Drho
-   meas.insert(pair<string, dato>("0602049_aDpi", dato(-0.01, 0.023, 0.007))); // a_Dpi
-   meas.insert(pair<string, dato>("0602049_cDpi", dato(-0.033, 0.042, 0.012))); // c_Dpi (lep)
-   meas.insert(pair<string, dato>("0602049_aDstarpi", dato(-0.04, 0.023, 0.01))); // a_Dstarpi
-   meas.insert(pair<string, dato>("0602049_cDstarpi", dato(0.049, 0.042, 0.015))); // c_Dstarpi (lep)
-   meas.insert(pair<string, dato>("0602049_aDrho", dato(-0.024, 0.031, 0.009))); // a_Drho
-   meas.insert(pair<string, dato>("0602049_cDrho", dato(-0.098, 0.055, 0.018))); // c_Drho (lep)
+   meas.Add(Meas::arXiv_0602049_aDpi, "0602049_aDpi", dato(-0.01, 0.023, 0.007)); // a_Dpi
+   meas.Add(Meas::arXiv_0602049_cDpi, "0602049_cDpi", dato(-0.033, 0.042, 0.012)); // c_Dpi (lep)
+   meas.Add(Meas::arXiv_0602049_aDstarpi, "0602049_aDstarpi", dato(-0.04, 0.023, 0.01)); // a_Dstarpi
+   meas.Add(Meas::arXiv_0602049_cDstarpi, "0602049_cDstarpi", dato(0.049, 0.042, 0.015)); // c_Dstarpi (lep)
+   meas.Add(Meas::arXiv_0602049_aDrho, "0602049_aDrho", dato(-0.024, 0.031, 0.009)); // a_Drho
+   meas.Add(Meas::arXiv_0602049_cDrho, "0602049_cDrho", dato(-0.098, 0.055, 0.018)); // c_Drho (lep)
 
    // https://arxiv.org/pdf/hep-ex/0504035
    // B^0 -> Dstar-pi+ (Partial rec.)
-   meas.insert(pair<string, dato>("0504035_aDstarpi", dato(-0.034, 0.014, 0.009))); // a_Dstarpi
-   meas.insert(pair<string, dato>("0504035_cDstarpi", dato(-0.019, 0.022, 0.013))); // c_Dstarpi (lep)
+   meas.Add(Meas::arXiv_0504035_aDstarpi, "0504035_aDstarpi", dato(-0.034, 0.014, 0.009)); // a_Dstarpi
+   meas.Add(Meas::arXiv_0504035_cDstarpi, "0504035_cDstarpi", dato(-0.019, 0.022, 0.013)); // c_Dstarpi (lep)
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -3804,15 +3869,15 @@ void MixingModel::Add_NeutralBd_meas()
 
   // https://arxiv.org/pdf/hep-ex/0604013 (HFLAV conversion)
   // B^0 -> D-pi+, B0 -> D^*(Full rec.)pi
-  meas.insert(pair<string, dato>("0604013_aDpi", dato(-0.050, 0.021, 0.012))); // a_Dpi
-  meas.insert(pair<string, dato>("0604013_cDpi", dato(0.019, 0.021, 0.012))); // c_Dpi (lep)
-  meas.insert(pair<string, dato>("0604013_aDstarpi", dato(-0.039, 0.020, 0.013))); // a_Dstarpi
-  meas.insert(pair<string, dato>("0604013_cDstarpi", dato(-0.011, 0.02, 0.013))); // c_Dstarpi (lep)
+  meas.Add(Meas::arXiv_0604013_aDpi, "0604013_aDpi", dato(-0.050, 0.021, 0.012)); // a_Dpi
+  meas.Add(Meas::arXiv_0604013_cDpi, "0604013_cDpi", dato(0.019, 0.021, 0.012)); // c_Dpi (lep)
+  meas.Add(Meas::arXiv_0604013_aDstarpi, "0604013_aDstarpi", dato(-0.039, 0.020, 0.013)); // a_Dstarpi
+  meas.Add(Meas::arXiv_0604013_cDstarpi, "0604013_cDstarpi", dato(-0.011, 0.02, 0.013)); // c_Dstarpi (lep)
 
   // https://arxiv.org/pdf/1102.0888
   // B^0 -> Dstar-pi+ (Partial rec.)
-  meas.insert(pair<string, dato>("11020888_aDstarpi", dato(-0.046, 0.011, 0.015))); // a_Dstarpi
-  meas.insert(pair<string, dato>("11020888_cDstarpi", dato(-0.015, 0.011, 0.015))); // c_Dstarpi (lep)
+  meas.Add(Meas::arXiv_11020888_aDstarpi, "11020888_aDstarpi", dato(-0.046, 0.011, 0.015)); // a_Dstarpi
+  meas.Add(Meas::arXiv_11020888_cDstarpi, "11020888_cDstarpi", dato(-0.015, 0.011, 0.015)); // c_Dstarpi (lep)
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -3825,12 +3890,12 @@ void MixingModel::Add_NeutralBd_meas()
   // kB_Dkstz
   // https://arxiv.org/pdf/1602.03455
   // Observables 1:
-  meas.insert(pair<string, dato>("UID25", dato(0.934, 0.0075, 0.024))); // k_dkstz
+  meas.Add(Meas::UID25, "UID25", dato(0.934, 0.0075, 0.024)); // k_dkstz
 
   // sin(2beta)
   // https://indico.cern.ch/event/1291157/contributions/5903548/attachments/2900988/5087304/bona-utfit.pdf
   // Observables 1:
-  meas.insert(pair<string, dato>("UID27", dato(0.699, 0.015, 0.))); // sin(phi_d=2beta)
+  meas.Add(Meas::UID27, "UID27", dato(0.699, 0.015, 0.)); // sin(phi_d=2beta)
 
   //----------------------------------------------------------------------------------------------------------------------------------
 
@@ -3844,6 +3909,11 @@ void MixingModel::Add_NeutralBs_meas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2;
 
+  // parameters of Calculate_neutralBsobservables; in comb 3 it also fits the 2401.17934 predictions of the Bd block
+  DeclareBlock(MixingContext::NeutralBs, "g x12 y12 rD_kpi dD_kpi rD_k3pi dD_k3pi kD_k3pi F_pipipipi r_dkstzs d_dkstzs k_dkstzs l_dsk d_dsk phis l_dskpipi "
+               "d_dskpipi k_dskpipi",
+               comb == 3 ? "2401.17934Bd" : "");
+
   //-------------------------------------- Bs^0 -> DKst0bar -------------------------------------------------------------------------
 
   if (comb == 2)
@@ -4030,7 +4100,7 @@ void MixingModel::Add_NeutralBs_meas()
     Corr2(11, 11) = 1.;
     SymmetrizeUpperTriangularMatrix(Corr2);
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2401.17934Bs", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+    corrmeas.Add(CorrMeas::arXiv_2401_17934Bs, "2401.17934Bs", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   }
   else if (comb == 3)
@@ -4704,7 +4774,7 @@ void MixingModel::Add_NeutralBs_meas()
     Corr2(23, 23) = 1.;
     SymmetrizeUpperTriangularMatrix(Corr2);
 
-    corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2401.17934", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+    corrmeas.Add(CorrMeas::arXiv_2401_17934, "2401.17934", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   }
 
@@ -4760,7 +4830,7 @@ void MixingModel::Add_NeutralBs_meas()
   Corr2(4, 4) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("BSDSKRun1", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::BSDSKRun1, "BSDSKRun1", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // Time dependent B0s, Ds -> KKpi, pipipi, LHCb Run 1 full
@@ -4811,7 +4881,7 @@ void MixingModel::Add_NeutralBs_meas()
   Corr2(4, 4) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("BSDSKRun2", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::BSDSKRun2, "BSDSKRun2", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -4865,7 +4935,7 @@ void MixingModel::Add_NeutralBs_meas()
   Corr2(4, 4) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID11", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID11, "UID11", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -4874,11 +4944,11 @@ void MixingModel::Add_NeutralBs_meas()
   // phis
   // https://hflav-eos.web.cern.ch/hflav-eos/osc/HFLAV_2024/
   // Observables 1:
-    meas.insert(pair<string, dato>("UID26", dato(-0.060, 0.014, 0.))); // phis = - 2 beta_s J/psi-phi only
+    meas.Add(Meas::UID26, "UID26", dato(-0.060, 0.014, 0.)); // phis = - 2 beta_s J/psi-phi only
   // phis
   // https://arxiv.org/pdf/2308.01468
   // Observables 1:
-  // meas.insert(pair<string, dato>("UID26", dato(-0.031, 0.018, 0.))); // phis = - 2 beta_s
+  // meas.Add(Meas::UID26, "UID26", dato(-0.031, 0.018, 0.)); // phis = - 2 beta_s
 
 }
 // ---------------------------------------------------------
@@ -4890,14 +4960,19 @@ void MixingModel::Add_time_dependent_Dmeas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2, Corr3;
 
+  // parameters of Calculate_time_dependent_Dobservables
+  DeclareBlock(MixingContext::TimeDependentD, "x12 y12 PhiM12 PhiG12 rD_kpi dD_kpi F_pipipi0 adKK adpipi DYKKmDYpipi tavepitaggedOverTauD tavemutaggedOverTauD "
+               "DeltatmutaggedOverTauD DeltatpitaggedOverTauD tKKCDp tKKCDs tauKK_DAcp_Run1_sl taupipi_DAcp_Run1_sl tauKK_Acp_Run1_sl "
+               "tauKK_DAcp_Run1_pi taupipi_DAcp_Run1_pi tauKK_Acp_Run1_pi tauKK_Acp_CDF taupipi_Acp_CDF");
+
   //-------------------------------------- D -> hh  -------------------------------------------------------------------------
 
   // Delta ACP; Acp(KK); Run1 semileptonic tagging
   // https://arxiv.org/pdf/1405.2797
   // Observables 4:
-  meas.insert(pair<string, dato>("1405.2797_tKKOverTauD_DAcp", dato(1.082, 0.001, 0.004))); // tKK/tau_D DAcp
-  meas.insert(pair<string, dato>("1405.2797_tpipiOverTauD_DAcp", dato(1.068, 0.001, 0.004))); // tpipi/tau_D DAcp
-  meas.insert(pair<string, dato>("1405.2797_tKKOverTauD_Acp", dato(1.051, 0.001, 0.004))); // tKK/tau_D Acp
+  meas.Add(Meas::arXiv_1405_2797_tKKOverTauD_DAcp, "1405.2797_tKKOverTauD_DAcp", dato(1.082, 0.001, 0.004)); // tKK/tau_D DAcp
+  meas.Add(Meas::arXiv_1405_2797_tpipiOverTauD_DAcp, "1405.2797_tpipiOverTauD_DAcp", dato(1.068, 0.001, 0.004)); // tpipi/tau_D DAcp
+  meas.Add(Meas::arXiv_1405_2797_tKKOverTauD_Acp, "1405.2797_tKKOverTauD_Acp", dato(1.051, 0.001, 0.004)); // tKK/tau_D Acp
   CorrData.clear();
   CorrData.push_back(dato(14e-4, 16e-4, 8e-4)); // Delta Acp
   CorrData.push_back(dato(-6e-4, 15e-4, 10e-4)); // Acp KK
@@ -4924,31 +4999,31 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("1405.2797_1610.09476_Acp", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_1405_2797_1610_09476_Acp, "1405.2797_1610.09476_Acp", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // tOverTauD; Run1 Hadronic tagging;
   // https://arxiv.org/pdf/1610.09476
   // Observables 1:
-  meas.insert(pair<string, dato>("1610.09476_tKKOverTauD", dato(2.2390, 0.0007, 0.0187))); // tKK/tau_D
+  meas.Add(Meas::arXiv_1610_09476_tKKOverTauD, "1610.09476_tKKOverTauD", dato(2.2390, 0.0007, 0.0187)); // tKK/tau_D
 
 
   // Delta ACP; Run1 Hadronic tagging
   // https://arxiv.org/pdf/1602.03160
   // Observables 3:
-  meas.insert(pair<string, dato>("1602.03160_DeltaACPpitagged", dato(-0.0010, 0.0008, 0.0003))); // DeltaACPpitagged
-  meas.insert(pair<string, dato>("1602.03160_tKKOverTauD", dato(2.1524, 0.0005, 0.0162))); // tKKpitaggedOverTauD
-  meas.insert(pair<string, dato>("1602.03160_tpipiOverTauD",dato(2.0371, 0.0005, 0.0151))); // tpipipitaggedOverTauD
+  meas.Add(Meas::arXiv_1602_03160_DeltaACPpitagged, "1602.03160_DeltaACPpitagged", dato(-0.0010, 0.0008, 0.0003)); // DeltaACPpitagged
+  meas.Add(Meas::arXiv_1602_03160_tKKOverTauD, "1602.03160_tKKOverTauD", dato(2.1524, 0.0005, 0.0162)); // tKKpitaggedOverTauD
+  meas.Add(Meas::arXiv_1602_03160_tpipiOverTauD, "1602.03160_tpipiOverTauD", dato(2.0371, 0.0005, 0.0151)); // tpipipitaggedOverTauD
 
 
   // Delta ACP; Run2 Hadronic and Semileptonic tagging
   // https://arxiv.org/pdf/1903.08726
   // Observables 6:
-  meas.insert(pair<string, dato>("DeltaACPpitagged", dato(-0.00182, 0.00032, 0.00009))); // DeltaACPpitagged
-  meas.insert(pair<string, dato>("DeltaACPmutagged", dato(-0.0009, 0.0008, 0.0005))); // DeltaACPmutagged
-  meas.insert(pair<string, dato>("tavepitaggedOverTauD", dato(1.74, 0.1, 0.))); // tpitaggedOverTauD
-  meas.insert(pair<string, dato>("tavemutaggedOverTauD", dato(1.21, 0.01, 0.))); // tmutaggedOverTauD
-  meas.insert(pair<string, dato>("DeltatmutaggedOverTauD",dato(-0.003, 0.001, 0.))); // DeltatmutaggedOverTauD
+  meas.Add(Meas::DeltaACPpitagged, "DeltaACPpitagged", dato(-0.00182, 0.00032, 0.00009)); // DeltaACPpitagged
+  meas.Add(Meas::DeltaACPmutagged, "DeltaACPmutagged", dato(-0.0009, 0.0008, 0.0005)); // DeltaACPmutagged
+  meas.Add(Meas::tavepitaggedOverTauD, "tavepitaggedOverTauD", dato(1.74, 0.1, 0.)); // tpitaggedOverTauD
+  meas.Add(Meas::tavemutaggedOverTauD, "tavemutaggedOverTauD", dato(1.21, 0.01, 0.)); // tmutaggedOverTauD
+  meas.Add(Meas::DeltatmutaggedOverTauD, "DeltatmutaggedOverTauD", dato(-0.003, 0.001, 0.)); // DeltatmutaggedOverTauD
   // tOverTauD; Run 2 Acp(KK); Correlated through reconstructed mean decay times
   // https://arxiv.org/pdf/2209.03179
   // Observables 2:
@@ -4971,7 +5046,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2.ResizeTo(3, 3);
   Corr2.UnitMatrix();
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("tausforDACP", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::tausforDACP, "tausforDACP", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // Run 2 Acp(KK)
@@ -4993,59 +5068,59 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("ACPKK", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::ACPKK, "ACPKK", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // yCP - yCP(Kpi)
   // HFLAV combo: https://hflav-eos.web.cern.ch/hflav-eos/charm/CKM23/results_mixing.html#kkpipi including latest https://arxiv.org/abs/2202.09106
-  meas.insert(pair<string, dato>("UID28", dato(0.00697, 0.00028, 0.))); // ytilde_cp
+  meas.Add(Meas::UID28, "UID28", dato(0.00697, 0.00028, 0.)); // ytilde_cp
 
 
   // ( DY(KK) + DY(pipi) )/2 LHCb combo Run1 + Run2
   // https://arxiv.org/pdf/2105.09889
   // Observables 1:
-  meas.insert(pair<string, dato>("UID29", dato(-0.00019, 0.00013, 0.00004))); // DY // Average of KK and pipi
+  meas.Add(Meas::UID29, "UID29", dato(-0.00019, 0.00013, 0.00004)); // DY // Average of KK and pipi
 
 
   // ( DY(KK) - DY(pipi) ) LHCb combo Run1 + Run2
   // https://arxiv.org/pdf/2105.09889
   // Observables 1:
-  meas.insert(pair<string, dato>("DYKKmDYpipi", dato(3.3e-4, 2.7e-4, 0.2e-4))); // DYKKmDYpipi
+  meas.Add(Meas::DYKKmDYpipi, "DYKKmDYpipi", dato(3.3e-4, 2.7e-4, 0.2e-4)); // DYKKmDYpipi
 
 
   // Agamma(KK) and Agamma(pipi) Full CDF
   // https://arxiv.org/pdf/1410.5435
   // Observables 2:
-  meas.insert(pair<string, dato>("1410.5435_AGammaKK", dato(-0.19e-2, 0.15e-2, 0.04e-2))); // AgammaKK
-  meas.insert(pair<string, dato>("1410.5435_AGammapipi", dato(-0.01e-2, 0.18e-2, 0.03e-2))); // Agammapipi
+  meas.Add(Meas::arXiv_1410_5435_AGammaKK, "1410.5435_AGammaKK", dato(-0.19e-2, 0.15e-2, 0.04e-2)); // AgammaKK
+  meas.Add(Meas::arXiv_1410_5435_AGammapipi, "1410.5435_AGammapipi", dato(-0.01e-2, 0.18e-2, 0.03e-2)); // Agammapipi
 
 
   // tOverTauD CDF
   // https://arxiv.org/pdf/1111.5023
   // Observables 2:
-  meas.insert(pair<string, dato>("1111.5023_tKKOverTauD_CDF", dato(2.65, 0.03, 0.))); // tKK/tau_D Acp
-  meas.insert(pair<string, dato>("1111.5023_tpipiOverTauD_CDF", dato(2.40, 0.03, 0.))); // tpipi/tau_D Acp
+  meas.Add(Meas::arXiv_1111_5023_tKKOverTauD_CDF, "1111.5023_tKKOverTauD_CDF", dato(2.65, 0.03, 0.)); // tKK/tau_D Acp
+  meas.Add(Meas::arXiv_1111_5023_tpipiOverTauD_CDF, "1111.5023_tpipiOverTauD_CDF", dato(2.40, 0.03, 0.)); // tpipi/tau_D Acp
 
 
   // Acp(KK), Acp(pipi)
   // https://arxiv.org/pdf/1208.2517
   // Observables 2
-  meas.insert(pair<string, dato>("1208.2517_AcpKK_CDF", dato(-0.32e-2, 0.21e-2, 0.))); // Acp(KK)
-  meas.insert(pair<string, dato>("1208.2517_Acppipi_CDF", dato(0.31e-2, 0.22e-2, 0.))); // Acp(pipi)
+  meas.Add(Meas::arXiv_1208_2517_AcpKK_CDF, "1208.2517_AcpKK_CDF", dato(-0.32e-2, 0.21e-2, 0.)); // Acp(KK)
+  meas.Add(Meas::arXiv_1208_2517_Acppipi_CDF, "1208.2517_Acppipi_CDF", dato(0.31e-2, 0.22e-2, 0.)); // Acp(pipi)
 
 
   // Acp(KK), Acp(pipi) Babar
   // https://arxiv.org/pdf/0709.2715
   // Observables 2
-  meas.insert(pair<string, dato>("0709.2715_AcpKK_Babar", dato(0., 0.34e-2, 0.13e-2))); // Acp(KK)
-  meas.insert(pair<string, dato>("0709.2715_Acppipi_Babar", dato(-0.24e-2, 0.52e-2, 0.22e-2))); // Acp(pipi)
+  meas.Add(Meas::arXiv_0709_2715_AcpKK_Babar, "0709.2715_AcpKK_Babar", dato(0., 0.34e-2, 0.13e-2)); // Acp(KK)
+  meas.Add(Meas::arXiv_0709_2715_Acppipi_Babar, "0709.2715_Acppipi_Babar", dato(-0.24e-2, 0.52e-2, 0.22e-2)); // Acp(pipi)
 
 
   // Acp(KK), Acp(pipi) Belle
   // https://arxiv.org/pdf/0807.0148
   // Observables 2
-  meas.insert(pair<string, dato>("0807.0148_AcpKK_Belle", dato(-0.43e-2, 0.30e-2, 0.11e-2))); // Acp(KK)
-  meas.insert(pair<string, dato>("0807.0148_Acppipi_Belle", dato(0.43e-2, 0.52e-2, 0.12e-2))); // Acp(pipi)
+  meas.Add(Meas::arXiv_0807_0148_AcpKK_Belle, "0807.0148_AcpKK_Belle", dato(-0.43e-2, 0.30e-2, 0.11e-2)); // Acp(KK)
+  meas.Add(Meas::arXiv_0807_0148_Acppipi_Belle, "0807.0148_Acppipi_Belle", dato(0.43e-2, 0.52e-2, 0.12e-2)); // Acp(pipi)
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -5088,7 +5163,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr(5, 5) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID30", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::UID30, "UID30", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // rD_kpi, c'pm_Kpi, Dc'pm_kpi; LHCb Run1+Run2, pi-tagged
@@ -5160,7 +5235,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2.ResizeTo(9, 9);
   Corr2.UnitMatrix();
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2407.18001", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2407_18001, "2407.18001", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // Asymmetries D -> Kpi   BESIII
@@ -5185,7 +5260,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("BESIII_Adk", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::BESIII_Adk, "BESIII_Adk", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   // Second measurements
   // Observables 2:
@@ -5200,7 +5275,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("BESIII_rDkpi_polar", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::BESIII_rDkpi_polar, "BESIII_rDkpi_polar", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   //-------------------------------------- D -> K0spipi -------------------------------------------------------------------------
@@ -5242,7 +5317,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID14", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID14, "UID14", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // https://arxiv.org/pdf/2208.06512.pdf
@@ -5281,7 +5356,7 @@ void MixingModel::Add_time_dependent_Dmeas()
   Corr2(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("LHCb_kspp_Au2022", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::LHCb_kspp_Au2022, "LHCb_kspp_Au2022", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5297,12 +5372,16 @@ void MixingModel::Add_other_meas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2;
 
+  // parameters of Calculate_other_observables
+  DeclareBlock(MixingContext::Other, "x12 y12 PhiM12 PhiG12 rD_kpi dD_kpi rD_k3pi dD_k3pi kD_k3pi F_pipipipi rD_kpipi0 dD_kpipi0 kD_kpipi0 F_pipipi0 F_kkpi0 "
+               "rD_kskpi dD_kskpi kD_kskpi F_kkpipi");
+
   //-------------------------------------- BESIII Branching ratios -------------------------------------------------------------------------
   // https://arxiv.org/pdf/2503.19542
   // Branching ratios DCS/CF
-  meas.insert(pair<string, dato>("BESIII_2503.19542_BrDKpi", dato(0.328, 0.027))); // D -> Kpi
-  meas.insert(pair<string, dato>("BESIII_2503.19542_BrDK3pi", dato(0.289, 0.028))); // D -> K3pi
-  meas.insert(pair<string, dato>("BESIII_2503.19542_BrDKpipi0", dato(0.212, 0.021))); // D -> Kpipi0
+  meas.Add(Meas::BESIII_2503_19542_BrDKpi, "BESIII_2503.19542_BrDKpi", dato(0.328, 0.027)); // D -> Kpi
+  meas.Add(Meas::BESIII_2503_19542_BrDK3pi, "BESIII_2503.19542_BrDK3pi", dato(0.289, 0.028)); // D -> K3pi
+  meas.Add(Meas::BESIII_2503_19542_BrDKpipi0, "BESIII_2503.19542_BrDKpipi0", dato(0.212, 0.021)); // D -> Kpipi0
 
 
 
@@ -5329,7 +5408,7 @@ void MixingModel::Add_other_meas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID21", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID21, "UID21", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // CP-even fractions BESIII
@@ -5353,26 +5432,26 @@ void MixingModel::Add_other_meas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("2409.07197_F_BESIII", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::arXiv_2409_07197_F_BESIII, "2409.07197_F_BESIII", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // CP-even fractions, Cleo-c
   // https://arxiv.org/pdf/1504.05878
   // Observables 2:
   // Observables 1:
-  meas.insert(pair<string, dato>("UID20", dato(0.737, 0.028, 0.0))); // Fpipipipi
+  meas.Add(Meas::UID20, "UID20", dato(0.737, 0.028, 0.0)); // Fpipipipi
 
 
   // CP-even fractioon 4pi, BESIII
   // https://arxiv.org/pdf/2408.16279
   // Observables 1:
-  meas.insert(pair<string, dato>("Fpipipipi_BESIII", dato(0.746, 0.010, 0.004))); // F_pipipipi
+  meas.Add(Meas::Fpipipipi_BESIII, "Fpipipipi_BESIII", dato(0.746, 0.010, 0.004)); // F_pipipipi
 
 
   // CP-even fraction, BESIII
   // https://arxiv.org/pdf/2502.12873 supersedes https://arxiv.org/pdf/2212.06489
   // Observables 1:
-  meas.insert(pair<string, dato>("FKKpipi_BESIII", dato(0.754, 0.010, 0.008))); // F_KKpipi
+  meas.Add(Meas::FKKpipi_BESIII, "FKKpipi_BESIII", dato(0.754, 0.010, 0.008)); // F_KKpipi
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -5440,7 +5519,7 @@ void MixingModel::Add_other_meas()
   Corr2(5, 5) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID19", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID19, "UID19", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5451,7 +5530,7 @@ void MixingModel::Add_other_meas()
   // Br(D0 -> K0sKpi) / Br(D0bar -> K0sKpi), restricted to K^*pm region
   // https://arxiv.org/pdf/1509.06628
   // Observables 1:
-  meas.insert(pair<string, dato>("UID22", dato(0.37, 0.003, 0.012))); // Br_kskpi
+  meas.Add(Meas::UID22, "UID22", dato(0.37, 0.003, 0.012)); // Br_kskpi
 
 
   // Rates and strong phase Cleo-c
@@ -5481,7 +5560,7 @@ void MixingModel::Add_other_meas()
   Corr2(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID23", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID23, "UID23", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -5495,6 +5574,9 @@ void MixingModel::Add_old_meas()
   vector<dato> CorrData;
   TMatrixDSym Corr, Corr2;
 
+  // parameters of Calculate_old_observables
+  DeclareBlock(MixingContext::Old, "g x12 y12 PhiM12 PhiG12 rD_kpi dD_kpi dD_kpipi0");
+
 
   //-------------------------------------- D -> Kpi -------------------------------------------------------------------------
 
@@ -5517,7 +5599,7 @@ void MixingModel::Add_old_meas()
   Corr(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpi_babar_plus", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpi_babar_plus, "kpi_babar_plus", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // AD_kpi, x'm^2, y'm Babar
@@ -5539,7 +5621,7 @@ void MixingModel::Add_old_meas()
   Corr(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpi_babar_minus", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpi_babar_minus, "kpi_babar_minus", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // rD_kpi, x'p^2, y'p Belle
@@ -5561,8 +5643,7 @@ void MixingModel::Add_old_meas()
   Corr(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpi_belle_plus",
-                                                              CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpi_belle_plus, "kpi_belle_plus", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // AD_kpi, x'm^2, y'm Belle
@@ -5582,7 +5663,7 @@ void MixingModel::Add_old_meas()
   Corr(2, 2) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpi_belle_minus", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpi_belle_minus, "kpi_belle_minus", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // rD_kpi, x^2, y, cos(d_kpi), sin(d_kpi) NO CPV
@@ -5615,7 +5696,7 @@ void MixingModel::Add_old_meas()
   Corr(4, 4) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("cleoc", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::cleoc, "cleoc", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5648,7 +5729,7 @@ void MixingModel::Add_old_meas()
   Corr(3, 3) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpp_belle", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpp_belle, "kpp_belle", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   // x, y NO CPV
@@ -5672,7 +5753,7 @@ void MixingModel::Add_old_meas()
   Corr2(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr2);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("UID13", CorrelatedGaussianObservables(CorrData, Corr, Corr2)));
+  corrmeas.Add(CorrMeas::UID13, "UID13", CorrelatedGaussianObservables(CorrData, Corr, Corr2));
 
 
   // x, y NO CPV
@@ -5690,7 +5771,7 @@ void MixingModel::Add_old_meas()
   Corr(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kppkk", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kppkk, "kppkk", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5713,7 +5794,7 @@ void MixingModel::Add_old_meas()
   Corr(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kppp0_Babar", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kppp0_Babar, "kppp0_Babar", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5734,7 +5815,7 @@ void MixingModel::Add_old_meas()
   Corr(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpp_babar_plus", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpp_babar_plus, "kpp_babar_plus", CorrelatedGaussianObservables(CorrData, Corr));
 
   // xm_kpp, ym_kpp
   // https://arxiv.org/pdf/0807.4544
@@ -5751,7 +5832,7 @@ void MixingModel::Add_old_meas()
   Corr(1, 1) = 1.;
   SymmetrizeUpperTriangularMatrix(Corr);
 
-  corrmeas.insert(pair<string, CorrelatedGaussianObservables>("kpp_babar_minus", CorrelatedGaussianObservables(CorrData, Corr)));
+  corrmeas.Add(CorrMeas::kpp_babar_minus, "kpp_babar_minus", CorrelatedGaussianObservables(CorrData, Corr));
 
 
   //---------------------------------------------------------------------------------------------------------------
@@ -5761,14 +5842,14 @@ void MixingModel::Add_old_meas()
   // x^2 + y^2 NO CPV
   // https://arxiv.org/pdf/1602.07224
   // Observables 1:
-  meas.insert(pair<string, dato>("UID18", dato(0.000048, 0.000018, 0.))); // k3pi // informations about x,y 0.25 * (x^2 + y^2)
+  meas.Add(Meas::UID18, "UID18", dato(0.000048, 0.000018, 0.)); // k3pi // informations about x,y 0.25 * (x^2 + y^2)
 
 
   //-------------------------------------- D -> Klnu_l -------------------------------------------------------------------------
 
   // (x^2 + y^2)/2
   // COMBOS average https://hflav-eos.web.cern.ch/hflav-eos/charm/CKM23/results_mixing.html#semileptonic
-  meas.insert(pair<string, dato>("RM", dato(0.013e-2, 0.0269e-2, 0.)));
+  meas.Add(Meas::RM, "RM", dato(0.013e-2, 0.0269e-2, 0.));
 
   //---------------------------------------------------------------------------------------------------------------
 
@@ -6176,2281 +6257,1008 @@ void MixingModel::DefineParameters()
 void MixingModel::DefineHistograms()
 {
 
-  //-------------------------------------- Generating 1D and 2D histograms ---------------------------------------
-  int j = 0;
-  for (int i = 0; i < nVarab.size(); i++)
-  { // looping over all the names of the variables
-    histos.createH1D(nVarab[i], 200, 1., -1.);
-    for (int j = i + 1; j < nVarab.size(); j++)
+  //-------------------------------------- Resolving the names of the variables to observable handles ---------------------------------------
+  obsid.clear();
+  for (unsigned i = 0; i < nVarab.size(); i++)
+  {
+    int id = MixingContext::FindObservable(nVarab[i]);
+    if (id < 0)
+    {
+      cout << "Unknown observable " << nVarab[i] << " in the variables file" << endl;
+      exit(EXIT_FAILURE);
+    }
+    string par = MixingContext::ObservableParameter(id);
+    bool found = par.empty();
+    for (unsigned k = 0; k < GetNParameters() && !found; k++)
+      found = (GetParameter(k).GetName() == par);
+    if (!found)
     {
-      histos.createH2D(nVarab[i], nVarab[j], 200, 1., -1., 200, 1., -1.);
+      cout << "Observable " << nVarab[i] << " is not available in combination " << comb << endl;
+      exit(EXIT_FAILURE);
     }
+    obsid.push_back(id);
   }
+  obs.assign(obsid.size(), 0.);
 }
 // ---------------------------------------------------------
 
-double MixingModel::Acp(double rB, double delta_B, double kB, double F_D, double alpha)
+void MixingModel::SetHistogramPairs(const vector<pair<string, string> >& pairs)
 {
-  return (2 * rB * kB * sin(g) * sin(delta_B) * ((2 * F_D - 1) - alpha * y12)) /
-         ((1 + rB * rB) * (1 - alpha * y12 * (2 * F_D - 1)) + 2 * rB * kB * cos(g) * cos(delta_B) * ((2 * F_D - 1) - alpha * y12));
+  allpairs = false;
+  histpairs.clear();
+  for (unsigned k = 0; k < pairs.size(); k++)
+  {
+    unsigned y = find(nVarab.begin(), nVarab.end(), pairs[k].first) - nVarab.begin();
+    unsigned x = find(nVarab.begin(), nVarab.end(), pairs[k].second) - nVarab.begin();
+    if (y == nVarab.size() || x == nVarab.size())
+    {
+      cout << "The pair " << pairs[k].first << " " << pairs[k].second << " is not made of variables of the variables file" << endl;
+      exit(EXIT_FAILURE);
+    }
+    if (find(histpairs.begin(), histpairs.end(), make_pair(y, x)) == histpairs.end())
+      histpairs.push_back(make_pair(y, x));
+  }
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Afav(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha)
+void MixingModel::SetHistogramMemory(double budget, unsigned buffer)
 {
-  return (2 * rD * rB * kD * kB * sin(g) * sin(delta_B - delta_D) - alpha * rB * kB * sin(g) * (x12 * cos(delta_B) * (1 - rD * rD) + y12 * sin(delta_B) * (1 + rD * rD))) /
-         (1 + rD * rD * rB * rB + 2 * rB * rD * kB * kD * cos(g) * cos(delta_B - delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(g) * cos(delta_B)) + alpha * x12 * (rB * kB * (1 - rD * rD) * cos(g) * sin(delta_B) - rD * kD * (1 - rB * rB) * sin(delta_D)));
+  histbudget = budget;
+  histos.buffersize = buffer;
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rcp_h(double rBCP, double delta_BCP, double rBCF, double rD, double delta_BCF, double delta_D, double kB, double kD, double F_D, double alpha)
+void MixingModel::SetHistogramBins(bool automatic)
 {
-  return ((1 + rBCP * rBCP) * (1 - (2 * F_D - 1) * alpha * y12) + 2 * kB * rBCP * cos(g) * cos(delta_BCP) * ((2 * F_D - 1) - alpha * y12)) /
-         (1 + rD * rD * rBCF * rBCF + 2 * rBCF * rD * kB * kD * cos(g) * cos(delta_BCF - delta_D) - alpha * y12 * (rD * kD * (1 + rBCF * rBCF) * cos(delta_D) + kB * rBCF * (1 + rD * rD) * cos(g) * cos(delta_BCF)) + alpha * x12 * (kB * rBCF * (1 - rD * rD) * cos(g) * sin(delta_BCF) - rD * kD * (1 - rBCF * rBCF) * sin(delta_D)));
+  autobins = automatic;
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rm(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha)
+void MixingModel::SetSparseHistograms(bool sparse)
 {
-  return (rD * rD + rB * rB + 2 * kB * kD * rB * rD * cos(delta_B - g + delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(delta_B - g)) - alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * sin(delta_B - g))) /
-         (1 + rD * rD * rB * rB + 2 * rD * rB * kD * kB * cos(delta_B - g - delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(delta_B - g)) + alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * sin(delta_B - g)));
+  histos.sparse = sparse;
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rp(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha)
+void MixingModel::BookHistograms()
 {
-  return (rD * rD + rB * rB + 2 * kB * kD * rB * rD * cos(delta_B + g + delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(delta_B + g)) - alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * sin(delta_B + g))) /
-         (1 + rD * rD * rB * rB + 2 * rD * rB * kD * kB * cos(delta_B + g - delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(delta_B + g)) + alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * sin(delta_B + g)));
-}
+  if (booked)
+    return;
+  booked = true;
+  if (allpairs)
+    for (unsigned i = 0; i < nVarab.size(); i++)
+      for (unsigned j = i + 1; j < nVarab.size(); j++)
+        histpairs.push_back(make_pair(i, j));
+
+  //-------------------------------------- Projected memory ---------------------------------------
+  int nbins = 200;
+  double h1 = nVarab.size() * histo::memory(nbins, 0, false, 0);
+  double h2 = histos.sparse ? 0. : histpairs.size() * histo::memory(nbins, nbins, false, 0); // sparse: grows with the occupied bins
+  double sample = (double)histos.samplesize * nVarab.size() * sizeof(double); // pre-run states kept for the ranges
+  double bat = 0.; // BAT's marginalized distributions, of every parameter and every pair of parameters
+  for (unsigned i = 0; i < GetNParameters(); i++)
+  {
+    bat += histo::memory(GetParameter(i).GetNbins(), 0, false, 0);
+    for (unsigned j = i + 1; j < GetNParameters(); j++)
+      bat += histo::memory(GetParameter(j).GetNbins(), GetParameter(i).GetNbins(), false, 0);
+  }
+  double MB = 1024. * 1024.;
+  double pair = histos.sparse ? 0. : histo::memory(nbins, nbins, false, 0);
+  if (h1 + h2 + sample + bat > histbudget * MB && h1 + sample + bat <= histbudget * MB && pair > 0.)
+  { // the last pairs are dropped, as many as needed to fit in the budget
+    unsigned keep = floor((histbudget * MB - h1 - sample - bat) / pair);
+    BCLog::OutWarning(Form("The histograms would take %.1f MB, more than the budget of %g MB: %u of the %u 2D histograms dropped",
+                           (h1 + h2 + sample + bat) / MB, histbudget, (unsigned)histpairs.size() - keep, (unsigned)histpairs.size()));
+    for (unsigned k = keep; k < histpairs.size(); k++)
+      BCLog::OutDetail(Form("2D histogram %s_vs_%s dropped", nVarab[histpairs[k].first].c_str(), nVarab[histpairs[k].second].c_str()));
+    histpairs.resize(keep);
+    h2 = histpairs.size() * pair;
+  }
+  string h2text = histos.sparse ? Form("%u 2D, sparse, about 50 bytes per occupied bin", (unsigned)histpairs.size())
+                                 : Form("%u 2D, %.1f MB", (unsigned)histpairs.size(), h2 / MB);
+  BCLog::OutSummary(Form("Histograms: %u 1D, %.1f MB; %s; pre-run states for their ranges %.1f MB; BAT's marginalized distributions %.1f MB; total %.1f MB of %.0f MB",
+                         (unsigned)nVarab.size(), h1 / MB, h2text.c_str(), sample / MB, bat / MB, (h1 + h2 + sample + bat) / MB,
+                         histbudget));
+  if (h1 + h2 + sample + bat > histbudget * MB)
+  {
+    cout << "The histograms would take " << (h1 + sample + bat) / MB << " MB, more than the budget of " << histbudget
+         << " MB even without 2D histograms: request fewer variables or raise the budget" << endl;
+    exit(EXIT_FAILURE);
+  }
 
+  //-------------------------------------- Generating 1D and 2D histograms ---------------------------------------
+  // their ranges are set before the main run, by SetHistogramRanges
+  for (unsigned i = 0; i < nVarab.size(); i++)
+    histos.createH1D(nVarab[i], i, nbins, 0., 1.);
+  for (unsigned k = 0; k < histpairs.size(); k++)
+  {
+    unsigned i = histpairs[k].first, j = histpairs[k].second;
+    histos.createH2D(nVarab[i], i, nVarab[j], j, nbins, 0., 1., nbins, 0., 1.);
+  }
+}
 // ---------------------------------------------------------
 
-double MixingModel::Asup(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha)
+void MixingModel::SetHistogramRanges()
 {
-  return (2 * rB * rD * kB * kD * sin(g) * sin(delta_B + delta_D) - alpha * rB * kB * sin(g) * (y12 * (1 + rD * rD) * sin(delta_B) - x12 * (1 - rD * rD) * cos(delta_B))) /
-         (rB * rB + rD * rD + 2 * rB * rD * kB * kD * cos(g) * cos(delta_B + delta_D) - alpha * y12 * (rB * kB * (1 + rD * rD) * cos(g) * cos(delta_B) + rD * kD * (1 + rB * rB) * cos(delta_D)) - alpha * x12 * (rB * kB * (1 - rD * rD) * cos(g) * sin(delta_B) + rD * kD * (rB * rB - 1) * sin(delta_D)));
+  double nentries = (double)fMCMCNChains * GetNIterationsRun();
+  if (histos.setranges(0.0005, 0.1, autobins, nentries))
+  {
+    BCLog::OutDetail("Ranges of the histograms set from the pre-run");
+    return;
+  }
+  // too short a pre-run, e.g. a warm start without warmup: ranges from the first states of the main run, kept until then
+  double MB = 1024. * 1024.;
+  double buffers = (double)histos.buffersize * nVarab.size() * sizeof(double);
+  BCLog::OutSummary(Form("Too few pre-run states to set the ranges of the histograms: ranges from the first %u states, %.1f MB more",
+                         histos.buffersize, buffers / MB));
+  if (buffers > histbudget * MB)
+  {
+    cout << "The states kept for the ranges of the histograms would take " << buffers / MB << " MB, more than the budget of "
+         << histbudget << " MB: run a pre-run or buffer fewer entries" << endl;
+    exit(EXIT_FAILURE);
+  }
+  histos.autoranges(0.0005, 0.1, autobins, nentries);
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rads(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha)
+void MixingModel::AddWarmupState(unsigned ichain, const vector<double>& point)
 {
-  return (rD * rD + rB * rB + 2 * rB * rD * kB * kD * cos(g) * cos(delta_B + delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + kB * rB * (1 + rD * rD) * cos(g) * cos(delta_B)) - alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * cos(g) * sin(delta_B))) /
-         (1 + rD * rD * rB * rB + 2 * rB * rD * kB * kD * cos(g) * cos(delta_B - delta_D) - alpha * y12 * (rD * kD * (1 + rB * rB) * cos(delta_D) + rB * kB * (1 + rD * rD) * cos(g) * cos(delta_B)) + alpha * x12 * (rD * kD * (1 - rB * rB) * sin(-delta_D) + rB * kB * (1 - rD * rD) * cos(g) * sin(delta_B)));
+  if (histos.ranged)
+    return;
+  contexts[0].SetParameters(point); // called serially by the samplers
+  contexts[0].FillObservables(obsid, obs);
+  histos.collect();
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rfav(double rB1, double rB2, double rD, double delta_B1, double delta_B2, double delta_D, double BR, double kD, double alpha)
+double MixingModel::LogLikelihood(const std::vector<double> &parameters)
 {
-  return BR * ((1 + rB1 * rB1 * rD * rD + 2 * kD * rD * rB1 * cos(g) * cos(delta_B1 - delta_D) - alpha * y12 * (rD * kD * (1 + rB1 * rB1) * cos(delta_D) + rB1 * (1 + rD * rD) * cos(g) * cos(delta_B1)) + alpha * x12 * (rD * kD * (1 - rB1 * rB1) * sin(-delta_D) + rB1 * (1 - rD * rD) * cos(g) * sin(delta_B1))) /
-               (1 + rB2 * rB2 * rD * rD + 2 * kD * rD * rB2 * cos(g) * cos(delta_B2 - delta_D) - alpha * y12 * (rD * kD * (1 + rB2 * rB2) * cos(delta_D) + rB2 * (1 + rD * rD) * cos(g) * cos(delta_B2)) + alpha * x12 * (rD * kD * (1 - rB2 * rB2) * sin(-delta_D) + rB2 * (1 - rD * rD) * cos(g) * sin(delta_B2))));
+  MixingContext& c = GetContext(); // evaluation state of the calling thread
+  c.SetParameters(parameters);
+  return c.LogLikelihood();
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::Rsup(double rB1, double rB2, double rD, double delta_B1, double delta_B2, double delta_D, double BR, double kD, double alpha)
+void MixingModel::LogLikelihoodBatch(const std::vector<std::vector<double> > &points, std::vector<double> &ll)
 {
-  return BR * ((rD * rD + rB1 * rB1 + 2 * rD * kD * rB1 * cos(g) * cos(delta_B1 + delta_D) - alpha * y12 * (rD * kD * (1 + rB1 * rB1) * cos(delta_D) + rB1 * (1 + rD * rD) * cos(g) * cos(delta_B1)) - alpha * x12 * (rD * kD * (1 - rB1 * rB1) * sin(-delta_D) + rB1 * (1 - rD * rD) * cos(g) * sin(delta_B1))) /
-               (rD * rD + rB2 * rB2 + 2 * rD * kD * rB2 * cos(g) * cos(delta_B2 + delta_D) - alpha * y12 * (rD * kD * (1 + rB2 * rB2) * cos(delta_D) + rB2 * (1 + rD * rD) * cos(g) * cos(delta_B2)) - alpha * x12 * (rD * kD * (1 - rB2 * rB2) * sin(-delta_D) + rB2 * (1 - rD * rD) * cos(g) * sin(delta_B2))));
+  int npoints = points.size();
+  ll.resize(npoints);
+  int width = 1, npacks = 0; // packs of width points, the points from npacks * width on being evaluated one at a time
+#ifdef LANES
+  width = Lanes::size();
+  npacks = npoints / width;
+#endif
+  int nitems = npacks + npoints - npacks * width;
+
+  // the packs, then the remaining points, are spread over the threads, each one evaluating with its own contexts
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (!omp_in_parallel())
+#endif
+  for (int j = 0; j < nitems; j++)
+  {
+#ifdef LANES
+    if (j < npacks)
+    {
+      int t = &GetContext() - &contexts[0]; // thread number
+      BatchContext& c = batchcontexts[t];
+      vector<Lanes>& p = batchpoints[t];
+      int first = j * width;
+      for (unsigned i = 0; i < p.size(); i++)
+        p[i] = Lanes([&](auto l) { return points[first + l][i]; }); // gather the parameter i of the points of the pack
+      c.SetParameters(p);
+      Lanes v = c.LogLikelihood();
+      for (int l = 0; l < width; l++)
+        ll[first + l] = v[l];
+      continue;
+    }
+#endif
+    int k = npacks * width + j - npacks;
+    MixingContext& c = GetContext();
+    c.SetParameters(points[k]);
+    ll[k] = c.LogLikelihood();
+  }
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::y_plus(double delta_D)
+double MixingModel::LogLikelihoodGradient(const std::vector<double> &parameters, std::vector<double> &gradient)
 {
-  return qop * (sin(phi) * (x * cos(delta_D) + y * sin(delta_D)) - cos(phi) * (-x * sin(delta_D) + y * cos(delta_D)));
+  int t = &GetContext() - &contexts[0]; // thread number, checked by GetContext against the contexts and gradcontexts
+  GradientContext& c = gradcontexts[t];
+  vector<Var>& p = gradpoints[t];
+
+  // the parameters are the first nodes of the tape, so that the backward sweep leaves d ll / d parameter i in position i
+  Tape& tape = tapes[t];
+  tape.Use();
+  tape.clear();
+  for (unsigned i = 0; i < parameters.size(); i++)
+    p[i] = Var::Independent(parameters[i]);
+  c.SetParameters(p);
+  c.Invalidate(); // every block must be recorded on the tape
+  Var ll = c.LogLikelihood();
+
+  gradient.resize(parameters.size());
+  tape.gradient(ll.i, gradient);
+  return ll.v;
 }
-
 // ---------------------------------------------------------
 
-double MixingModel::y_minus(double delta_D)
+void MixingModel::MarginalizeAllNUTS(unsigned nwarmup, unsigned niterations)
 {
-  return (1. / qop) * (-sin(phi) * (x * cos(delta_D) + y * sin(delta_D)) - cos(phi) * (-x * sin(delta_D) + y * cos(delta_D)));
-}
+  NUTSSampler nuts(*this, fMCMCNChains, 4357);
+  if (!warmstart.x.empty())
+  {
+    nuts.SetInitialPositions(warmstart.x);
+    nuts.SetMetric(warmstart.cov, warmstart.sampler == "nuts" ? warmstart.scale : 0.1);
+    warmstart = StartPoint();
+  }
 
-// ---------------------------------------------------------
+  clock_t start = clock();
+  if (!resume)
+  {
+    BCLog::OutSummary(Form("NUTS: %u chains, %u warmup iterations", fMCMCNChains, nwarmup));
+    nuts.Warmup(nwarmup);
+    for (unsigned i = 0; i < fMCMCNChains; i++)
+      BCLog::OutDetail(Form("NUTS: chain %u, step size %g", i, nuts.GetStepSize(i)));
+    BCLog::OutSummary(Form("NUTS: warmup done, %lu gradients, %lu divergent transitions, %.1f s CPU", nuts.GetNGradients(),
+                           nuts.GetNDivergent(), (double)(clock() - start) / CLOCKS_PER_SEC));
+    nuts.ResetStatistics();
+  }
 
-double MixingModel::x_plus(double delta_D)
-{
-  return (qop) * (-cos(phi) * (x * cos(delta_D) + y * sin(delta_D)) - sin(phi) * (-x * sin(delta_D) + y * cos(delta_D)));
-}
+  start = clock();
+  niterations = RunExternal(nuts, "nuts", niterations);
 
-// ---------------------------------------------------------
+  tuned.sampler = "nuts";
+  tuned.x.clear();
+  tuned.cov.assign(GetNParameters() * GetNParameters(), 0.);
+  tuned.scale = 0.;
+  vector<double> cov;
+  for (unsigned i = 0; i < fMCMCNChains; i++)
+  {
+    tuned.x.push_back(nuts.GetPoint(i));
+    nuts.GetMetric(i, cov);
+    for (unsigned k = 0; k < cov.size(); k++)
+      tuned.cov[k] += cov[k] / fMCMCNChains;
+    tuned.scale += nuts.GetStepSize(i) / fMCMCNChains;
+  }
 
-double MixingModel::x_minus(double delta_D)
-{
-  return (-1. / qop) * (cos(phi) * (x * cos(delta_D) + y * sin(delta_D)) - sin(phi) * (-x * sin(delta_D) + y * cos(delta_D)));
+  BCLog::OutSummary(Form("NUTS: %u iterations, %lu gradients, mean tree depth %.2f, mean acceptance %.3f, %lu divergent transitions, %.1f s CPU",
+                         niterations, nuts.GetNGradients(), nuts.GetMeanTreeDepth(), nuts.GetMeanAcceptance(), nuts.GetNDivergent(),
+                         (double)(clock() - start) / CLOCKS_PER_SEC));
 }
-
 // ---------------------------------------------------------
-double MixingModel::Calculate_ChargedB_observables()
+
+void MixingModel::MarginalizeAllTempering(unsigned nwarmup, unsigned niterations, const vector<double>& temperatures,
+                                          const vector<string>& modenames)
 {
+  TemperingSampler pt(*this, fMCMCNChains, temperatures, 4357);
+  vector<unsigned> modepars;
+  for (unsigned m = 0; m < modenames.size(); m++)
+    for (unsigned i = 0; i < GetNParameters(); i++)
+      if (GetParameter(i).GetName() == modenames[m])
+        modepars.push_back(i);
+  pt.SetModeParameters(modepars);
+  if (!warmstart.x.empty())
+  {
+    pt.SetStart(warmstart.x, warmstart.cov, warmstart.sampler == "tempering" ? warmstart.scale : 0.);
+    warmstart = StartPoint();
+  }
 
-  double ll1;
-  ll1 = 0.;
+  string ladder;
+  for (unsigned k = 0; k < temperatures.size(); k++)
+    ladder += Form(k ? ", %g" : "%g", temperatures[k]);
+  clock_t start = clock();
+  if (!resume)
+  {
+    BCLog::OutSummary(Form("Parallel tempering: %u chains, temperatures %s, %u warmup iterations", fMCMCNChains, ladder.c_str(), nwarmup));
+    pt.Warmup(nwarmup);
+    BCLog::OutSummary(Form("Parallel tempering: warmup done, %.1f s CPU", (double)(clock() - start) / CLOCKS_PER_SEC));
+    pt.ResetStatistics();
+  }
 
-  //-------------------------------------------------  Bpm -> Dhpm  -------------------------------------------------------------------------
+  // only the cold replicas are passed on, to BAT and to histo
+  start = clock();
+  niterations = RunExternal(pt, "tempering", niterations);
 
-  // GLW: D -> KK, pipi; ADS: D -> Kpi
-  // https://arxiv.org/pdf/2012.09903.pdf
-  // Observables 8:
-  acp_dk_uid0 = Acp(r_dk, d_dk, 1., 1., 2 * 0.523);
-  acp_dpi_uid0 = Acp(r_dpi, d_dpi, 1., 1., 2 * 0.523);
-  afav_dk_uid0 = Afav(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.523);
-  rcp_uid0 = Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1., 2 * 0.523) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1., 2 * 0.523);
-  rm_dk_uid0 = Rm(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.523);
-  rm_dpi_uid0 = Rm(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dk_uid0 = Rp(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dpi_uid0 = Rp(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.523);
+  tuned.sampler = "tempering";
+  tuned.x.clear();
+  tuned.cov.assign(GetNParameters() * GetNParameters(), 0.);
+  tuned.scale = 0.;
+  vector<double> cov;
+  for (unsigned i = 0; i < fMCMCNChains; i++)
+  {
+    double scale;
+    tuned.x.push_back(pt.GetPoint(i));
+    pt.GetProposal(i, cov, scale);
+    for (unsigned k = 0; k < cov.size(); k++)
+      tuned.cov[k] += cov[k] / fMCMCNChains;
+    tuned.scale += scale / fMCMCNChains;
+  }
 
+  BCLog::OutSummary(Form("Parallel tempering: %u iterations, %.1f s CPU", niterations, (double)(clock() - start) / CLOCKS_PER_SEC));
+  for (unsigned k = 0; k < temperatures.size(); k++)
+    BCLog::OutSummary(Form("  T = %-8g efficiency %.3f%s", temperatures[k], pt.GetEfficiency(k),
+                           k + 1 < temperatures.size() ? Form(", swap rate with T = %g: %.3f", temperatures[k + 1], pt.GetSwapRate(k)) : ""));
+  vector<pair<string, double> > occ = pt.GetModeOccupancy();
+  BCLog::OutSummary("  occupancy of the modes by the cold chains:");
+  for (unsigned m = 0; m < occ.size(); m++)
+    BCLog::OutSummary(Form("    %6.2f%%  %s", 100. * occ[m].second, occ[m].first.c_str()));
+}
+// ---------------------------------------------------------
 
-  // GLW: D -> KKpipi, D -> 4pi
-  // https://arxiv.org/abs/2301.10328
-  // 6 Observables
-  acp_dk_kkpipi_230110328 = Acp(r_dk, d_dk, 1., F_kkpipi, 1.);
-  acp_dpi_kkpipi_230110328 = Acp(r_dpi, d_dpi, 1., F_kkpipi, 1.);
-  acp_dk_pipipipi_230110328 = Acp(r_dk, d_dk, 1., F_pipipipi, 1.);
-  acp_dpi_pipipipi_230110328 = Acp(r_dpi, d_dpi, 1., F_pipipipi, 1.);
-  rcp_kpi_kkpipi_230110328 = Rcp_h(r_dk, d_dk, r_dk, rD_k3pi, d_dk, dD_k3pi, 1., kD_k3pi, F_kkpipi, 1.) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_k3pi, d_dpi, dD_k3pi, 1., kD_k3pi, F_kkpipi, 1.);
-  rcp_kpi_pipipipi_230110328 = Rcp_h(r_dk, d_dk, r_dk, rD_k3pi, d_dk, dD_k3pi, 1., kD_k3pi, F_pipipipi, 1.) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_k3pi, d_dpi, dD_k3pi, 1., kD_k3pi, F_pipipipi, 1.);
+template <class Sampler>
+unsigned MixingModel::RunExternal(Sampler& sampler, const char* name, unsigned niterations)
+{
+  BeginExternalRun();
+  unsigned it = resume ? ReadCheckpoint(sampler, name) : 0;
+  if (checkpointinterval > 0)
+    signal(SIGTERM, Terminate);
+  while (it < niterations)
+  {
+    sampler.Iterate();
+    for (unsigned i = 0; i < fMCMCNChains; i++)
+      SetChainState(i, it, sampler.GetPoint(i), sampler.GetLogLikelihood(i));
+    EndIteration();
+    it++;
+    bool stop = StopRun(it, niterations);
+    if (checkpointinterval > 0 && (it % checkpointinterval == 0 || stop || it == niterations || terminated))
+      WriteCheckpoint(sampler, name, it);
+    if (terminated)
+    {
+      CloseSampleStore();
+      BCLog::OutSummary(Form("Terminated after %u iterations, the run can be resumed from %s", it, checkpointfile.c_str()));
+      BCLog::CloseLog();
+      exit(EXIT_FAILURE);
+    }
+    if (stop)
+      break;
+  }
+  fFlagMarginalized = true;
+  return it;
+}
+// ---------------------------------------------------------
 
+void MixingModel::SetCheckpoint(const string& file, unsigned interval, bool r)
+{
+  checkpointfile = file;
+  checkpointinterval = interval;
+  resume = r;
+}
+// ---------------------------------------------------------
 
-  // GLW: D -> pipipi0, KKpi0; D -> Kpipi0
-  //https://arxiv.org/pdf/2112.10617
-  // Observables 11:
-  rcp_kkpi0_211210617 = Rcp_h(r_dk, d_dk, r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, F_kkpi0, 2 * 0.5) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, F_kkpi0, 2 * 0.5);
-  rcp_pipipi0_211210617 = Rcp_h(r_dk, d_dk, r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, F_pipipi0, 2 * 0.5) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, F_pipipi0, 2 * 0.5);
-  afav_dk_kpipi0_211210617 = Afav(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5);
-  acp_dk_kkpi0_211210617 = Acp(r_dk, d_dk, 1., F_kkpi0, 2 * 0.5);
-  acp_dk_pipipi0_211210617 = Acp(r_dk, d_dk, 1., F_pipipi0, 2 * 0.5);
-  acp_dpi_kkpi0_211210617 = Acp(r_dpi, d_dpi, 1., F_kkpi0, 2 * 0.5);
-  acp_dpi_pipipi0_211210617 = Acp(r_dpi, d_dpi, 1., F_pipipi0, 2 * 0.5);
-  rp_dk_211210617 = Rp(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5);
-  rm_dk_211210617 = Rm(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5);
-  rp_dpi_211210617 = Rp(r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5);
-  rm_dpi_211210617 = Rm(r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5);
+volatile sig_atomic_t MixingModel::terminated = 0;
 
+void MixingModel::Terminate(int)
+{
+  terminated = 1; // the run writes its checkpoint and exits at the end of the iteration
+}
+// ---------------------------------------------------------
 
-  // ADS: D -> K0sKpi
-  // https://arxiv.org/pdf/2002.08858
-  // Observables 7:
-  afav_dpi_kskpi_uid4 = Afav(r_dpi, rD_kskpi, d_dpi, dD_kskpi, 1., kD_kskpi, 1.);
-  asup_dpi_kskpi_uid4 = Asup(r_dpi, rD_kskpi, d_dpi, dD_kskpi, 1., kD_kskpi, 1.);
-  afav_dk_kskpi_uid4 = Afav(r_dk, rD_kskpi, d_dk, dD_kskpi, 1., kD_kskpi, 1.);
-  asup_dk_kskpi_uid4 = Asup(r_dk, rD_kskpi, d_dk, dD_kskpi, 1., kD_kskpi, 1.);
-  rfavsup_dpi_kskpi_uid4 = 1. / Rads(r_dpi, rD_kskpi, d_dpi, dD_kskpi, 1., kD_kskpi, 1.);
-  rfav_dkdpi_kskpi_uid4 = Rfav(r_dk, r_dpi, rD_kskpi, d_dk, d_dpi, dD_kskpi, RBRdkdpi, kD_kskpi, 1.);
-  rsup_dkdpi_kskpi_uid4 = Rsup(r_dk, r_dpi, rD_kskpi, d_dk, d_dpi, dD_kskpi, RBRdkdpi, kD_kskpi, 1.);
+// BAT's statistics of a chain, field by field
+static void WriteStatistics(StateWriter& w, const BCEngineMCMC::Statistics& s)
+{
+  w.Add(s.n_samples);
+  w.Add(s.mean);
+  w.Add(s.variance);
+  w.Add(s.covariance.size());
+  for (unsigned i = 0; i < s.covariance.size(); i++)
+    w.Add(s.covariance[i]);
+  w.Add(s.minimum);
+  w.Add(s.maximum);
+  w.Add(s.probability_mean);
+  w.Add(s.probability_variance);
+  w.Add(s.modepar);
+  w.Add(s.probability_mode);
+  w.Add(s.log_likelihood_mode);
+  w.Add(s.log_prior_mode);
+  w.Add(s.efficiency);
+}
 
+static void ReadStatistics(StateReader& r, BCEngineMCMC::Statistics& s)
+{
+  s.n_samples = r.Next();
+  r.Next(s.mean);
+  r.Next(s.variance);
+  s.covariance.resize(r.Next());
+  for (unsigned i = 0; i < s.covariance.size(); i++)
+    r.Next(s.covariance[i]);
+  r.Next(s.minimum);
+  r.Next(s.maximum);
+  s.probability_mean = r.Next();
+  s.probability_variance = r.Next();
+  r.Next(s.modepar);
+  s.probability_mode = r.Next();
+  s.log_likelihood_mode = r.Next();
+  s.log_prior_mode = r.Next();
+  r.Next(s.efficiency);
+}
 
-  xm_dk_uid3 = r_dk * cos(d_dk - g);
-  ym_dk_uid3 = r_dk * sin(d_dk - g);
-  xp_dk_uid3 = r_dk * cos(d_dk + g);
-  yp_dk_uid3 = r_dk * sin(d_dk + g);
-  xi_x_dpi_uid3 = (r_dpi / r_dk) * cos(d_dpi - d_dk);
-  xi_y_dpi_uid3 = (r_dpi / r_dk) * sin(d_dpi - d_dk);
+template <class Sampler>
+void MixingModel::WriteCheckpoint(const Sampler& sampler, const char* name, unsigned iterations)
+{
+  // written aside and renamed, so that a kill while writing leaves the previous checkpoint intact
+  string tmp = checkpointfile + ".tmp";
+  TFile f(tmp.c_str(), "RECREATE");
+  if (f.IsZombie())
+  {
+    BCLog::OutWarning(Form("Cannot write the checkpoint %s", tmp.c_str()));
+    return;
+  }
+  StateWriter run;
+  run.Add(iterations);
+  run.Add(comb);
+  run.Add(fMCMCNChains);
+  run.Add(GetNParameters());
+  run.Add(monitor != 0);
+  run.Write(f, "run");
+  sampler.SaveState(*f.mkdir(name));
+
+  StateWriter stat;
+  for (unsigned i = 0; i < fMCMCStatistics.size(); i++)
+    WriteStatistics(stat, fMCMCStatistics[i]);
+  WriteStatistics(stat, fMCMCStatistics_AllChains);
+  stat.Write(f, "statistics");
+  TDirectory* bat = f.mkdir("marginalized");
+  for (unsigned i = 0; i < fH1Marginalized.size(); i++)
+    if (fH1Marginalized[i])
+      bat->WriteTObject(fH1Marginalized[i], Form("h1_%u", i));
+  for (unsigned i = 0; i < fH2Marginalized.size(); i++)
+    for (unsigned j = 0; j < fH2Marginalized[i].size(); j++)
+      if (fH2Marginalized[i][j])
+        bat->WriteTObject(fH2Marginalized[i][j], Form("h2_%u_%u", i, j));
+  TDirectory* hdir = f.mkdir("histo");
+  hdir->cd();
+  histos.write();
+  histos.SaveState(*hdir);
+  if (monitor)
+    monitor->SaveState(f);
+  f.Close();
+
+  if (rename(tmp.c_str(), checkpointfile.c_str()) != 0)
+    BCLog::OutWarning(Form("Cannot write the checkpoint %s", checkpointfile.c_str()));
+  else
+    BCLog::OutDetail(Form("Checkpoint after %u iterations written to %s", iterations, checkpointfile.c_str()));
+}
 
+template <class Sampler>
+unsigned MixingModel::ReadCheckpoint(Sampler& sampler, const char* name)
+{
+  TFile f(checkpointfile.c_str(), "READ");
+  if (f.IsZombie())
+  {
+    cout << "Cannot open the checkpoint " << checkpointfile << endl;
+    exit(EXIT_FAILURE);
+  }
+  StateReader run(f, "run");
+  unsigned iterations = run.Next();
+  int c = run.Next();
+  unsigned nch = run.Next(), npars = run.Next();
+  bool monitored = run.Next();
+  TDirectory* dir = f.GetDirectory(name);
+  if (c != comb || nch != fMCMCNChains || npars != GetNParameters() || !dir)
+  {
+    cout << "The checkpoint " << checkpointfile << " was written by a run with another combination, number of chains or sampler" << endl;
+    exit(EXIT_FAILURE);
+  }
+  sampler.LoadState(*dir);
+
+  StateReader stat(f, "statistics");
+  for (unsigned i = 0; i < fMCMCStatistics.size(); i++)
+    ReadStatistics(stat, fMCMCStatistics[i]);
+  ReadStatistics(stat, fMCMCStatistics_AllChains);
+  TDirectory* bat = f.GetDirectory("marginalized");
+  for (unsigned i = 0; i < fH1Marginalized.size(); i++)
+    if (fH1Marginalized[i])
+    {
+      TH1* h = 0;
+      bat->GetObject(Form("h1_%u", i), h);
+      if (!h)
+      {
+        cout << "The checkpoint has no marginalized distribution of " << GetParameter(i).GetName() << endl;
+        exit(EXIT_FAILURE);
+      }
+      h->SetDirectory(0);
+      delete fH1Marginalized[i];
+      fH1Marginalized[i] = h;
+    }
+  for (unsigned i = 0; i < fH2Marginalized.size(); i++)
+    for (unsigned j = 0; j < fH2Marginalized[i].size(); j++)
+      if (fH2Marginalized[i][j])
+      {
+        TH2* h = 0;
+        bat->GetObject(Form("h2_%u_%u", i, j), h);
+        if (!h)
+        {
+          cout << "The checkpoint has no marginalized distribution of " << GetParameter(i).GetName() << " and "
+               << GetParameter(j).GetName() << endl;
+          exit(EXIT_FAILURE);
+        }
+        h->SetDirectory(0);
+        delete fH2Marginalized[i][j];
+        fH2Marginalized[i][j] = h;
+      }
+  histos.LoadState(*f.GetDirectory("histo"));
+  histos.read(*f.GetDirectory("histo"));
+  if (monitor && monitored)
+    monitor->LoadState(f);
+  else if (monitor)
+    BCLog::OutWarning("The checkpoint has no convergence diagnostics, they start from the resumed iteration");
+  f.Close();
+
+  BCLog::OutSummary(Form("Resuming from %s after %u iterations", checkpointfile.c_str(), iterations));
+  if (storethin > 0) // the states after the checkpoint may already be in the store of the interrupted run
+    storefile = storefile.substr(0, storefile.rfind(".root")) + Form("_%u.root", iterations);
+  return iterations;
+}
+// ---------------------------------------------------------
 
-  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
-  // https://arxiv.org/abs/2012.09903
-  // Observables 18:
-  acp_dstk_dg_uid5 = Acp(r_dstk, d_dstk + M_PI, 1., 1., 2 * 0.523);
-  acp_dstk_dp_uid5 = Acp(r_dstk, d_dstk, 1., 1., 2 * 0.523);
-  afav_dstk_dg_uid5 = Afav(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  afav_dstk_dp_uid5 = Afav(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.523);
-  rcp_dg_uid5 = Rcp_h(r_dstk, d_dstk + M_PI, r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 1., 2 * 0.523) / Rcp_h(r_dstpi, d_dstpi + M_PI, r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 1., 2 * 0.523);
-  rcp_dp_uid5 = Rcp_h(r_dstk, d_dstk, r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 1., 2 * 0.523) / Rcp_h(r_dstpi, d_dstpi, r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 1., 2 * 0.523);
-  rm_dstk_dg_uid5 = Rm(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  rm_dstk_dp_uid5 = Rm(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dstk_dg_uid5 = Rp(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dstk_dp_uid5 = Rp(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.523);
-  acp_dstpi_dg_uid5 = Acp(r_dstpi, d_dstpi + M_PI, 1., 1., 2 * 0.523);
-  acp_dstpi_dp_uid5 = Acp(r_dstpi, d_dstpi, 1., 1., 2 * 0.523);
-  rm_dstpi_dg_uid5 = Rm(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  rm_dstpi_dp_uid5 = Rm(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dstpi_dg_uid5 = Rp(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  rp_dstpi_dp_uid5 = Rp(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.523);
-  afav_dstpi_dg_uid5 = Afav(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.523);
-  afav_dstpi_dp_uid5 = Afav(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.523);
+void MixingModel::BeginExternalRun()
+{
+  MCMCInitialize();
+  CreateHistograms();
+  MCMCUserInitialize();
+  fMCMCPhase = BCEngineMCMC::kMainRun;
 
+  if (checkinterval > 0)
+  {
+    vector<string> names;
+    if (monitorvariables)
+      names = nVarab;
+    else
+      for (unsigned i = 0; i < GetNParameters(); i++)
+        names.push_back(GetParameter(i).GetName());
+    delete monitor;
+    monitor = new ConvergenceMonitor(fMCMCNChains, names);
+  }
+  runstart = time(0);
+}
+// ---------------------------------------------------------
 
-  // GLW: D -> KK, D -> pipi, D -> 4pi; ADS: D -> Kpi, D -> K3pi
-  // LHCb-PAPER-2024-023
-  // Observables 12:
-  afav_dkst_kpi = Afav(r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 2 * 0.6);
-  acp_dkst_kk = Acp(r_dkst, d_dkst, k_dkst, 1., 2 * 0.6);
-  acp_dkst_pipi = Acp(r_dkst, d_dkst, k_dkst, 1., 2 * 0.6);
-  asup_dkst_kpi = Asup(r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 2 * 0.6);
-  rcp_dkst_kk = Rcp_h(r_dkst, d_dkst, r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 1., 2 * 0.6);
-  rcp_dkst_pipi = Rcp_h(r_dkst, d_dkst, r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 1., 2 * 0.6);
-  rsup_dkst_kpi = Rads(r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 2 * 0.6);
-  afav_dkst_k3pi = Afav(r_dkst, rD_k3pi, d_dkst, dD_k3pi, k_dkst, kD_k3pi, 2 * 0.6);
-  acp_dkst_pipipipi = Acp(r_dkst, d_dkst, k_dkst, F_pipipipi, 2 * 0.6);
-  asup_dkst_k3pi = Asup(r_dkst, rD_k3pi, d_dkst, dD_k3pi, k_dkst, kD_k3pi, 2 * 0.6);
-  rcp_dkst_pipipipi = Rcp_h(r_dkst, d_dkst, r_dkst, rD_k3pi, d_dkst, dD_k3pi, k_dkst, kD_k3pi, F_pipipipi, 2 * 0.6);
-  rsup_dkst_k3pi = Rads(r_dkst, rD_k3pi, d_dkst, dD_k3pi, k_dkst, kD_k3pi, 2 * 0.6);
+void MixingModel::SetChainState(unsigned ichain, unsigned iteration, const vector<double>& point, double ll)
+{
+  ChainState& cs = fMCMCStates[ichain];
+  cs.iteration = iteration;
+  cs.parameters = point;
+  cs.log_likelihood = ll;
+  cs.log_prior = LogAPrioriProbability(point);
+  cs.log_probability = ll + cs.log_prior;
+  MCMCCurrentPointInterface(point, ichain, true);
+}
+// ---------------------------------------------------------
 
+void MixingModel::EndIteration()
+{
+  MCMCInChainUpdateStatistics();
+  MCMCInChainFillHistograms();
+  MCMCUserIterationInterface();
+  if (monitor)
+    for (unsigned i = 0; i < fMCMCNChains; i++)
+      monitor->Add(i, monitorvariables ? chainobs[i] : fMCMCStates[i].parameters);
+}
+// ---------------------------------------------------------
 
-  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
-  // https://arxiv.org/pdf/1505.07044
-  // Observables 11:
-  rcp_dkpipi_uid9 = Rcp_h(r_dkpipi, d_dkpipi, r_dkpipi, rD_kpi, d_dkpipi, dD_kpi, k_dkpipi, 1., 1., 2 * 0.6) / Rcp_h(r_dpipipi, d_dpipipi, r_dpipipi, rD_kpi, d_dpipipi, dD_kpi, k_dpipipi, 1., 1., 2 * 0.6);
-  afav_dkpipi_kpi_uid9 = Afav(r_dkpipi, rD_kpi, d_dkpipi, dD_kpi, k_dkpipi, 1., 2 * 0.6);
-  afav_dpipipi_kpi_uid9 = Afav(r_dpipipi, rD_kpi, d_dpipipi, dD_kpi, k_dpipipi, 1., 2 * 0.6);
-  acp_dkpipi_kk_uid9 = Acp(r_dkpipi, d_dkpipi, k_dkpipi, 1., 2 * 0.6);
-  acp_dkpipi_pipi_uid9 = Acp(r_dkpipi, d_dkpipi, k_dkpipi, 1., 2 * 0.6);
-  acp_dpipipi_kk_uid9 = Acp(r_dpipipi, d_dpipipi, k_dpipipi, 1., 2 * 0.6);
-  acp_dpipipi_pipi_uid9 = Acp(r_dpipipi, d_dpipipi, k_dpipipi, 1., 2 * 0.6);
-  rp_dkpipi_uid9 = Rp(r_dkpipi, rD_kpi, d_dkpipi, dD_kpi, k_dkpipi, 1., 2 * 0.6);
-  rm_dkpipi_uid9 = Rm(r_dkpipi, rD_kpi, d_dkpipi, dD_kpi, k_dkpipi, 1., 2 * 0.6);
-  rp_dpipipi_uid9 = Rp(r_dpipipi, rD_kpi, d_dpipipi, dD_kpi, k_dpipipi, 1., 2 * 0.6);
-  rm_dpipipi_uid9 = Rm(r_dpipipi, rD_kpi, d_dpipipi, dD_kpi, k_dpipipi, 1., 2 * 0.6);
-
-
-  // Coherence factor kappakstpm
-  // https://arxiv.org/pdf/1709.05855
-  k_dkst_uid24 = k_dkst;
+void MixingModel::SetConvergenceTargets(double rhat, double ess, unsigned interval, double maxt, bool variablesonly)
+{
+  rhattarget = rhat;
+  esstarget = ess;
+  checkinterval = interval;
+  maxtime = maxt;
+  monitorvariables = variablesonly;
+}
+// ---------------------------------------------------------
 
-  //------------------------------------------------------ Calculating the contribution to the LogLikelihood ----------------------------------------------------
+bool MixingModel::StopRun(unsigned iterations, unsigned maxiterations)
+{
+  if (!monitor)
+    return false;
+  bool outoftime = maxtime > 0. && difftime(time(0), runstart) >= maxtime;
+  bool outofiterations = iterations >= maxiterations;
+  if (iterations % checkinterval != 0 && !outoftime && !outofiterations)
+    return false;
+
+  monitor->Compute();
+  unsigned ir, ib, it;
+  double rhat = monitor->MaxRhat(&ir), bulk = monitor->MinBulkESS(&ib), tail = monitor->MinTailESS(&it);
+  bool converged = rhat < rhattarget && bulk >= esstarget && tail >= esstarget;
+  BCLog::OutSummary(Form("Iteration %u: max R-hat %.4f (%s), min bulk ESS %.0f (%s), min tail ESS %.0f (%s)%s", iterations,
+                         rhat, monitor->GetName(ir).c_str(), bulk, monitor->GetName(ib).c_str(), tail, monitor->GetName(it).c_str(),
+                         converged ? ": converged" : ""));
+  if (!converged && !outoftime && !outofiterations)
+    return false;
+  if (!converged && outoftime)
+    BCLog::OutWarning(Form("Time budget of %g s reached before convergence", maxtime));
+  else if (!converged)
+    BCLog::OutWarning(Form("Budget of %u iterations reached before convergence", maxiterations));
+
+  // achieved diagnostics of every quantity
+  for (unsigned i = 0; i < monitor->GetNQuantities(); i++)
+    BCLog::OutDetail(Form("  %-30s R-hat %.4f  bulk ESS %8.0f  tail ESS %8.0f", monitor->GetName(i).c_str(), monitor->GetRhat(i),
+                          monitor->GetBulkESS(i), monitor->GetTailESS(i)));
+  return true;
+}
+// ---------------------------------------------------------
 
-  TVectorD corr(8);
+void MixingModel::ReadWarmStart(const string& file)
+{
+  ifstream in(file.c_str());
+  if (!in)
+  {
+    cout << "Cannot open the warm start " << file << endl;
+    exit(EXIT_FAILURE);
+  }
+  string line, key;
+  unsigned nch = 0, np = 0;
+  double scale = 0.;
+  StartPoint start;
+  while (getline(in, line))
+  { // header lines
+    if (line.empty() || line[0] == '#')
+      continue;
+    istringstream l(line);
+    l >> key;
+    if (key == "sampler")
+      l >> start.sampler;
+    else if (key == "scale")
+      l >> scale;
+    else if (key == "chains")
+      l >> nch;
+    else if (key == "parameters")
+    {
+      l >> np;
+      break;
+    }
+  }
+  if (nch == 0 || np == 0)
+  {
+    cout << "The warm start " << file << " has no chains or parameters" << endl;
+    exit(EXIT_FAILURE);
+  }
 
-  //-------------------------------------------------  Babar measurements  -------------------------------------------------------------------------
+  // one line per parameter: name, position in every chain, row of the covariance
+  vector<int> index(np, -1); // parameter of the model of each parameter of the file
+  vector<vector<double> > x(np, vector<double>(nch)), cov(np, vector<double>(np));
+  for (unsigned f = 0; f < np; f++)
+  {
+    string name;
+    if (!(in >> name))
+    {
+      cout << "The warm start " << file << " is truncated" << endl;
+      exit(EXIT_FAILURE);
+    }
+    for (unsigned c = 0; c < nch; c++)
+      in >> x[f][c];
+    for (unsigned g = 0; g < np; g++)
+      in >> cov[f][g];
+    for (unsigned i = 0; i < GetNParameters(); i++)
+      if (GetParameter(i).GetName() == name)
+        index[f] = i;
+  }
 
-  // B -> DK, D -> KK, D -> pipi normalized to D -> Kpi
-  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.82.072004
-  // 4 Observables :
-  corr.ResizeTo(4);
-  corr(0) = Acp(r_dk, d_dk, 1., 1., 2*0.5);
-  corr(1) = Acp(r_dk, d_dk, 1., 0., 2*0.5);
-  corr(2) =  Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1., 2 * 0.5) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1., 2 * 0.5);
-  corr(3) =  Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 0., 2 * 0.5) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 0., 2 * 0.5);
-  ll1 += corrmeas.at("Babar_PRD82_072004").logweight(corr);
+  // the parameters missing from the file start from the centre, with a proposal of a tenth of their range
+  unsigned npars = GetNParameters(), matched = 0;
+  start.x.assign(fMCMCNChains, vector<double>(npars));
+  start.cov.assign(npars * npars, 0.);
+  for (unsigned i = 0; i < npars; i++)
+  {
+    double lo = GetParameter(i).GetLowerLimit(), hi = GetParameter(i).GetUpperLimit();
+    for (unsigned c = 0; c < fMCMCNChains; c++)
+      start.x[c][i] = 0.5 * (lo + hi);
+    start.cov[i * npars + i] = (hi - lo) * (hi - lo) / 100.;
+  }
+  for (unsigned f = 0; f < np; f++)
+  {
+    int i = index[f];
+    if (i < 0)
+      continue;
+    matched++;
+    double lo = GetParameter(i).GetLowerLimit(), hi = GetParameter(i).GetUpperLimit();
+    for (unsigned c = 0; c < fMCMCNChains; c++) // the chains of the file are reused if it has fewer
+      start.x[c][i] = min(max(x[f][c % nch], lo), hi);
+    for (unsigned g = 0; g < np; g++)
+      if (index[g] >= 0)
+        start.cov[i * npars + index[g]] = cov[f][g];
+  }
+  start.scale = scale;
+  warmstart = start;
+
+  // BAT's Metropolis starts from the positions, its proposal being set in MCMCUserInitialize
+  SetInitialPositions(warmstart.x);
+  SetInitialPositionScheme(BCEngineMCMC::kInitUserDefined);
+  BCLog::OutSummary(Form("Warm start from %s, written by %s: %u of the %u parameters found", file.c_str(), start.sampler.c_str(),
+                         matched, npars));
+}
+// ---------------------------------------------------------
 
+void MixingModel::WriteWarmStart(const string& file)
+{
+  unsigned npars = GetNParameters();
+  StartPoint start = tuned;
+  if (start.sampler.empty())
+  { // BAT's Metropolis, averaging the proposals of its chains
+    start.sampler = "metropolis";
+    start.cov.assign(npars * npars, 0.);
+    start.scale = 0.;
+    for (unsigned c = 0; c < fMCMCNChains; c++)
+    {
+      start.x.push_back(fMCMCStates[c].parameters);
+      for (unsigned i = 0; i < npars; i++)
+        for (unsigned j = 0; j < npars; j++)
+          start.cov[i * npars + j] += fMultivariateProposalFunctionCovariance[c](i, j) / fMCMCNChains;
+      start.scale += fMultivariateProposalFunctionScaleFactor[c] / fMCMCNChains;
+    }
+  }
 
-  //  https://arxiv.org/pdf/0807.2408
-  // B -> DstarK
-  // D -> KK, pipi + fcp-
-  // 4 Observables :
-  ll1 += meas.at("Babar_0807.2408_ACPp").logweight(Acp(r_dstk, d_dstk, 1., 1., 2 * 0.5));
-  ll1 += meas.at("Babar_0807.2408_ACPm").logweight(Acp(r_dstk, d_dstk, 1., 0., 2 * 0.5));
-  ll1 += meas.at("Babar_0807.2408_RCPp").logweight(Rcp_h(r_dstk, d_dstk, r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 1., 2 * 0.5) / Rcp_h(r_dstpi, d_dstpi, r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 1., 2 * 0.5));
-  ll1 += meas.at("Babar_0807.2408_RCPm").logweight(Rcp_h(r_dstk, d_dstk, r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 0., 2 * 0.5) / Rcp_h(r_dstpi, d_dstpi, r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 0., 2 * 0.5));
+  ofstream out(file.c_str());
+  out << "# warm start: final positions of the chains and covariance of the proposal" << endl;
+  out << "# then one line per parameter: name, position in every chain, row of the covariance" << endl;
+  out << "sampler " << start.sampler << endl;
+  out << "scale " << setprecision(17) << start.scale << endl;
+  out << "chains " << start.x.size() << endl;
+  out << "parameters " << npars << endl;
+  for (unsigned i = 0; i < npars; i++)
+  {
+    out << GetParameter(i).GetName();
+    for (unsigned c = 0; c < start.x.size(); c++)
+      out << " " << start.x[c][i];
+    for (unsigned j = 0; j < npars; j++)
+      out << " " << start.cov[i * npars + j];
+    out << endl;
+  }
+  if (!out)
+    BCLog::OutWarning(Form("Cannot write the warm start %s", file.c_str()));
+}
+// ---------------------------------------------------------
 
+void MixingModel::SetSampleStore(const string& file, unsigned thin)
+{
+  storefile = file;
+  storethin = thin;
+}
+// ---------------------------------------------------------
 
-  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.80.092001
-  // B -> DKstar
-  // D -> KK, pipi, fcp-
-  ll1 += meas.at("Babar_PRD80_092001_ACPp").logweight(Acp(r_dkst, d_dkst, k_dkst, 1., 2 * 0.5));
-  ll1 += meas.at("Babar_PRD80_092001_ACPm").logweight(Acp(r_dkst, d_dkst, k_dkst, 0., 2 * 0.5));
-  ll1 += meas.at("Babar_PRD80_092001_RCPp").logweight(Rcp_h(r_dkst, d_dkst, r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 1., 2 * 0.5)  );
-  ll1 += meas.at("Babar_PRD80_092001_RCPm").logweight(Rcp_h(r_dkst, d_dkst, r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 0., 2 * 0.5)  );
-  //https://arxiv.org/pdf/0909.3981
-  // B -> DK
-  // D -> Kpi
-  ll1 += meas.at("Babar_0909.3981_RADS").logweight(Rads(r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 2 * 0.5));
-  ll1 += meas.at("Babar_0909.3981_Asup").logweight(Asup(r_dkst, rD_kpi, d_dkst, dD_kpi, k_dkst, 1., 2 * 0.5));
+void MixingModel::CloseSampleStore()
+{
+  if (!store)
+    return;
+  unsigned long n = store->GetNRows();
+  double wait = store->GetWaitTime();
+  delete store; // waits for the writer
+  store = 0;
+  BCLog::OutSummary(Form("Sample store: %lu states written to %s, the chains waited %.2f s for the writer", n, storefile.c_str(), wait));
+}
+// ---------------------------------------------------------
 
+void MixingModel::MCMCUserInitialize()
+{
+  BookHistograms();
+  if (!warmstart.x.empty())
+  { // first initialization of BAT's Metropolis: proposal of the warm start
+    unsigned npars = GetNParameters();
+    vector<double> L(npars * npars, 0.);
+    bool pd = true;
+    for (unsigned i = 0; i < npars && pd; i++)
+      for (unsigned j = 0; j <= i && pd; j++)
+      {
+        double s = warmstart.cov[i * npars + j];
+        for (unsigned k = 0; k < j; k++)
+          s -= L[i * npars + k] * L[j * npars + k];
+        if (i == j)
+        {
+          pd = s > 0.;
+          L[i * npars + i] = sqrt(s);
+        }
+        else
+          L[i * npars + j] = s / L[j * npars + j];
+      }
+    for (unsigned c = 0; c < fMCMCNChains && pd && c < fMultivariateProposalFunctionCovariance.size(); c++)
+    {
+      fMultivariateProposalFunctionCovariance[c].ResizeTo(npars, npars);
+      fMultivariateProposalFunctionCholeskyDecomposition[c].ResizeTo(npars, npars);
+      for (unsigned i = 0; i < npars; i++)
+        for (unsigned j = 0; j < npars; j++)
+        {
+          fMultivariateProposalFunctionCovariance[c](i, j) = warmstart.cov[i * npars + j];
+          fMultivariateProposalFunctionCholeskyDecomposition[c](i, j) = L[i * npars + j];
+        }
+      if (warmstart.sampler == "metropolis")
+        fMultivariateProposalFunctionScaleFactor[c] = warmstart.scale;
+    }
+    warmstart = StartPoint();
+  }
+  chainobs.assign(fMCMCNChains, vector<double>(obsid.size(), 0.));
+  chainobsset.assign(fMCMCNChains, 0);
+}
+// ---------------------------------------------------------
 
-  // https://arxiv.org/pdf/hep-ex/0703037
-  // B -> DK
-  // GLW D -> pi+pi-pi0
-  ll1 += meas.at("Babar_0703037").logweight(Acp(r_dk, d_dk, 1., F_pipipi0, 2 * 0.5));
-  corr.ResizeTo(4);
-  corr(0) = sqrt( ( r_dk * cos(d_dk + g) - (2 * F_pipipi0 -1 ) ) * ( r_dk * cos(d_dk + g) - (2 * F_pipipi0 -1 ) ) + ( r_dk * sin(d_dk + g) )*( r_dk * sin(d_dk + g) ) );
-  double thetap_babar = atan2( r_dk * sin( d_dk + g ), ( r_dk * cos(d_dk + g)  - (2*F_pipipi0 -1) )  );
-  if( thetap_babar < 0){
-    thetap_babar+= 2*M_PI; // in [0, 2 pi]
+void MixingModel::MCMCCurrentPointInterface(const std::vector<double>& point, int ichain, bool accepted)
+{
+  // called by each chain after every proposal, possibly from several threads at once
+  if (!accepted)
+    return; // the chain did not move: its observables are still valid, or are taken from its state by MCMCUserIterationInterface
+  MixingContext& c = GetContext();
+  c.SetParameters(point); // the observables need the parameters only, not the likelihood
+  c.FillObservables(obsid, chainobs[ichain]);
+  chainobsset[ichain] = 1;
+}
+// ---------------------------------------------------------
+
+void MixingModel::MCMCUserIterationInterface()
+{
+  if (fMCMCPhase == BCEngineMCMC::kMainRun && !histos.ranged)
+    SetHistogramRanges(); // first iteration of the main run
+  for (unsigned int i = 0; i < fMCMCNChains; ++i)
+  {
+    if (!chainobsset[i])
+    { // no proposal seen yet for this chain
+      contexts[0].SetParameters(fMCMCStates.at(i).parameters); // called serially, once per iteration
+      contexts[0].FillObservables(obsid, chainobs[i]);
+      chainobsset[i] = 1;
+    }
   }
-  corr(1) = thetap_babar;
-  corr(2) = sqrt( ( r_dk * cos(d_dk - g) - (2 * F_pipipi0 -1 ) ) * ( r_dk * cos(d_dk - g) - (2 * F_pipipi0 -1 ) ) + ( r_dk * sin(d_dk - g) )*( r_dk * sin(d_dk - g) ) );
-  double thetam_babar = atan2( r_dk * sin( d_dk - g ) , ( r_dk * cos(d_dk - g)  - (2*F_pipipi0 -1)  ) );
-  if( thetam_babar < 0){
-    thetam_babar+= 2*M_PI;
+  if (fMCMCPhase != BCEngineMCMC::kMainRun)
+  { // pre-run: kept for the ranges of the histograms
+    if (!histos.ranged)
+      for (unsigned int i = 0; i < fMCMCNChains; ++i)
+      {
+        obs = chainobs[i];
+        histos.collect();
+      }
+    return;
   }
-  corr(3) = thetam_babar;
-  ll1 += corrmeas.at("Babar_0703037_rhotheta").logweight(corr);
+  histos.fill(chainobs);
 
+  for (unsigned int i = 0; i < fMCMCNChains; ++i)
+  {
+    const ChainState& cs = fMCMCStates[i];
+    if (storethin > 0 && cs.iteration % storethin == 0)
+    {
+      if (!store)
+      {
+        vector<string> names;
+        for (unsigned k = 0; k < GetNParameters(); k++)
+          names.push_back(GetParameter(k).GetName());
+        storeobs.clear();
+        for (unsigned k = 0; k < nVarab.size(); k++)
+          if (find(names.begin(), names.end(), nVarab[k]) == names.end())
+            storeobs.push_back(k);
+        for (unsigned k = 0; k < storeobs.size(); k++)
+          names.push_back(nVarab[storeobs[k]]);
+        store = new SampleStore(storefile, names);
+        storerow.resize(names.size());
+      }
+      copy(cs.parameters.begin(), cs.parameters.end(), storerow.begin());
+      for (unsigned k = 0; k < storeobs.size(); k++)
+        storerow[cs.parameters.size() + k] = chainobs[i][storeobs[k]];
+      store->Add(i, cs.iteration, cs.log_likelihood, storerow);
+    }
+  }
+}
 
-  // https://arxiv.org/pdf/1006.4241
-  // B -> DK
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDK").logweight( 0.5 * ( Rp(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) + Rm(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) ) );
-  ll1 += meas.at("Babar_1006.4241_ADK").logweight( ( - Rp(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) + Rm(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) ) / ( Rp(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) + Rm(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 2 * 0.5) ) );
-  // B -> [Dpi0]_Dstar K
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDstarKpi0").logweight( 0.5 * (  Rm(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5)  )  );
-  ll1 += meas.at("Babar_1006.4241_ADstarKpi0").logweight( (  Rm(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5) -  Rp(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5)  ) / (  Rm(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 2 * 0.5)  ) );
-  // B -> [Dg]_Dstar K
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDstarKg").logweight( 0.5 * ( Rm(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) + Rp(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) );
-  ll1 += meas.at("Babar_1006.4241_ADstarKg").logweight( ( Rm(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) - Rp(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) / ( Rm(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) + Rp(r_dstk, rD_kpi, d_dstk + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) );
-  // B -> Dpi
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDpi").logweight( 0.5 * ( Rm(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) ) );
-  ll1 += meas.at("Babar_1006.4241_ADpi").logweight( ( Rm(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) -  Rp(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) ) / ( Rm(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 2 * 0.5) ) );
-  // B -> [Dpi0]_Dstarpi
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDstarpipi0").logweight( 0.5 * (  Rm(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5)  )  );
-  ll1 += meas.at("Babar_1006.4241_ADstarpipi0").logweight( (  Rm(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5) -  Rp(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5)  ) / (  Rm(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5) +  Rp(r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 2 * 0.5)  ) );
-  // B -> [Dpig]_Dstarpi
-  // D -> Kpi
-  ll1 += meas.at("Babar_1006.4241_RDstarpig").logweight( 0.5 * ( Rm(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) + Rp(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) );
-  ll1 += meas.at("Babar_1006.4241_ADstarpig").logweight( ( Rm(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) - Rp(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) / ( Rm(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) + Rp(r_dstpi, rD_kpi, d_dstpi + M_PI, dD_kpi, 1., 1., 2 * 0.5) ) );
+void MixingModel::DeclareBlock(int block, const string& parameters, const string& uses, const string& gives)
+{
+  BlockDeclaration& d = blockdecl[block];
+  d.declared = true;
+  d.parameters.clear();
+  d.uses.clear();
+  d.gives.clear();
+  string name;
+  stringstream p(parameters), u(uses), g(gives);
+  while (p >> name)
+  {
+    if (!MixingContext::IsParameter(name))
+    {
+      cout << "The block " << BlockName[block] << " is declared to depend on " << name << ", which is not a parameter" << endl;
+      exit(EXIT_FAILURE);
+    }
+    d.parameters.push_back(name);
+  }
+  while (u >> name)
+    d.uses.push_back(name);
+  while (g >> name)
+    d.gives.push_back(name);
+  // the measurements registered from now on belong to this block
+  meas.SetRange(MeasBegin[block], MeasBegin[block + 1], BlockName[block]);
+  corrmeas.SetRange(CorrMeasBegin[block], CorrMeasBegin[block + 1], BlockName[block]);
+}
+// ---------------------------------------------------------
 
+void MixingModel::SetDependencies()
+{
+  const vector<int>& blocks = contexts[0].blocks;
+  unsigned reads[MixingContext::NBlocks] = {0};
+  for (unsigned k = 0; k < blocks.size(); k++)
+  {
+    int b = blocks[k];
+    if (!blockdecl[b].declared)
+    {
+      cout << "The block " << BlockName[b] << " of the combination " << comb << " has not been declared" << endl;
+      exit(EXIT_FAILURE);
+    }
+    // a block uses the predictions given by the blocks evaluated before it
+    for (unsigned i = 0; i < blockdecl[b].uses.size(); i++)
+    {
+      const string& label = blockdecl[b].uses[i];
+      bool found = false;
+      for (unsigned l = 0; l < k; l++)
+      {
+        const vector<string>& gives = blockdecl[blocks[l]].gives;
+        if (find(gives.begin(), gives.end(), label) != gives.end())
+        {
+          reads[b] |= 1u << blocks[l];
+          found = true;
+        }
+      }
+      if (!found)
+      {
+        cout << "The block " << BlockName[b] << " uses the predictions " << label << ", given by no block evaluated before it" << endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
 
-  // https://arxiv.org/pdf/1104.4472
-  // B -> DK
-  // D -> Kpipi0
-  ll1 += meas.at("Babar_1104.4472_Rp_DK_Kpipi0").logweight(Rp(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5));
-  ll1 += meas.at("Babar_1104.4472_Rm_DK_Kpipi0").logweight(Rm(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 2 * 0.5));
+  unsigned npars = GetNParameters();
+  vector<unsigned> deps(npars, 0);
+  for (unsigned i = 0; i < npars; i++)
+  {
+    for (unsigned k = 0; k < blocks.size(); k++)
+    {
+      const vector<string>& p = blockdecl[blocks[k]].parameters;
+      if (find(p.begin(), p.end(), GetParameter(i).GetName()) != p.end())
+        deps[i] |= 1u << blocks[k];
+    }
+    // the blocks using the predictions of a block that changes change too
+    for (unsigned k = 0; k < blocks.size(); k++)
+      if (reads[blocks[k]] & deps[i])
+        deps[i] |= 1u << blocks[k];
+  }
 
+  for (unsigned t = 0; t < contexts.size(); t++)
+  {
+    contexts[t].pardeps = deps;
+    copy(reads, reads + MixingContext::NBlocks, contexts[t].reads);
+    copy(reads, reads + MixingContext::NBlocks, gradcontexts[t].reads);
+    contexts[t].Invalidate();
+  }
+}
+// ---------------------------------------------------------
 
-  // https://journals.aps.org/prl/pdf/10.1103/PhysRevLett.105.121801
-  // B -> D(star)K(star) BPGGSZ
-  // D -> K0spipi + D -> K0sKK
-  corr.ResizeTo(12);
-  corr(0) = r_dk * cos(d_dk - g);
-  corr(1) = r_dk * sin(d_dk - g);
-  corr(2) = r_dk * cos(d_dk + g);
-  corr(3) = r_dk * sin(d_dk + g);
-  corr(4) = r_dstk * cos(d_dstk - g);
-  corr(5) = r_dstk * sin(d_dstk - g);
-  corr(6) = r_dstk * cos(d_dstk + g);
-  corr(7) = r_dstk * sin(d_dstk + g);
-  corr(8) = k_dkst * r_dstk * cos(d_dkst - g);
-  corr(9) = k_dkst * r_dkst * sin(d_dkst - g);
-  corr(10) = k_dkst * r_dkst * cos(d_dkst + g);
-  corr(11) = k_dkst * r_dkst * sin(d_dkst + g);
-  ll1 += corrmeas.at("Babar_PRL105.121801").logweight(corr);
-
-
-  //-------------------------------------------------  CDF measurements  -------------------------------------------------------------------------
-
-  // https://journals.aps.org/prd/pdf/10.1103/PhysRevD.81.031105
-  // B -> DK
-  // D -> KK, D-> pipi
-  ll1 += meas.at("CDF_PRD81_031105_ACPp").logweight(Acp(r_dk, d_dk, 1., 1., 2*0.5));
-  ll1 += meas.at("CDF_PRD81_031105_RCPp").logweight(Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1., 2 * 0.5) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1., 2 * 0.5));
-
-
-  // https://arxiv.org/pdf/1108.5765
-  // B -> DK
-  // D -> Kpi
-  ll1 += meas.at("CDF_1108.5765_RDK").logweight(Rads(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1.));
-  ll1 += meas.at("CDF_1108.5765_ADK").logweight(Asup(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1.));
-  // B -> Dpi
-  // D -> Kpi
-  ll1 += meas.at("CDF_1108.5765_RDpi").logweight(Rads(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1.));
-  ll1 += meas.at("CDF_1108.5765_ADpi").logweight(Asup(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1.));
-
-  //--------------------------------------------------------------------------------------------------------------------------
-
-  //--------------------------------------------------------------------------------------------------------------------------
-
-
-  // GLW: D -> KK, pipi; ADS: D -> Kpi
-  // https://arxiv.org/pdf/2012.09903.pdf
-  // Observables 8:
-  corr.ResizeTo(8);
-  corr(0) = acp_dk_uid0;
-  corr(1) = acp_dpi_uid0;
-  corr(2) = afav_dk_uid0;
-  corr(3) = rcp_uid0;
-  corr(4) = rm_dk_uid0;
-  corr(5) = rm_dpi_uid0;
-  corr(6) = rp_dk_uid0;
-  corr(7) = rp_dpi_uid0;
-  ll1 += corrmeas.at("UID0").logweight(corr);
-
-
-  // GLW: D -> KKpipi, D -> 4pi
-  // https://arxiv.org/abs/2301.10328
-  // 6 Observables
-  corr.ResizeTo(6);
-  corr(0) = acp_dk_kkpipi_230110328;
-  corr(1) = acp_dpi_kkpipi_230110328;
-  corr(2) = acp_dk_pipipipi_230110328;
-  corr(3) = acp_dpi_pipipipi_230110328;
-  corr(4) = rcp_kpi_kkpipi_230110328;
-  corr(5) = rcp_kpi_pipipipi_230110328;
-  ll1 += corrmeas.at("GLW_2301.10328").logweight(corr);
-
-
-  // GLW: D -> pipipi0, KKpi0; D -> Kpipi0
-  //https://arxiv.org/pdf/2112.10617
-  // Observables 11:
-  corr.ResizeTo(11);
-  corr(0) = rcp_kkpi0_211210617;
-  corr(1) = rcp_pipipi0_211210617;
-  corr(2) = afav_dk_kpipi0_211210617;
-  corr(3) = acp_dk_kkpi0_211210617;
-  corr(4) = acp_dk_pipipi0_211210617;
-  corr(5) = acp_dpi_kkpi0_211210617;
-  corr(6) = acp_dpi_pipipi0_211210617;
-  corr(7) = rp_dk_211210617;
-  corr(8) = rm_dk_211210617;
-  corr(9) = rp_dpi_211210617;
-  corr(10) = rm_dpi_211210617;
-  ll1 += corrmeas.at("2112.10617").logweight(corr);
-
-
-  // ADS: D -> K0sKpi
-  // https://arxiv.org/pdf/2002.08858
-  // Observables 7:
-  corr.ResizeTo(7);
-  corr(0) = afav_dpi_kskpi_uid4;
-  corr(1) = asup_dpi_kskpi_uid4;
-  corr(2) = afav_dk_kskpi_uid4;
-  corr(3) = asup_dk_kskpi_uid4;
-  corr(4) = rfavsup_dpi_kskpi_uid4;
-  corr(5) = rfav_dkdpi_kskpi_uid4;
-  corr(6) = rsup_dkdpi_kskpi_uid4;
-  ll1 += corrmeas.at("UID4").logweight(corr);
-
-
-  // GLW: D -> KK, D -> K0spi0
-  // https://arxiv.org/abs/2308.05048
-  // Observables 4:
-  corr.ResizeTo(4);
-  corr(0) = Acp(r_dk, d_dk, 1., 0., 1.);
-  corr(1) = Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 0., 1.) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 0., 1.);
-  corr(2) = Acp(r_dk, d_dk, 1., 1., 1.);
-  corr(3) = Rcp_h(r_dk, d_dk, r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1., 1.) / Rcp_h(r_dpi, d_dpi, r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1., 1.);
-  ll1 += corrmeas.at("2308.05048").logweight(corr);
-
-
-  // ADS: D -> Kpipi0
-  // https://arxiv.org/pdf/1310.1741
-  // Observables 4:
-  corr.ResizeTo(4);
-  corr(0) = Rads(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 1.);
-  corr(1) = Asup(r_dk, rD_kpipi0, d_dk, dD_kpipi0, 1., kD_kpipi0, 1.);
-  corr(2) = Rads(r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, 1.);
-  corr(3) = Asup(r_dpi, rD_kpipi0, d_dpi, dD_kpipi0, 1., kD_kpipi0, 1.);
-  ll1 += corrmeas.at("Belle_PRD88_2013").logweight(corr);
-
-
-  // ADS: D -> Kpi
-  // https://arxiv.org/abs/1103.5951
-  // Observables 4:
-  corr.ResizeTo(4);
-  corr(0) = Rads(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1.);
-  corr(1) = Asup(r_dk, rD_kpi, d_dk, dD_kpi, 1., 1., 1.);
-  corr(2) = Rads(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1.);
-  corr(3) = Asup(r_dpi, rD_kpi, d_dpi, dD_kpi, 1., 1., 1.);
-  ll1 += corrmeas.at("Belle_PRL106_2011").logweight(corr);
-
-
-  // K^*+- region fit: ADS: D -> K0sKpi
-  // 2306.02940
-  // Observables 7:
-  corr.ResizeTo(7);
-  corr(0) = afav_dk_kskpi_uid4;
-  corr(1) = asup_dk_kskpi_uid4;
-  corr(2) = afav_dpi_kskpi_uid4;
-  corr(3) = asup_dpi_kskpi_uid4;
-  corr(4) = rfav_dkdpi_kskpi_uid4;
-  corr(5) = rsup_dkdpi_kskpi_uid4;
-  corr(6) = rfavsup_dpi_kskpi_uid4;
-  ll1 += corrmeas.at("2306.02940").logweight(corr);
-
-
-  // GGSZ: D -> K3pi
-  // https://arxiv.org/pdf/2209.03692
-  // Observables 6:
-  corr.ResizeTo(6);
-  corr(0) = xp_dk_uid3;
-  corr(1) = xm_dk_uid3;
-  corr(2) = yp_dk_uid3;
-  corr(3) = ym_dk_uid3;
-  corr(4) = xi_x_dpi_uid3;
-  corr(5) = xi_y_dpi_uid3;
-  ll1 += corrmeas.at("2209.03692").logweight(corr);
-
-
-  // GGSZ D -> K0spipipi0
-  // https://arxiv.org/pdf/1908.09499
-  // Observables 8:
-  corr.ResizeTo(8);
-  corr(0) = xm_dk_uid3;
-  corr(1) = ym_dk_uid3;
-  corr(2) = xp_dk_uid3;
-  corr(3) = yp_dk_uid3;
-  corr(4) = r_dpi * cos(d_dpi - g);
-  corr(5) = r_dpi * sin(d_dpi - g);
-  corr(6) = r_dpi * cos(d_dpi + g);
-  corr(7) = r_dpi * sin(d_dpi + g);
-  ll1 += corrmeas.at("1908.09499").logweight(corr);
-
-
-  // GGSZ: D -> K0spipi, D -> K0sKK
-  // https://arxiv.org/abs/2110.12125
-  // Observables 6:
-  corr.ResizeTo(6);
-  corr(0) = xm_dk_uid3;
-  corr(1) = ym_dk_uid3;
-  corr(2) = xp_dk_uid3;
-  corr(3) = yp_dk_uid3;
-  corr(4) = xi_x_dpi_uid3;
-  corr(5) = xi_y_dpi_uid3;
-  ll1 += corrmeas.at("2110.12125").logweight(corr);
-
-
-  // GGSZ: D -> K0sKK, D -> K0spipi
-  // https://arxiv.org/abs/2301.10328
-  // 6 Observables
-  corr.ResizeTo(6);
-  corr(0) = xm_dk_uid3;
-  corr(1) = ym_dk_uid3;
-  corr(2) = xp_dk_uid3;
-  corr(3) = yp_dk_uid3;
-  corr(4) = xi_x_dpi_uid3;
-  corr(5) = xi_y_dpi_uid3;
-  ll1 += corrmeas.at("GGSZ_2301.10328").logweight(corr);
-
-
-  // If combiining chargedB modes only
-  // If combining all the modes see the neutralBd section since they are all correlated
-  // https://arxiv.org/pdf/2010.08483 + https://arxiv.org/abs/2310.04277 +  https://arxiv.org/abs/2311.10434 + LHCB-PAPER-2024-023
-  if (comb == 0)
-  {
-
-    // 4. GGSZ LHCb ChargedB
-    // Observables 22:
-    corr.ResizeTo(22);
-
-    // D -> K0spipi, D -> K0sKK
-    // https://arxiv.org/pdf/2010.08483
-    // Observables 6:
-    corr(0) = xm_dk_uid3;
-    corr(1) = ym_dk_uid3;
-    corr(2) = xp_dk_uid3;
-    corr(3) = yp_dk_uid3;
-    corr(4) = xi_x_dpi_uid3;
-    corr(5) = xi_y_dpi_uid3;
-
-    //----------------------------------------------------------------------------------------------------------------------------------
-
-    //-------------------------------------------------  Bpm -> D*hpm -------------------------------------------------------------------------
-
-    // GGSZ: D -> K0spipi, D -> K0sKK
-    // https://arxiv.org/abs/2310.04277 LHCb
-    // Observables 6:
-    corr(6) = r_dstk * cos(d_dstk + g);
-    corr(7) = r_dstk * cos(d_dstk - g);
-    corr(8) = r_dstk * sin(d_dstk + g);
-    corr(9) = r_dstk * sin(d_dstk - g);
-    corr(10) = r_dstpi / r_dstk * cos(d_dstpi - d_dstk);
-    corr(11) = r_dstpi / r_dstk * sin(d_dstpi - d_dstk);
-
-    // GGSZ: D -> K0spipi, D -> K0sKK
-    // https://arxiv.org/abs/2311.10434 LHCb
-    // Observables 6:
-    corr(12) = r_dstk * cos(d_dstk - g);
-    corr(13) = r_dstk * sin(d_dstk - g);
-    corr(14) = r_dstk * cos(d_dstk + g);
-    corr(15) = r_dstk * sin(d_dstk + g);
-    corr(16) = r_dstpi / r_dstk * cos(d_dstpi - d_dstk);
-    corr(17) = r_dstpi / r_dstk * sin(d_dstpi - d_dstk);
-
-    //----------------------------------------------------------------------------------------------------------------------------------
-
-    //-------------------------------------------------  Bpm -> DK*pm -------------------------------------------------------------------------
-
-    // GGSZ: D -> K0spipi, D -> K0sKK
-    // LHCB-PAPER-2024-023
-    // Observables 4:
-    corr(18) = r_dkst * cos(d_dkst - g);
-    corr(19) = r_dkst * sin(d_dkst - g);
-    corr(20) = r_dkst * cos(d_dkst + g);
-    corr(21) = r_dkst * sin(d_dkst + g);
-    ll1 += corrmeas.at("GGSZ_LHCb_Cb").logweight(corr);
-
-  }
-
-  //----------------------------------------------------------------------------------------------------------------------------------
-
-  //-------------------------------------------------  Bpm -> D*hpm -------------------------------------------------------------------------
-
-  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
-  // https://arxiv.org/abs/2012.09903
-  // Observables 18:
-  corr.ResizeTo(18);
-  corr(0) = acp_dstk_dg_uid5;
-  corr(1) = acp_dstk_dp_uid5;
-  corr(2) = afav_dstk_dg_uid5;
-  corr(3) = afav_dstk_dp_uid5;
-  corr(4) = rcp_dg_uid5;
-  corr(5) = rcp_dp_uid5;
-  corr(6) = rm_dstk_dg_uid5;
-  corr(7) = rm_dstk_dp_uid5;
-  corr(8) = rp_dstk_dg_uid5;
-  corr(9) = rp_dstk_dp_uid5;
-  corr(10) = acp_dstpi_dg_uid5;
-  corr(11) = acp_dstpi_dp_uid5;
-  corr(12) = rm_dstpi_dg_uid5;
-  corr(13) = rm_dstpi_dp_uid5;
-  corr(14) = rp_dstpi_dg_uid5;
-  corr(15) = rp_dstpi_dp_uid5;
-  corr(16) = afav_dstpi_dg_uid5;
-  corr(17) = afav_dstpi_dp_uid5;
-  ll1 += corrmeas.at("UID5").logweight(corr);
-
-
-  // GLW: D -> KK, D -> pipi, D -> K0spi0, ....
-  // https://arxiv.org/pdf/hep-ex/0601032
-  // Observables 4:
-  corr.ResizeTo(4);
-  corr(0) = Acp(r_dstk, d_dstk, 1., 0., 1.);
-  corr(1) = Rcp_h(r_dstk, d_dstk, r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 0., 1.) / Rcp_h(r_dstpi, d_dstpi, r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 0., 1.);
-  corr(2) = Acp(r_dstk, d_dstk, 1., 1., 1.);
-  corr(3) = Rcp_h(r_dstk, d_dstk, r_dstk, rD_kpi, d_dstk, dD_kpi, 1., 1., 1., 1.) / Rcp_h(r_dstpi, d_dstpi, r_dstpi, rD_kpi, d_dstpi, dD_kpi, 1., 1., 1., 1.);
-  ll1 += corrmeas.at("Belle_PRD73_2006").logweight(corr);
-
-
-  // GGSZ: D -> K0spipi
-  // https://arxiv.org/abs/1003.3360
-  // Observables 8:
-  corr.ResizeTo(8);
-  corr(0) = r_dstk * cos(d_dstk - g);
-  corr(1) = r_dstk * sin(d_dstk - g);
-  corr(2) = r_dstk * cos(d_dstk + g);
-  corr(3) = r_dstk * sin(d_dstk + g);
-  corr(4) = -r_dstk * cos(d_dstk - g);
-  corr(5) = -r_dstk * sin(d_dstk - g);
-  corr(6) = -r_dstk * cos(d_dstk + g);
-  corr(7) = -r_dstk * sin(d_dstk + g);
-  ll1 += corrmeas.at("Belle_PRD81_2010").logweight(corr);
-
-
-  //----------------------------------------------------------------------------------------------------------------------------------
-
-  //-------------------------------------------------  Bpm -> DKstpm -------------------------------------------------------------------------
-
-  // Bpm -> DK^*pm
-  // https://arxiv.org/pdf/hep-ex/0604054 (Belle)
-  corr.ResizeTo(4);
-  corr(0) = r_dkst * cos(d_dkst + g);
-  corr(1) = r_dkst * sin(d_dkst + g);
-  corr(2) = r_dkst * cos(d_dkst - g);
-  corr(3) = r_dkst * sin(d_dkst - g);
-  ll1 += corrmeas.at("0604054").logweight(corr);
-
-  // GLW: D -> KK, D -> pipi, D -> 4pi; ADS: D -> Kpi, D -> K3pi
-  // LHCb-PAPER-2024-023
-  // Observables 12:
-  corr.ResizeTo(12);
-  corr(0) = afav_dkst_kpi;
-  corr(1) = acp_dkst_kk;
-  corr(2) = acp_dkst_pipi;
-  corr(3) = asup_dkst_kpi;
-  corr(4) = rcp_dkst_kk;
-  corr(5) = rcp_dkst_pipi;
-  corr(6) = rsup_dkst_kpi;
-  corr(7) = afav_dkst_k3pi;
-  corr(8) = acp_dkst_pipipipi;
-  corr(9) = asup_dkst_k3pi;
-  corr(10) = rcp_dkst_pipipipi;
-  corr(11) = rsup_dkst_k3pi;
-  ll1 += corrmeas.at("LHCB-PAPER-2024-023-GLWADS").logweight(corr);
-
-
-  // Coherence factor kappakstpm
-  // https://arxiv.org/pdf/1709.05855
-  ll1 += meas.at("UID24").logweight(k_dkst_uid24);
-
-  //----------------------------------------------------------------------------------------------------------------------------------
-
-  //-------------------------------------------------  Bpm -> Dhpipi -------------------------------------------------------------------------
-
-  // GLW: D -> KK, D -> pipi; ADS: D -> Kpi
-  // https://arxiv.org/pdf/1505.07044
-  // Observables 11:
-  corr.ResizeTo(11);
-  corr(0) = rcp_dkpipi_uid9;
-  corr(1) = afav_dkpipi_kpi_uid9;
-  corr(2) = afav_dpipipi_kpi_uid9;
-  corr(3) = acp_dkpipi_kk_uid9;
-  corr(4) = acp_dkpipi_pipi_uid9;
-  corr(5) = acp_dpipipi_kk_uid9;
-  corr(6) = acp_dpipipi_pipi_uid9;
-  corr(7) = rp_dkpipi_uid9;
-  corr(8) = rm_dkpipi_uid9;
-  corr(9) = rp_dpipipi_uid9;
-  corr(10) = rm_dpipipi_uid9;
-  ll1 += corrmeas.at("UID9").logweight(corr);
-
-  return ll1;
-}
-// ---------------------------------------------------------
-
-// ---------------------------------------------------------
-double MixingModel::Calculate_neutralBdobservables()
+void MixingModel::SetIncrementalValidation(bool v)
 {
-
-  double ll2;
-  ll2 = 0.;
-
-  // 26. PDF: dkstzcoherence (UID25)
-  //  1 Osservabile
-  k_dkstz_uid25 = k_dkstz;
-
-  //----------------------------------------------- Calculating time Integrated B0d observables -------------------------------------------------------------------------
-
-  // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
-  // Observables 12:
-  acp_dkstz_kk_240117934Bd = Acp(r_dkstz, d_dkstz, k_dkstz, 1., 1.34);
-  acp_dkstz_pipi_240117934Bd = Acp(r_dkstz, d_dkstz, k_dkstz, 1., 1.34);
-  rcp_dkstz_kk_240117934Bd = Rcp_h(r_dkstz, d_dkstz, r_dkstz, rD_kpi, d_dkstz, dD_kpi, k_dkstz, 1., 1., 1.34);
-  rcp_dkstz_pipi_240117934Bd = Rcp_h(r_dkstz, d_dkstz, r_dkstz, rD_kpi, d_dkstz, dD_kpi, k_dkstz, 1., 1., 1.34);
-  acp_dkstz_4pi_240117934Bd = Acp(r_dkstz, d_dkstz, k_dkstz, F_pipipipi, 1.34);
-  rcp_dkstz_4pi_240117934Bd = Rcp_h(r_dkstz, d_dkstz, r_dkstz, rD_k3pi, d_dkstz, dD_k3pi, k_dkstz, kD_k3pi, F_pipipipi, 1.34);
-  rp_dkstz_kpi_240117934Bd = Rp(r_dkstz, rD_kpi, d_dkstz, dD_kpi, k_dkstz, 1., 1.34);
-  rm_dkstz_kpi_240117934Bd = Rm(r_dkstz, rD_kpi, d_dkstz, dD_kpi, k_dkstz, 1., 1.34);
-  rp_dkstz_k3pi_240117934Bd = Rp(r_dkstz, rD_k3pi, d_dkstz, dD_k3pi, k_dkstz, kD_k3pi, 1.34);
-  rm_dkstz_k3pi_240117934Bd = Rm(r_dkstz, rD_k3pi, d_dkstz, dD_k3pi, k_dkstz, kD_k3pi, 1.34);
-  afav_dkstz_kpi_240117934Bd = Afav(r_dkstz, rD_kpi, d_dkstz, dD_kpi, k_dkstz, 1., 1.34);
-  afav_dkstz_k3pi_240117934Bd = Afav(r_dkstz, rD_k3pi, d_dkstz, dD_k3pi, k_dkstz, kD_k3pi, 1.34);
-
-
-  xm_dkstz_230905514 = r_dkstz * cos(d_dkstz - g);
-  ym_dkstz_230905514 = r_dkstz * sin(d_dkstz - g);
-  xp_dkstz_230905514 = r_dkstz * cos(d_dkstz + g);
-  yp_dkstz_230905514 = r_dkstz * sin(d_dkstz + g);
-
-  //----------------------------------------------- Calculating time dependent B0d observables -------------------------------------------------------------------------
-
-
-  s_dmpi_uid12 = -(2 * l_dmpi * sin(d_dmpi - (phi_d + g))) / (1 + l_dmpi * l_dmpi);
-  sb_dmpi_uid12 = (2 * l_dmpi * sin(d_dmpi + (phi_d + g))) / (1 + l_dmpi * l_dmpi);
-
-  //-------------------------------------- Babar Measurements -------------------------------------------------------------------------
-
-  // https://arxiv.org/pdf/hep-ex/0602049
-  double a_Dpi = -2 * l_dmpi / (1 + l_dmpi * l_dmpi) * sin(phi_d + g) * cos(d_dmpi);
-  double c_Dpi = -2 * l_dmpi / (1 + l_dmpi * l_dmpi) * cos(phi_d + g) * sin(d_dmpi);
-  double a_Dstarpi = -2 * l_dstarmpi / (1 + l_dstarmpi * l_dstarmpi) * sin(phi_d + g) * cos(d_dstarmpi);
-  double c_Dstarpi = -2 * l_dstarmpi / (1 + l_dstarmpi * l_dstarmpi) * cos(phi_d + g) * sin(d_dstarmpi);
-  double a_Drho = -2 * l_dmrho / (1 + l_dmrho * l_dmrho) * sin(phi_d + g) * cos(d_dmrho);
-  double c_Drho = -2 * l_dmrho / (1 + l_dmrho * l_dmrho) * cos(phi_d + g) * sin(d_dmrho);
-
-
-  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
-
-  TVectorD corr(8);
-
-  if (comb == 1)
-  { // If treating it seprately from the Bs counterpart
-
-    corr.ResizeTo(12);
-    corr(0) = afav_dkstz_kpi_240117934Bd;
-    corr(1) = rp_dkstz_kpi_240117934Bd;
-    corr(2) = rm_dkstz_kpi_240117934Bd;
-    corr(3) = afav_dkstz_k3pi_240117934Bd;
-    corr(4) = rp_dkstz_k3pi_240117934Bd;
-    corr(5) = rm_dkstz_k3pi_240117934Bd;
-    corr(6) = acp_dkstz_kk_240117934Bd;
-    corr(7) = rcp_dkstz_kk_240117934Bd;
-    corr(8) = acp_dkstz_pipi_240117934Bd;
-    corr(9) = rcp_dkstz_pipi_240117934Bd;
-    corr(10) = acp_dkstz_4pi_240117934Bd;
-    corr(11) = rcp_dkstz_4pi_240117934Bd;
-    ll2 += corrmeas.at("2401.17934Bd").logweight(corr);
-
-    corr.ResizeTo(4);
-    corr(0) = xp_dkstz_230905514;
-    corr(1) = xm_dkstz_230905514;
-    corr(2) = yp_dkstz_230905514;
-    corr(3) = ym_dkstz_230905514;
-    ll2 += corrmeas.at("2309.05514").logweight(corr);
-
-  }
-  else if (comb == 3)
-  {
-
-    corr.ResizeTo(26);
-
-    corr(0) = xm_dk_uid3;
-    corr(1) = ym_dk_uid3;
-    corr(2) = xp_dk_uid3;
-    corr(3) = yp_dk_uid3;
-    corr(4) = xi_x_dpi_uid3;
-    corr(5) = xi_y_dpi_uid3;
-
-    corr(6) = r_dstk * cos(d_dstk + g);
-    corr(7) = r_dstk * cos(d_dstk - g);
-    corr(8) = r_dstk * sin(d_dstk + g);
-    corr(9) = r_dstk * sin(d_dstk - g);
-    corr(10) = r_dstpi / r_dstk * cos(d_dstpi - d_dstk);
-    corr(11) = r_dstpi / r_dstk * sin(d_dstpi - d_dstk);
-
-    corr(12) = r_dstk * cos(d_dstk - g);
-    corr(13) = r_dstk * sin(d_dstk - g);
-    corr(14) = r_dstk * cos(d_dstk + g);
-    corr(15) = r_dstk * sin(d_dstk + g);
-    corr(16) = r_dstpi / r_dstk * cos(d_dstpi - d_dstk);
-    corr(17) = r_dstpi / r_dstk * sin(d_dstpi - d_dstk);
-
-    corr(18) = r_dkst * cos(d_dkst - g);
-    corr(19) = r_dkst * sin(d_dkst - g);
-    corr(20) = r_dkst * cos(d_dkst + g);
-    corr(21) = r_dkst * sin(d_dkst + g);
-
-    corr(22) = xp_dkstz_230905514;
-    corr(23) = xm_dkstz_230905514;
-    corr(24) = yp_dkstz_230905514;
-    corr(25) = ym_dkstz_230905514;
-    ll2 += corrmeas.at("DKst0Pcomb").logweight(corr);
-
-  }
-
-
-  //  https://arxiv.org/pdf/1509.01098 (Belle)
-  corr.ResizeTo(4);
-  corr(0) = r_dkstz * cos( d_dkstz + g );
-  corr(1) = r_dkstz * sin( d_dkstz + g );
-  corr(2) = r_dkstz * cos( d_dkstz - g );
-  corr(3) = r_dkstz * sin( d_dkstz - g );
-  ll2 += corrmeas.at("1509.01098").logweight(corr);
-
-
-  corr.ResizeTo(2);
-  corr(0) = s_dmpi_uid12;
-  corr(1) = sb_dmpi_uid12;
-  ll2 += corrmeas.at("UID12").logweight(corr);
-
-
-  //-------------------------------------- Babar Measurements -------------------------------------------------------------------------
-  // https://arxiv.org/pdf/hep-ex/0602049
-  ll2+= meas.at("0602049_aDpi").logweight(a_Dpi);
-  ll2+= meas.at("0602049_cDpi").logweight(c_Dpi);
-  ll2+= meas.at("0602049_aDstarpi").logweight(a_Dstarpi);
-  ll2+=meas.at("0602049_cDstarpi").logweight(c_Dstarpi);
-  ll2+=meas.at("0602049_aDrho").logweight(a_Drho);
-  ll2+=meas.at("0602049_cDrho").logweight(c_Drho);
-
-  // https://arxiv.org/pdf/hep-ex/0504035
-  ll2+=meas.at("0504035_aDstarpi").logweight(a_Dstarpi);
-  ll2+=meas.at("0504035_cDstarpi").logweight(c_Dstarpi);
-
-
-  ll2 += meas.at("UID25").logweight(k_dkstz_uid25);
-
-  ll2 += meas.at("UID27").logweight(sin(phi_d));
-
-
-  //-------------------------------------- Belle Measurements -------------------------------------------------------------------------
-
-  // https://arxiv.org/pdf/hep-ex/0604013 (HFLAV conversion)
-  ll2+= meas.at("0604013_aDpi").logweight(a_Dpi);
-  ll2+= meas.at("0604013_cDpi").logweight(c_Dpi);
-  ll2+= meas.at("0604013_aDstarpi").logweight(a_Dstarpi);
-  ll2+=meas.at("0604013_cDstarpi").logweight(c_Dstarpi);
-
-  // https://arxiv.org/pdf/1102.0888
-  ll2+= meas.at("11020888_aDstarpi").logweight(a_Dstarpi);
-  ll2+=meas.at("11020888_cDstarpi").logweight(c_Dstarpi);
-
-
-
-  return ll2;
+  for (unsigned t = 0; t < contexts.size(); t++)
+    contexts[t].validate = v;
 }
 // ---------------------------------------------------------
 
-// ---------------------------------------------------------
-double MixingModel::Calculate_neutralBsobservables()
+MixingContext& MixingModel::GetContext()
 {
-
-  double ll2;
-  ll2 = 0.;
-
-  //----------------------------------------------- Calculating time Integrated B0d observables -------------------------------------------------------------------------
-
-  acp_dkstz_kk_240117934Bs = Acp(r_dkstzs, d_dkstzs, k_dkstzs, 1., 1.34);
-  acp_dkstz_pipi_240117934Bs = Acp(r_dkstzs, d_dkstzs, k_dkstzs, 1., 1.34);
-  rcp_dkstz_kk_240117934Bs = Rcp_h(r_dkstzs, d_dkstzs, r_dkstzs, rD_kpi, d_dkstzs, dD_kpi, k_dkstzs, 1., 1., 1.34);
-  rcp_dkstz_pipi_240117934Bs = Rcp_h(r_dkstzs, d_dkstzs, r_dkstzs, rD_kpi, d_dkstzs, dD_kpi, k_dkstzs, 1., 1., 1.34);
-  acp_dkstz_4pi_240117934Bs = Acp(r_dkstzs, d_dkstzs, k_dkstzs, F_pipipipi, 1.34);
-  rcp_dkstz_4pi_240117934Bs = Rcp_h(r_dkstzs, d_dkstzs, r_dkstzs, rD_k3pi, d_dkstzs, dD_k3pi, k_dkstzs, kD_k3pi, F_pipipipi, 1.34);
-  rp_dkstz_kpi_240117934Bs = Rp(r_dkstzs, rD_kpi, d_dkstzs, dD_kpi, k_dkstzs, 1., 1.34);
-  rm_dkstz_kpi_240117934Bs = Rm(r_dkstzs, rD_kpi, d_dkstzs, dD_kpi, k_dkstzs, 1., 1.34);
-  rp_dkstz_k3pi_240117934Bs = Rp(r_dkstzs, rD_k3pi, d_dkstzs, dD_k3pi, k_dkstzs, kD_k3pi, 1.34);
-  rm_dkstz_k3pi_240117934Bs = Rm(r_dkstzs, rD_k3pi, d_dkstzs, dD_k3pi, k_dkstzs, kD_k3pi, 1.34);
-  afav_dkstz_kpi_240117934Bs = Afav(r_dkstzs, rD_kpi, d_dkstzs, dD_kpi, k_dkstzs, 1., 1.34);
-  afav_dkstz_k3pi_240117934Bs = Afav(r_dkstzs, rD_k3pi, d_dkstzs, dD_k3pi, k_dkstzs, kD_k3pi, 1.34);
-
-  //----------------------------------------------- Calculating time dependent B0s observables -------------------------------------------------------------------------
-
-  c_dsk_uid10 = (1 - l_dsk * l_dsk) / (1 + l_dsk * l_dsk);
-  d_dsk_uid10 = -(2 * l_dsk * cos(d_dsk - (g + phis))) / (1 + l_dsk * l_dsk); // phis = - 2 beta_s
-  db_dsk_uid10 = -(2 * l_dsk * cos(d_dsk + (g + phis))) / (1 + l_dsk * l_dsk);
-  s_dsk_uid10 = (2 * l_dsk * sin(d_dsk - (g + phis))) / (1 + l_dsk * l_dsk);
-  sb_dsk_uid10 = -(2 * l_dsk * sin(d_dsk + (g + phis))) / (1 + l_dsk * l_dsk);
-
-
-  c_dskpipi_uid11 = (1 - l_dskpipi * l_dskpipi) / (1 + l_dskpipi * l_dskpipi);
-  d_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * cos(d_dskpipi - (g + phis))) / (1 + l_dskpipi * l_dskpipi);
-  db_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * cos(d_dskpipi + (g + phis))) / (1 + l_dskpipi * l_dskpipi);
-  s_dskpipi_uid11 = (2 * k_dskpipi * l_dskpipi * sin(d_dskpipi - (g + phis))) / (1 + l_dskpipi * l_dskpipi);
-  sb_dskpipi_uid11 = -(2 * k_dskpipi * l_dskpipi * sin(d_dskpipi + (g + phis))) / (1 + l_dskpipi * l_dskpipi);
-
-  phis_uid26 = phis; // -2 betas
-
-  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
-
-  TVectorD corr(8);
-
-  if (comb == 2)
-  { // If treating it separately from Bd counterpart
-
-    // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
-    // Observables 12:
-    corr.ResizeTo(12);
-    corr(0) = afav_dkstz_kpi_240117934Bs;
-    corr(1) = rp_dkstz_kpi_240117934Bs;
-    corr(2) = rm_dkstz_kpi_240117934Bs;
-    corr(3) = afav_dkstz_k3pi_240117934Bs;
-    corr(4) = rp_dkstz_k3pi_240117934Bs;
-    corr(5) = rm_dkstz_k3pi_240117934Bs;
-    corr(6) = acp_dkstz_kk_240117934Bs;
-    corr(7) = rcp_dkstz_kk_240117934Bs;
-    corr(8) = acp_dkstz_pipi_240117934Bs;
-    corr(9) = rcp_dkstz_pipi_240117934Bs;
-    corr(10) = acp_dkstz_4pi_240117934Bs;
-    corr(11) = rcp_dkstz_4pi_240117934Bs;
-
-    ll2 += corrmeas.at("2401.17934Bs").logweight(corr);
+#ifdef _OPENMP
+  // thread number in the innermost active parallel region, also when called from a serialized nested region
+  unsigned t = omp_get_ancestor_thread_num(omp_get_active_level());
+  if (t >= contexts.size())
+  { // the contexts are created for omp_get_max_threads() threads when the model is built
+    cout << "Thread " << t << " of a team larger than the " << contexts.size() << " threads the model was built for: "
+         << "set the number of threads before building it" << endl;
+    exit(EXIT_FAILURE);
   }
-  else if (comb == 3)
-  { // When using also the Bd counterpart
-
-    // PDF: glwads-dkst-hh-Kpi-h3pi-dmix (2401.17934)
-    // Observables 24:
-    corr.ResizeTo(24); // Bd  part
-    corr(0) = afav_dkstz_kpi_240117934Bd;
-    corr(1) = rp_dkstz_kpi_240117934Bd;
-    corr(2) = rm_dkstz_kpi_240117934Bd;
-    corr(3) = afav_dkstz_k3pi_240117934Bd;
-    corr(4) = rp_dkstz_k3pi_240117934Bd;
-    corr(5) = rm_dkstz_k3pi_240117934Bd;
-    corr(6) = acp_dkstz_kk_240117934Bd;
-    corr(7) = rcp_dkstz_kk_240117934Bd;
-    corr(8) = acp_dkstz_pipi_240117934Bd;
-    corr(9) = rcp_dkstz_pipi_240117934Bd;
-    corr(10) = acp_dkstz_4pi_240117934Bd;
-    corr(11) = rcp_dkstz_4pi_240117934Bd;
-
-    // Bs part
-    corr(12) = afav_dkstz_kpi_240117934Bs;
-    corr(13) = rp_dkstz_kpi_240117934Bs;
-    corr(14) = rm_dkstz_kpi_240117934Bs;
-    corr(15) = afav_dkstz_k3pi_240117934Bs;
-    corr(16) = rp_dkstz_k3pi_240117934Bs;
-    corr(17) = rm_dkstz_k3pi_240117934Bs;
-    corr(18) = acp_dkstz_kk_240117934Bs;
-    corr(19) = rcp_dkstz_kk_240117934Bs;
-    corr(20) = acp_dkstz_pipi_240117934Bs;
-    corr(21) = rcp_dkstz_pipi_240117934Bs;
-    corr(22) = acp_dkstz_4pi_240117934Bs;
-    corr(23) = rcp_dkstz_4pi_240117934Bs;
-
-    ll2 += corrmeas.at("2401.17934").logweight(corr);
-
-  }
-
-
-  corr.ResizeTo(5);
-  corr(0) = c_dsk_uid10;
-  corr(1) = d_dsk_uid10;
-  corr(2) = db_dsk_uid10;
-  corr(3) = s_dsk_uid10;
-  corr(4) = sb_dsk_uid10;
-  ll2 += corrmeas.at("BSDSKRun1").logweight(corr);
-  ll2 += corrmeas.at("BSDSKRun2").logweight(corr);
-
-
-  corr.ResizeTo(5);
-  corr(0) = c_dskpipi_uid11;
-  corr(1) = d_dskpipi_uid11;
-  corr(2) = db_dskpipi_uid11;
-  corr(3) = s_dskpipi_uid11;
-  corr(4) = sb_dskpipi_uid11;
-  ll2 += corrmeas.at("UID11").logweight(corr);
-
-
-  ll2 += meas.at("UID26").logweight(phis_uid26); // -2betas
-
-  return ll2;
-}
-// ---------------------------------------------------------
-
-// ---------------------------------------------------------
-double MixingModel::Calculate_time_dependent_Dobservables()
-{
-
-  double ll3;
-  ll3 = 0.;
-
-  xcp_uid14 = xcp;
-  ycp_uid14 = ycp;
-  dx_uid14 = dx;
-  dy_uid14 = dy;
-
-  ycp_uid28 = ycp + 0.5 * rD_kpi * (cos(phi) * (-y * cos(dD_kpi) - x * sin(dD_kpi)) * (qop + 1. / qop) + sin(phi) * (-y * sin(dD_kpi) + x * cos(dD_kpi)) * (qop - 1. / qop));
-
-  DY_uid29 = 0.5 * (-y * cos(phi) * (qop - 1. / qop) + x * sin(phi) * (qop + 1. / qop));
-
-  Rdp_uid30 = rD_kpi * rD_kpi * (1 + AD);
-  yp_uid30 = y_plus(dD_kpi);
-  xpsq_uid30 = x_plus(dD_kpi) * x_plus(dD_kpi);
-  Rdm_uid30 = rD_kpi * rD_kpi * (1 - AD);
-  ym_uid30 = y_minus(dD_kpi);
-  xmsq_uid30 = x_minus(dD_kpi) * x_minus(dD_kpi);
-
-  Akpi_BESIII = (-2 * rD_kpi * cos(dD_kpi) + y) / (1 + rD_kpi * rD_kpi);
-  Akpi_kpipi0_BESIII = (F_pipipi0 * (-2 * rD_kpi * cos(dD_kpi) + y)) / (1 + rD_kpi * rD_kpi + (1 - F_pipipi0) * (2 * rD_kpi * cos(dD_kpi) + y));
-
-  xi_x_BESIII = rD_kpi * cos(dD_kpi);
-  xi_y_BESIII = rD_kpi * sin(dD_kpi);
-
-  double tKKpitaggedOverTauD = tavepitaggedOverTauD + 0.5 * DeltatpitaggedOverTauD;
-  double tKKmutaggedOverTauD = tavemutaggedOverTauD + 0.5 * DeltatmutaggedOverTauD;
-  double tpipipitaggedOverTauD = tavepitaggedOverTauD - 0.5 * DeltatpitaggedOverTauD;
-  double tpipimutaggedOverTauD = tavemutaggedOverTauD - 0.5 * DeltatmutaggedOverTauD;
-  double DYKK = DY_uid29 + 0.5 * DYKKmDYpipi;
-  double DYpipi = DY_uid29 - 0.5 * DYKKmDYpipi;
-  double DeltaACP_pitagged = adKK - adpipi + tKKpitaggedOverTauD * DYKK - tpipipitaggedOverTauD * DYpipi;
-  double DeltaACP_mutagged = adKK - adpipi + tKKmutaggedOverTauD * DYKK - tpipimutaggedOverTauD * DYpipi;
-  double ACPKKDp = adKK + tKKCDp / tauD * DYKK;
-  double ACPKKDs = adKK + tKKCDs / tauD * DYKK;
-
-  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
-  TVectorD corr(8);
-
-  // Delta ACP; Acp(KK); Run1 semileptonic tagging
-  // https://arxiv.org/pdf/1405.2797
-  // Observables 4:
-  ll3 += meas.at("1405.2797_tKKOverTauD_DAcp").logweight(tauKK_DAcp_Run1_sl);
-  ll3 += meas.at("1405.2797_tpipiOverTauD_DAcp").logweight(taupipi_DAcp_Run1_sl);
-  ll3 += meas.at("1405.2797_tKKOverTauD_Acp").logweight(tauKK_Acp_Run1_sl);
-  corr.ResizeTo(3);
-  corr(0) = adKK - adpipi + tauKK_DAcp_Run1_sl * DYKK - taupipi_DAcp_Run1_sl * DYpipi; // DAcp Run1 sl
-  corr(1) = adKK + tauKK_Acp_Run1_sl * DYKK; // Acp(KK) sl
-  // ACP(KK); Run1 Hadronic tagging; Correlated due to the removing of the detection asymmetry
-  // https://arxiv.org/pdf/1610.09476
-  // Observables 1:
-  corr(2) = adKK + tauKK_Acp_Run1_pi * DYKK; // Acp(KK) pi-tagged
-  ll3 += corrmeas.at("1405.2797_1610.09476_Acp").logweight(corr);
-
-
-  // tOverTauD; Run1 Hadronic tagging;
-  // https://arxiv.org/pdf/1610.09476
-  // Observables 1:
-  ll3 += meas.at("1610.09476_tKKOverTauD").logweight(tauKK_Acp_Run1_pi);
-
-
-  // Delta ACP; Run1 Hadronic tagging
-  // https://arxiv.org/pdf/1602.03160
-  // Observables 3:
-  double DeltaACP_Run1_pitagged = adKK - adpipi + tauKK_DAcp_Run1_pi * DYKK - taupipi_DAcp_Run1_pi * DYpipi;
-  ll3 += meas.at("1602.03160_DeltaACPpitagged").logweight(DeltaACP_Run1_pitagged);
-  ll3 += meas.at("1602.03160_tKKOverTauD").logweight(tauKK_DAcp_Run1_pi);
-  ll3 += meas.at("1602.03160_tpipiOverTauD").logweight(taupipi_DAcp_Run1_pi);
-
-
-  // Delta ACP; Run2 Hadronic and Semileptonic tagging
-  // https://arxiv.org/pdf/1903.08726
-  // Observables 6:
-  ll3 += meas.at("DeltaACPpitagged").logweight(DeltaACP_pitagged);
-  ll3 += meas.at("DeltaACPmutagged").logweight(DeltaACP_mutagged);
-  ll3 += meas.at("tavepitaggedOverTauD").logweight(tavepitaggedOverTauD);
-  ll3 += meas.at("tavemutaggedOverTauD").logweight(tavemutaggedOverTauD);
-  ll3 += meas.at("DeltatmutaggedOverTauD").logweight(DeltatmutaggedOverTauD);
-  // tOverTauD; Run 2 Acp(KK); Correlated through reconstructed mean decay times
-  // https://arxiv.org/pdf/2209.03179
-  // Observables 2:
-  corr.ResizeTo(3);
-  corr(0) = tKKCDp;
-  corr(1) = tKKCDs;
-  corr(2) = DeltatpitaggedOverTauD;
-  ll3 += corrmeas.at("tausforDACP").logweight(corr);
-
-
-  // Run 2 Acp(KK)
-  // https://arxiv.org/pdf/2209.03179
-  // Observables 2:
-  corr.ResizeTo(2);
-  corr(0) = ACPKKDp;
-  corr(1) = ACPKKDs;
-  ll3 += corrmeas.at("ACPKK").logweight(corr);
-
-
-  // yCP - yCP(Kpi)
-  // HFLAV combo: https://hflav-eos.web.cern.ch/hflav-eos/charm/CKM23/results_mixing.html#kkpipi including latest https://arxiv.org/abs/2202.09106
-  ll3 += meas.at("UID28").logweight(ycp_uid28);
-
-
-  // ( DY(KK) + DY(pipi) )/2 LHCb combo Run1 + Run2
-  // https://arxiv.org/pdf/2105.09889
-  // Observables 1:
-  ll3 += meas.at("UID29").logweight(DY_uid29);
-
-
-  // ( DY(KK) - DY(pipi) ) LHCb combo Run1 + Run2
-  // https://arxiv.org/pdf/2105.09889
-  // Observables 1:
-  ll3 += meas.at("DYKKmDYpipi").logweight(DYKKmDYpipi);
-
-
-  // Agamma(KK) and Agamma(pipi) Full CDF
-  // https://arxiv.org/pdf/1410.5435
-  // Observables 2:
-  ll3 += meas.at("1410.5435_AGammaKK").logweight(-DYKK);
-  ll3 += meas.at("1410.5435_AGammapipi").logweight(-DYpipi);
-
-
-  // tOverTauD CDF
-  // https://arxiv.org/pdf/1111.5023
-  // Observables 2:
-  ll3 += meas.at("1111.5023_tKKOverTauD_CDF").logweight(tauKK_Acp_CDF);
-  ll3 += meas.at("1111.5023_tpipiOverTauD_CDF").logweight(taupipi_Acp_CDF);
-
-
-  // Acp(KK), Acp(pipi)
-  // https://arxiv.org/pdf/1208.2517
-  // Observables 2
-  double ACPKKCDF = adKK + tauKK_Acp_CDF * DYKK;
-  double ACPpipiCDF = adpipi + taupipi_Acp_CDF * DYpipi;
-  ll3 += meas.at("1208.2517_AcpKK_CDF").logweight(ACPKKCDF);
-  ll3 += meas.at("1208.2517_Acppipi_CDF").logweight(ACPpipiCDF);
-
-
-  // Acp(KK), Acp(pipi) Babar
-  // https://arxiv.org/pdf/0709.2715
-  // Observables 2
-  double ACPKKBfacts = adKK + DYKK; // B factories tau = 1
-  double ACPpipiBfacts = adpipi + DYpipi;
-  ll3 += meas.at("0709.2715_AcpKK_Babar").logweight(ACPKKBfacts);
-  ll3 += meas.at("0709.2715_Acppipi_Babar").logweight(ACPpipiBfacts);
-
-
-  // Acp(KK), Acp(pipi) Belle
-  // https://arxiv.org/pdf/0807.0148
-  // Observables 2
-  ll3 += meas.at("0807.0148_AcpKK_Belle").logweight(ACPKKBfacts);
-  ll3 += meas.at("0807.0148_Acppipi_Belle").logweight(ACPpipiBfacts);
-
-
-  CKpi = -y12 * cos(PhiG12) * cos(dD_kpi) + x12 * cos(PhiM12) * sin(dD_kpi);
-  CpKpi = 1. / 4. * (x12 * x12 + y12 * y12) + 0.25 * Rdp_uid30 * (y12 * y12 - x12 * x12);
-  DCKpi = -y12 * sin(PhiG12) * sin(dD_kpi) - x12 * sin(PhiM12) * cos(dD_kpi);
-  DCpKpi = 0.5 * x12 * y12 * sin(phi12);
-  double AtildeKpi = - 2. * adKK;
-  double DCtildeKpi = DCKpi - CKpi * adKK - 2. * rD_kpi * DYKK;
-  double DCtildepKpi = DCpKpi - 2. * CpKpi * adKK - 2. * rD_kpi * CKpi * DYKK;
-
-  corr.ResizeTo(9);
-  corr(0) = Rdp_uid30;
-  corr(1) = CKpi;
-  corr(2) = CpKpi;
-  corr(3) = AtildeKpi;
-  corr(4) = DCtildeKpi;
-  corr(5) = DCtildepKpi;
-  corr(6) = AD;
-  corr(7) = DCKpi;
-  corr(8) = DCpKpi;
-  ll3 += corrmeas.at("2407.18001").logweight(corr);
-
-
-  corr.ResizeTo(6);
-  corr(0) = Rdp_uid30;
-  corr(1) = CKpi;
-  corr(2) = CpKpi;
-  corr(3) = AD;
-  corr(4) = DCKpi;
-  corr(5) = DCpKpi;
-  ll3 += corrmeas.at("UID30").logweight(corr);
-
-
-  corr.ResizeTo(2);
-  corr(0) = Akpi_BESIII;
-  corr(1) = Akpi_kpipi0_BESIII;
-  ll3 += corrmeas.at("BESIII_Adk").logweight(corr);
-
-
-  corr.ResizeTo(2);
-  corr(0) = xi_x_BESIII;
-  corr(1) = xi_y_BESIII;
-  ll3 += corrmeas.at("BESIII_rDkpi_polar").logweight(corr);
-
-
-  corr.ResizeTo(4);
-  corr(0) = xcp_uid14;
-  corr(1) = ycp_uid14;
-  corr(2) = dx_uid14;
-  corr(3) = dy_uid14;
-
-  ll3 += corrmeas.at("UID14").logweight(corr);
-
-
-  corr.ResizeTo(4);
-  corr(0) = xcp;
-  corr(1) = ycp;
-  corr(2) = dx;
-  corr(3) = dy;
-
-  ll3 += corrmeas.at("LHCb_kspp_Au2022").logweight(corr);
-
-  return ll3;
-}
-// ---------------------------------------------------------
-
-// ---------------------------------------------------------
-double MixingModel::Calculate_other_observables()
-{
-
-  double ll4;
-  ll4 = 0.;
-
-  // 20. PDF: dk3pi_dkpipi0_constraints (UID19)
-  //  6 Observables
-  kD_k3pi_uid19 = kD_k3pi;
-  dD_k3pi_uid19 = dD_k3pi; // because of the phase sign convention
-  kD_kpipi0_uid19 = kD_kpipi0;
-  dD_kpipi0_uid19 = dD_kpipi0; // because of the phase sign convention
-  rD_k3pi_uid19 = rD_k3pi;
-  rD_kpipi0_uid19 = rD_kpipi0;
-
-  // 21. PDF: d4pi_dmixing_cleo (UID20)
-  //  1 Osservabile
-  F_pipipipi_uid20 = F_pipipipi;
-
-  // 22. PDF: CleoDhhpi0Dilution (UID21)
-  F_pipipi0_uid21 = F_pipipi0;
-  F_kkpi0_uid21 = F_kkpi0;
-
-  //----------------------------------------------- Other Observables-------------------------------------------------------------------------
-  // 14. PDF: charm-kspipi-nocpv (UID13)
-  // 2 Observables
-  x_uid13 = x;
-  y_uid13 = y;
-
-
-
-  // 23. PDF: dkskpiRWS (UID22)
-  //  1 Osservabile
-  RD_kskpi_uid22 = (rD_kskpi * rD_kskpi - rD_kskpi * kD_kskpi * (y * cos(dD_kskpi) - x * sin(dD_kskpi))) / (1. - rD_kskpi * kD_kskpi * (y * cos(dD_kskpi) + x * sin(dD_kskpi)));
-  // Relative Sign Problem
-
-  // 24. PDF: dkskpi (UID23)
-  //  3 Observables
-  RD_kskpi_uid23 = (rD_kskpi * rD_kskpi - rD_kskpi * kD_kskpi * (y * cos(dD_kskpi) - x * sin(dD_kskpi))) / (1. - rD_kskpi * kD_kskpi * (y * cos(dD_kskpi) + x * sin(dD_kskpi)));
-  dD_kskpi_uid23 = dD_kskpi;
-  kD_kskpi_uid23 = kD_kskpi;
-
-  F_pipipipi_BESIII = F_pipipipi;
-
-  //----------------------------------------------- Contribution to the LogLikelihood -------------------------------------------------------------------------
-  TVectorD corr(8);
-
-  // https://arxiv.org/pdf/2503.19542
-  ll4 += meas.at("BESIII_2503.19542_BrDKpi").logweight( rD_kpi * rD_kpi + rD_kpi * y_plus(dD_kpi) + 0.5 * x_plus(dD_kpi) * x_plus(dD_kpi) * y_plus(dD_kpi) * y_plus(dD_kpi) );
-  ll4 += meas.at("BESIII_2503.19542_BrDK3pi").logweight( rD_k3pi * rD_k3pi + kD_k3pi * rD_k3pi * y_plus(dD_k3pi) + 0.5 * x_plus(dD_k3pi) * x_plus(dD_k3pi) * y_plus(dD_k3pi) * y_plus(dD_k3pi) );
-  ll4 += meas.at("BESIII_2503.19542_BrDKpipi0").logweight( rD_kpipi0 * rD_kpipi0 + kD_kpipi0 * rD_kpipi0 * y_plus(dD_kpipi0) + 0.5 * x_plus(dD_kpipi0) * x_plus(dD_kpipi0) * y_plus(dD_kpipi0) * y_plus(dD_kpipi0) );
-
-
-
-  corr.ResizeTo(2);
-  corr(0) = F_pipipi0;
-  corr(1) = F_kkpi0;
-  ll4 += corrmeas.at("UID21").logweight(corr);
-
-
-  corr.ResizeTo(2);
-  corr(0) = F_pipipi0;
-  corr(1) = F_kkpi0;
-  ll4 += corrmeas.at("2409.07197_F_BESIII").logweight(corr);
-
-
-  ll4 += meas.at("UID20").logweight(F_pipipipi_uid20);
-
-
-  ll4 += meas.at("Fpipipipi_BESIII").logweight(F_pipipipi_BESIII);
-
-  ll4 += meas.at("FKKpipi_BESIII").logweight(F_kkpipi);
-
-
-  corr.ResizeTo(6);
-  corr(0) = kD_k3pi_uid19;
-  corr(1) = dD_k3pi_uid19;
-  corr(2) = kD_kpipi0_uid19;
-  corr(3) = dD_kpipi0_uid19;
-  corr(4) = rD_k3pi_uid19;
-  corr(5) = rD_kpipi0_uid19;
-  ll4 += corrmeas.at("UID19").logweight(corr);
-
-
-  ll4 += meas.at("UID22").logweight(RD_kskpi_uid22);
-
-
-  corr.ResizeTo(3);
-  corr(0) = RD_kskpi_uid23;
-  corr(1) = dD_kskpi_uid23;
-  corr(2) = kD_kskpi_uid23;
-
-  ll4 += corrmeas.at("UID23").logweight(corr);
-
-
-  return ll4;
+  return contexts[t];
+#else
+  return contexts[0];
+#endif
 }
-// ---------------------------------------------------------
-
-// ---------------------------------------------------------
-double MixingModel::Calculate_old_observables()
-{
-
-  double llo;
-  llo = 0.;
-
-  Rd = rD_kpi * rD_kpi;
-
-  // 6th Block
-  rm = (x * x + y * y) / 2.;
-
-  yp_kpp_plus = y_plus(dD_kpipi0);
-  xp_kpp_plus = x_plus(dD_kpipi0);
-
-  yp_kpp_minus = y_minus(dD_kpipi0);
-  xp_kpp_minus = x_minus(dD_kpipi0);
-
-  yp_plus = y_plus(dD_kpi);
-  xp_plus = x_plus(dD_kpi);
-  xp_plus_sq = xp_plus * xp_plus;
-
-  yp_minus = y_minus(dD_kpi);
-  xp_minus = x_minus(dD_kpi);
-  xp_minus_sq = xp_minus * xp_minus;
-
-  TVectorD corr(4);
-
-
-  corr.ResizeTo(3);
-  corr(0) = Rd;
-  corr(1) = xp_plus_sq;
-  corr(2) = yp_plus;
-  llo += corrmeas.at("kpi_babar_plus").logweight(corr);
-  llo += corrmeas.at("kpi_belle_plus").logweight(corr);
-
-  corr(0) = AD;
-  corr(1) = xp_minus_sq;
-  corr(2) = yp_minus;
-  llo += corrmeas.at("kpi_babar_minus").logweight(corr);
-  llo += corrmeas.at("kpi_belle_minus").logweight(corr);
-
-
-
-  corr.ResizeTo(5);
-  corr(0) = Rd;
-  corr(1) = x * x;
-  corr(2) = y;
-  corr(3) = cos(M_PI - dD_kpi);
-  corr(4) = sin(M_PI - dD_kpi);
-  llo += corrmeas.at("cleoc").logweight(corr);
 
-  // 3rd Block
-  double epsI = 2.228 * sin(43.5 * M_PI / 180.) * 1.e-3; // values taken from PDG: https://pdglive.lbl.gov/ParticleGroup.action?init=0&node=MXXX020
-  double RCKM = 0.00384 * 0.04120 / 0.2251 / 0.97345 * sin(g); // values taken from https://indico.cern.ch/event/1291157/contributions/5903548/attachments/2900988/5087304/bona-utfit.pdf
-  corr.ResizeTo(4);
-  corr(0) = x;
-  corr(1) = y;
-  corr(2) = qop;
-  corr(3) = phi - 2*epsI - RCKM; // Because of B-factories
-  llo += corrmeas.at("kpp_belle").logweight(corr);
-
-
-  corr.ResizeTo(2);
-  corr(0) = x;
-  corr(1) = y;
-
-  llo += corrmeas.at("kppkk").logweight(corr);
-  llo += corrmeas.at("kppp0_Babar").logweight(corr);
-  llo += corrmeas.at("UID13").logweight(corr);
-
-
-  corr.ResizeTo(2);
-
-  corr(0) = xp_kpp_plus;
-  corr(1) = yp_kpp_plus;
-  llo += corrmeas.at("kpp_babar_plus").logweight(corr);
-
-  corr(0) = xp_kpp_minus;
-  corr(1) = yp_kpp_minus;
-  llo += corrmeas.at("kpp_babar_minus").logweight(corr);
-
-
-  k3pi_uid18 = 0.25 * (x * x + y * y);
-  llo += meas.at("UID18").logweight(k3pi_uid18);
-
-
-  llo += meas.at("RM").logweight(rm);
-
-  return llo;
-}
-// ---------------------------------------------------------
-
-double MixingModel::LogLikelihood(const std::vector<double> &parameters)
-{
-
-  double ll = 0.;
-
-  if (comb == 0)
-  {
-
-    // Variabili globali
-    g = parameters[0];
-    x12 = parameters[1];
-    y12 = parameters[2];
-
-    // 1. PDF: glwads-dh-hh-dmix (UID0)
-    r_dk = parameters[3];
-    r_dpi = parameters[4];
-    rD_kpi = parameters[5];
-    d_dk = parameters[6];
-    d_dpi = parameters[7];
-    dD_kpi = parameters[8];
-
-    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
-    rD_k3pi = parameters[9];
-    dD_k3pi = parameters[10];
-    kD_k3pi = parameters[11];
-    F_pipipipi = parameters[12];
-
-    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
-    rD_kpipi0 = parameters[13];
-    dD_kpipi0 = parameters[14];
-    kD_kpipi0 = parameters[15];
-    F_pipipi0 = parameters[16];
-    F_kkpi0 = parameters[17];
-
-    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
-    rD_kskpi = parameters[18];
-    dD_kskpi = parameters[19];
-    kD_kskpi = parameters[20];
-    RBRdkdpi = parameters[21];
-
-    // 6. PDF: glwads-dsth-hh-dmix (UID5)
-    r_dstk = parameters[22];
-    d_dstk = parameters[23];
-    r_dstpi = parameters[24];
-    d_dstpi = parameters[25];
-
-    // 7. PDF: glwads-dkst-hh-h3pi-dmix-newvars (UID6)
-    r_dkst = parameters[26];
-    d_dkst = parameters[27];
-    k_dkst = parameters[28];
-
-    // 10. PDF: glwads-dhpipi-hh-dmix (UID9)
-    r_dkpipi = parameters[29];
-    d_dkpipi = parameters[30];
-    k_dkpipi = parameters[31];
-    r_dpipipi = parameters[32];
-    d_dpipipi = parameters[33];
-    k_dpipipi = parameters[34];
-
-    // 15. PDF: charm-kspipi (UID14)
-    PhiM12 = parameters[35];
-    PhiG12 = parameters[36];
-
-    adKK = parameters[37];
-    adpipi = parameters[38];
-    DYKKmDYpipi = parameters[39];
-    tavepitaggedOverTauD = parameters[40];
-    tavemutaggedOverTauD = parameters[41];
-    DeltatmutaggedOverTauD = parameters[42];
-    DeltatpitaggedOverTauD = parameters[43];
-    tKKCDp = parameters[44];
-    tKKCDs = parameters[45];
-
-    F_kkpipi = parameters[46];
-
-    tauKK_DAcp_Run1_sl = parameters[47];
-    taupipi_DAcp_Run1_sl = parameters[48];
-    tauKK_Acp_Run1_sl = parameters[49];
-
-    tauKK_DAcp_Run1_pi = parameters[50];
-    taupipi_DAcp_Run1_pi = parameters[51];
-    tauKK_Acp_Run1_pi = parameters[52];
-
-    tauKK_Acp_CDF = parameters[53];
-    taupipi_Acp_CDF = parameters[54];
-
-    // General parameters
-    AD = 0.; // NO direct CPV for CF/DCS
-    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
-    x = x12;
-    y = y12;
-    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
-    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
-    d = (1. - qop * qop) / (1. + qop * qop);
-
-    xcp = 0.5 * (x * cos(phi) * (qop + 1. / qop) + y * sin(phi) * (qop - 1. / qop));
-    ycp = 0.5 * (y * cos(phi) * (qop + 1. / qop) - x * sin(phi) * (qop - 1. / qop));
-    dx = 0.5 * (x * cos(phi) * (qop - 1. / qop) + y * sin(phi) * (qop + 1. / qop));
-    dy = 0.5 * (y * cos(phi) * (qop - 1. / qop) - x * sin(phi) * (qop + 1. / qop));
-
-    //---------------------------------------------------- Contribution to the LogLikelihood of the charged B measurements  ----------------------------------------------------
-    ll += Calculate_ChargedB_observables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables ----------------------------------------------------
-    ll += Calculate_time_dependent_Dobservables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
-    ll += Calculate_other_observables();
-    //-----------------------------------------------  Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
-    ll += Calculate_old_observables();
-
-    //---------------------------------- Fill the Histograms ---------------------
-
-    // Time Integrated B decay chain
-    obs["g"] = g * r2d;
-    obs["x12"] = x12 * 1000;
-    obs["y12"] = y12 * 1000;
-    obs["r_dk"] = r_dk * 100;
-    obs["r_dpi"] = r_dpi * 1000;
-    obs["rD_kpi"] = rD_kpi * 100;
-    obs["d_dk"] = d_dk * r2d;
-    obs["d_dpi"] = d_dpi * r2d;
-    obs["dD_kpi"] = dD_kpi * r2d;
-    obs["rD_k3pi"] = rD_k3pi;
-    obs["dD_k3pi"] = dD_k3pi * r2d;
-    obs["kD_k3pi"] = kD_k3pi;
-    obs["F_pipipipi"] = F_pipipipi;
-    obs["rD_kpipi0"] = rD_kpipi0;
-    obs["dD_kpipi0"] = dD_kpipi0 * r2d;
-    obs["kD_kpipi0"] = kD_kpipi0;
-    obs["F_pipipi0"] = F_pipipi0;
-    obs["F_kkpi0"] = F_kkpi0;
-    obs["rD_kskpi"] = rD_kskpi;
-    obs["dD_kskpi"] = dD_kskpi * r2d;
-    obs["kD_kskpi"] = kD_kskpi;
-    obs["RBRdkdpi"] = RBRdkdpi;
-    obs["r_dstk"] = r_dstk;
-    obs["d_dstk"] = d_dstk * r2d;
-    obs["r_dstpi"] = r_dstpi;
-    obs["d_dstpi"] = d_dstpi * r2d;
-    obs["r_dkst"] = r_dkst;
-    obs["d_dkst"] = d_dkst * r2d;
-    obs["k_dkst"] = k_dkst;
-    obs["r_dkpipi"] = r_dkpipi;
-    obs["d_dkpipi"] = d_dkpipi * r2d;
-    obs["k_dkpipi"] = k_dkpipi;
-    obs["r_dpipipi"] = r_dpipipi;
-    obs["d_dpipipi"] = d_dpipipi * r2d;
-    obs["k_dpipipi"] = k_dpipipi;
-    obs["F_kkpipi"] = F_kkpipi;
-
-    // Time dependent D decay and mixing
-    obs["PhiM12"] = PhiM12 * r2d;
-    obs["PhiG12"] = PhiG12 * r2d;
-    obs["phipphig12"] = remainder(PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["phimphig12"] = remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["AD"] = AD;
-    obs["adKK"] = adKK * 1000;
-    obs["adpipi"] = adpipi * 1000;
-    obs["qopm1"] = (qop - 1) * 100;
-    obs["qop"] = qop;
-    obs["phi"] = phi * r2d;
-    obs["phi12"] = phi12 * r2d;
-    obs["delta"] = d;
-
-    obs["x"] = x * 1000;
-    obs["y"] = y * 1000;
-    obs["M12"] = 0.5 * x12 / tau;
-    obs["G12"] = y12 / tau;
-    obs["ImM12"] = 0.5 * x12 / tau * sin(PhiM12);
-  }
-  else if (comb == 1)
-  {
-
-    // Variabili globali
-    g = parameters[0];
-    x12 = parameters[1];
-    y12 = parameters[2];
-
-    // 1. PDF: glwads-dh-hh-dmix (UID0)
-    rD_kpi = parameters[3];
-    dD_kpi = parameters[4];
-
-    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
-    rD_k3pi = parameters[5];
-    dD_k3pi = parameters[6];
-    kD_k3pi = parameters[7];
-    F_pipipipi = parameters[8];
-
-    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
-    rD_kpipi0 = parameters[9];
-    dD_kpipi0 = parameters[10];
-    kD_kpipi0 = parameters[11];
-    F_pipipi0 = parameters[12];
-    F_kkpi0 = parameters[13];
-
-    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
-    rD_kskpi = parameters[14];
-    dD_kskpi = parameters[15];
-    kD_kskpi = parameters[16];
-
-    //  8. PDF: glwads-dkstz-hh-h3pi-dmix
-    r_dkstz = parameters[17];
-    d_dkstz = parameters[18];
-    k_dkstz = parameters[19];
-
-    // 13. PDF: dmpi (UID12)
-    l_dmpi = parameters[20];
-    d_dmpi = parameters[21];
-    phi_d = parameters[22];
-
-    // 15. PDF: charm-kspipi (UID14)
-    PhiM12 = parameters[23];
-    PhiG12 = parameters[24];
-
-    adKK = parameters[25];
-    adpipi = parameters[26];
-    DYKKmDYpipi = parameters[27];
-    tavepitaggedOverTauD = parameters[28];
-    tavemutaggedOverTauD = parameters[29];
-    DeltatmutaggedOverTauD = parameters[30];
-    DeltatpitaggedOverTauD = parameters[31];
-    tKKCDp = parameters[32];
-    tKKCDs = parameters[33];
-
-    F_kkpipi = parameters[34];
-
-    tauKK_DAcp_Run1_sl = parameters[35];
-    taupipi_DAcp_Run1_sl = parameters[36];
-    tauKK_Acp_Run1_sl = parameters[37];
-
-    tauKK_DAcp_Run1_pi = parameters[38];
-    taupipi_DAcp_Run1_pi = parameters[39];
-    tauKK_Acp_Run1_pi = parameters[40];
-
-    tauKK_Acp_CDF = parameters[41];
-    taupipi_Acp_CDF = parameters[42];
-
-    l_dstarmpi = parameters[43];
-    d_dstarmpi = parameters[44];
-    l_dmrho = parameters[45];
-    d_dmrho = parameters[46];
-
-    // General parameters
-    AD = 0.; // NO direct CPV for CF/DCS
-    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
-    x = x12;
-    y = y12;
-    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
-    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
-    d = (1. - qop * qop) / (1. + qop * qop);
-
-    xcp = 0.5 * (x * cos(phi) * (qop + 1. / qop) + y * sin(phi) * (qop - 1. / qop));
-    ycp = 0.5 * (y * cos(phi) * (qop + 1. / qop) - x * sin(phi) * (qop - 1. / qop));
-    dx = 0.5 * (x * cos(phi) * (qop - 1. / qop) + y * sin(phi) * (qop + 1. / qop));
-    dy = 0.5 * (y * cos(phi) * (qop - 1. / qop) - x * sin(phi) * (qop + 1. / qop));
-
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Bd observables  ----------------------------------------------------
-    ll += Calculate_neutralBdobservables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables ----------------------------------------------------
-    ll += Calculate_time_dependent_Dobservables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
-    ll += Calculate_other_observables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
-    ll += Calculate_old_observables();
-
-    //---------------------------------- Fill the Histograms ---------------------
-
-    // Time Integrated B decay chain
-    obs["g"] = g * r2d;
-    obs["x12"] = x12 * 1000;
-    obs["y12"] = y12 * 1000;
-    obs["rD_kpi"] = rD_kpi * 100;
-    obs["dD_kpi"] = dD_kpi * r2d;
-    obs["rD_k3pi"] = rD_k3pi;
-    obs["dD_k3pi"] = dD_k3pi * r2d;
-    obs["kD_k3pi"] = kD_k3pi;
-    obs["F_pipipipi"] = F_pipipipi;
-    obs["rD_kpipi0"] = rD_kpipi0;
-    obs["dD_kpipi0"] = dD_kpipi0 * r2d;
-    obs["kD_kpipi0"] = kD_kpipi0;
-    obs["F_pipipi0"] = F_pipipi0;
-    obs["F_kkpi0"] = F_kkpi0;
-    obs["rD_kskpi"] = rD_kskpi;
-    obs["dD_kskpi"] = dD_kskpi * r2d;
-    obs["kD_kskpi"] = kD_kskpi;
-    obs["r_dkstz"] = r_dkstz;
-    obs["d_dkstz"] = d_dkstz * r2d;
-    obs["k_dkstz"] = k_dkstz;
-
-    // Time dependent B decay chain
-    obs["l_dmpi"] = l_dmpi;
-    obs["d_dmpi"] = d_dmpi * r2d;
-    obs["beta"] = phi_d*0.5 * r2d;
-    obs["phid"] = phi_d * r2d;
-
-    // Time dependent D decay and mixing
-    obs["PhiM12"] = PhiM12 * r2d;
-    obs["PhiG12"] = PhiG12 * r2d;
-    obs["phipphig12"] = remainder(PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["phimphig12"] = remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["AD"] = AD;
-    obs["adKK"] = adKK * 1000;
-    obs["adpipi"] = adpipi * 1000;
-    obs["qopm1"] = (qop - 1) * 100;
-    obs["qop"] = qop;
-    obs["phi"] = phi * r2d;
-    obs["phi12"] = phi12 * r2d;
-    obs["delta"] = d;
-
-    obs["x"] = x * 1000;
-    obs["y"] = y * 1000;
-    obs["M12"] = 0.5 * x12 / tau ;
-    obs["G12"] = y12 / tau ;
-    obs["ImM12"] = 0.5 * x12 / tau * sin(PhiM12);
-
-  }
-  else if (comb == 2)
-  {
-
-    // Variabili globali
-    g = parameters[0];
-    x12 = parameters[1];
-    y12 = parameters[2];
-
-    // 1. PDF: glwads-dh-hh-dmix (UID0)
-    rD_kpi = parameters[3];
-    dD_kpi = parameters[4];
-
-    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
-    rD_k3pi = parameters[5];
-    dD_k3pi = parameters[6];
-    kD_k3pi = parameters[7];
-    F_pipipipi = parameters[8];
-
-    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
-    rD_kpipi0 = parameters[9];
-    dD_kpipi0 = parameters[10];
-    kD_kpipi0 = parameters[11];
-    F_pipipi0 = parameters[12];
-    F_kkpi0 = parameters[13];
-
-    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
-    rD_kskpi = parameters[14];
-    dD_kskpi = parameters[15];
-    kD_kskpi = parameters[16];
-
-    // 11. PDF: dsk (UID10)
-    l_dsk = parameters[17];
-    d_dsk = parameters[18];
-    phis = parameters[19];
-
-    // 12. PDF: dskpipi (UID11)
-    l_dskpipi = parameters[20];
-    d_dskpipi = parameters[21];
-    k_dskpipi = parameters[22];
-
-    // 15. PDF: charm-kspipi (UID14)
-    PhiM12 = parameters[23];
-    PhiG12 = parameters[24];
-
-    adKK = parameters[25];
-    adpipi = parameters[26];
-    DYKKmDYpipi = parameters[27];
-    tavepitaggedOverTauD = parameters[28];
-    tavemutaggedOverTauD = parameters[29];
-    DeltatmutaggedOverTauD = parameters[30];
-    DeltatpitaggedOverTauD = parameters[31];
-    tKKCDp = parameters[32];
-    tKKCDs = parameters[33];
-
-    F_kkpipi = parameters[34];
-
-    // 2401.17934 Bs part
-    r_dkstzs = parameters[35];
-    d_dkstzs = parameters[36];
-    k_dkstzs = parameters[37];
-
-    tauKK_DAcp_Run1_sl = parameters[38];
-    taupipi_DAcp_Run1_sl = parameters[39];
-    tauKK_Acp_Run1_sl = parameters[40];
-
-    tauKK_DAcp_Run1_pi = parameters[41];
-    taupipi_DAcp_Run1_pi = parameters[42];
-    tauKK_Acp_Run1_pi = parameters[43];
-
-    tauKK_Acp_CDF = parameters[44];
-    taupipi_Acp_CDF = parameters[45];
-
-    // General parameters
-    AD = 0.; // NO direct CPV for CF/DCS
-    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
-    x = x12;
-    y = y12;
-    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
-    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
-    d = (1. - qop * qop) / (1. + qop * qop);
-
-    xcp = 0.5 * (x * cos(phi) * (qop + 1. / qop) + y * sin(phi) * (qop - 1. / qop));
-    ycp = 0.5 * (y * cos(phi) * (qop + 1. / qop) - x * sin(phi) * (qop - 1. / qop));
-    dx = 0.5 * (x * cos(phi) * (qop - 1. / qop) + y * sin(phi) * (qop + 1. / qop));
-    dy = 0.5 * (y * cos(phi) * (qop - 1. / qop) - x * sin(phi) * (qop + 1. / qop));
-
-    //------------------------------------------------------  Contribution to the LogLikelihood of the B0s observables  ----------------------------------------------------
-    ll += Calculate_neutralBsobservables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables  ----------------------------------------------------
-    ll += Calculate_time_dependent_Dobservables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
-    ll += Calculate_other_observables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
-    ll += Calculate_old_observables();
-
-    //---------------------------------- Fill the Histograms ---------------------
-
-    // Time Integrated B decay chain
-    obs["g"] = g * r2d;
-    obs["x12"] = x12 * 1000;
-    obs["y12"] = y12 * 1000;
-    obs["rD_kpi"] = rD_kpi * 100;
-    obs["dD_kpi"] = dD_kpi * r2d;
-    obs["rD_k3pi"] = rD_k3pi;
-    obs["dD_k3pi"] = dD_k3pi * r2d;
-    obs["kD_k3pi"] = kD_k3pi;
-    obs["F_pipipipi"] = F_pipipipi;
-    obs["rD_kpipi0"] = rD_kpipi0;
-    obs["dD_kpipi0"] = dD_kpipi0 * r2d;
-    obs["kD_kpipi0"] = kD_kpipi0;
-    obs["F_pipipi0"] = F_pipipi0;
-    obs["F_kkpi0"] = F_kkpi0;
-    obs["rD_kskpi"] = rD_kskpi;
-    obs["dD_kskpi"] = dD_kskpi * r2d;
-    obs["kD_kskpi"] = kD_kskpi;
-
-    // Time integrated Bs chain
-    obs["r_dkstzs"] = r_dkstzs;
-    obs["d_dkstzs"] = d_dkstzs * r2d;
-    obs["k_dkstzs"] = k_dkstzs;
-
-    // Time dependent B decay chain
-
-    obs["l_dsk"] = l_dsk;
-    obs["d_dsk"] = d_dsk * r2d;
-    obs["phis"] = phis * r2d;
-    obs["beta_s"] = -0.5 * phis;
-    obs["l_dskpipi"] = l_dskpipi;
-    obs["d_dskpipi"] = d_dskpipi * r2d;
-    obs["k_dskpipi"] = k_dskpipi;
-
-    // Time dependent D decay and mixing
-    obs["PhiM12"] = PhiM12 * r2d;
-    obs["PhiG12"] = PhiG12 * r2d;
-    obs["phipphig12"] = remainder(PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["phimphig12"] = remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["AD"] = AD;
-    obs["adKK"] = adKK * 1000;
-    obs["adpipi"] = adpipi * 1000;
-    obs["qopm1"] = (qop - 1) * 100;
-    obs["qop"] = qop;
-    obs["phi"] = phi * r2d;
-    obs["phi12"] = phi12 * r2d;
-    obs["delta"] = d;
-
-    obs["x"] = x * 1000;
-    obs["y"] = y * 1000;
-    obs["M12"] = 0.5 * x12 / tau ;
-    obs["G12"] = y12 / tau ;
-    obs["ImM12"] = 0.5 * x12 / tau * sin(PhiM12);
-  }
-  else if (comb == 3)
-  {
-
-    // Variabili globali
-    g = parameters[0];
-    x12 = parameters[1];
-    y12 = parameters[2];
-
-    // 1. PDF: glwads-dh-hh-dmix (UID0)
-    r_dk = parameters[3];
-    r_dpi = parameters[4];
-    rD_kpi = parameters[5];
-    d_dk = parameters[6];
-    d_dpi = parameters[7];
-    dD_kpi = parameters[8];
-
-    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
-    rD_k3pi = parameters[9];
-    dD_k3pi = parameters[10];
-    kD_k3pi = parameters[11];
-    F_pipipipi = parameters[12];
-
-    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
-    rD_kpipi0 = parameters[13];
-    dD_kpipi0 = parameters[14];
-    kD_kpipi0 = parameters[15];
-    F_pipipi0 = parameters[16];
-    F_kkpi0 = parameters[17];
-
-    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
-    rD_kskpi = parameters[18];
-    dD_kskpi = parameters[19];
-    kD_kskpi = parameters[20];
-    RBRdkdpi = parameters[21];
-
-    // 6. PDF: glwads-dsth-hh-dmix (UID5)
-    r_dstk = parameters[22];
-    d_dstk = parameters[23];
-    r_dstpi = parameters[24];
-    d_dstpi = parameters[25];
-
-    // 7. PDF: glwads-dkst-hh-h3pi-dmix-newvars (UID6)
-    r_dkst = parameters[26];
-    d_dkst = parameters[27];
-    k_dkst = parameters[28];
-
-    //  8. PDF: glwads-dkstz-hh-h3pi-dmix
-    r_dkstz = parameters[29];
-    d_dkstz = parameters[30];
-    k_dkstz = parameters[31];
-
-    // 10. PDF: glwads-dhpipi-hh-dmix (UID9)
-    r_dkpipi = parameters[32];
-    d_dkpipi = parameters[33];
-    k_dkpipi = parameters[34];
-    r_dpipipi = parameters[35];
-    d_dpipipi = parameters[36];
-    k_dpipipi = parameters[37];
-
-    // 11. PDF: dsk (UID10)
-    l_dsk = parameters[38];
-    d_dsk = parameters[39];
-    phis = parameters[40];
-
-    // 12. PDF: dskpipi (UID11)
-    l_dskpipi = parameters[41];
-    d_dskpipi = parameters[42];
-    k_dskpipi = parameters[43];
-
-    // 13. PDF: dmpi (UID12)
-    l_dmpi = parameters[44];
-    d_dmpi = parameters[45];
-    phi_d = parameters[46];
-
-    // 15. PDF: charm-kspipi (UID14)
-    PhiM12 = parameters[47];
-    PhiG12 = parameters[48];
-
-    adKK = parameters[49];
-    adpipi = parameters[50];
-    DYKKmDYpipi = parameters[51];
-    tavepitaggedOverTauD = parameters[52];
-    tavemutaggedOverTauD = parameters[53];
-    DeltatmutaggedOverTauD = parameters[54];
-    DeltatpitaggedOverTauD = parameters[55];
-    tKKCDp = parameters[56];
-    tKKCDs = parameters[57];
-
-    // https://arxiv.org/abs/2301.10328
-    F_kkpipi = parameters[58];
-
-    // 2401.17934 Bs part
-    r_dkstzs = parameters[59];
-    d_dkstzs = parameters[60];
-    k_dkstzs = parameters[61];
-
-    tauKK_DAcp_Run1_sl = parameters[62];
-    taupipi_DAcp_Run1_sl = parameters[63];
-    tauKK_Acp_Run1_sl = parameters[64];
-
-    tauKK_DAcp_Run1_pi = parameters[65];
-    taupipi_DAcp_Run1_pi = parameters[66];
-    tauKK_Acp_Run1_pi = parameters[67];
-
-    tauKK_Acp_CDF = parameters[68];
-    taupipi_Acp_CDF = parameters[69];
-
-    l_dstarmpi = parameters[70];
-    d_dstarmpi = parameters[71];
-    l_dmrho = parameters[72];
-    d_dmrho = parameters[73];
-
-
-    // General parameters
-    AD = 0.; // NO direct CPV for CF/DCS
-    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
-    x = x12;
-    y = y12;
-    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
-    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
-    d = (1. - qop * qop) / (1. + qop * qop);
-
-    xcp = 0.5 * (x * cos(phi) * (qop + 1. / qop) + y * sin(phi) * (qop - 1. / qop));
-    ycp = 0.5 * (y * cos(phi) * (qop + 1. / qop) - x * sin(phi) * (qop - 1. / qop));
-    dx = 0.5 * (x * cos(phi) * (qop - 1. / qop) + y * sin(phi) * (qop + 1. / qop));
-    dy = 0.5 * (y * cos(phi) * (qop - 1. / qop) - x * sin(phi) * (qop + 1. / qop));
-
-    //---------------------------------------------------- Contribution to the LogLikelihood of the charged B observables ----------------------------------------------------
-    ll += Calculate_ChargedB_observables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the neutral Bd observables  ----------------------------------------------------
-    ll += Calculate_neutralBdobservables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the neutral Bs observables  ----------------------------------------------------
-    ll += Calculate_neutralBsobservables();
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables  ----------------------------------------------------
-    ll += Calculate_time_dependent_Dobservables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
-    ll += Calculate_other_observables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
-    ll += Calculate_old_observables();
-
-    //---------------------------------- Fill the map "obs", a subset of which will be used to fill the histograms --------------------------------------------------------
-    // Time Integrated B decay chain
-    obs["g"] = g * r2d;
-    obs["x12"] = x12 * 1000;
-    obs["y12"] = y12 * 1000;
-    obs["r_dk"] = r_dk * 100;
-    obs["r_dpi"] = r_dpi * 1000;
-    obs["rD_kpi"] = rD_kpi * 100;
-    obs["d_dk"] = d_dk * r2d;
-    obs["d_dpi"] = d_dpi * r2d;
-    obs["dD_kpi"] = dD_kpi * r2d;
-    obs["rD_k3pi"] = rD_k3pi;
-    obs["dD_k3pi"] = dD_k3pi * r2d;
-    obs["kD_k3pi"] = kD_k3pi;
-    obs["F_pipipipi"] = F_pipipipi;
-    obs["rD_kpipi0"] = rD_kpipi0;
-    obs["dD_kpipi0"] = dD_kpipi0 * r2d;
-    obs["kD_kpipi0"] = kD_kpipi0;
-    obs["F_pipipi0"] = F_pipipi0;
-    obs["F_kkpi0"] = F_kkpi0;
-    obs["rD_kskpi"] = rD_kskpi;
-    obs["dD_kskpi"] = dD_kskpi * r2d;
-    obs["kD_kskpi"] = kD_kskpi;
-    obs["RBRdkdpi"] = RBRdkdpi;
-    obs["r_dstk"] = r_dstk;
-    obs["d_dstk"] = d_dstk * r2d;
-    obs["r_dstpi"] = r_dstpi;
-    obs["d_dstpi"] = d_dstpi * r2d;
-    obs["r_dkst"] = r_dkst;
-    obs["d_dkst"] = d_dkst * r2d;
-    obs["k_dkst"] = k_dkst;
-    obs["r_dkstz"] = r_dkstz;
-    obs["d_dkstz"] = d_dkstz * r2d;
-    obs["k_dkstz"] = k_dkstz;
-    obs["r_dkstzs"] = r_dkstzs;
-    obs["d_dkstzs"] = d_dkstzs * r2d;
-    obs["k_dkstzs"] = k_dkstzs;
-    obs["r_dkpipi"] = r_dkpipi;
-    obs["d_dkpipi"] = d_dkpipi * r2d;
-    obs["k_dkpipi"] = k_dkpipi;
-    obs["r_dpipipi"] = r_dpipipi;
-    obs["d_dpipipi"] = d_dpipipi * r2d;
-    obs["k_dpipipi"] = k_dpipipi;
-    obs["F_kkpipi"] = F_kkpipi;
-
-    // Time dependent B decay chain
-
-    obs["l_dsk"] = l_dsk;
-    obs["d_dsk"] = d_dsk * r2d;
-    obs["phis"] = phis * r2d;
-    obs["beta_s"] = -0.5 * phis;
-    obs["l_dskpipi"] = l_dskpipi;
-    obs["d_dskpipi"] = d_dskpipi * r2d;
-    obs["k_dskpipi"] = k_dskpipi;
-    obs["l_dmpi"] = l_dmpi;
-    obs["d_dmpi"] = d_dmpi * r2d;
-    obs["beta"] = phi_d*0.5 * r2d;
-    obs["phid"] = phi_d * r2d;
-
-    // Time dependent D decay and mixing
-    obs["PhiM12"] = PhiM12 * r2d;
-    obs["PhiG12"] = PhiG12 * r2d;
-    obs["phipphig12"] = remainder(PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["phimphig12"] = remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["AD"] = AD;
-    obs["adKK"] = adKK * 1000;
-    obs["adpipi"] = adpipi * 1000;
-    obs["qopm1"] = (qop - 1) * 100;
-    obs["qop"] = qop;
-    obs["phi"] = phi * r2d;
-    obs["phi12"] = phi12 * r2d;
-    obs["delta"] = d;
-
-    obs["x"] = x * 1000;
-    obs["y"] = y * 1000;
-    obs["M12"] = 0.5 * x12 / tau ; // ps^-1
-    obs["G12"] = y12 / tau ;
-    obs["ImM12"] = 0.5 * x12 / tau * sin(PhiM12);
-
-
-    // Other parameters
-    obs["DYKKmDYpipi"] = DYKKmDYpipi*1000; // permille
-    obs["tavepitaggedOverTauD"] = tavepitaggedOverTauD;
-    obs["tavemutaggedOverTauD"] = tavemutaggedOverTauD;
-    obs["DeltatmutaggedOverTauD"] = DeltatmutaggedOverTauD;
-    obs["DeltatpitaggedOverTauD"] = DeltatpitaggedOverTauD;
-    obs["tKKCDp"] = tKKCDp*1e12;
-    obs["tKKCDs"] = tKKCDs*1e12;
-    obs["tauKK_DAcp_Run1_sl"] = tauKK_DAcp_Run1_sl;
-    obs["taupipi_DAcp_Run1_sl"] = taupipi_DAcp_Run1_sl;
-    obs["tauKK_Acp_Run1_sl"] = tauKK_Acp_Run1_sl;
-    obs["tauKK_DAcp_Run1_pi"] = tauKK_DAcp_Run1_pi;
-    obs["taupipi_DAcp_Run1_pi"] = taupipi_DAcp_Run1_pi;
-    obs["tauKK_Acp_Run1_pi"] = tauKK_Acp_Run1_pi;
-    obs["tauKK_Acp_CDF"] = tauKK_Acp_CDF;
-    obs["taupipi_Acp_CDF"] = taupipi_Acp_CDF;
-    obs["l_dstarmpi"] = l_dstarmpi;
-    obs["d_dstarmpi"] = d_dstarmpi*180./M_PI;
-    obs["l_dmrho"] = l_dmrho;
-    obs["d_dmrho"] = d_dmrho*180./M_PI;
-
-  }
-  else if (comb == 4)
-  {
-
-    // Variabili globali
-    x12 = parameters[0];
-    y12 = parameters[1];
-
-    // 1. PDF: glwads-dh-hh-dmix (UID0)
-    rD_kpi = parameters[2];
-    dD_kpi = parameters[3];
-
-    //  2. PDF: glwads-dh-h3pi-dmix (UID1)
-    rD_k3pi = parameters[4];
-    dD_k3pi = parameters[5];
-    kD_k3pi = parameters[6];
-    F_pipipipi = parameters[7];
-
-    // 3. PDF: glwads-dh-hhpi0-dmix (UID2)
-    rD_kpipi0 = parameters[8];
-    dD_kpipi0 = parameters[9];
-    kD_kpipi0 = parameters[10];
-    F_pipipi0 = parameters[11];
-    F_kkpi0 = parameters[12];
-
-    // 5. PDF: glwads-dkdpi-kskpi-dmix (UID4)
-    rD_kskpi = parameters[13];
-    dD_kskpi = parameters[14];
-    kD_kskpi = parameters[15];
-
-    // 15. PDF: charm-kspipi (UID14)
-    PhiM12 = parameters[16];
-    PhiG12 = parameters[17];
-
-    adKK = parameters[18];
-    adpipi = parameters[19];
-    DYKKmDYpipi = parameters[20];
-    tavepitaggedOverTauD = parameters[21];
-    tavemutaggedOverTauD = parameters[22];
-    DeltatmutaggedOverTauD = parameters[23];
-    DeltatpitaggedOverTauD = parameters[24];
-    tKKCDp = parameters[25];
-    tKKCDs = parameters[26];
-
-    F_kkpipi = parameters[27];
-
-    tauKK_DAcp_Run1_sl = parameters[28];
-    taupipi_DAcp_Run1_sl = parameters[29];
-    tauKK_Acp_Run1_sl = parameters[30];
-
-    tauKK_DAcp_Run1_pi = parameters[31];
-    taupipi_DAcp_Run1_pi = parameters[32];
-    tauKK_Acp_Run1_pi = parameters[33];
-
-    tauKK_Acp_CDF = parameters[34];
-    taupipi_Acp_CDF = parameters[35];
-
-
-    // General parameters
-    AD = 0.; // NO direct CPV for CF/DCS
-    phi12 = remainder(-PhiG12 + PhiM12, 2. * M_PI);
-    x = x12;
-    y = y12;
-    qop = 1. + x12 * y12 * sin(phi12) / (x12 * x12 + y12 * y12);
-    phi = atan(-(x12 * x12 * sin(2. * PhiM12) + y12 * y12 * sin(2. * PhiG12)) / (x12 * x12 * cos(2. * PhiM12) + y12 * y12 * cos(2. * PhiG12))) / 2.;
-    d = (1. - qop * qop) / (1. + qop * qop);
-
-    xcp = 0.5 * (x * cos(phi) * (qop + 1. / qop) + y * sin(phi) * (qop - 1. / qop));
-    ycp = 0.5 * (y * cos(phi) * (qop + 1. / qop) - x * sin(phi) * (qop - 1. / qop));
-    dx = 0.5 * (x * cos(phi) * (qop - 1. / qop) + y * sin(phi) * (qop + 1. / qop));
-    dy = 0.5 * (y * cos(phi) * (qop - 1. / qop) - x * sin(phi) * (qop + 1. / qop));
-
-    //------------------------------------------------------  Contribution to the LogLikelihood of the Time Dependent D observables  ----------------------------------------------------
-    ll += Calculate_time_dependent_Dobservables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Other Observables -------------------------------------------------------------------------
-    ll += Calculate_other_observables();
-    //----------------------------------------------- Contribution to the LogLikelihood of the Old Observables -------------------------------------------------------------------------
-    ll += Calculate_old_observables();
-
-    //---------------------------------- Fill the Histograms ---------------------
-
-    // Time Integrated B decay chain
-    obs["x12"] = x12 * 1000;
-    obs["y12"] = y12 * 1000;
-    obs["rD_kpi"] = rD_kpi * 100;
-    obs["dD_kpi"] = dD_kpi * r2d;
-    obs["rD_k3pi"] = rD_k3pi;
-    obs["dD_k3pi"] = dD_k3pi * r2d;
-    obs["kD_k3pi"] = kD_k3pi;
-    obs["F_pipipipi"] = F_pipipipi;
-    obs["rD_kpipi0"] = rD_kpipi0;
-    obs["dD_kpipi0"] = dD_kpipi0 * r2d;
-    obs["kD_kpipi0"] = kD_kpipi0;
-    obs["F_pipipi0"] = F_pipipi0;
-    obs["F_kkpi0"] = F_kkpi0;
-    obs["rD_kskpi"] = rD_kskpi;
-    obs["dD_kskpi"] = dD_kskpi * r2d;
-    obs["kD_kskpi"] = kD_kskpi;
-    obs["F_kkpipi"] = F_kkpipi;
-
-    // Time dependent D decay and mixing
-    obs["PhiM12"] = PhiM12 * r2d;
-    obs["PhiG12"] = PhiG12 * r2d;
-    obs["phipphig12"] = remainder(PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["phimphig12"] = remainder(-PhiG12 + phi, 2. * M_PI) * r2d;
-    obs["AD"] = AD;
-    obs["adKK"] = adKK * 1000;
-    obs["adpipi"] = adpipi * 1000;
-    obs["qopm1"] = (qop - 1) * 100;
-    obs["qop"] = qop;
-    obs["phi"] = phi * r2d;
-    obs["phi12"] = phi12 * r2d;
-    obs["delta"] = d;
-
-    obs["x"] = x * 1000;
-    obs["y"] = y * 1000;
-    obs["M12"] = 0.5 * x12 / tau ;
-    obs["G12"] = y12 / tau ;
-    obs["ImM12"] = 0.5 * x12 / tau * sin(PhiM12);
-  }
-
-  return ll;
-}
-// ---------------------------------------------------------
-
-void MixingModel::MCMCUserIterationInterface()
+void MixingModel::PrintHistogram()
 {
-  std::vector<double> pars;
-  for (unsigned int i = 0; i < fMCMCNChains; ++i)
+  histos.flush(); // sets the ranges if the run was shorter than the states kept for them
+  if (histos.sparse)
   {
-    //        std::cout << "interface: chain " << i << ", ";
-    pars = fMCMCStates.at(i).parameters;
-    //    std::cout << pars.size() << std::endl;
-    LogLikelihood(pars);
-    histos.fillh1d();
-    histos.fillh2d();
+    double occupied = 0., bins = 0.;
+    for (unsigned k = 0; k < histos.h2sp.size(); k++)
+      if (histos.h2sp[k])
+      {
+        occupied += histos.h2sp[k]->GetNbins();
+        bins += (histos.h2dbinx[k] + 2.) * (histos.h2dbiny[k] + 2.);
+      }
+    if (bins > 0.)
+      BCLog::OutSummary(Form("Sparse 2D histograms: %.0f occupied bins, %.1f%% of their bins", occupied, 100. * occupied / bins));
   }
-}
-
-void MixingModel::PrintHistogram()
-{
   histos.write();
 }
@@ -8,9 +8,15 @@
 #include "histo.h"
 #include "dato.h"
 #include "CorrelatedGaussianObservables.h"
+#include "MeasurementRegistry.h"
+#include "MixingContext.h"
+#include "ConvergenceMonitor.h"
+#include "SampleStore.h"
 #include <iostream>
 #include <cmath>
 #include <math.h>
+#include <ctime>
+#include <csignal>
 // --------------------------------------------------------- This is the class to make the model ----------------------------------------------------
 
 using namespace std;
@@ -25,6 +31,65 @@ public:
   // Methods to overload, see file MixingModel.cpp
   void DefineParameters(); // Define the parameters
   double LogLikelihood(const std::vector<double> &parameters); // Compute the log likelihood
+  // Log likelihood of n points, ll[k] that of points[k], for grid scans or ensembles of walkers. The points are taken
+  // Lanes::size() at a time, one in each lane of a SIMD pack (Lanes.h), the last n % Lanes::size() one at a time by
+  // LogLikelihood; the packs and the remaining points are spread over the OpenMP threads. The lanes agree with
+  // LogLikelihood to rounding: the sines and cosines of the packs are not those of the C library.
+  void LogLikelihoodBatch(const std::vector<std::vector<double> > &points, std::vector<double> &ll);
+  // Log likelihood and its gradient with respect to all the parameters, by reverse mode automatic differentiation
+  double LogLikelihoodGradient(const std::vector<double> &parameters, std::vector<double> &gradient);
+  // Sample the posterior with the No-U-Turn sampler instead of BAT's Metropolis: nwarmup iterations to tune it, then
+  // niterations per chain filling the histograms, the marginalized distributions and the statistics used by the summaries
+  void MarginalizeAllNUTS(unsigned nwarmup, unsigned niterations);
+  // Same with parallel tempering: one ladder of replicas at the given temperatures per chain, the cold replicas filling the
+  // histograms; the swap rates and the occupancy of the modes of the parameters modenames are written to the log
+  void MarginalizeAllTempering(unsigned nwarmup, unsigned niterations, const vector<double>& temperatures, const vector<string>& modenames);
+  // Draws produced by the samplers above are passed to BAT and to histo through these
+  void BeginExternalRun(); // set up BAT's chain statistics and marginalized histograms for the main run
+  void SetChainState(unsigned ichain, unsigned iteration, const vector<double>& point, double ll);
+  void EndIteration(); // update the statistics and fill the histograms with the states of all the chains
+  // Run length set by convergence, for the samplers above: the main run stops as soon as every monitored quantity has a
+  // split R-hat below rhat and bulk and tail ESS above ess, checked every interval iterations, or when maxtime seconds
+  // (wall clock, 0 for no limit) have passed; niterations is then the maximum. The quantities are all the parameters, or
+  // the observables of the variables file if variablesonly.
+  void SetConvergenceTargets(double rhat, double ess, unsigned interval, double maxtime, bool variablesonly);
+  // Whether the main run must stop after the given number of iterations; when it does, the diagnostics are logged
+  bool StopRun(unsigned iterations, unsigned maxiterations);
+  // Checkpoints of the main run of the samplers above, written to file every interval iterations, at its end and on
+  // SIGTERM: state of the sampler, BAT's statistics and marginalized distributions, histograms and convergence monitor.
+  // With resume the run skips the warmup and continues bit for bit from the checkpoint in file up to niterations in total,
+  // which also extends a finished run.
+  void SetCheckpoint(const string& file, unsigned interval, bool resume);
+  // Warm start: a run writes to file the final positions of its chains and its tuned proposal, its covariance (for nuts the
+  // mass matrix) and scale, by parameter name; a later run, possibly of another combination, starts its chains from these
+  // positions and its proposal from this covariance for the parameters of the same name, the others starting from the
+  // centre of their range, so that a short pre-run or warmup is enough. The scale is used only by the same sampler.
+  void ReadWarmStart(const string& file);
+  void WriteWarmStart(const string& file);
+  // Store every thin-th state of every chain of the main run, its parameters and the observables of the variables file, in
+  // the tree of file while the chains run (see SampleStore); a resumed run writes to file_N.root, N being the iteration
+  // it resumes from. CloseSampleStore writes the rest, the destructor does it otherwise.
+  void SetSampleStore(const string& file, unsigned thin);
+  void CloseSampleStore();
+  // Histograms of the variables of the variables file: the 1D ones of all of them and the 2D ones of the given pairs
+  // (y, x), all the pairs by default. They are booked before the sampling, after the memory they and BAT's marginalized
+  // distributions will take has been logged; beyond budget megabytes the last 2D ones are dropped until it fits, the program
+  // stopping only if the rest exceeds it. Without a pre-run the ranges are set from the first buffer states of the main
+  // run, kept until then.
+  void SetHistogramPairs(const vector<pair<string, string> >& pairs);
+  void SetHistogramMemory(double budget, unsigned buffer);
+  void BookHistograms(); // called by main before the run, otherwise at the start of the sampling
+  // The ranges of the histograms are set at the start of the main run from the observables in the latest states of BAT's
+  // pre-run or of the second half of the warmup of the samplers above, passed by them to AddWarmupState; with automatic
+  // bins, their number also depends on the spread of the variable. Too short a pre-run leaves the ranges to ROOT.
+  void SetHistogramBins(bool automatic);
+  // Sparse 2D histograms (THnSparseD), holding only their occupied bins in memory and in the output files, for long lists
+  // of pairs whose posteriors fill a small part of their range; a TH2D is made from them on demand by histo::getH2D.
+  // Without a pre-run they are dense.
+  void SetSparseHistograms(bool sparse);
+  void AddWarmupState(unsigned ichain, const vector<double>& point);
+  void MCMCUserInitialize(); // Size the per-chain observables
+  void MCMCCurrentPointInterface(const std::vector<double>& point, int ichain, bool accepted); // Update the observables of a chain
   void MCMCUserIterationInterface();
   void PrintHistogram(); // This is to print the histograms
 
@@ -37,7 +102,7 @@ public:
   void Add_old_meas(); // old D analysis measurements
 
   //Histograms
-  void DefineHistograms(); // Function to define the histograms to fill
+  void DefineHistograms(); // Function to define the variables of the histograms to fill
 
   void SymmetrizeUpperTriangularMatrix(TMatrixDSym& Corr); // Function to symmetrize an upper triangular matrix
 
@@ -47,144 +112,75 @@ public:
   std::vector<string> nVarab; // name of the parameters to fill the histograms
 
 
-  map<string,dato> meas;
-  map<string,CorrelatedGaussianObservables> corrmeas;
-  map<string,double> obs;
+  MeasurementRegistry<dato> meas;
+  MeasurementRegistry<CorrelatedGaussianObservables> corrmeas;
+  vector<unsigned> obsid; // handles of the observables in nVarab, resolved in DefineHistograms
+  vector<double> obs; // obs[i] is the value of the observable nVarab[i] at the current point
+  vector<vector<double> > chainobs; // observables at the current state of each chain, recomputed only when it moves
+  vector<char> chainobsset; // whether chainobs of a chain has been computed yet
   histo histos;
 
-  //PARAMETERS
-
-  //Combination parameters
-  double g, x12, y12, r_dk, r_dpi, rD_kpi, d_dk, d_dpi, dD_kpi, //9
-  rD_k3pi, dD_k3pi, kD_k3pi, F_pipipipi, //4
-  rD_kpipi0, dD_kpipi0, kD_kpipi0, F_pipipi0, F_kkpi0, //5
-  rD_kskpi, dD_kskpi, kD_kskpi, RBRdkdpi, //4
-  r_dstk, d_dstk, r_dstpi, d_dstpi, //4
-  r_dkst, d_dkst, k_dkst, //3
-  r_dkstz, d_dkstz, k_dkstz, //3
-  r_dkpipi, d_dkpipi, k_dkpipi, r_dpipipi, d_dpipipi, k_dpipipi, //6
-  l_dsk, d_dsk, phis, //3
-  l_dskpipi, d_dskpipi, k_dskpipi, //3
-  l_dmpi, d_dmpi, beta, phi_d, // 3
-  PhiM12, PhiG12, AD, adKK, adpipi, DYKKmDYpipi, tavepitaggedOverTauD, tavemutaggedOverTauD, DeltatmutaggedOverTauD, DeltatpitaggedOverTauD, tKKCDp, tKKCDs, //12
-  //59 total parameters
-  F_kkpipi, //airXiv 20301.10328
-  // 2401.17934 Bs
-  r_dkstzs, d_dkstzs, k_dkstzs, //3
-  tauKK_DAcp_Run1_sl, taupipi_DAcp_Run1_sl, tauKK_Acp_Run1_sl,
-  tauKK_DAcp_Run1_pi, taupipi_DAcp_Run1_pi, tauKK_Acp_Run1_pi,
-  tauKK_Acp_CDF, taupipi_Acp_CDF;
-
-  //old parameter
-  double Rd, Rdkp, d; // rdkpi^2
-
-  //auxiliary parameters
-  double x,y, phi12, qop, phi; // other parametrization of the mixing parameters
-
-  //OBSERVABLES
-  //Combination Observables
-  double  acp_dk_uid0, acp_dpi_uid0, afav_dk_uid0, rcp_uid0, rm_dk_uid0, rm_dpi_uid0, rp_dk_uid0, rp_dpi_uid0, //UID0
-  rp_dk_211210617, rm_dk_211210617, acp_dk_kkpi0_211210617, acp_dk_pipipi0_211210617, acp_dpi_kkpi0_211210617, acp_dpi_pipipi0_211210617, afav_dk_kpipi0_211210617, rp_dpi_211210617, rm_dpi_211210617, rcp_kkpi0_211210617, rcp_pipipi0_211210617, //2112.10617
-  xm_dk_uid3, ym_dk_uid3, xp_dk_uid3, yp_dk_uid3, xi_x_dpi_uid3, xi_y_dpi_uid3, //UID3
-  afav_dpi_kskpi_uid4, asup_dpi_kskpi_uid4, afav_dk_kskpi_uid4, asup_dk_kskpi_uid4, rfavsup_dpi_kskpi_uid4, rfav_dkdpi_kskpi_uid4, rsup_dkdpi_kskpi_uid4, //UID4
-  acp_dstk_dg_uid5, acp_dstk_dp_uid5, afav_dstk_dg_uid5, afav_dstk_dp_uid5, rcp_dg_uid5, rcp_dp_uid5, rm_dstk_dg_uid5, rm_dstk_dp_uid5,  rp_dstk_dg_uid5, rp_dstk_dp_uid5, acp_dstpi_dg_uid5, acp_dstpi_dp_uid5,
-  rm_dstpi_dg_uid5, rm_dstpi_dp_uid5, rp_dstpi_dg_uid5, rp_dstpi_dp_uid5, afav_dstpi_dg_uid5, afav_dstpi_dp_uid5, //UID5
-  afav_dkst_kpi, acp_dkst_kk, acp_dkst_pipi, rcp_dkst_kk, rcp_dkst_pipi, rp_dkst_kpi_uid6, rm_dkst_kpi_uid6, afav_dkst_k3pi,
-  acp_dkst_pipipipi, rcp_dkst_pipipipi, rp_dkst_k3pi_uid6, rm_dkst_k3pi_uid6, //UID6
-  asup_dkst_kpi, asup_dkst_k3pi, rsup_dkst_kpi, rsup_dkst_k3pi, //LHCb-PAPER-2024-023
-  acp_dkstz_kk_uid7, acp_dkstz_pipi_uid7, rcp_dkstz_kk_uid7, rcp_dkstz_pipi_uid7, acp_dkstz_4pi_uid7, rcp_dkstz_4pi_uid7, rp_dkstz_kpi_uid7,
-  rm_dkstz_kpi_uid7, rp_dkstz_k3pi_uid7, rm_dkstz_k3pi_uid7, afav_dkstz_kpi_uid7, afav_dkstz_k3pi_uid7, //UID7
-  xm_dkstz_uid8, ym_dkstz_uid8, xp_dkstz_uid8, yp_dkstz_uid8, //UID8
-  xm_dkstz_230905514, ym_dkstz_230905514, xp_dkstz_230905514, yp_dkstz_230905514, //230905514
-  rcp_dkpipi_uid9, afav_dkpipi_kpi_uid9, afav_dpipipi_kpi_uid9, acp_dkpipi_kk_uid9, acp_dkpipi_pipi_uid9, acp_dpipipi_kk_uid9,
-  acp_dpipipi_pipi_uid9, rp_dkpipi_uid9, rm_dkpipi_uid9, rp_dpipipi_uid9, rm_dpipipi_uid9, //UID9
-  c_dsk_uid10, d_dsk_uid10, db_dsk_uid10, s_dsk_uid10, sb_dsk_uid10, //UID10
-  c_dskpipi_uid11, d_dskpipi_uid11, db_dskpipi_uid11, s_dskpipi_uid11, sb_dskpipi_uid11, //UID11
-  s_dmpi_uid12, sb_dmpi_uid12, //UID12
-  x_uid13, y_uid13, //UID13
-  xcp_uid14, ycp_uid14, dx_uid14, dy_uid14, //UID14
-  xcp_uid15, ycp_uid15, dx_uid15, dy_uid15, //UID15
-  Rdp_uid16, yp_uid16, xpsq_uid16, Rdm_uid16, ym_uid16, xmsq_uid16, //UID16
-  dtotau_uid17, dacp_uid17, //UID17
-  k3pi_uid18, //UID18
-  kD_k3pi_uid19, dD_k3pi_uid19, kD_kpipi0_uid19, dD_kpipi0_uid19, rD_k3pi_uid19, rD_kpipi0_uid19, //UID19
-  F_pipipipi_uid20, //UID20
-  F_pipipi0_uid21, F_kkpi0_uid21, //UID21
-  RD_kskpi_uid22, //UID22
-  RD_kskpi_uid23, dD_kskpi_uid23, kD_kskpi_uid23, //UID23
-  k_dkst_uid24,  //UID24
-  k_dkstz_uid25, //UID25
-  phis_uid26, //UID26
-  beta_uid27, //UID27
-  ycp_uid28, //UID28
-  DY_uid29, //UID29
-  Rdp_uid30, yp_uid30, xpsq_uid30, Rdm_uid30, ym_uid30, xmsq_uid30; //UID30
-
-  double xcp, ycp, dx, dy; // D Observables CP final states
-
-  double tauD = 410.3e-15; // D mean lifetime
-
-  //old_observables
-  double rm,
-  yp_kpp_plus, xp_kpp_plus,
-  yp_kpp_minus, xp_kpp_minus,
-  xp_plus, xp_plus_sq, yp_plus,
-  xp_minus, xp_minus_sq, yp_minus;
-
-  //https://arxiv.org/abs/2208.09402 observables
-  double Akpi_BESIII, Akpi_kpipi0_BESIII,
-         xi_x_BESIII, xi_y_BESIII;
-
-  //https://arxiv.org/pdf/2208.10098.pdf
-  double F_pipipipi_BESIII;
-
-  //https://arxiv.org/abs/2301.10328
-  double acp_dk_kkpipi_230110328, acp_dpi_kkpipi_230110328, acp_dk_pipipipi_230110328, acp_dpi_pipipipi_230110328,
-         rcp_kpi_kkpipi_230110328, rcp_kpi_pipipipi_230110328;
-
-  //https://arxiv.org/pdf/2401.17934.pdf
-  //Bd observables
-  double acp_dkstz_kk_240117934Bd, acp_dkstz_pipi_240117934Bd, rcp_dkstz_kk_240117934Bd, rcp_dkstz_pipi_240117934Bd, acp_dkstz_4pi_240117934Bd, rcp_dkstz_4pi_240117934Bd, rp_dkstz_kpi_240117934Bd,
-           rm_dkstz_kpi_240117934Bd, rp_dkstz_k3pi_240117934Bd, rm_dkstz_k3pi_240117934Bd, afav_dkstz_kpi_240117934Bd, afav_dkstz_k3pi_240117934Bd;
-
-  //Bs observables
-  double acp_dkstz_kk_240117934Bs, acp_dkstz_pipi_240117934Bs, rcp_dkstz_kk_240117934Bs, rcp_dkstz_pipi_240117934Bs, acp_dkstz_4pi_240117934Bs, rcp_dkstz_4pi_240117934Bs, rp_dkstz_kpi_240117934Bs,
-            rm_dkstz_kpi_240117934Bs, rp_dkstz_k3pi_240117934Bs, rm_dkstz_k3pi_240117934Bs, afav_dkstz_kpi_240117934Bs, afav_dkstz_k3pi_240117934Bs;
-
-  // Alternative parametrization
-  double CKpi, CpKpi, DCKpi, DCpKpi;
-
-
-  // Babar beauty
-  // B0 time dependent
-  double l_dstarmpi, d_dstarmpi, l_dmrho, d_dmrho;
-
-  //Methods to calculate the observables and the Log-Likelihood
-  double Calculate_ChargedB_observables();
-  double Calculate_neutralBdobservables();
-  double Calculate_neutralBsobservables();
-  double Calculate_time_dependent_Dobservables();
-  double Calculate_other_observables();
-  double Calculate_old_observables();
-
-  //General structure of the fit equations
-  double Acp(double rB, double delta_B, double kB, double F_D, double alpha );
-  double Rcp_h(double rBCP, double delta_BCP, double rBCF, double rD, double delta_BCF, double delta_D, double kB, double kD, double F_D, double alpha);
-  double Afav(double rB, double rD, double delta_B, double delta_D, double kB, double kD , double alpha );
-  double Asup(double rB, double rD, double delta_B, double delta_D, double kB, double kD , double alpha);
-  double Rm(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha);
-  double Rp(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha);
-  double Rads(double rB, double rD, double delta_B, double delta_D, double kB, double kD, double alpha);
-  double Rfav(double rB1, double rB2, double rD, double delta_B1, double delta_B2, double delta_D, double BR, double kD, double alpha);
-  double Rsup(double rB1, double rB2, double rD, double delta_B1, double delta_B2, double delta_D, double BR, double kD, double alpha);
-  double y_plus(double delta_D);
-  double x_plus(double delta_D);
-  double y_minus(double delta_D);
-  double x_minus(double delta_D);
+  //Evaluation state, one context per thread so that the chains can be run in parallel
+  vector<MixingContext> contexts;
+  MixingContext& GetContext(); // context of the calling thread; stops if the team is larger than when the model was built
+  vector<GradientContext> gradcontexts; // same, to differentiate the likelihood
+  vector<vector<Var> > gradpoints; // independent variables of each gradient context
+  vector<Tape> tapes; // tape of each gradient context
+#ifdef LANES
+  vector<BatchContext> batchcontexts; // same, for the packs of points of LogLikelihoodBatch
+  vector<vector<Lanes> > batchpoints; // parameters of each batch context, those of a point in each lane
+#endif
+  // Dependencies of a block of the likelihood (MixingContext::Block), declared by the Add_*_meas function that registers
+  // its measurements: the parameters its predictions depend on, the predictions of other blocks it uses and those it
+  // gives to other blocks, by label. Names of parameters absent from the combination are ignored.
+  void DeclareBlock(int block, const string& parameters, const string& uses = "", const string& gives = "");
+  void SetDependencies(); // Map the parameters to the blocks from the declarations, in every context
+  void SetIncrementalValidation(bool v); // Check every incremental evaluation against a full recomputation
 
 private:
-  double d2r, r2d;
-  double tau; // Mean lifetime
+  double d2r;
+  ConvergenceMonitor* monitor; // 0 if the run length is fixed
+  double rhattarget, esstarget, maxtime;
+  unsigned checkinterval;
+  bool monitorvariables;
+  time_t runstart;
+
+  template <class Sampler> unsigned RunExternal(Sampler& sampler, const char* name, unsigned niterations); // main run, returns its length
+  template <class Sampler> void WriteCheckpoint(const Sampler& sampler, const char* name, unsigned iterations);
+  template <class Sampler> unsigned ReadCheckpoint(Sampler& sampler, const char* name); // returns the iterations done
+  string checkpointfile;
+  unsigned checkpointinterval; // 0 if no checkpoints are written
+  bool resume;
+  static volatile sig_atomic_t terminated; // SIGTERM received
+  static void Terminate(int);
+
+  struct StartPoint { // positions and proposal of a warm start
+    string sampler; // metropolis, nuts or tempering
+    vector<vector<double> > x; // x[ichain][i] is the parameter i of the chain
+    vector<double> cov; // covariance of the proposal, npars x npars
+    double scale;
+  };
+  StartPoint warmstart; // read by ReadWarmStart, cleared once applied
+  StartPoint tuned; // final state of the last run of nuts or tempering, BAT's being read from its proposal
+
+  SampleStore* store; // created at the first state stored
+  string storefile;
+  unsigned storethin; // 0 if no states are stored
+  vector<unsigned> storeobs; // observables stored, those of the variables file not named as a parameter
+  vector<double> storerow;
+
+  struct BlockDeclaration {
+    bool declared;
+    vector<string> parameters, uses, gives;
+  };
+  BlockDeclaration blockdecl[MixingContext::NBlocks]; // set by DeclareBlock
+
+  vector<pair<unsigned, unsigned> > histpairs; // indices in nVarab of the y and x variables of the 2D histograms
+  bool allpairs; // 2D histograms of all the pairs of variables
+  double histbudget; // megabytes
+  bool booked; // histograms created
+  bool autobins; // number of bins of the histograms from the pre-run
+  void SetHistogramRanges(); // from the states of the pre-run
 
 };
 // ---------------------------------------------------------
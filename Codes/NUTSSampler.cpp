@@ -0,0 +1,613 @@
+#include "NUTSSampler.h"
+#include "MixingModel.h"
+#include "Checkpoint.h"
+#include <TString.h>
+
+#include <cmath>
+#include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static double LogSumExp(double a, double b)
+{
+  if (a == -numeric_limits<double>::infinity())
+    return b;
+  double m = a > b ? a : b;
+  return m + log(exp(a - m) + exp(b - m));
+}
+
+// Cholesky factor L of the n x n matrix a, a = L L^T; false if a is not positive definite
+static bool Cholesky(const vector<double>& a, vector<double>& L, unsigned n)
+{
+  L.assign(n * n, 0.);
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned j = 0; j <= i; j++)
+    {
+      double s = a[i * n + j];
+      for (unsigned k = 0; k < j; k++)
+        s -= L[i * n + k] * L[j * n + k];
+      if (i == j)
+      {
+        if (!(s > 0.))
+          return false;
+        L[i * n + i] = sqrt(s);
+      }
+      else
+        L[i * n + j] = s / L[j * n + j];
+    }
+  return true;
+}
+
+NUTSSampler::NUTSSampler(MixingModel& m, unsigned nchains, unsigned seed) : delta(0.8), maxdepth(10), model(m)
+{
+  npars = model.GetNParameters();
+  for (unsigned i = 0; i < npars; i++)
+  {
+    lo.push_back(model.GetParameter(i).GetLowerLimit());
+    width.push_back(model.GetParameter(i).GetUpperLimit() - model.GetParameter(i).GetLowerLimit());
+  }
+
+  chains.resize(nchains);
+  vector<vector<double> > x(nchains, vector<double>(npars));
+  for (unsigned k = 0; k < nchains; k++)
+  {
+    Chain& c = chains[k];
+    c.rnd.SetSeed(seed + k);
+    c.cov.assign(npars * npars, 0.);
+    for (unsigned i = 0; i < npars; i++)
+      c.cov[i * npars + i] = 1.;
+    Cholesky(c.cov, c.chol, npars);
+    c.eps = 0.1;
+    RestartDualAveraging(c);
+    c.wn = 0;
+    c.z.p.assign(npars, 0.);
+    c.v.assign(npars, 0.);
+    for (unsigned i = 0; i < npars; i++)
+      x[k][i] = lo[i] + 0.5 * width[i];
+  }
+  ResetStatistics();
+  SetInitialPositions(x);
+}
+
+void NUTSSampler::SetInitialPositions(const vector<vector<double> >& x)
+{
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    Chain& c = chains[k];
+    c.z.q.resize(npars);
+    for (unsigned i = 0; i < npars; i++)
+    {
+      double s = (x[k][i] - lo[i]) / width[i];
+      s = s < 1e-12 ? 1e-12 : (s > 1. - 1e-12 ? 1. - 1e-12 : s);
+      c.z.q[i] = log(s / (1. - s));
+    }
+    Evaluate(c, c.z);
+    ToModel(c.z.q, c.x);
+  }
+}
+
+// dx/du = width s (1 - s) at the mean position of the chains, s the logistic function of u
+void NUTSSampler::Jacobian(vector<double>& d) const
+{
+  d.assign(npars, 0.);
+  for (unsigned i = 0; i < npars; i++)
+  {
+    double q = 0.;
+    for (unsigned k = 0; k < chains.size(); k++)
+      q += chains[k].z.q[i] / chains.size();
+    double s = 1. / (1. + exp(-q));
+    d[i] = width[i] * s * (1. - s);
+  }
+}
+
+void NUTSSampler::SetMetric(const vector<double>& cov, double eps)
+{
+  vector<double> d;
+  Jacobian(d);
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    Chain& c = chains[k];
+    vector<double> covu(npars * npars), chol;
+    for (unsigned i = 0; i < npars; i++)
+      for (unsigned j = 0; j < npars; j++)
+        covu[i * npars + j] = cov[i * npars + j] / (d[i] * d[j]);
+    if (Cholesky(covu, chol, npars))
+    {
+      c.cov = covu;
+      c.chol = chol;
+    }
+    c.eps = eps;
+  }
+}
+
+void NUTSSampler::GetMetric(unsigned ichain, vector<double>& cov) const
+{
+  const Chain& c = chains[ichain];
+  vector<double> d;
+  Jacobian(d);
+  cov.resize(npars * npars);
+  for (unsigned i = 0; i < npars; i++)
+    for (unsigned j = 0; j < npars; j++)
+      cov[i * npars + j] = d[i] * c.cov[i * npars + j] * d[j];
+}
+
+void NUTSSampler::ToModel(const vector<double>& q, vector<double>& x) const
+{
+  x.resize(npars);
+  for (unsigned i = 0; i < npars; i++)
+    x[i] = lo[i] + width[i] / (1. + exp(-q[i]));
+}
+
+void NUTSSampler::Evaluate(Chain& c, PhasePoint& z)
+{
+  ToModel(z.q, c.xs);
+  z.ll = model.LogLikelihoodGradient(c.xs, c.gx);
+  c.ngrad++;
+
+  // x = lo + width s, s = 1 / (1 + exp(-u)): the density of u has the extra factor dx/du = width s (1 - s)
+  z.logp = z.ll;
+  z.g.resize(npars);
+  for (unsigned i = 0; i < npars; i++)
+  {
+    double u = z.q[i], a = fabs(u);
+    double s = 1. / (1. + exp(-u));
+    z.logp += log(width[i]) - a - 2. * log1p(exp(-a));
+    z.g[i] = c.gx[i] * width[i] * s * (1. - s) + 1. - 2. * s;
+  }
+  if (!std::isfinite(z.logp))
+    z.logp = -numeric_limits<double>::infinity(); // outside the physical region
+}
+
+void NUTSSampler::Velocity(const Chain& c, const vector<double>& p, vector<double>& v) const
+{
+  v.resize(npars);
+  for (unsigned i = 0; i < npars; i++)
+  {
+    const double* row = &c.cov[i * npars];
+    double s = 0.;
+    for (unsigned j = 0; j < npars; j++)
+      s += row[j] * p[j];
+    v[i] = s;
+  }
+}
+
+double NUTSSampler::Hamiltonian(Chain& c, const PhasePoint& z)
+{
+  Velocity(c, z.p, c.v);
+  double k = 0.;
+  for (unsigned i = 0; i < npars; i++)
+    k += z.p[i] * c.v[i];
+  return -z.logp + 0.5 * k;
+}
+
+void NUTSSampler::SampleMomentum(Chain& c, PhasePoint& z)
+{
+  // p = L^-T n with n standard normal has covariance (L L^T)^-1, the mass matrix
+  z.p.resize(npars);
+  for (unsigned i = 0; i < npars; i++)
+    z.p[i] = c.rnd.Gaus(0., 1.);
+  for (int i = npars - 1; i >= 0; i--)
+  {
+    double s = z.p[i];
+    for (unsigned j = i + 1; j < npars; j++)
+      s -= c.chol[j * npars + i] * z.p[j];
+    z.p[i] = s / c.chol[i * npars + i];
+  }
+}
+
+void NUTSSampler::Leapfrog(Chain& c, PhasePoint& z, double eps)
+{
+  for (unsigned i = 0; i < npars; i++)
+    z.p[i] += 0.5 * eps * z.g[i];
+  Velocity(c, z.p, c.v);
+  for (unsigned i = 0; i < npars; i++)
+    z.q[i] += eps * c.v[i];
+  Evaluate(c, z);
+  for (unsigned i = 0; i < npars; i++)
+    z.p[i] += 0.5 * eps * z.g[i];
+}
+
+bool NUTSSampler::Criterion(const vector<double>& psharpminus, const vector<double>& psharpplus, const vector<double>& rho) const
+{
+  double a = 0., b = 0.;
+  for (unsigned i = 0; i < npars; i++)
+  {
+    a += psharpminus[i] * rho[i];
+    b += psharpplus[i] * rho[i];
+  }
+  return a > 0. && b > 0.;
+}
+
+bool NUTSSampler::BuildTree(Chain& c, int depth, PhasePoint& z, PhasePoint& zpropose, vector<double>& psharpbeg,
+                            vector<double>& psharpend, vector<double>& rho, vector<double>& pbeg, vector<double>& pend,
+                            double H0, double sign, double& logsumweight)
+{
+  if (depth == 0)
+  { // one step
+    Leapfrog(c, z, sign * c.eps);
+    c.nleapfrog++;
+    double h = Hamiltonian(c, z);
+    if (std::isnan(h))
+      h = numeric_limits<double>::infinity();
+    if (h - H0 > 1000.)
+      c.divergent = true;
+    logsumweight = LogSumExp(logsumweight, H0 - h);
+    c.summetro += H0 - h > 0. ? 1. : exp(H0 - h);
+    zpropose = z;
+    Velocity(c, z.p, psharpbeg);
+    psharpend = psharpbeg;
+    for (unsigned i = 0; i < npars; i++)
+      rho[i] += z.p[i];
+    pbeg = z.p;
+    pend = pbeg;
+    return !c.divergent;
+  }
+
+  // first half
+  vector<double> psharpinit_end(npars), rhoinit(npars, 0.), pinit_end(npars);
+  double logsumweightinit = -numeric_limits<double>::infinity();
+  if (!BuildTree(c, depth - 1, z, zpropose, psharpbeg, psharpinit_end, rhoinit, pbeg, pinit_end, H0, sign, logsumweightinit))
+    return false;
+
+  // second half
+  PhasePoint zproposefinal = z;
+  vector<double> psharpfinal_beg(npars), rhofinal(npars, 0.), pfinal_beg(npars);
+  double logsumweightfinal = -numeric_limits<double>::infinity();
+  if (!BuildTree(c, depth - 1, z, zproposefinal, psharpfinal_beg, psharpend, rhofinal, pfinal_beg, pend, H0, sign, logsumweightfinal))
+    return false;
+
+  // multinomial sample from the two halves
+  double logsumweightsubtree = LogSumExp(logsumweightinit, logsumweightfinal);
+  logsumweight = LogSumExp(logsumweight, logsumweightsubtree);
+  if (logsumweightfinal > logsumweightsubtree || c.rnd.Rndm() < exp(logsumweightfinal - logsumweightsubtree))
+    zpropose = zproposefinal;
+
+  // No-U-Turn criterion across the subtree and across the junction of the two halves
+  vector<double> rhosubtree(npars), rhoextended(npars);
+  for (unsigned i = 0; i < npars; i++)
+    rhosubtree[i] = rhoinit[i] + rhofinal[i];
+  bool persist = Criterion(psharpbeg, psharpend, rhosubtree);
+  for (unsigned i = 0; i < npars; i++)
+    rhoextended[i] = rhoinit[i] + pfinal_beg[i];
+  persist = persist && Criterion(psharpbeg, psharpfinal_beg, rhoextended);
+  for (unsigned i = 0; i < npars; i++)
+    rhoextended[i] = rhofinal[i] + pinit_end[i];
+  persist = persist && Criterion(psharpinit_end, psharpend, rhoextended);
+
+  for (unsigned i = 0; i < npars; i++)
+    rho[i] += rhosubtree[i];
+  return persist;
+}
+
+void NUTSSampler::Transition(Chain& c)
+{
+  SampleMomentum(c, c.z);
+  c.divergent = false;
+  c.nleapfrog = 0;
+  c.summetro = 0.;
+
+  PhasePoint zfwd = c.z, zbck = c.z, zsample = c.z, zpropose = c.z;
+  vector<double> pfwdfwd = c.z.p, pfwdbck = c.z.p, pbckfwd = c.z.p, pbckbck = c.z.p;
+  vector<double> psharpfwdfwd(npars), psharpfwdbck, psharpbckfwd, psharpbckbck;
+  Velocity(c, c.z.p, psharpfwdfwd);
+  psharpfwdbck = psharpbckfwd = psharpbckbck = psharpfwdfwd;
+  vector<double> rho = c.z.p, rhofwd(npars), rhobck(npars), rhoextended(npars);
+  double H0 = Hamiltonian(c, c.z);
+  double logsumweight = 0.; // log of exp(H0 - h(z))
+
+  unsigned depth = 0;
+  while (depth < maxdepth)
+  {
+    rhofwd.assign(npars, 0.);
+    rhobck.assign(npars, 0.);
+    double logsumweightsubtree = -numeric_limits<double>::infinity();
+    bool valid;
+    if (c.rnd.Rndm() > 0.5)
+    { // extend the trajectory forward
+      rhobck = rho;
+      pbckfwd = pfwdbck;
+      psharpbckfwd = psharpfwdbck;
+      valid = BuildTree(c, depth, zfwd, zpropose, psharpfwdbck, psharpfwdfwd, rhofwd, pfwdbck, pfwdfwd, H0, 1., logsumweightsubtree);
+    }
+    else
+    { // extend it backward
+      rhofwd = rho;
+      pfwdbck = pbckfwd;
+      psharpfwdbck = psharpbckfwd;
+      valid = BuildTree(c, depth, zbck, zpropose, psharpbckfwd, psharpbckbck, rhobck, pbckfwd, pbckbck, H0, -1., logsumweightsubtree);
+    }
+    if (!valid)
+      break;
+    depth++;
+
+    // the new subtree is favoured over the old trajectory (biased progressive sampling)
+    if (logsumweightsubtree > logsumweight || c.rnd.Rndm() < exp(logsumweightsubtree - logsumweight))
+      zsample = zpropose;
+    logsumweight = LogSumExp(logsumweight, logsumweightsubtree);
+
+    for (unsigned i = 0; i < npars; i++)
+      rho[i] = rhobck[i] + rhofwd[i];
+    bool persist = Criterion(psharpbckbck, psharpfwdfwd, rho);
+    for (unsigned i = 0; i < npars; i++)
+      rhoextended[i] = rhobck[i] + pfwdbck[i];
+    persist = persist && Criterion(psharpbckbck, psharpfwdbck, rhoextended);
+    for (unsigned i = 0; i < npars; i++)
+      rhoextended[i] = rhofwd[i] + pbckfwd[i];
+    persist = persist && Criterion(psharpbckfwd, psharpfwdfwd, rhoextended);
+    if (!persist)
+      break;
+  }
+
+  c.z = zsample;
+  ToModel(c.z.q, c.x);
+  c.ntrans++;
+  c.sumdepth += depth;
+  c.ndivergent += c.divergent;
+  c.sumaccept += c.nleapfrog ? c.summetro / c.nleapfrog : 0.;
+}
+
+void NUTSSampler::InitStepSize(Chain& c)
+{
+  // double or halve the step size until the acceptance probability of one step crosses 0.8
+  PhasePoint z = c.z;
+  SampleMomentum(c, z);
+  double H0 = Hamiltonian(c, z);
+  Leapfrog(c, z, c.eps);
+  double dH = H0 - Hamiltonian(c, z);
+  int direction = dH > log(0.8) ? 1 : -1;
+  for (int k = 0; k < 50; k++)
+  {
+    z = c.z;
+    SampleMomentum(c, z);
+    H0 = Hamiltonian(c, z);
+    Leapfrog(c, z, c.eps);
+    dH = H0 - Hamiltonian(c, z);
+    if (direction == 1 && !(dH > log(0.8)))
+      break;
+    if (direction == -1 && !(dH < log(0.8)))
+      break;
+    c.eps = direction == 1 ? 2. * c.eps : 0.5 * c.eps;
+  }
+}
+
+void NUTSSampler::RestartDualAveraging(Chain& c)
+{
+  c.mu = log(10. * c.eps);
+  c.sbar = 0.;
+  c.xbar = 0.;
+  c.counter = 0;
+}
+
+void NUTSSampler::AdaptStepSize(Chain& c, double accept)
+{
+  // dual averaging, Hoffman and Gelman (2014), with the constants used by Stan
+  const double gamma = 0.05, t0 = 10., kappa = 0.75;
+  c.counter++;
+  accept = accept > 1. ? 1. : accept;
+  double eta = 1. / (c.counter + t0);
+  c.sbar = (1. - eta) * c.sbar + eta * (delta - accept);
+  double x = c.mu - c.sbar * sqrt((double)c.counter) / gamma;
+  double xeta = pow((double)c.counter, -kappa);
+  c.xbar = (1. - xeta) * c.xbar + xeta * x;
+  c.eps = exp(x);
+}
+
+void NUTSSampler::UpdateMetric(Chain& c)
+{
+  // sample covariance of the window, shrunk towards 1e-3 times the identity for short windows
+  vector<double> cov(npars * npars), chol;
+  double n = c.wn;
+  for (unsigned i = 0; i < npars; i++)
+    for (unsigned j = 0; j < npars; j++)
+      cov[i * npars + j] = n / (n + 5.) * c.wcov[i * npars + j] / (n - 1.) + (i == j ? 1e-3 * 5. / (n + 5.) : 0.);
+  if (Cholesky(cov, chol, npars))
+  {
+    c.cov = cov;
+    c.chol = chol;
+  }
+  c.wn = 0;
+}
+
+void NUTSSampler::Warmup(unsigned niterations)
+{
+  // windows of the estimate of the mass matrix, as in Stan: a first buffer of 75 iterations where only the step size is
+  // tuned, windows of 25, 50, 100, ... iterations, the last one stretched to 50 iterations from the end, and a final
+  // buffer of 50 iterations to tune the step size to the last mass matrix
+  unsigned initbuffer = 75, termbuffer = 50, window = 25;
+  bool adaptmetric = niterations >= 20;
+  if (adaptmetric && initbuffer + termbuffer + window > niterations)
+  {
+    initbuffer = 0.15 * niterations;
+    termbuffer = 0.1 * niterations;
+    window = niterations - initbuffer - termbuffer;
+  }
+  unsigned windowend = initbuffer + window - 1; // last iteration of the current window
+  if (niterations == 0)
+    return; // the step sizes and mass matrices are kept, e.g. those of a warm start
+
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    InitStepSize(chains[k]);
+    RestartDualAveraging(chains[k]);
+  }
+
+  for (unsigned it = 0; it < niterations; it++)
+  {
+    bool inwindow = adaptmetric && it >= initbuffer && it < niterations - termbuffer;
+    bool endwindow = inwindow && it == windowend;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int k = 0; k < (int)chains.size(); k++)
+    {
+      Chain& c = chains[k];
+      double accept0 = c.sumaccept;
+      Transition(c);
+      AdaptStepSize(c, c.sumaccept - accept0);
+      if (inwindow)
+      { // Welford update of the mean and of the sum of the products of the deviations
+        if (c.wn == 0)
+        {
+          c.wmean.assign(npars, 0.);
+          c.wcov.assign(npars * npars, 0.);
+        }
+        c.wn++;
+        vector<double> d(npars);
+        for (unsigned i = 0; i < npars; i++)
+        {
+          d[i] = c.z.q[i] - c.wmean[i];
+          c.wmean[i] += d[i] / c.wn;
+        }
+        for (unsigned i = 0; i < npars; i++)
+          for (unsigned j = 0; j < npars; j++)
+            c.wcov[i * npars + j] += d[i] * (c.z.q[j] - c.wmean[j]);
+      }
+      if (endwindow)
+      {
+        UpdateMetric(c);
+        InitStepSize(c);
+        RestartDualAveraging(c);
+      }
+    }
+    if (it >= niterations / 2) // second half: the observables of the states set the ranges of the histograms
+      for (unsigned k = 0; k < chains.size(); k++)
+        model.AddWarmupState(k, chains[k].x);
+    if (endwindow && windowend != niterations - termbuffer - 1)
+    { // next window, twice as long, stretched to the final buffer if the one after would not fit
+      window *= 2;
+      windowend = it + window;
+      if (windowend != niterations - termbuffer - 1 && windowend + 2 * window >= niterations - termbuffer)
+        windowend = niterations - termbuffer - 1;
+    }
+  }
+
+  for (unsigned k = 0; k < chains.size(); k++)
+    chains[k].eps = exp(chains[k].xbar);
+}
+
+void NUTSSampler::Iterate()
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int k = 0; k < (int)chains.size(); k++)
+    Transition(chains[k]);
+}
+
+void NUTSSampler::ResetStatistics()
+{
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    Chain& c = chains[k];
+    c.ngrad = c.ndivergent = c.ntrans = c.sumdepth = 0;
+    c.sumaccept = 0.;
+  }
+}
+
+unsigned long NUTSSampler::GetNGradients() const
+{
+  unsigned long n = 0;
+  for (unsigned k = 0; k < chains.size(); k++)
+    n += chains[k].ngrad;
+  return n;
+}
+
+unsigned long NUTSSampler::GetNDivergent() const
+{
+  unsigned long n = 0;
+  for (unsigned k = 0; k < chains.size(); k++)
+    n += chains[k].ndivergent;
+  return n;
+}
+
+double NUTSSampler::GetMeanTreeDepth() const
+{
+  double s = 0., n = 0.;
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    s += chains[k].sumdepth;
+    n += chains[k].ntrans;
+  }
+  return n > 0. ? s / n : 0.;
+}
+
+double NUTSSampler::GetMeanAcceptance() const
+{
+  double s = 0., n = 0.;
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    s += chains[k].sumaccept;
+    n += chains[k].ntrans;
+  }
+  return n > 0. ? s / n : 0.;
+}
+
+void NUTSSampler::SaveState(TDirectory& dir) const
+{
+  StateWriter w;
+  w.Add(chains.size());
+  w.Add(npars);
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    const Chain& c = chains[k];
+    w.Add(c.z.q);
+    w.Add(c.z.p);
+    w.Add(c.z.g);
+    w.Add(c.z.logp);
+    w.Add(c.z.ll);
+    w.Add(c.cov);
+    w.Add(c.chol);
+    w.Add(c.eps);
+    w.Add(c.mu);
+    w.Add(c.sbar);
+    w.Add(c.xbar);
+    w.Add(c.counter);
+    w.Add(c.wmean);
+    w.Add(c.wcov);
+    w.Add(c.wn);
+    w.Add(c.ngrad);
+    w.Add(c.ndivergent);
+    w.Add(c.ntrans);
+    w.Add(c.sumdepth);
+    w.Add(c.sumaccept);
+    WriteRandom(dir, Form("rnd%u", k), c.rnd);
+  }
+  w.Write(dir, "chains");
+}
+
+void NUTSSampler::LoadState(TDirectory& dir)
+{
+  StateReader r(dir, "chains");
+  if (r.Next() != chains.size() || r.Next() != npars)
+  {
+    cout << "The checkpoint was written by a NUTS run with other chains or parameters" << endl;
+    exit(EXIT_FAILURE);
+  }
+  for (unsigned k = 0; k < chains.size(); k++)
+  {
+    Chain& c = chains[k];
+    r.Next(c.z.q);
+    r.Next(c.z.p);
+    r.Next(c.z.g);
+    c.z.logp = r.Next();
+    c.z.ll = r.Next();
+    r.Next(c.cov);
+    r.Next(c.chol);
+    c.eps = r.Next();
+    c.mu = r.Next();
+    c.sbar = r.Next();
+    c.xbar = r.Next();
+    c.counter = r.Next();
+    r.Next(c.wmean);
+    r.Next(c.wcov);
+    c.wn = r.Next();
+    c.ngrad = r.Next();
+    c.ndivergent = r.Next();
+    c.ntrans = r.Next();
+    c.sumdepth = r.Next();
+    c.sumaccept = r.Next();
+    ReadRandom(dir, Form("rnd%u", k), c.rnd);
+    ToModel(c.z.q, c.x);
+  }
+}
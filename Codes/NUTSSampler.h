@@ -0,0 +1,101 @@
+#ifndef __NUTSSAMPLER__H
+#define __NUTSSAMPLER__H
+
+#include <vector>
+#include <TRandom3.h>
+#include <TDirectory.h>
+// ------------------------------------------ No-U-Turn sampler ------------------------------------------------
+// Hamiltonian Monte Carlo in which the length of every trajectory is set by the No-U-Turn criterion and the new point is
+// drawn from the whole trajectory with multinomial weights, as in Stan. The chains move in the unbounded variables
+// u = logit((x - lo) / (hi - lo)) of the parameters x of the model, with the gradient of MixingModel::LogLikelihoodGradient;
+// the priors are flat within the ranges of the parameters, as set by DefineParameters.
+// During the warmup the step size is tuned by dual averaging and the mass matrix is set to the inverse of the covariance
+// of the draws, estimated in windows of growing length; it is dense, the phases and the ratios being strongly correlated.
+
+using namespace std;
+
+class MixingModel;
+
+class NUTSSampler {
+public:
+
+  NUTSSampler(MixingModel& model, unsigned nchains, unsigned seed);
+
+  void SetInitialPositions(const vector<vector<double> >& x); // one point per chain, by default the centre of the ranges
+  // Mass matrix of every chain from a covariance (npars x npars) of the parameters of the model, transformed to the unbounded
+  // variables at the mean position of the chains, and step size; a warmup shorter than 20 iterations then tunes only the step
+  // size, none keeps it
+  void SetMetric(const vector<double>& cov, double eps);
+  void GetMetric(unsigned ichain, vector<double>& cov) const; // inverse mass matrix of a chain in the parameters of the model
+  void Warmup(unsigned niterations); // tune the step sizes and the mass matrices; the states of the second half are passed to MixingModel::AddWarmupState
+  void Iterate(); // one transition of every chain, the chains in parallel
+
+  unsigned GetNChains() const { return chains.size(); }
+  const vector<double>& GetPoint(unsigned ichain) const { return chains[ichain].x; } // parameters of the model
+  double GetLogLikelihood(unsigned ichain) const { return chains[ichain].z.ll; }
+
+  // Statistics of the transitions since the last reset
+  void ResetStatistics();
+  unsigned long GetNGradients() const; // number of evaluations of the gradient
+  unsigned long GetNDivergent() const; // number of transitions stopped by a divergence
+  double GetMeanTreeDepth() const;
+  double GetMeanAcceptance() const; // mean acceptance statistic of the trajectories
+  double GetStepSize(unsigned ichain) const { return chains[ichain].eps; }
+
+  // Complete state of the chains, with their tuning, generators and statistics, for the checkpoints of long runs; the
+  // state read must come from a sampler with the same number of chains and parameters
+  void SaveState(TDirectory& dir) const;
+  void LoadState(TDirectory& dir);
+
+  double delta; // target of the acceptance statistic, 0.8 by default
+  unsigned maxdepth; // maximum depth of the trees, i.e. at most 2^maxdepth - 1 steps per transition, 10 by default
+
+private:
+  struct PhasePoint {
+    vector<double> q, p; // position (unbounded variables) and momentum
+    vector<double> g; // gradient of logp
+    double logp, ll; // log posterior density of q, log likelihood
+  };
+
+  struct Chain {
+    PhasePoint z;
+    vector<double> x; // z.q in the parameters of the model
+    vector<double> cov, chol; // inverse mass matrix and its Cholesky factor, dense
+    double eps; // step size
+    double mu, sbar, xbar; // state of the dual averaging
+    unsigned counter;
+    vector<double> wmean, wcov; // running mean and covariance of the draws in the current window
+    unsigned wn;
+    TRandom3 rnd;
+    unsigned long ngrad, ndivergent, ntrans, sumdepth;
+    double sumaccept;
+    // scratch of a transition
+    bool divergent;
+    unsigned long nleapfrog;
+    double summetro;
+    vector<double> v, xs, gx;
+  };
+
+  void Evaluate(Chain& c, PhasePoint& z); // logp and its gradient at z.q
+  void ToModel(const vector<double>& q, vector<double>& x) const;
+  void Jacobian(vector<double>& d) const; // dx/du of every parameter at the mean position of the chains
+  double Hamiltonian(Chain& c, const PhasePoint& z);
+  void Velocity(const Chain& c, const vector<double>& p, vector<double>& v) const; // cov p
+  void SampleMomentum(Chain& c, PhasePoint& z);
+  void Leapfrog(Chain& c, PhasePoint& z, double eps);
+  void Transition(Chain& c);
+  bool BuildTree(Chain& c, int depth, PhasePoint& z, PhasePoint& zpropose, vector<double>& psharpbeg, vector<double>& psharpend,
+                 vector<double>& rho, vector<double>& pbeg, vector<double>& pend, double H0, double sign, double& logsumweight);
+  bool Criterion(const vector<double>& psharpminus, const vector<double>& psharpplus, const vector<double>& rho) const;
+  void InitStepSize(Chain& c);
+  void RestartDualAveraging(Chain& c);
+  void UpdateMetric(Chain& c); // set the mass matrix from the draws of the window just ended
+  void AdaptStepSize(Chain& c, double accept);
+
+  MixingModel& model;
+  unsigned npars;
+  vector<double> lo, width; // lower limit and width of the range of each parameter
+  vector<Chain> chains;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef __PHASE__H
+#define __PHASE__H
+
+#include <cmath>
+#include <math.h>
+// ------------------------------------------ Angle stored through its sine and cosine ------------------------------------------------
+// The sine and cosine of every angular parameter are computed once per likelihood evaluation; sums and differences of
+// angles are then obtained with the addition formulas, which need only a few multiplications.
+// T is the numeric type of the formulas (see Kernels.h), Phase the one used by the fit.
+
+inline void SinCos(double angle, double* s, double* c)
+{
+#ifdef __GLIBC__
+  sincos(angle, s, c);
+#else
+  *s = sin(angle);
+  *c = cos(angle);
+#endif
+}
+
+template <class T>
+inline void SinCos(const T& angle, T* s, T* c)
+{
+  using std::sin;
+  using std::cos;
+  *s = sin(angle); // found by argument dependent lookup for the non-builtin types
+  *c = cos(angle);
+}
+
+template <class T>
+struct PhaseT {
+  T s, c; // sine and cosine
+
+  PhaseT() : s(0.), c(1.) {}
+  PhaseT(const T& sn, const T& cs) : s(sn), c(cs) {}
+  explicit PhaseT(const T& angle) { SinCos(angle, &s, &c); }
+};
+
+template <class T>
+inline PhaseT<T> operator+(const PhaseT<T>& a, const PhaseT<T>& b) { return PhaseT<T>(a.s * b.c + a.c * b.s, a.c * b.c - a.s * b.s); }
+template <class T>
+inline PhaseT<T> operator-(const PhaseT<T>& a, const PhaseT<T>& b) { return PhaseT<T>(a.s * b.c - a.c * b.s, a.c * b.c + a.s * b.s); }
+template <class T>
+inline PhaseT<T> operator-(const PhaseT<T>& a) { return PhaseT<T>(-a.s, a.c); }
+
+typedef PhaseT<double> Phase;
+
+#endif
@@ -0,0 +1,127 @@
+#include "SampleStore.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <TFile.h>
+#include <TTree.h>
+
+SampleStore::SampleStore(const string& filename, const vector<string>& n, unsigned bs, unsigned nblocks, int compression)
+  : ncolumns(n.size()), blocksize(bs), current(0), finished(false), names(n), nrows(0), waittime(0.)
+{
+  file = new TFile(filename.c_str(), "RECREATE", "MCMC samples", compression);
+  if (file->IsZombie())
+  {
+    cout << "Cannot open the sample store " << filename << endl;
+    exit(EXIT_FAILURE);
+  }
+  tree = new TTree("samples", "MCMC samples");
+  tree->SetDirectory(file);
+
+  blocks.resize(nblocks);
+  for (unsigned b = 0; b < nblocks; b++)
+  {
+    blocks[b].chain.resize(blocksize);
+    blocks[b].iteration.resize(blocksize);
+    blocks[b].ll.resize(blocksize);
+    blocks[b].values.resize(blocksize * ncolumns);
+    blocks[b].n = 0;
+    freeblocks.push_back(&blocks[b]);
+  }
+  writer = thread(&SampleStore::Write, this);
+}
+
+SampleStore::~SampleStore()
+{
+  Flush();
+  {
+    lock_guard<mutex> lock(m);
+    finished = true;
+  }
+  cond.notify_all();
+  writer.join();
+  file->Close();
+  delete file; // also deletes the tree
+}
+
+void SampleStore::Add(unsigned ichain, unsigned iteration, double ll, const vector<double>& values)
+{
+  if (!current)
+  {
+    unique_lock<mutex> lock(m);
+    if (freeblocks.empty())
+    {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      cond.wait(lock, [this] { return !freeblocks.empty(); });
+      waittime += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    current = freeblocks.front();
+    freeblocks.pop_front();
+    current->n = 0;
+  }
+  Block& b = *current;
+  b.chain[b.n] = ichain;
+  b.iteration[b.n] = iteration;
+  b.ll[b.n] = ll;
+  float* row = &b.values[b.n * ncolumns];
+  for (unsigned i = 0; i < ncolumns; i++)
+    row[i] = values[i];
+  nrows++;
+  if (++b.n == blocksize)
+    Flush();
+}
+
+void SampleStore::Flush()
+{
+  if (!current)
+    return;
+  {
+    lock_guard<mutex> lock(m);
+    fullblocks.push_back(current);
+  }
+  current = 0;
+  cond.notify_all();
+}
+
+void SampleStore::Write()
+{
+  // branches on a row buffer of the writer thread, copied from the blocks row by row
+  int chain;
+  unsigned iteration;
+  float ll;
+  vector<float> row(ncolumns);
+  tree->Branch("chain", &chain, "chain/I");
+  tree->Branch("iteration", &iteration, "iteration/i");
+  tree->Branch("loglikelihood", &ll, "loglikelihood/F");
+  for (unsigned i = 0; i < ncolumns; i++)
+    tree->Branch(names[i].c_str(), &row[i], (names[i] + "/F").c_str());
+
+  while (true)
+  {
+    Block* b;
+    {
+      unique_lock<mutex> lock(m);
+      cond.wait(lock, [this] { return finished || !fullblocks.empty(); });
+      if (fullblocks.empty())
+        break; // finished, and everything written
+      b = fullblocks.front();
+      fullblocks.pop_front();
+    }
+    for (unsigned k = 0; k < b->n; k++)
+    {
+      chain = b->chain[k];
+      iteration = b->iteration[k];
+      ll = b->ll[k];
+      for (unsigned i = 0; i < ncolumns; i++)
+        row[i] = b->values[k * ncolumns + i];
+      tree->Fill();
+    }
+    {
+      lock_guard<mutex> lock(m);
+      freeblocks.push_back(b);
+    }
+    cond.notify_all();
+  }
+  file->cd();
+  tree->Write();
+}
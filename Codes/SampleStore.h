@@ -0,0 +1,63 @@
+#ifndef __SAMPLESTORE__H
+#define __SAMPLESTORE__H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+// ------------------------------------------ Streaming store of the samples ------------------------------------------------
+// Writes the states of the chains during the run to a TTree "samples" in a ROOT file: the chain, the iteration, the log
+// likelihood and one float branch per quantity (parameters and observables), so that any of them can be histogrammed or
+// rebinned later. A TTree is stored by columns, each branch in baskets compressed separately.
+// The sampler only copies a row into a block; full blocks are passed to a background thread that fills the tree and
+// writes it. The blocks come from a fixed pool, which bounds the memory: when the writer is behind and the pool is used
+// up, the sampler waits for it. Since ROOT is then used by two threads, ROOT::EnableThreadSafety() must have been called
+// before any ROOT object was created, as main does with the samples option.
+
+using namespace std;
+
+class TFile;
+class TTree;
+
+class SampleStore {
+public:
+
+  // blocksize rows per block, nblocks blocks; compression as TFile's, e.g. 101 for zlib level 1, 505 for zstd level 5
+  SampleStore(const string& filename, const vector<string>& names, unsigned blocksize = 1024, unsigned nblocks = 8,
+              int compression = 101);
+  ~SampleStore(); // writes the rows still in the blocks, then the tree, and closes the file
+
+  void Add(unsigned ichain, unsigned iteration, double ll, const vector<double>& values); // values in the order of names
+  unsigned long GetNRows() const { return nrows; }
+  double GetWaitTime() const { return waittime; } // seconds the sampler waited for a free block
+
+private:
+  struct Block {
+    vector<int> chain;
+    vector<unsigned> iteration;
+    vector<float> ll;
+    vector<float> values; // row by row
+    unsigned n;
+  };
+
+  void Write(); // the writer thread
+  void Flush(); // pass the current block to the writer
+
+  unsigned ncolumns, blocksize;
+  vector<Block> blocks;
+  deque<Block*> freeblocks, fullblocks;
+  Block* current;
+  bool finished;
+  mutex m;
+  condition_variable cond;
+  thread writer;
+  TFile* file;
+  TTree* tree;
+  vector<string> names;
+  unsigned long nrows;
+  double waittime;
+};
+
+#endif
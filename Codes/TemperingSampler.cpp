@@ -0,0 +1,384 @@
+#include "TemperingSampler.h"
+#include "MixingModel.h"
+#include "Checkpoint.h"
+#include <TString.h>
+
+#include <cmath>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Cholesky factor L of the n x n matrix a, from its lower triangle, a = L L^T; false if a is not positive definite
+static bool Cholesky(const vector<double>& a, vector<double>& L, unsigned n)
+{
+  L.assign(n * n, 0.);
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned j = 0; j <= i; j++)
+    {
+      double s = a[i * n + j];
+      for (unsigned k = 0; k < j; k++)
+        s -= L[i * n + k] * L[j * n + k];
+      if (i == j)
+      {
+        if (!(s > 0.))
+          return false;
+        L[i * n + i] = sqrt(s);
+      }
+      else
+        L[i * n + j] = s / L[j * n + j];
+    }
+  return true;
+}
+
+TemperingSampler::TemperingSampler(MixingModel& m, unsigned nch, const vector<double>& temps, unsigned seed)
+  : swapinterval(1), model(m), nchains(nch), temperatures(temps), iteration(0), evenround(true), ncold(0)
+{
+  if (temperatures.empty() || temperatures[0] != 1.)
+  {
+    cout << "The first temperature of the ladder must be 1" << endl;
+    exit(EXIT_FAILURE);
+  }
+  for (unsigned k = 1; k < temperatures.size(); k++)
+    if (!(temperatures[k] > temperatures[k - 1]))
+    {
+      cout << "The temperatures of the ladder must be increasing" << endl;
+      exit(EXIT_FAILURE);
+    }
+
+  npars = model.GetNParameters();
+  for (unsigned i = 0; i < npars; i++)
+  {
+    lo.push_back(model.GetParameter(i).GetLowerLimit());
+    hi.push_back(model.GetParameter(i).GetUpperLimit());
+  }
+
+  // every replica starts at the centre of the ranges, like the Metropolis with kInitCenter, with a diagonal proposal
+  unsigned ntemps = temperatures.size();
+  replicas.resize(nchains * ntemps);
+  proposals.resize(nchains * ntemps);
+  for (unsigned r = 0; r < replicas.size(); r++)
+  {
+    rnd.push_back(TRandom3(seed + r));
+    Replica& rep = replicas[r];
+    rep.x.resize(npars);
+    for (unsigned i = 0; i < npars; i++)
+      rep.x[i] = 0.5 * (lo[i] + hi[i]);
+    rep.ll = model.LogLikelihood(rep.x);
+    Proposal& p = proposals[r];
+    p.chol.assign(npars * npars, 0.);
+    for (unsigned i = 0; i < npars; i++)
+      p.chol[i * npars + i] = (hi[i] - lo[i]) / 10.;
+    p.scale = 2.38 / sqrt((double)npars);
+    p.mean.assign(npars, 0.);
+    p.cov.assign(npars * npars, 0.);
+    p.n = 0.;
+    p.accepted = p.proposed = 0;
+  }
+  for (unsigned c = 0; c < nchains; c++)
+    swaprnd.push_back(TRandom3(seed + replicas.size() + c));
+  ResetStatistics();
+}
+
+void TemperingSampler::Step(unsigned r, bool adapt)
+{
+  Replica& rep = replicas[r];
+  Proposal& p = proposals[r];
+  TRandom3& rn = rnd[r];
+  double beta = 1. / temperatures[r % temperatures.size()];
+
+  // multivariate Cauchy: Gaussian with covariance scale^2 L L^T divided by |g|, g standard normal
+  vector<double> z(npars), y(npars);
+  double w = fabs(rn.Gaus(0., 1.));
+  for (unsigned i = 0; i < npars; i++)
+    z[i] = rn.Gaus(0., 1.) / w;
+  bool inside = true;
+  for (unsigned i = 0; i < npars; i++)
+  {
+    double d = 0.;
+    for (unsigned j = 0; j <= i; j++)
+      d += p.chol[i * npars + j] * z[j];
+    y[i] = rep.x[i] + p.scale * d;
+    inside = inside && y[i] >= lo[i] && y[i] <= hi[i];
+  }
+  double u = rn.Rndm(); // drawn also when the point is outside, so that the sequence does not depend on it
+  rep.proposed++;
+  p.proposed++;
+  if (inside)
+  {
+    double ll = model.LogLikelihood(y);
+    if (log(u) < beta * (ll - rep.ll))
+    {
+      rep.x = y;
+      rep.ll = ll;
+      rep.accepted++;
+      p.accepted++;
+    }
+  }
+
+  if (adapt)
+  { // Welford update of the mean and of the sum of the products of the deviations of the positions at this temperature
+    p.n++;
+    for (unsigned i = 0; i < npars; i++)
+    {
+      z[i] = rep.x[i] - p.mean[i];
+      p.mean[i] += z[i] / p.n;
+    }
+    for (unsigned i = 0; i < npars; i++)
+      for (unsigned j = 0; j <= i; j++)
+        p.cov[i * npars + j] += z[i] * (rep.x[j] - p.mean[j]);
+  }
+}
+
+void TemperingSampler::Tune(Proposal& p)
+{
+  // scale towards an efficiency between 0.15 and 0.35, as BAT does in its pre-run
+  double eff = p.proposed > 0 ? (double)p.accepted / p.proposed : 0.;
+  if (eff < 0.15)
+    p.scale /= 1.5;
+  else if (eff > 0.35)
+    p.scale *= 1.5;
+  p.accepted = p.proposed = 0;
+
+  // covariance of the positions so far, kept only if positive definite
+  if (p.n < 2. * npars)
+    return;
+  vector<double> cov(npars * npars), L;
+  for (unsigned i = 0; i < npars; i++)
+    for (unsigned j = 0; j <= i; j++)
+      cov[i * npars + j] = p.cov[i * npars + j] / (p.n - 1.);
+  if (Cholesky(cov, L, npars))
+    p.chol = L;
+}
+
+void TemperingSampler::SetStart(const vector<vector<double> >& x, const vector<double>& cov, double scale)
+{
+  unsigned ntemps = temperatures.size();
+  for (unsigned r = 0; r < replicas.size(); r++)
+  {
+    Replica& rep = replicas[r];
+    rep.x = x[r / ntemps];
+    rep.ll = model.LogLikelihood(rep.x);
+    Proposal& p = proposals[r];
+    vector<double> covT(cov), L;
+    for (unsigned i = 0; i < covT.size(); i++)
+      covT[i] *= temperatures[r % ntemps];
+    if (Cholesky(covT, L, npars))
+      p.chol = L;
+    if (scale > 0.)
+      p.scale = scale;
+  }
+}
+
+void TemperingSampler::GetProposal(unsigned ichain, vector<double>& cov, double& scale) const
+{
+  const Proposal& p = proposals[ichain * temperatures.size()];
+  cov.assign(npars * npars, 0.);
+  for (unsigned i = 0; i < npars; i++)
+    for (unsigned j = 0; j < npars; j++)
+      for (unsigned k = 0; k <= i && k <= j; k++)
+        cov[i * npars + j] += p.chol[i * npars + k] * p.chol[j * npars + k];
+  scale = p.scale;
+}
+
+void TemperingSampler::Swap()
+{
+  // exchange the positions of the replicas k and k + 1 with probability min(1, exp((b_k - b_k+1) (ll_k+1 - ll_k))),
+  // b = 1/T; the proposals stay with their temperature
+  unsigned ntemps = temperatures.size();
+  for (unsigned c = 0; c < nchains; c++)
+    for (unsigned k = evenround ? 0 : 1; k + 1 < ntemps; k += 2)
+    {
+      Replica& a = At(c, k);
+      Replica& b = At(c, k + 1);
+      double dbeta = 1. / temperatures[k] - 1. / temperatures[k + 1];
+      swapproposed[k]++;
+      if (log(swaprnd[c].Rndm()) < dbeta * (b.ll - a.ll))
+      {
+        a.x.swap(b.x);
+        swap(a.ll, b.ll);
+        swapaccepted[k]++;
+      }
+    }
+  evenround = !evenround;
+}
+
+void TemperingSampler::Warmup(unsigned niterations)
+{
+  for (unsigned it = 0; it < niterations; it++)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int r = 0; r < (int)replicas.size(); r++)
+      Step(r, true);
+    if ((it + 1) % swapinterval == 0)
+      Swap();
+    if (it >= niterations / 2) // second half: the observables of the cold states set the ranges of the histograms
+      for (unsigned c = 0; c < nchains; c++)
+        model.AddWarmupState(c, Cold(c).x);
+    if ((it + 1) % 500 == 0 && it + 1 < niterations) // every 500 iterations, as BAT's default pre-run check
+      for (unsigned r = 0; r < proposals.size(); r++)
+        Tune(proposals[r]);
+  }
+  for (unsigned r = 0; r < proposals.size(); r++)
+  {
+    Tune(proposals[r]);
+    proposals[r].mean.clear(); // not needed any more
+    proposals[r].cov.clear();
+  }
+  iteration += niterations;
+}
+
+void TemperingSampler::Iterate()
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < (int)replicas.size(); r++)
+    Step(r, false);
+  iteration++;
+  if (iteration % swapinterval == 0)
+    Swap();
+  for (unsigned c = 0; c < nchains; c++)
+    CountMode(c);
+}
+
+void TemperingSampler::CountMode(unsigned ichain)
+{
+  const vector<double>& x = Cold(ichain).x;
+  unsigned mode = 0;
+  for (unsigned m = 0; m < modepars.size(); m++)
+  {
+    unsigned i = modepars[m];
+    if (fabs(x[i] - 0.5 * (lo[i] + hi[i])) > 0.25 * (hi[i] - lo[i]))
+      mode |= 1u << m; // outer half of the range
+  }
+  modecount[mode]++;
+  ncold++;
+}
+
+vector<pair<string, double> > TemperingSampler::GetModeOccupancy() const
+{
+  vector<pair<string, double> > occ;
+  for (map<unsigned, long>::const_iterator it = modecount.begin(); it != modecount.end(); ++it)
+  {
+    string label;
+    for (unsigned m = 0; m < modepars.size(); m++)
+      label += (m ? " " : "") + model.GetParameter(modepars[m]).GetName() + ((it->first >> m) & 1 ? ":outer" : ":inner");
+    occ.push_back(make_pair(label, (double)it->second / ncold));
+  }
+  return occ;
+}
+
+void TemperingSampler::ResetStatistics()
+{
+  swapaccepted.assign(temperatures.size(), 0);
+  swapproposed.assign(temperatures.size(), 0);
+  for (unsigned r = 0; r < replicas.size(); r++)
+    replicas[r].accepted = replicas[r].proposed = 0;
+  modecount.clear();
+  ncold = 0;
+}
+
+double TemperingSampler::GetSwapRate(unsigned k) const
+{
+  return swapproposed[k] > 0 ? (double)swapaccepted[k] / swapproposed[k] : 0.;
+}
+
+double TemperingSampler::GetEfficiency(unsigned k) const
+{
+  long a = 0, p = 0;
+  for (unsigned c = 0; c < nchains; c++)
+  {
+    a += replicas[c * temperatures.size() + k].accepted;
+    p += replicas[c * temperatures.size() + k].proposed;
+  }
+  return p > 0 ? (double)a / p : 0.;
+}
+
+void TemperingSampler::SaveState(TDirectory& dir) const
+{
+  StateWriter w;
+  w.Add(nchains);
+  w.Add(npars);
+  w.Add(temperatures);
+  w.Add(iteration);
+  w.Add(evenround);
+  for (unsigned r = 0; r < replicas.size(); r++)
+  {
+    w.Add(replicas[r].x);
+    w.Add(replicas[r].ll);
+    w.Add(replicas[r].accepted);
+    w.Add(replicas[r].proposed);
+    const Proposal& p = proposals[r];
+    w.Add(p.chol);
+    w.Add(p.scale);
+    w.Add(p.mean);
+    w.Add(p.cov);
+    w.Add(p.n);
+    w.Add(p.accepted);
+    w.Add(p.proposed);
+    WriteRandom(dir, Form("rnd%u", r), rnd[r]);
+  }
+  for (unsigned c = 0; c < nchains; c++)
+    WriteRandom(dir, Form("swaprnd%u", c), swaprnd[c]);
+  for (unsigned k = 0; k < temperatures.size(); k++)
+  {
+    w.Add(swapaccepted[k]);
+    w.Add(swapproposed[k]);
+  }
+  w.Add(modecount.size());
+  for (map<unsigned, long>::const_iterator it = modecount.begin(); it != modecount.end(); ++it)
+  {
+    w.Add(it->first);
+    w.Add(it->second);
+  }
+  w.Add(ncold);
+  w.Write(dir, "replicas");
+}
+
+void TemperingSampler::LoadState(TDirectory& dir)
+{
+  StateReader r(dir, "replicas");
+  unsigned nch = r.Next(), np = r.Next();
+  vector<double> temps;
+  r.Next(temps);
+  if (nch != nchains || np != npars || temps != temperatures)
+  {
+    cout << "The checkpoint was written by a parallel tempering with other chains, parameters or temperatures" << endl;
+    exit(EXIT_FAILURE);
+  }
+  iteration = r.Next();
+  evenround = r.Next();
+  for (unsigned k = 0; k < replicas.size(); k++)
+  {
+    r.Next(replicas[k].x);
+    replicas[k].ll = r.Next();
+    replicas[k].accepted = r.Next();
+    replicas[k].proposed = r.Next();
+    Proposal& p = proposals[k];
+    r.Next(p.chol);
+    p.scale = r.Next();
+    r.Next(p.mean);
+    r.Next(p.cov);
+    p.n = r.Next();
+    p.accepted = r.Next();
+    p.proposed = r.Next();
+    ReadRandom(dir, Form("rnd%u", k), rnd[k]);
+  }
+  for (unsigned c = 0; c < nchains; c++)
+    ReadRandom(dir, Form("swaprnd%u", c), swaprnd[c]);
+  for (unsigned k = 0; k < temperatures.size(); k++)
+  {
+    swapaccepted[k] = r.Next();
+    swapproposed[k] = r.Next();
+  }
+  modecount.clear();
+  for (unsigned m = r.Next(); m > 0; m--)
+  {
+    unsigned mode = r.Next();
+    modecount[mode] = r.Next();
+  }
+  ncold = r.Next();
+}
@@ -0,0 +1,95 @@
+#ifndef __TEMPERINGSAMPLER__H
+#define __TEMPERINGSAMPLER__H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <TRandom3.h>
+#include <TDirectory.h>
+// ------------------------------------------ Parallel tempering ------------------------------------------------
+// Every chain is a ladder of replicas, one per temperature T, each sampling likelihood^(1/T) times the (flat) prior with
+// a Metropolis of its own: multivariate Cauchy proposal, as BAT's with SetProposeMultivariate(true), whose covariance and
+// scale are tuned during the warmup. The hot replicas cross the barriers between the modes of the phases, and the modes
+// reach the cold replica (T = 1) through exchanges of the positions of neighbouring replicas.
+// All the replicas of all the chains take their Metropolis step in parallel; the exchanges follow, serially, every
+// swapinterval iterations: they only compare the stored log likelihoods and swap the positions.
+// The mode of a point is labelled by the half, inner or outer, of the range of each mode parameter in which it lies:
+// for a phase whose range is its expected value +- pi, the two halves separate the point from its ambiguity at +pi.
+
+using namespace std;
+
+class MixingModel;
+
+class TemperingSampler {
+public:
+
+  // temperatures[0] must be 1, the others increasing
+  TemperingSampler(MixingModel& model, unsigned nchains, const vector<double>& temperatures, unsigned seed);
+
+  // Warm start: every replica of a chain starts from its position x[ichain], the proposal of temperature T from T times
+  // the covariance cov (npars x npars) and, if positive, the scale
+  void SetStart(const vector<vector<double> >& x, const vector<double>& cov, double scale);
+  void GetProposal(unsigned ichain, vector<double>& cov, double& scale) const; // tuned proposal at T = 1 of a chain
+  void Warmup(unsigned niterations); // tune the proposals, with exchanges; the cold states of the second half are passed to MixingModel::AddWarmupState
+  void Iterate(); // one Metropolis step of every replica, then the exchanges when due
+
+  unsigned GetNChains() const { return nchains; }
+  unsigned GetNTemperatures() const { return temperatures.size(); }
+  const vector<double>& GetPoint(unsigned ichain) const { return Cold(ichain).x; } // position of the cold replica
+  double GetLogLikelihood(unsigned ichain) const { return Cold(ichain).ll; }
+
+  // Statistics since the last reset
+  void ResetStatistics();
+  double GetSwapRate(unsigned k) const; // acceptance of the exchanges between the temperatures k and k + 1
+  double GetEfficiency(unsigned k) const; // acceptance of the Metropolis steps at temperature k
+  // Fraction of the cold draws in each mode, with its label
+  void SetModeParameters(const vector<unsigned>& pars) { modepars = pars; }
+  vector<pair<string, double> > GetModeOccupancy() const;
+
+  // Complete state of the replicas, proposals, generators and statistics, for the checkpoints of long runs; the state read
+  // must come from a sampler with the same chains, parameters and temperatures
+  void SaveState(TDirectory& dir) const;
+  void LoadState(TDirectory& dir);
+
+  unsigned swapinterval; // iterations between two rounds of exchanges, 1 by default
+
+private:
+  struct Replica {
+    vector<double> x; // position
+    double ll; // log likelihood
+    long accepted, proposed;
+  };
+
+  struct Proposal { // Metropolis proposal of one temperature of one chain, kept by the temperature through the exchanges
+    vector<double> chol; // Cholesky factor of the covariance, dense
+    double scale;
+    vector<double> mean, cov; // running mean and sum of the products of the deviations, warmup only
+    double n;
+    long accepted, proposed; // since the last tuning
+  };
+
+  Replica& At(unsigned ichain, unsigned k) { return replicas[ichain * temperatures.size() + k]; }
+  const Replica& Cold(unsigned ichain) const { return replicas[ichain * temperatures.size()]; }
+  void Step(unsigned r, bool adapt); // Metropolis step of the replica r
+  void Swap(); // a round of exchanges in every chain
+  void Tune(Proposal& p); // update the covariance and the scale of a proposal from the warmup
+  void CountMode(unsigned ichain);
+
+  MixingModel& model;
+  unsigned nchains, npars;
+  vector<double> temperatures;
+  vector<double> lo, hi;
+  vector<Replica> replicas; // replicas[ichain * ntemperatures + k] has temperature k
+  vector<Proposal> proposals; // same layout
+  vector<TRandom3> rnd; // one per replica, so that the result does not depend on the threads
+  vector<TRandom3> swaprnd; // one per chain
+  unsigned iteration;
+  bool evenround; // the exchanges alternate between the pairs (0,1), (2,3), ... and (1,2), (3,4), ...
+  vector<long> swapaccepted, swapproposed;
+
+  vector<unsigned> modepars;
+  map<unsigned, long> modecount;
+  long ncold;
+};
+
+#endif
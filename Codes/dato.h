@@ -21,27 +21,32 @@ public:
         sigma3 = sig3;
         mean = ave;
         sigma = sqrt(sigma1 * sigma1 + sigma2 * sigma2 + sigma3 * sigma3);
+        invsigma2 = 1. / (sigma * sigma);
     };
 
     virtual ~dato() {
     };
 
-    double getMean() {
+    double getMean() const {
         return mean;
     };
 
-    double getSigma() {
+    double getSigma() const {
         return sigma;
     };
 
-    double weight(double x) {
-        return exp(-0.5 * (x - mean)*(x - mean) / sigma / sigma);
+    double getInvSigma2() const {
+        return invsigma2;
+    };
+
+    double weight(double x) const {
+        return exp(-0.5 * (x - mean)*(x - mean) * invsigma2);
     };
 
 
     //Peso Gaussiano del dato
-    double logweight(double x) {
-        return (-0.5 * (x - mean)*(x - mean) / sigma / sigma);
+    double logweight(double x) const {
+        return (-0.5 * (x - mean)*(x - mean) * invsigma2);
     };
 
     double getRandom() {
@@ -69,6 +74,7 @@ public:
 
 private:
     double mean, sigma, sigma1, sigma2, sigma3;
+    double invsigma2; // 1/sigma^2
 
 };
 
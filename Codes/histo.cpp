@@ -1,51 +1,292 @@
 #include "histo.h"
 #include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-histo::histo(map<string, double>& obs) : h1d(), h2d(), myobs(obs) {
+histo::histo(vector<double>& obs) : h1d(), h2d(), buffersize(100000), samplesize(20000), ranged(false), buffered(false), sparse(false), myobs(obs), nsample(0), pending(false) {
 };
 
-void histo::createH1D(string name, int binx, double minx, double maxx) {
+double histo::memory(int binx, int biny, bool autorange, unsigned buffersize) {
+    // the bins include underflow and overflow; a buffer entry is the weight and the coordinates
+    double bins = biny > 0 ? (binx + 2.) * (biny + 2.) : binx + 2.;
+    double buffer = autorange ? (biny > 0 ? 3. : 2.) * buffersize + 1. : 0.;
+    return (bins + buffer) * sizeof(double);
+}
+
+void histo::createH1D(string name, unsigned slot, int binx, double minx, double maxx) {
 //    std::cout << "creating h1d " << name << std::endl;
     h1dnames.push_back(name);
-    h1d[name] = new TH1D(name.c_str(), name.c_str(), binx, minx, maxx);
+    h1dslot.push_back(slot);
+    TH1D* h = new TH1D(name.c_str(), name.c_str(), binx, minx, maxx);
+    if (minx >= maxx)
+        h->SetBuffer(buffersize);
+    h1d[name] = h;
+    h1dp.push_back(h);
 }
 
 void histo::fillh1d() {
-    for (vector<string>::iterator it = h1dnames.begin(); it != h1dnames.end(); ++it) {
-        string name = *it;
-//        std::cout << "filling h1d " << name << std::endl;
-        h1d[name]->Fill(myobs.at(name));
-//        std::cout << "...done" << std::endl;
-    }
+    for (unsigned i = 0; i < h1dp.size(); ++i)
+        h1dp[i]->Fill(myobs[h1dslot[i]]);
 }
 
-void histo::createH2D(string namey, string namex, int binx, double minx, double maxx,
+void histo::createH2D(string namey, unsigned sloty, string namex, unsigned slotx, int binx, double minx, double maxx,
         int biny, double miny, double maxy) {
     string name = namey + "_vs_" + namex;
 //    std::cout << "creating h2d " << name << std::endl;
     h2dnames.push_back(name);
-    h2d[name] = new TH2D(name.c_str(), name.c_str(), binx, minx, maxx, biny, miny, maxy);
+    h2dslotx.push_back(slotx);
+    h2dsloty.push_back(sloty);
+    h2dbinx.push_back(binx);
+    h2dbiny.push_back(biny);
+    if (sparse) { // created by setranges
+        h2dp.push_back(0);
+        h2sp.push_back(0);
+        return;
+    }
+    TH2D* h = new TH2D(name.c_str(), name.c_str(), binx, minx, maxx, biny, miny, maxy);
+    if (minx >= maxx || miny >= maxy)
+        h->SetBuffer(buffersize);
+    h2d[name] = h;
+    h2dp.push_back(h);
+    h2sp.push_back(0);
 }
 
 void histo::fillh2d() {
-    for (vector<string>::iterator it = h2dnames.begin(); it != h2dnames.end(); ++it) {
-        string name = *it;
-//        std::cout << "filling h2d " << name << std::endl;
-        unsigned pos = name.find("_vs_");
-        double obsx = myobs.at(name.substr(pos + 4));
-        double obsy = myobs.at(name.substr(0, pos));
-        h2d.at(name)->Fill(obsx, obsy);
-//        std::cout << "...done" << std::endl;
+    for (unsigned i = 0; i < h2dp.size(); ++i)
+        if (h2sp[i]) {
+            double xy[2] = {myobs[h2dslotx[i]], myobs[h2dsloty[i]]};
+            h2sp[i]->Fill(xy);
+        } else
+            h2dp[i]->Fill(myobs[h2dslotx[i]], myobs[h2dsloty[i]]);
+}
+
+void histo::fill(const vector<vector<double> >& states) {
+    unsigned first = 0;
+    if (pending) { // kept until there are buffersize of them, flush filling them in before the rest of states
+        unsigned n = myobs.size();
+        for (; first < states.size() && nsample < samplesize; ++first, ++nsample)
+            copy(states[first].begin(), states[first].end(), sample.begin() + nsample * n);
+        if (nsample < samplesize)
+            return;
+        flush();
+    }
+    int n1 = h1dp.size(), n = n1 + h2dp.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (!buffered && !omp_in_parallel())
+#endif
+    for (int k = 0; k < n; ++k) {
+        if (k < n1)
+            for (unsigned c = first; c < states.size(); ++c)
+                h1dp[k]->Fill(states[c][h1dslot[k]]);
+        else {
+            unsigned i = k - n1;
+            if (h2sp[i])
+                for (unsigned c = first; c < states.size(); ++c) {
+                    double xy[2] = {states[c][h2dslotx[i]], states[c][h2dsloty[i]]};
+                    h2sp[i]->Fill(xy);
+                }
+            else
+                for (unsigned c = first; c < states.size(); ++c)
+                    h2dp[i]->Fill(states[c][h2dslotx[i]], states[c][h2dsloty[i]]);
+        }
     }
 }
 
 void histo::write() {
-        for (vector<string>::iterator it = h1dnames.begin(); it != h1dnames.end(); ++it) {
+    for (vector<string>::iterator it = h1dnames.begin(); it != h1dnames.end(); ++it) {
         string name = *it;
         h1d[name]->Write();
     }
-        for (vector<string>::iterator it = h2dnames.begin(); it != h2dnames.end(); ++it) {
-        string name = *it;
-        h2d[name]->Write();
+    for (unsigned i = 0; i < h2dnames.size(); ++i) {
+        if (h2sp[i])
+            h2sp[i]->Write();
+        else if (h2dp[i]) // not yet created if sparse and no state was filled since autoranges
+            h2dp[i]->Write();
+    }
+}
+
+TH2D* histo::getH2D(unsigned i) const {
+    TH2D* h;
+    if (h2sp[i]) {
+        h = h2sp[i]->Projection(1, 0); // y, x
+        h->SetName(h2dnames[i].c_str());
+    } else
+        h = new TH2D(*h2dp[i]);
+    h->SetDirectory(0);
+    return h;
+}
+
+void histo::read(TDirectory& dir) {
+    if (pending)
+        return;
+    for (unsigned i = 0; i < h1dnames.size(); ++i) {
+        const string& name = h1dnames[i];
+        TH1D* h = 0;
+        dir.GetObject(name.c_str(), h);
+        if (!h) {
+            std::cout << "The checkpoint has no histogram " << name << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        h->SetDirectory(0);
+        delete h1dp[i];
+        h1d[name] = h1dp[i] = h;
+        buffered = buffered || h->GetBuffer();
+    }
+    for (unsigned i = 0; i < h2dnames.size(); ++i) {
+        const string& name = h2dnames[i];
+        // written dense or sparse depending on the sparse option of the run that wrote the checkpoint
+        TH2D* h = 0;
+        THnSparseD* hs = 0;
+        dir.GetObject(name.c_str(), h);
+        if (!h)
+            dir.GetObject(name.c_str(), hs);
+        if (!h && !hs) {
+            std::cout << "The checkpoint has no histogram " << name << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (sparse) {
+            if (h) {
+                h->BufferEmpty(1); // entries still buffered by an automatic range
+                hs = static_cast<THnSparseD*> (THnSparse::CreateSparse(name.c_str(), name.c_str(), h));
+                delete h;
+            }
+            delete h2sp[i];
+            h2sp[i] = hs;
+            continue;
+        }
+        if (hs) {
+            h = hs->Projection(1, 0); // y, x
+            h->SetName(name.c_str());
+            delete hs;
+        }
+        h->SetDirectory(0);
+        delete h2dp[i];
+        h2d[name] = h2dp[i] = h;
+        buffered = buffered || h->GetBuffer();
+    }
+    pending = false;
+    sample.clear();
+    sample.shrink_to_fit();
+    ranged = true;
+}
+
+void histo::SaveState(TDirectory& dir) const {
+    StateWriter state;
+    state.Add(pending);
+    if (pending) {
+        state.Add(samplesize);
+        state.Add(rangeq);
+        state.Add(rangemargin);
+        state.Add(rangebins);
+        state.Add(rangeentries);
+        state.Add(vector<double>(sample.begin(), sample.begin() + (size_t) nsample * myobs.size()));
+    }
+    state.Write(dir, "ranges");
+}
+
+void histo::LoadState(TDirectory& dir) {
+    StateReader state(dir, "ranges");
+    pending = state.Next();
+    if (!pending)
+        return;
+    samplesize = state.Next();
+    rangeq = state.Next();
+    rangemargin = state.Next();
+    rangebins = state.Next();
+    rangeentries = state.Next();
+    vector<double> kept;
+    state.Next(kept);
+    nsample = kept.size() / myobs.size();
+    sample.assign((size_t) samplesize * myobs.size(), 0.);
+    copy(kept.begin(), kept.end(), sample.begin());
+    ranged = true;
+}
+
+void histo::collect() {
+    unsigned n = myobs.size();
+    if (sample.empty())
+        sample.resize(samplesize * n);
+    copy(myobs.begin(), myobs.end(), sample.begin() + (nsample % samplesize) * n);
+    nsample++;
+}
+
+bool histo::setranges(double q, double margin, bool autobins, double nentries) {
+    if (min(nsample, samplesize) < 100)
+        return false;
+    applyranges(q, margin, autobins, nentries);
+    sample.clear();
+    sample.shrink_to_fit();
+    ranged = true;
+    return true;
+}
+
+void histo::applyranges(double q, double margin, bool autobins, double nentries) {
+    unsigned n = myobs.size(), ns = min(nsample, samplesize);
+    vector<double> lo(n), hi(n), bins(n, HUGE_VAL), v(ns);
+    for (unsigned i = 0; i < n; ++i) {
+        for (unsigned k = 0; k < ns; ++k)
+            v[k] = sample[k * n + i];
+        sort(v.begin(), v.end());
+        unsigned t = q * (ns - 1);
+        double a = v[t], b = v[ns - 1 - t];
+        if (b > a) {
+            lo[i] = a - margin * (b - a);
+            hi[i] = b + margin * (b - a);
+        } else { // constant in the pre-run
+            double w = a != 0. ? 1.e-3 * fabs(a) : 1.e-3;
+            lo[i] = a - w;
+            hi[i] = a + w;
+        }
+        double iqr = v[(unsigned) (0.75 * (ns - 1))] - v[(unsigned) (0.25 * (ns - 1))];
+        if (autobins && iqr > 0.)
+            bins[i] = ceil((hi[i] - lo[i]) / (2. * iqr * pow(nentries, -1. / 3.)));
+    }
+    for (unsigned k = 0; k < h1dnames.size(); ++k) {
+        TH1D* h = h1dp[k];
+        unsigned i = h1dslot[k];
+        h->SetBins((int) min((double) h->GetNbinsX(), bins[i]), lo[i], hi[i]);
+    }
+    for (unsigned k = 0; k < h2dnames.size(); ++k) {
+        unsigned x = h2dslotx[k], y = h2dsloty[k];
+        int binx = min((double) h2dbinx[k], bins[x]), biny = min((double) h2dbiny[k], bins[y]);
+        if (sparse) {
+            int nbins[2] = {binx, biny};
+            double xmin[2] = {lo[x], lo[y]}, xmax[2] = {hi[x], hi[y]};
+            h2sp[k] = new THnSparseD(h2dnames[k].c_str(), h2dnames[k].c_str(), 2, nbins, xmin, xmax);
+        } else
+            h2dp[k]->SetBins(binx, lo[x], hi[x], biny, lo[y], hi[y]);
+    }
+}
+
+void histo::autoranges(double q, double margin, bool autobins, double nentries) {
+    rangeq = q;
+    rangemargin = margin;
+    rangebins = autobins;
+    rangeentries = nentries;
+    samplesize = buffersize; // the pre-run states are dropped
+    nsample = 0;
+    sample.assign((size_t) samplesize * myobs.size(), 0.);
+    pending = true;
+    ranged = true;
+}
+
+void histo::flush() {
+    if (!pending || nsample == 0)
+        return;
+    pending = false;
+    applyranges(rangeq, rangemargin, rangebins, rangeentries);
+    unsigned n = myobs.size();
+    vector<vector<double> > states(min(nsample, 1000u), vector<double>(n)); // filled by chunks
+    for (unsigned k = 0; k < nsample; k += states.size()) {
+        states.resize(min((unsigned) states.size(), nsample - k));
+        for (unsigned c = 0; c < states.size(); ++c)
+            copy(sample.begin() + (k + c) * n, sample.begin() + (k + c + 1) * n, states[c].begin());
+        fill(states);
     }
+    sample.clear();
+    sample.shrink_to_fit();
 }
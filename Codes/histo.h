@@ -12,6 +12,9 @@
 #include <map>
 #include <TH1D.h>
 #include <TH2D.h>
+#include <THnSparse.h>
+#include <TDirectory.h>
+#include "Checkpoint.h"
 
 using namespace std;
 
@@ -23,21 +26,73 @@ public:
     map<string, TH2D*> h2d;
     vector<string> h1dnames;
     vector<string> h2dnames;
+    vector<unsigned> h1dslot; // slot in myobs of the observable of each h1d
+    vector<unsigned> h2dslotx, h2dsloty; // slots in myobs of the x and y observables of each h2d
+    vector<TH1D*> h1dp; // h1d[h1dnames[i]], so that filling needs no lookup
+    vector<TH2D*> h2dp; // h2d[h2dnames[i]], 0 if sparse
+    vector<THnSparseD*> h2sp; // the histogram h2dnames[i] if sparse, axis 0 being x and axis 1 y
+    vector<int> h2dbinx, h2dbiny; // bins the 2D histograms were created with
 
-    histo(map<string, double>& obs);
+    histo(vector<double>& obs);
 
-    void createH1D(string name, int binx, double minx, double maxx);
+    unsigned buffersize; // entries kept by a histogram with automatic range (min >= max), or states kept by autoranges, to set the ranges
+    unsigned samplesize; // latest states of the pre-run kept to set the ranges
+    bool ranged; // ranges set by setranges or autoranges, or read back
+    bool buffered; // some histograms buffer their entries, and are then filled by one thread
+    // 2D histograms created afterwards are THnSparseD, which store only their occupied bins and are written as such; they
+    // are created once the ranges are set, since they need a fixed range
+    bool sparse;
+
+    // bytes taken by the bins of a histogram of binx (x biny, if not 0) bins and by its buffer if its range is automatic
+    static double memory(int binx, int biny, bool autorange, unsigned buffersize);
+
+    void createH1D(string name, unsigned slot, int binx, double minx, double maxx);
 
     void fillh1d();
 
-    void createH2D(string namey, string namex, int binx, double minx, double maxx,
+    void createH2D(string namey, unsigned sloty, string namex, unsigned slotx, int binx, double minx, double maxx,
             int biny, double miny, double maxy);
 
     void fillh2d();
 
+    // fill every histogram with the observables of all the states, in their order; the histograms are handed out to the
+    // threads 16 at a time as they get free, each filled by one of them only, which needs no synchronisation and gives the
+    // same result for any number of threads (the 1D and the sparse 2D histograms take less time than the dense 2D ones)
+    void fill(const vector<vector<double> >& states);
+
     void write();
-    map<string, double>& myobs;
+
+    TH2D* getH2D(unsigned i) const; // a copy of the 2D histogram i as a TH2D, converted if sparse, owned by the caller
+
+    // replace the histograms with those of the same name written in dir; a 2D histogram written dense is made sparse if
+    // sparse is set, and one written sparse dense otherwise. Nothing is read while the states kept by autoranges are
+    // pending, since none has entered the histograms yet.
+    void read(TDirectory& dir);
+
+    // states kept by autoranges and the arguments to set the ranges from them, for a checkpoint; LoadState comes before read
+    void SaveState(TDirectory& dir) const;
+    void LoadState(TDirectory& dir);
+
+    // Ranges from the pre-run: collect keeps myobs, a state of the pre-run, among the latest samplesize ones; setranges then
+    // sets the range of every histogram, from the quantiles q and 1 - q of its variables in these states widened by margin
+    // times their distance on both sides, before any entry is filled. With autobins the bins of a variable follow the
+    // Freedman-Diaconis rule for nentries entries, up to the bins the histogram was created with. setranges returns false
+    // if fewer than 100 states were kept; autoranges then keeps instead the first buffersize states filled, and sets the
+    // ranges from them with the same arguments before filling them in. flush does it with the states kept so far, when
+    // the results are written.
+    void collect();
+    bool setranges(double q, double margin, bool autobins, double nentries);
+    void autoranges(double q, double margin, bool autobins, double nentries);
+    void flush();
+    vector<double>& myobs;
 private:
+    vector<double> sample; // states kept, state k at k * myobs.size()
+    unsigned nsample; // states collected, the latest samplesize being kept
+    bool pending; // the states filled are kept by autoranges until the ranges are set
+    double rangeq, rangemargin, rangeentries; // arguments of autoranges
+    bool rangebins;
+
+    void applyranges(double q, double margin, bool autobins, double nentries); // sets the ranges from the states kept
 
 };
 
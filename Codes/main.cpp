@@ -6,7 +6,11 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <map>
+#include <cmath>
 #include <TFile.h>
+#include <TROOT.h>
 #include "MixingModel.h"
 
 int main(int argc, char ** argv)
@@ -16,7 +20,15 @@ int main(int argc, char ** argv)
 
   if (argc < 7) {
     std::cout << "To compile the code insert the following arguments: " << std::endl ;
-    std::cout << argv[0] << " N_chains N_events_pre N_events output_filename combination variables_filename" << std::endl << "combination = 0: Charged Beauty only" << std::endl << "combination = 1: B0d only" << std::endl << "combination = 2: B0s only" << std::endl << "combination = 3: All_modes" << std::endl;
+    std::cout << argv[0] << " N_chains N_events_pre N_events output_filename combination variables_filename [sampler [option=value ...]]" << std::endl << "combination = 0: Charged Beauty only" << std::endl << "combination = 1: B0d only" << std::endl << "combination = 2: B0s only" << std::endl << "combination = 3: All_modes" << std::endl << "sampler = metropolis (default), nuts or tempering" << std::endl;
+    std::cout << "options of tempering: temperatures=1,1.3,... (default 10 temperatures from 1 in steps of a factor 1.3), modes=g,d_dk,... (phases whose modes are counted)" << std::endl;
+    std::cout << "options of nuts and tempering: rhat=1.01 and/or ess=400 stop the run when the split R-hat and the bulk and tail ESS of every parameter meet them (N_events is then the maximum), checked every check=1000 iterations, within maxtime=... seconds; monitor=variables checks the variables of variables_filename instead of all the parameters" << std::endl;
+    std::cout << "                             checkpoint=10000 writes the state of the run to output_filename/checkpoint.root every 10000 iterations, at its end and on SIGTERM; resume=yes continues it from there up to N_events, also after its end" << std::endl;
+    std::cout << "options of every sampler: warmstart=folder/warmstart.txt starts the chains and the proposal from the end of a previous run, also of another combination (every run writes output_filename/warmstart.txt)" << std::endl;
+    std::cout << "                          samples=10 stores every 10th state of the chains, with the variables of variables_filename, in the tree of output_filename/samples.root" << std::endl;
+    std::cout << "                          pairs=file fills the 2D histograms only of the pairs of variables listed in file, two names per line (pairs=none for no 2D histograms, all the pairs by default); memory=4096 is the budget of the histograms in MB, checked before the run" << std::endl;
+    std::cout << "                          bins=auto sets the number of bins of each variable from its spread in the pre-run (at most 200), which also sets the ranges; buffer=100000 entries set the range of each histogram when the pre-run is too short" << std::endl;
+    std::cout << "                          sparse=yes keeps the 2D histograms as THnSparseD, only their occupied bins, in memory and in output_filename/results.root" << std::endl;
     exit(0);
   }
   // combination = 0 Charged beauty
@@ -25,13 +37,16 @@ int main(int argc, char ** argv)
   // combination = 3 All_modes
   // combination = 4 only D mixing data 
   // variables_filename = name of the variables for which we want the histograms
+  // sampler = metropolis: BAT's Metropolis, nuts: No-U-Turn sampler, tempering: parallel tempering
+  //           (N_events_pre is then the number of warmup iterations)
+  // option=value = further settings of the sampler, see above
 
   //----------------------------------------------------------------------------------------------------------------------------------
 
 
   //----------------------------------------- Setting the variables for the histograms ----------------------------------------
   int Nchains, Npre, Nevents, combination;
-  std::string filename, Nvarfile;
+  std::string filename, Nvarfile, sampler, word;
 
   Nchains=atoi(argv[1]); // Number of Markov chains
   Npre=atoi(argv[2]); // Number of iterations to thermalize the MCMC algorithm
@@ -39,6 +54,46 @@ int main(int argc, char ** argv)
   filename=string(argv[4]); // Name of the output folder
   combination = atoi(argv[5]); // Type of combination
   Nvarfile = string(argv[6]); // Name of the file containing the variable of interest
+  sampler = argc > 7 ? string(argv[7]) : "metropolis"; // Algorithm sampling the posterior
+  if (sampler != "metropolis" && sampler != "nuts" && sampler != "tempering") {
+    std::cout << "Unknown sampler " << sampler << ", use metropolis, nuts or tempering" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  std::map<string, string> options; // further settings, option=value
+  for (int i = 8; i < argc; i++) {
+    string arg(argv[i]);
+    size_t eq = arg.find('=');
+    if (eq == string::npos) {
+      std::cout << "Options must be given as option=value: " << arg << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    options[arg.substr(0, eq)] = arg.substr(eq + 1);
+  }
+
+  std::vector<double> temperatures; // ladder of the parallel tempering
+  if (options.count("temperatures")) {
+    std::stringstream list(options["temperatures"]);
+    string t;
+    while (getline(list, t, ','))
+      temperatures.push_back(atof(t.c_str()));
+  } else
+    for (int k = 0; k < 10; k++)
+      temperatures.push_back(pow(1.3, k));
+  std::vector<string> modes; // phases whose modes are counted by the parallel tempering
+  std::stringstream modelist(options.count("modes") ? options["modes"] : "g,d_dk,d_dpi,dD_kpi");
+  while (getline(modelist, word, ','))
+    modes.push_back(word);
+  bool converge = options.count("rhat") || options.count("ess"); // run length set by convergence
+  if (converge && sampler == "metropolis") {
+    std::cout << "The run length of BAT's Metropolis is fixed: use tempering with temperatures=1 for a Metropolis that stops at convergence" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  bool resume = options.count("resume") && options["resume"] == "yes"; // continue from the checkpoint
+  int checkpoint = options.count("checkpoint") ? atoi(options["checkpoint"].c_str()) : 0; // iterations between checkpoints
+  if ((resume || checkpoint > 0) && sampler == "metropolis") {
+    std::cout << "BAT's Metropolis cannot be checkpointed: use tempering with temperatures=1 for a Metropolis that can" << std::endl;
+    exit(EXIT_FAILURE);
+  }
 
   std::cout << "Your choice for the parameters: " << std::endl;
   cout << "Number of chains: " << Nchains << endl;
@@ -47,11 +102,13 @@ int main(int argc, char ** argv)
   cout << "Combination type: " << combination<< endl;
   cout << "Name of the output folder: "<< filename << endl;
   cout << "Path of the file containing the parameters of interest: " << Nvarfile << endl;
+  cout << "Sampler: " << sampler << endl;
+  for (std::map<string, string>::iterator it = options.begin(); it != options.end(); ++it)
+    cout << "  " << it->first << " = " << it->second << endl;
 
   std::vector<string> nParameters; // Names of parameters of interest
   std::ifstream variables_file; // file containing the names of the parameters
   variables_file.open(Nvarfile);
-  string word;
   while ( variables_file >> word) {
     nParameters.push_back(word);
   }
@@ -64,6 +121,11 @@ int main(int argc, char ** argv)
 
   //-------------------------------  Performing the fit  ------------------------------------------------------------------
 
+  // the sample store writes its tree from its own thread while this one writes the other files: ROOT has to know before
+  // any of its objects is created, the model's included
+  if (options.count("samples"))
+    ROOT::EnableThreadSafety();
+
   // open log file
   mkdir(filename.c_str(), 0777);
   filename+="/";
@@ -83,7 +145,46 @@ int main(int argc, char ** argv)
   // run MCMC and marginalize posterior wrt. all parameters
   // and all combinations of two parameters
 
-  m.MarginalizeAll();
+  if (converge)
+    m.SetConvergenceTargets(options.count("rhat") ? atof(options["rhat"].c_str()) : 1.01,
+                            options.count("ess") ? atof(options["ess"].c_str()) : 400.,
+                            options.count("check") ? atoi(options["check"].c_str()) : 1000,
+                            options.count("maxtime") ? atof(options["maxtime"].c_str()) : 0.,
+                            options.count("monitor") && options["monitor"] == "variables");
+  if (options.count("pairs") && options["pairs"] != "all") {
+    std::vector<std::pair<string, string> > pairs; // 2D histograms, y and x
+    if (options["pairs"] != "none") {
+      std::ifstream pairs_file(options["pairs"].c_str());
+      if (!pairs_file) {
+        std::cout << "Cannot open the pairs file " << options["pairs"] << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      string x;
+      while (pairs_file >> word >> x)
+        pairs.push_back(std::make_pair(word, x));
+    }
+    m.SetHistogramPairs(pairs);
+  }
+  m.SetHistogramMemory(options.count("memory") ? atof(options["memory"].c_str()) : 4096.,
+                       options.count("buffer") ? atoi(options["buffer"].c_str()) : 100000);
+  m.SetHistogramBins(options.count("bins") && options["bins"] == "auto");
+  m.SetSparseHistograms(options.count("sparse") && options["sparse"] == "yes");
+  m.BookHistograms(); // stops here if over the memory budget
+  if (options.count("warmstart"))
+    m.ReadWarmStart(options["warmstart"]);
+  if (options.count("samples"))
+    m.SetSampleStore(filename + "samples.root", atoi(options["samples"].c_str()));
+  if (resume || checkpoint > 0)
+    m.SetCheckpoint(filename + "checkpoint.root", checkpoint, resume);
+  if (sampler == "nuts")
+    m.MarginalizeAllNUTS(Npre, Nevents);
+  else if (sampler == "tempering")
+    m.MarginalizeAllTempering(Npre, Nevents, temperatures, modes);
+  else
+    m.MarginalizeAll();
+
+  m.CloseSampleStore();
+  m.WriteWarmStart(filename + "warmstart.txt");
 
   // draw all marginalized distributions into a PostScript file
   m.PrintAllMarginalized((filename+"parameters.ps").c_str());
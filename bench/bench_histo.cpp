@@ -0,0 +1,115 @@
+#include "histo.h"
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+// ------------------------------------------ Timing of the filling of the histograms ------------------------------------------------
+// The histograms of nvariables variables (first argument, default 82 as variables_Allmodes_all) and of all their pairs,
+// with nbins bins per axis (second argument, default 200), filled with niterations iterations (third argument, default
+// 1000) of 4 chains of uniform states, best of 3 repetitions:
+// - serial:      one state at a time through fillh1d and fillh2d, as before histo::fill;
+// - dense, sparse: histo::fill of the states of an iteration, with 1, 2, 4, ... threads up to OMP_NUM_THREADS, the 2D
+//                histograms being TH2D or THnSparseD.
+// The 2D histograms take nvariables (nvariables - 1) / 2 (nbins + 2)^2 doubles when dense: 1.1 GB by default.
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point t0) { return chrono::duration<double>(Clock::now() - t0).count(); }
+
+static void Book(histo& h, unsigned n, int nbins)
+{
+  for (unsigned i = 0; i < n; i++)
+    h.createH1D("v" + to_string(i), i, nbins, 0., 1.);
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned j = i + 1; j < n; j++)
+      h.createH2D("v" + to_string(i), i, "v" + to_string(j), j, nbins, 0., 1., nbins, 0., 1.);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 82;
+  int nbins = argc > 2 ? atoi(argv[2]) : 200;
+  unsigned niterations = argc > 3 ? atoi(argv[3]) : 1000;
+  const unsigned nchains = 4;
+  const int repeat = 3;
+#ifdef _OPENMP
+  int maxthreads = omp_get_max_threads();
+#else
+  int maxthreads = 1;
+#endif
+
+  mt19937_64 rng(1);
+  uniform_real_distribution<double> u(0., 1.);
+  vector<vector<vector<double> > > states(niterations, vector<vector<double> >(nchains, vector<double>(n)));
+  for (unsigned k = 0; k < niterations; k++)
+    for (unsigned c = 0; c < nchains; c++)
+      for (unsigned i = 0; i < n; i++)
+        states[k][c][i] = u(rng);
+  double fills = (double)niterations * nchains * (n + n * (n - 1) / 2.);
+
+  printf("%u variables, %u pairs, %d bins, %u iterations of %u chains\n", n, n * (n - 1) / 2, nbins, niterations, nchains);
+  printf("%-8s %8s %12s %12s %10s\n", "mode", "threads", "M fills/s", "ms/iter", "speedup");
+
+  vector<double> obs(n);
+  {
+    histo h(obs);
+    Book(h, n, nbins);
+    double best = HUGE_VAL;
+    for (int r = 0; r < repeat; r++)
+    {
+      Clock::time_point t0 = Clock::now();
+      for (unsigned k = 0; k < niterations; k++)
+        for (unsigned c = 0; c < nchains; c++)
+        {
+          obs = states[k][c];
+          h.fillh1d();
+          h.fillh2d();
+        }
+      best = min(best, Seconds(t0));
+    }
+    printf("%-8s %8d %12.1f %12.3f %10s\n", "serial", 1, fills / best / 1e6, best / niterations * 1e3, "");
+  }
+
+  for (int sparse = 0; sparse < 2; sparse++)
+  {
+    histo h(obs);
+    h.sparse = sparse;
+    Book(h, n, nbins);
+    for (unsigned k = 0; k < 100; k++)
+    { // ranges from the extremes of 100 states, about [0, 1], widened by 1%
+      obs = states[k % niterations][0];
+      h.collect();
+    }
+    h.setranges(0., 0.01, false, 0.);
+    double t1 = 0.;
+    for (int threads = 1;; threads = min(2 * threads, maxthreads))
+    {
+#ifdef _OPENMP
+      omp_set_num_threads(threads);
+#endif
+      double best = HUGE_VAL;
+      for (int r = 0; r < repeat; r++)
+      {
+        Clock::time_point t0 = Clock::now();
+        for (unsigned k = 0; k < niterations; k++)
+          h.fill(states[k]);
+        best = min(best, Seconds(t0));
+      }
+      if (threads == 1)
+        t1 = best;
+      printf("%-8s %8d %12.1f %12.3f %10.2f\n", sparse ? "sparse" : "dense", threads, fills / best / 1e6,
+             best / niterations * 1e3, t1 / best);
+      if (threads == maxthreads)
+        break;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "TestPoints.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+// ------------------------------------------ Timing of the log likelihood ------------------------------------------------
+// For every combination (or the one given as second argument), at npoints random points (first argument, default
+// 20000), best of 5 repetitions:
+// - full:        LogLikelihood at points differing in every parameter, as with the multivariate proposals;
+// - lanes:       LogLikelihoodBatch of the same points on one thread, Lanes::size() points at a time, and its gain over
+//                full: both are the throughput of one core;
+// - batch:       LogLikelihoodBatch of the same points, over OMP_NUM_THREADS threads;
+// - one-par:     moving a single parameter at each call, with and without the incremental likelihood;
+// - gradient:    LogLikelihoodGradient, and its cost in units of a full evaluation.
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point t0) { return chrono::duration<double>(Clock::now() - t0).count(); }
+
+int main(int argc, char** argv)
+{
+  int npoints = argc > 1 ? atoi(argv[1]) : 20000;
+  int first = argc > 2 ? atoi(argv[2]) : 0, last = argc > 2 ? first : 4;
+  const int repeat = 5;
+
+  int width = 1;
+#ifdef LANES
+  width = Lanes::size();
+#endif
+  printf("%d lanes\n", width);
+  printf("%4s %5s %12s %12s %8s %12s %14s %14s %12s %8s %10s\n", "comb", "npar", "full us", "lanes us", "gain", "batch us",
+         "one-par full", "one-par incr", "gradient us", "ratio", "tape nodes");
+  for (int comb = first; comb <= last; comb++)
+  {
+    MixingModel m(TestVariables(comb), comb);
+    unsigned npars = m.GetNParameters();
+    TestPoints rnd(2000 + comb);
+    vector<vector<double> > points(npoints);
+    for (int k = 0; k < npoints; k++)
+      points[k] = rnd.Point(m, 0.05);
+    // random walk moving one parameter at a time
+    vector<vector<double> > walk(npoints, points[0]);
+    for (int k = 1; k < npoints; k++)
+    {
+      walk[k] = walk[k - 1];
+      unsigned i = k % npars;
+      walk[k][i] = rnd.Uniform(m.GetParameter(i).GetLowerLimit(), m.GetParameter(i).GetUpperLimit());
+    }
+
+    double tfull = 1e30, tlanes = 1e30, tbatch = 1e30, tonefull = 1e30, toneinc = 1e30, tgrad = 1e30, sum = 0.;
+    vector<double> ll, gradient;
+    vector<unsigned> deps = m.contexts[0].pardeps;
+    for (int r = 0; r < repeat; r++)
+    {
+      Clock::time_point t0 = Clock::now();
+      for (int k = 0; k < npoints; k++)
+        sum += m.LogLikelihood(points[k]);
+      tfull = min(tfull, Seconds(t0));
+
+#ifdef _OPENMP
+      int threads = omp_get_max_threads();
+      omp_set_num_threads(1);
+#endif
+      t0 = Clock::now();
+      m.LogLikelihoodBatch(points, ll);
+      tlanes = min(tlanes, Seconds(t0));
+#ifdef _OPENMP
+      omp_set_num_threads(threads);
+#endif
+
+      t0 = Clock::now();
+      m.LogLikelihoodBatch(points, ll);
+      tbatch = min(tbatch, Seconds(t0));
+
+      for (unsigned t = 0; t < m.contexts.size(); t++)
+        m.contexts[t].pardeps.clear(); // every block depends on every parameter
+      t0 = Clock::now();
+      for (int k = 0; k < npoints; k++)
+        sum += m.LogLikelihood(walk[k]);
+      tonefull = min(tonefull, Seconds(t0));
+      for (unsigned t = 0; t < m.contexts.size(); t++)
+        m.contexts[t].pardeps = deps;
+      t0 = Clock::now();
+      for (int k = 0; k < npoints; k++)
+        sum += m.LogLikelihood(walk[k]);
+      toneinc = min(toneinc, Seconds(t0));
+
+      t0 = Clock::now();
+      for (int k = 0; k < npoints; k++)
+        sum += m.LogLikelihoodGradient(points[k], gradient);
+      tgrad = min(tgrad, Seconds(t0));
+    }
+    double us = 1e6 / npoints;
+    printf("%4d %5u %12.3f %12.3f %8.2f %12.3f %14.3f %14.3f %12.3f %8.1f %10u\n", comb, npars, tfull * us, tlanes * us,
+           tfull / tlanes, tbatch * us, tonefull * us, toneinc * us, tgrad * us, tgrad / tfull, (unsigned)m.tapes[0].size());
+    if (sum == 0.)
+      printf("(sum %g)\n", sum); // keeps the evaluations from being optimized away
+  }
+  return 0;
+}
@@ -3,7 +3,14 @@ codes_folder="$PWD/Codes" ## path to the folder containing the classes
 Path_to_ROOTSYS="$ROOTSYS/bin/root-config --cflags --libs"
 Path_to_BAT_config="bat-config --cflags"
 Path_to_BAT_libs="bat-config --libs"
+arch="-march=native" ## instruction set of this machine, which sets the points per SIMD pack of LogLikelihoodBatch; empty for a portable build
 
-g++ -c "$codes_folder/histo.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
-g++ -c "$codes_folder/CorrelatedGaussianObservables.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
-g++ -c "$codes_folder/MixingModel.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/histo.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/CorrelatedGaussianObservables.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/BlockDiagonalGaussian.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/MixingContext.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/MixingModel.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/NUTSSampler.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/TemperingSampler.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/ConvergenceMonitor.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
+g++ -fopenmp $arch -c "$codes_folder/SampleStore.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs`
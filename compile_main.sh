@@ -6,10 +6,13 @@ Nevents=$3 ## Number of events per chain used to do the statistics
 output_filename=$4 ## Name of the output folder
 Comb_type=$5 ## 0, 1, 2, 3 Charged, B0d, B0s, All
 variables_folder="$PWD/Variables/$6"
+sampler=${7:-metropolis} ## metropolis, nuts or tempering
+if [ $# -gt 7 ]; then shift 7; options="$@"; fi ## option=value settings of the sampler
 Path_to_ROOTSYS="$ROOTSYS/bin/root-config --cflags --libs"
 Path_to_BAT_config="bat-config --cflags"
 Path_to_BAT_libs="bat-config --libs"
+arch="-march=native" ## instruction set of this machine, which sets the points per SIMD pack of LogLikelihoodBatch; empty for a portable build
 
-g++ -o main.x "$codes_folder/main.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs` histo.o CorrelatedGaussianObservables.o MixingModel.o
+g++ -fopenmp $arch -o main.x "$codes_folder/main.cpp" `$Path_to_ROOTSYS` `$Path_to_BAT_config` `$Path_to_BAT_libs` histo.o CorrelatedGaussianObservables.o BlockDiagonalGaussian.o MixingContext.o MixingModel.o NUTSSampler.o TemperingSampler.o ConvergenceMonitor.o SampleStore.o
 
-time ./main.x $Nchains $Nevents_pre $Nevents $output_filename $Comb_type $variables_folder
+time ./main.x $Nchains $Nevents_pre $Nevents $output_filename $Comb_type $variables_folder $sampler $options
@@ -0,0 +1,19 @@
+#ifndef __CHECK__H
+#define __CHECK__H
+
+#include <iostream>
+// ------------------------------------------ Checks of the tests ------------------------------------------------
+// Failed checks are counted, and reported by the exit status of the test
+
+using namespace std;
+
+static int failures = 0;
+#define CHECK(condition, message)                                                       \
+  do {                                                                                  \
+    if (!(condition)) {                                                                 \
+      cout << __FILE__ << ":" << __LINE__ << ": " << message << endl;                   \
+      failures++;                                                                       \
+    }                                                                                   \
+  } while (0)
+
+#endif
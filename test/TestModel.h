@@ -0,0 +1,71 @@
+#ifndef __TESTMODEL__H
+#define __TESTMODEL__H
+
+#include <cmath>
+#include "TestPoints.h"
+#include "Check.h"
+// ------------------------------------------ MixingModel driven the way BAT's Metropolis drives it ------------------------------------------------
+// The tests call the hooks of the model in the order of BAT's run: MCMCCurrentPointInterface after every proposal of
+// every chain, MCMCUserIterationInterface once all the chains have made their step.
+
+using namespace std;
+
+class TestModel : public MixingModel {
+public:
+
+  TestModel(int combination) : MixingModel(TestVariables(combination), combination), rnd(3000 + combination) {};
+
+  // Start nchains chains at the given point, in the pre-run
+  void Start(unsigned nchains, const vector<double>& point)
+  {
+    SetNChains(nchains);
+    MCMCInitialize();
+    MCMCUserInitialize();
+    fMCMCPhase = BCEngineMCMC::kPreRun;
+    current.assign(nchains, point);
+    currentll.assign(nchains, LogLikelihood(point));
+    for (unsigned i = 0; i < nchains; i++)
+    {
+      fMCMCStates[i].parameters = point;
+      fMCMCStates[i].log_likelihood = currentll[i];
+    }
+    proposal = point;
+  }
+  void MainRun() { fMCMCPhase = BCEngineMCMC::kMainRun; }
+
+  // Metropolis step of the chain ichain, moving every parameter by up to step times its range; returns whether it moved
+  bool Step(unsigned ichain, double step)
+  {
+    for (unsigned i = 0; i < GetNParameters(); i++)
+    {
+      double lo = GetParameter(i).GetLowerLimit(), hi = GetParameter(i).GetUpperLimit();
+      proposal[i] = current[ichain][i] + step * (hi - lo) * (rnd.Uniform() - 0.5);
+      proposal[i] = proposal[i] < lo ? lo : (proposal[i] > hi ? hi : proposal[i]);
+    }
+    double ll = LogLikelihood(proposal);
+    bool accepted = log(rnd.Uniform()) < ll - currentll[ichain];
+    if (accepted)
+    {
+      current[ichain] = proposal;
+      currentll[ichain] = ll;
+      fMCMCStates[ichain].parameters = proposal;
+      fMCMCStates[ichain].log_likelihood = ll;
+    }
+    MCMCCurrentPointInterface(proposal, ichain, accepted);
+    return accepted;
+  }
+  // One iteration: a step of every chain, then the hook that fills the histograms
+  void Iterate(double step)
+  {
+    for (unsigned i = 0; i < GetNChains(); i++)
+      Step(i, step);
+    MCMCUserIterationInterface();
+  }
+
+  vector<vector<double> > current; // state of each chain
+  vector<double> currentll;
+  vector<double> proposal;
+  TestPoints rnd;
+};
+
+#endif
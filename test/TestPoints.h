@@ -0,0 +1,58 @@
+#ifndef __TESTPOINTS__H
+#define __TESTPOINTS__H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <stdint.h>
+#include "MixingModel.h"
+// ------------------------------------------ Helpers shared by the tests and the benchmarks ------------------------------------------------
+// The points come from a generator of our own (splitmix64) rather than TRandom3 or <random>, so that they, and the
+// reference values computed at them, are the same with every ROOT version and standard library.
+
+using namespace std;
+
+class TestPoints {
+public:
+
+  TestPoints(uint64_t seed) : state(seed) {};
+
+  double Uniform() { return (Next() >> 11) * (1. / 9007199254740992.); } // in [0, 1), 53 random bits
+  double Uniform(double lo, double hi) { return lo + (hi - lo) * Uniform(); }
+
+  // A point within the ranges of the parameters of m, margin being the fraction of each range left out on both sides
+  vector<double> Point(const MixingModel& m, double margin = 0.)
+  {
+    vector<double> p(m.GetNParameters());
+    for (unsigned i = 0; i < p.size(); i++)
+    {
+      double lo = m.GetParameter(i).GetLowerLimit(), hi = m.GetParameter(i).GetUpperLimit();
+      p[i] = Uniform(lo + margin * (hi - lo), hi - margin * (hi - lo));
+    }
+    return p;
+  }
+
+private:
+  uint64_t state;
+  uint64_t Next()
+  {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+};
+
+// Variables of the histograms given to the model by the tests, available in every combination
+inline vector<string> TestVariables(int comb)
+{
+  vector<string> v;
+  if (comb != 4)
+    v.push_back("g");
+  v.push_back("x12");
+  v.push_back("y12");
+  return v;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "TestModel.h"
+#include <new>
+// ------------------------------------------ The main run does no heap allocation ------------------------------------------------
+// Every operator new is counted. After a short pre-run and the first iterations of the main run, which set the ranges
+// of the histograms, the likelihood, the observables of the chains and the filling of the histograms must not
+// allocate at all, and neither must the gradient once its tape has been recorded.
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // the replacements below pair malloc and free themselves
+#endif
+
+static bool counting = false;
+static unsigned long allocations = 0;
+
+void* operator new(size_t size)
+{
+  if (counting)
+    allocations++;
+  void* p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+int main()
+{
+  const unsigned nchains = 4, niterations = 1000;
+  for (int comb = 0; comb < 5; comb++)
+  {
+    TestModel m(comb);
+    vector<double> centre(m.GetNParameters());
+    for (unsigned i = 0; i < centre.size(); i++)
+      centre[i] = 0.5 * (m.GetParameter(i).GetLowerLimit() + m.GetParameter(i).GetUpperLimit());
+    m.Start(nchains, centre);
+    for (int it = 0; it < 200; it++)
+      m.Iterate(0.01);
+    m.MainRun();
+    for (int it = 0; it < 10; it++)
+      m.Iterate(0.01);
+
+    allocations = 0;
+    counting = true;
+    for (unsigned it = 0; it < niterations; it++)
+      m.Iterate(0.01);
+    counting = false;
+    CHECK(allocations == 0, "comb " << comb << ": " << allocations << " heap allocations in " << niterations << " iterations of "
+          << nchains << " chains");
+
+    // the gradient reuses its tape from one call to the next: once the states of the chains have been recorded,
+    // recording them again allocates nothing
+    vector<double> gradient;
+    for (unsigned i = 0; i < nchains; i++)
+      m.LogLikelihoodGradient(m.current[i], gradient);
+    allocations = 0;
+    counting = true;
+    for (unsigned it = 0; it < niterations; it++)
+      m.LogLikelihoodGradient(m.current[it % nchains], gradient);
+    counting = false;
+    CHECK(allocations == 0, "comb " << comb << ": " << allocations << " heap allocations in " << niterations << " gradients");
+  }
+
+  if (failures == 0)
+    cout << "test_allocations: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,52 @@
+#include "TestModel.h"
+// ------------------------------------------ Observables of the chains after accepted and rejected proposals ------------------------------------------------
+// The observables kept for each chain must always be those of its current state: a rejected first proposal must not
+// leave them at the proposed point, and a rejected later one must keep those of the last accepted point.
+
+// Observables of the model's variables at a point
+static vector<double> Observables(MixingModel& m, const vector<double>& point)
+{
+  MixingContext c(m.comb, m.meas, m.corrmeas);
+  c.SetParameters(point);
+  vector<double> values(m.obsid.size());
+  c.FillObservables(m.obsid, values);
+  return values;
+}
+
+int main()
+{
+  for (int comb = 0; comb < 5; comb++)
+  {
+    TestModel m(comb);
+    TestPoints rnd(4000 + comb);
+    const unsigned nchains = 3;
+    vector<double> start = rnd.Point(m), moved = rnd.Point(m), rejected = rnd.Point(m);
+    vector<double> atstart = Observables(m, start), atmoved = Observables(m, moved);
+    m.Start(nchains, start);
+
+    // first proposal: rejected by chain 0, accepted by chain 1, none yet for chain 2
+    m.LogLikelihood(rejected);
+    m.MCMCCurrentPointInterface(rejected, 0, false);
+    m.LogLikelihood(moved);
+    m.MCMCCurrentPointInterface(moved, 1, true);
+    m.MCMCUserIterationInterface();
+    CHECK(m.chainobs[0] == atstart, "comb " << comb << ": chain 0 has the observables of its rejected first proposal");
+    CHECK(m.chainobs[1] == atmoved, "comb " << comb << ": chain 1 does not have the observables of its accepted proposal");
+    CHECK(m.chainobs[2] == atstart, "comb " << comb << ": chain 2 does not have the observables of its start");
+
+    // later proposals, all rejected
+    for (unsigned i = 0; i < nchains; i++)
+    {
+      m.LogLikelihood(rejected);
+      m.MCMCCurrentPointInterface(rejected, i, false);
+    }
+    m.MCMCUserIterationInterface();
+    CHECK(m.chainobs[0] == atstart, "comb " << comb << ": chain 0 lost the observables of its start");
+    CHECK(m.chainobs[1] == atmoved, "comb " << comb << ": chain 1 lost the observables of its accepted proposal");
+    CHECK(m.chainobs[2] == atstart, "comb " << comb << ": chain 2 lost the observables of its start");
+  }
+
+  if (failures == 0)
+    cout << "test_chainobs: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
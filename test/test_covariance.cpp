@@ -0,0 +1,58 @@
+#include "TestPoints.h"
+#include "Check.h"
+#include <cmath>
+// ------------------------------------------ Correlated measurements with any covariance ------------------------------------------------
+// The chi2 of a CorrelatedGaussianObservables must be (v - Obs)^T Cov^-1 (v - Obs), with Cov^-1 from an explicit
+// inversion, whether Cov is positive definite (Cholesky factor) or not (LDL^T factor); a singular Cov is reported.
+
+// Correlated measurement of three values with uncertainties 0.1, 0.2, 0.3 and the correlations r01, r02, r12
+static CorrelatedGaussianObservables Measurement(double r01, double r02, double r12, TMatrixDSym& Cov)
+{
+  vector<dato> data;
+  data.push_back(dato(1., 0.1));
+  data.push_back(dato(2., 0.2));
+  data.push_back(dato(3., 0.3));
+  TMatrixDSym Corr(3);
+  double r[3][3] = {{1., r01, r02}, {r01, 1., r12}, {r02, r12, 1.}};
+  Cov.ResizeTo(3, 3);
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+    {
+      Corr(i, j) = r[i][j];
+      Cov(i, j) = data[i].getSigma() * r[i][j] * data[j].getSigma();
+    }
+  return CorrelatedGaussianObservables(data, Corr);
+}
+
+int main()
+{
+  TestPoints rnd(7000);
+  const double cases[2][3] = {{0.5, 0.2, -0.3}, {0.9, 0.9, -0.9}}; // positive definite, indefinite
+  for (int c = 0; c < 2; c++)
+  {
+    TMatrixDSym Cov(3);
+    CorrelatedGaussianObservables m = Measurement(cases[c][0], cases[c][1], cases[c][2], Cov);
+    CHECK(m.IsPositiveDefinite() == (c == 0), "case " << c << ": positive definite " << m.IsPositiveDefinite());
+    CHECK(!m.IsSingular(), "case " << c << ": singular");
+    TMatrixDSym Inv(Cov);
+    Inv.InvertFast();
+    for (int k = 0; k < 20; k++)
+    {
+      double v[3], chisq = 0.;
+      for (int i = 0; i < 3; i++)
+        v[i] = m.getObs()(i) + rnd.Uniform(-0.5, 0.5);
+      for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+          chisq += (v[i] - m.getObs()(i)) * Inv(i, j) * (v[j] - m.getObs()(j));
+      double ll = m.logweight(v);
+      CHECK(fabs(ll + 0.5 * chisq) <= 1e-10 * max(1., fabs(chisq)), "case " << c << ": log weight " << ll << " instead of " << -0.5 * chisq);
+    }
+  }
+
+  TMatrixDSym Cov(3);
+  CHECK(Measurement(1., 1., 1., Cov).IsSingular(), "fully correlated measurement not reported as singular");
+
+  if (failures == 0)
+    cout << "test_covariance: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,42 @@
+#include "TestPoints.h"
+#include "Check.h"
+#include <cmath>
+#include <algorithm>
+// ------------------------------------------ Gradient of the log likelihood against finite differences ------------------------------------------------
+// At random points of every combination, LogLikelihoodGradient must return the value of LogLikelihood and a gradient
+// agreeing with central finite differences. The step is 1e-6 of the parameter (at least 1e-6), so that the rounding of
+// log likelihoods of order 1e5 leaves about 1e-5 on the differences: the tolerance is 1e-3 of max(1, |derivative|).
+
+int main()
+{
+  for (int comb = 0; comb < 5; comb++)
+  {
+    MixingModel m(TestVariables(comb), comb);
+    unsigned npars = m.GetNParameters();
+    TestPoints rnd(6000 + comb);
+    vector<double> gradient;
+    for (int k = 0; k < 10; k++)
+    {
+      vector<double> point = rnd.Point(m, 0.05);
+      double ll = m.LogLikelihoodGradient(point, gradient), ref = m.LogLikelihood(point);
+      CHECK(fabs(ll - ref) <= 1e-12 * fabs(ref), "comb " << comb << " point " << k << ": value " << ll << " instead of " << ref);
+      CHECK(gradient.size() == npars, "comb " << comb << ": " << gradient.size() << " derivatives for " << npars << " parameters");
+      for (unsigned i = 0; i < npars && i < gradient.size(); i++)
+      {
+        vector<double> p = point;
+        double h = 1e-6 * max(1., fabs(p[i]));
+        p[i] = point[i] + h;
+        double up = m.LogLikelihood(p);
+        p[i] = point[i] - h;
+        double down = m.LogLikelihood(p);
+        double fd = (up - down) / (2 * h);
+        CHECK(fabs(gradient[i] - fd) <= 1e-3 * max(1., fabs(fd)), "comb " << comb << " point " << k << ": derivative with respect to "
+              << m.GetParameter(i).GetName() << " " << gradient[i] << " instead of " << fd);
+      }
+    }
+  }
+
+  if (failures == 0)
+    cout << "test_gradient: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
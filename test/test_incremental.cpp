@@ -0,0 +1,66 @@
+#include "TestPoints.h"
+#include "Check.h"
+#include <cstring>
+// ------------------------------------------ Incremental likelihood against the declared dependencies ------------------------------------------------
+// The map from the parameters to the blocks of the likelihood comes from the declarations of MixingModel::DeclareBlock.
+// For every combination:
+// - with the validation on, random walks moving one, a few or all the parameters at a time: any incremental evaluation
+//   differing from a full recomputation stops the program;
+// - at random points, moving each parameter alone must change only blocks it is declared to affect.
+
+int main()
+{
+  for (int comb = 0; comb < 5; comb++)
+  {
+    MixingModel m(TestVariables(comb), comb);
+    unsigned npars = m.GetNParameters();
+    TestPoints rnd(5000 + comb);
+
+    m.SetIncrementalValidation(true);
+    vector<double> point = rnd.Point(m);
+    for (int k = 0; k < 3000; k++)
+    {
+      unsigned nmoved = k % 3 == 0 ? 1 : (k % 3 == 1 ? 3 : npars);
+      for (unsigned j = 0; j < nmoved; j++)
+      {
+        unsigned i = nmoved == npars ? j : (unsigned)(rnd.Uniform() * npars) % npars;
+        point[i] = rnd.Uniform(m.GetParameter(i).GetLowerLimit(), m.GetParameter(i).GetUpperLimit());
+      }
+      m.LogLikelihood(point);
+    }
+    m.SetIncrementalValidation(false);
+
+    MixingContext& c = m.contexts[0];
+    double base[MixingContext::NBlocks];
+    for (int ipoint = 0; ipoint < 10; ipoint++)
+    {
+      vector<double> p = rnd.Point(m);
+      c.SetParameters(p);
+      for (unsigned k = 0; k < c.blocks.size(); k++)
+        c.CalculatePredictions(c.blocks[k]);
+      for (unsigned k = 0; k < c.blocks.size(); k++)
+        base[c.blocks[k]] = c.BlockLogWeight(c.blocks[k]);
+      for (unsigned i = 0; i < npars; i++)
+      {
+        vector<double> moved = p;
+        moved[i] = rnd.Uniform(m.GetParameter(i).GetLowerLimit(), m.GetParameter(i).GetUpperLimit());
+        c.SetParameters(moved);
+        for (unsigned k = 0; k < c.blocks.size(); k++)
+          c.CalculatePredictions(c.blocks[k]);
+        for (unsigned k = 0; k < c.blocks.size(); k++)
+        {
+          int b = c.blocks[k];
+          double v = c.BlockLogWeight(b);
+          CHECK(memcmp(&v, &base[b], sizeof(double)) == 0 || (c.pardeps[i] >> b & 1u),
+                "comb " << comb << ": the block " << BlockName[b] << " changes with " << m.GetParameter(i).GetName()
+                << ", which it is not declared to depend on");
+        }
+      }
+    }
+    c.Invalidate();
+  }
+
+  if (failures == 0)
+    cout << "test_incremental: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
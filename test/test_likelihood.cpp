@@ -0,0 +1,57 @@
+#include "TestPoints.h"
+#include "Check.h"
+#include <cmath>
+#include <cstring>
+// ------------------------------------------ Regression test of the log likelihood ------------------------------------------------
+// The log likelihood of every combination at fixed random points must match the reference values below. The batch entry
+// point must give the values of LogLikelihood: to 1e-14 relative for the points in the lanes of its SIMD packs, whose
+// sines and cosines are computed otherwise, and exactly for the remaining ones, evaluated by LogLikelihood itself.
+// The references were computed with this code. For combinations 0-3 they agree with the code before the per-thread
+// contexts (MixingModel only) to 6e-14 relative. Combination 4 differs there by up to 2e-7, because that code read
+// gamma uninitialized in Calculate_old_observables.
+
+static const int npoints = 8;
+static const double reference[5][npoints] = {
+  {-157975.8764465079, -64925.494368109998, -85397.412028734281, -31564.251277477972, -87275.424276463527, -280951.16642214754, -51247.794518709612, -123208.58205309168},
+  {-29192.651903842849, -46124.721480048029, -388872.6847264946, -98239.796718018275, -289781.79659951216, -15319.990980728273, -596694.78470568627, -117907.22141500415},
+  {-41391.668005950691, -63517.763107909072, -80058.120749213034, -123092.0696027332, -64415.736061190932, -72512.327482860332, -604491.79986578086, -66776.68990909381},
+  {-206642.39550863978, -168296.78175124715, -24468.004370705385, -185148.74321905835, -108226.32283869421, -239658.5209753011, -125398.60694212902, -44815.12601981662},
+  {-146137.88546967477, -382762.11162972788, -28432.490875452513, -46792.03621262755, -139002.09079077712, -398255.1015165018, -37910.782409634041, -42476.100398425879}};
+
+int main()
+{
+  for (int comb = 0; comb < 5; comb++)
+  {
+    MixingModel m(TestVariables(comb), comb);
+    TestPoints rnd(1000 + comb);
+    vector<vector<double> > points;
+    for (int k = 0; k < npoints; k++)
+    {
+      points.push_back(rnd.Point(m));
+      double ll = m.LogLikelihood(points[k]);
+      CHECK(fabs(ll - reference[comb][k]) <= 1e-12 * fabs(reference[comb][k]),
+            "comb " << comb << " point " << k << ": log likelihood " << ll << " instead of " << reference[comb][k]);
+    }
+
+    // the batch of the same points and of further ones, some repeated, leaving a few points out of the packs
+    for (int k = 0; k < 203; k++)
+      points.push_back(k % 10 == 0 ? points[k] : rnd.Point(m));
+    vector<double> batch;
+    m.LogLikelihoodBatch(points, batch);
+    CHECK(batch.size() == points.size(), "comb " << comb << ": " << batch.size() << " batch values for " << points.size() << " points");
+    unsigned inpacks = 0;
+#ifdef LANES
+    inpacks = points.size() / Lanes::size() * Lanes::size();
+#endif
+    for (unsigned k = 0; k < points.size() && k < batch.size(); k++)
+    {
+      double ll = m.LogLikelihood(points[k]);
+      CHECK(k < inpacks ? fabs(batch[k] - ll) <= 1e-14 * fabs(ll) : memcmp(&ll, &batch[k], sizeof(double)) == 0,
+            "comb " << comb << " point " << k << ": batch value " << batch[k] << " instead of " << ll);
+    }
+  }
+
+  if (failures == 0)
+    cout << "test_likelihood: all checks passed" << endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}